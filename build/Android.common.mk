@@ -81,6 +81,19 @@ $(info Enabling ART_USE_PORTABLE_COMPILER because WITH_ART_USE_PORTABLE_COMPILER
 ART_USE_PORTABLE_COMPILER := true
 endif
 
+#
+# Used to enable implicit null checks
+#
+ART_USE_IMPLICIT_NULL_CHECKS := false
+ifneq ($(wildcard art/USE_IMPLICIT_NULL_CHECKS),)
+$(info Enabling ART_USE_IMPLICIT_NULL_CHECKS because of existence of art/USE_IMPLICIT_NULL_CHECKS)
+ART_USE_IMPLICIT_NULL_CHECKS := true
+endif
+ifeq ($(WITH_ART_USE_IMPLICIT_NULL_CHECKS),true)
+$(info Enabling ART_USE_IMPLICIT_NULL_CHECKS because WITH_ART_USE_IMPLICIT_NULL_CHECKS=true)
+ART_USE_IMPLICIT_NULL_CHECKS := true
+endif
+
 LLVM_ROOT_PATH := external/llvm
 include $(LLVM_ROOT_PATH)/llvm.mk
 
@@ -125,6 +138,10 @@ ifeq ($(ART_SEA_IR_MODE),true)
   art_cflags += -DART_SEA_IR_MODE=1
 endif
 
+ifeq ($(ART_USE_IMPLICIT_NULL_CHECKS),true)
+  art_cflags += -DART_USE_IMPLICIT_NULL_CHECKS=1
+endif
+
 ifeq ($(HOST_OS),linux)
   art_non_debug_cflags := \
 	-Wframe-larger-than=1728
@@ -44,6 +44,8 @@ enum SpecialTargetRegister {
   kRet0,
   kRet1,
   kInvokeTgt,
+  kHiddenArg,       // Interface method for the imt conflict stub, see NextInterfaceCallInsn.
+  kHiddenFpArg,     // Where x86 passes it, as it has no core register left.
   kCount
 };
 
@@ -187,21 +187,44 @@ static CompiledMethod* CompileMethod(CompilerDriver& compiler,
   }
 #endif
 
+  /* Inline calls of trivial methods, whose leftovers only the Quick backend understands */
+  if (compiler_backend == kQuick) {
+    cu.mir_graph->InlineCalls(Runtime::Current()->GetInlineMaxCodeUnits());
+  }
+
   /* Do a code layout pass */
   cu.mir_graph->CodeLayout();
 
+  /* Give the loops preheaders to hoist their invariants to */
+  if (compiler_backend == kQuick) {
+    cu.mir_graph->InsertLoopPreheaders();
+  }
+
   /* Perform SSA transformation for the whole method */
   cu.mir_graph->SSATransformation();
 
   /* Do constant propagation */
   cu.mir_graph->PropagateConstants();
 
+  /* Eliminate computations and checks redundant across basic blocks */
+  cu.mir_graph->GlobalRedundancyElimination();
+
   /* Count uses */
   cu.mir_graph->MethodUseCount();
 
   /* Perform null check elimination */
   cu.mir_graph->NullCheckElimination();
 
+  /* Hoist loop invariant computations */
+  if (compiler_backend == kQuick) {
+    cu.mir_graph->LoopInvariantCodeMotion();
+  }
+
+  /* Eliminate the range checks of array accesses by loop induction variables */
+  if (compiler_backend == kQuick) {
+    cu.mir_graph->RangeCheckElimination();
+  }
+
   /* Combine basic blocks where possible */
   cu.mir_graph->BasicBlockCombine();
 
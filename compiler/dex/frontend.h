@@ -56,6 +56,10 @@ enum opt_control_vector {
   kMatch,
   kPromoteCompilerTemps,
   kBranchFusing,
+  kInlineCalls,
+  kGlobalValueNumbering,
+  kLoopInvariantCodeMotion,
+  kRangeCheckElimination,
 };
 
 // Force code generation paths for testing.
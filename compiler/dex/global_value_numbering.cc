@@ -0,0 +1,512 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "global_value_numbering.h"
+
+#include "dataflow_iterator-inl.h"
+
+namespace art {
+
+GlobalValueNumbering::GlobalValueNumbering(CompilationUnit* cu, MIRGraph* mir_graph)
+    : cu_(cu),
+      mir_graph_(mir_graph),
+      heap_version_(0),
+      next_heap_version_(1),
+      num_eliminated_(0) {
+}
+
+uint16_t GlobalValueNumbering::LookupValue(uint16_t op, uint16_t operand1, uint16_t operand2,
+                                           uint16_t modifier) {
+  uint64_t key = LocalValueNumbering::BuildKey(op, operand1, operand2, modifier);
+  ValueMap::iterator it = value_map_.find(key);
+  if (it != value_map_.end()) {
+    return it->second;
+  }
+  uint16_t res = value_map_.size() + 1;
+  value_map_.Put(key, res);
+  return res;
+}
+
+uint16_t GlobalValueNumbering::GetOperandValue(int s_reg) {
+  SregValueMap::iterator it = sreg_value_map_.find(s_reg);
+  if (it != sreg_value_map_.end()) {
+    return it->second;
+  }
+  // First use, of a Phi or of an incoming argument.
+  uint16_t res = LookupValue(NO_VALUE, s_reg, NO_VALUE, 0);
+  sreg_value_map_.Put(s_reg, res);
+  return res;
+}
+
+uint16_t GlobalValueNumbering::GetOperandValueWide(int s_reg) {
+  SregValueMap::iterator it = sreg_wide_value_map_.find(s_reg);
+  if (it != sreg_wide_value_map_.end()) {
+    return it->second;
+  }
+  uint16_t res = LookupValue(NO_VALUE, s_reg, NO_VALUE, 1);
+  sreg_wide_value_map_.Put(s_reg, res);
+  return res;
+}
+
+void GlobalValueNumbering::SetOperandValue(int s_reg, uint16_t value) {
+  SregValueMap::iterator it = sreg_value_map_.find(s_reg);
+  if (it != sreg_value_map_.end()) {
+    DCHECK_EQ(it->second, value);
+  } else {
+    sreg_value_map_.Put(s_reg, value);
+  }
+}
+
+void GlobalValueNumbering::SetOperandValueWide(int s_reg, uint16_t value) {
+  SregValueMap::iterator it = sreg_wide_value_map_.find(s_reg);
+  if (it != sreg_wide_value_map_.end()) {
+    DCHECK_EQ(it->second, value);
+  } else {
+    sreg_wide_value_map_.Put(s_reg, value);
+  }
+}
+
+/* The check half of a throwing instruction split by ProcessCanThrow, or NULL */
+static MIR* GetCheckHalf(MIR* mir) {
+  MIR* check_half = mir->meta.throw_insn;
+  if ((check_half == NULL) ||
+      (static_cast<int>(check_half->dalvikInsn.opcode) != static_cast<int>(kMirOpCheck))) {
+    return NULL;
+  }
+  return check_half;
+}
+
+/* Unary, binary and conversion operations, whose value only depends on their operands */
+static bool IsPureOperation(int opcode) {
+  return (opcode == Instruction::ARRAY_LENGTH) ||
+      ((opcode >= Instruction::CMPL_FLOAT) && (opcode <= Instruction::CMP_LONG)) ||
+      ((opcode >= Instruction::NEG_INT) && (opcode <= Instruction::USHR_INT_LIT8));
+}
+
+/*
+ * Whether memory may be written on a path from the end of the immediate dominator of the block to
+ * its start, which only a merge can have.  The predecessors are searched backwards up to the
+ * immediate dominator, reaching the block itself again if it heads a loop.
+ */
+bool GlobalValueNumbering::MayWriteMemoryBefore(BasicBlock* bb) {
+  std::vector<bool> visited(mir_graph_->GetNumBlocks(), false);
+  std::vector<BasicBlock*> work_list;
+  GrowableArray<BasicBlock*>::Iterator iter(bb->predecessors);
+  for (BasicBlock* pred_bb = iter.Next(); pred_bb != NULL; pred_bb = iter.Next()) {
+    work_list.push_back(pred_bb);
+  }
+  while (!work_list.empty()) {
+    BasicBlock* curr_bb = work_list.back();
+    work_list.pop_back();
+    if ((curr_bb == bb->i_dom) || visited[curr_bb->id]) {
+      continue;
+    }
+    visited[curr_bb->id] = true;
+    if (may_write_memory_[curr_bb->id] || curr_bb->catch_entry) {
+      return true;
+    }
+    GrowableArray<BasicBlock*>::Iterator pred_iter(curr_bb->predecessors);
+    for (BasicBlock* pred_bb = pred_iter.Next(); pred_bb != NULL; pred_bb = pred_iter.Next()) {
+      work_list.push_back(pred_bb);
+    }
+  }
+  return false;
+}
+
+/*
+ * The SSA names held by the Dalvik registers at the start of the block are those the
+ * predecessors agree on at their end.  Where they don't, the block begins with a Phi or the
+ * register is dead.
+ */
+void GlobalValueNumbering::InitVRegMap(BasicBlock* bb) {
+  int num_vregs = cu_->num_dalvik_registers;
+  if (bb->predecessors->Size() == 0) {
+    for (int i = 0; i < num_vregs; i++) {
+      vreg_to_ssa_map_[i] = i;
+    }
+    return;
+  }
+  bool first = true;
+  GrowableArray<BasicBlock*>::Iterator iter(bb->predecessors);
+  for (BasicBlock* pred_bb = iter.Next(); pred_bb != NULL; pred_bb = iter.Next()) {
+    int* pred_map = (pred_bb->data_flow_info == NULL) ? NULL :
+        pred_bb->data_flow_info->vreg_to_ssa_map;
+    for (int i = 0; i < num_vregs; i++) {
+      if (pred_map == NULL) {
+        vreg_to_ssa_map_[i] = INVALID_SREG;
+      } else if (first) {
+        vreg_to_ssa_map_[i] = pred_map[i];
+      } else if (vreg_to_ssa_map_[i] != pred_map[i]) {
+        vreg_to_ssa_map_[i] = INVALID_SREG;
+      }
+    }
+    first = false;
+  }
+}
+
+bool GlobalValueNumbering::IsCurrent(int s_reg) const {
+  int v_reg = mir_graph_->SRegToVReg(s_reg);
+  return (v_reg >= 0) && (v_reg < cu_->num_dalvik_registers) &&
+      (vreg_to_ssa_map_[v_reg] == s_reg);
+}
+
+void GlobalValueNumbering::MakeAvailable(uint16_t value, int s_reg_lo, int s_reg_hi) {
+  Fact fact;
+  fact.kind = kAvailable;
+  fact.key = value;
+  fact.old_s_reg_lo = INVALID_SREG;
+  fact.old_s_reg_hi = INVALID_SREG;
+  SafeMap<uint16_t, std::pair<int, int> >::iterator it = available_.find(value);
+  if (it != available_.end()) {
+    fact.old_s_reg_lo = it->second.first;
+    fact.old_s_reg_hi = it->second.second;
+  }
+  undo_log_.push_back(fact);
+  available_.Overwrite(value, std::make_pair(s_reg_lo, s_reg_hi));
+}
+
+void GlobalValueNumbering::AddFact(FactKind kind, uint32_t key) {
+  Fact fact;
+  fact.kind = kind;
+  fact.key = key;
+  fact.old_s_reg_lo = INVALID_SREG;
+  fact.old_s_reg_hi = INVALID_SREG;
+  undo_log_.push_back(fact);
+  if (kind == kNullChecked) {
+    null_checked_.insert(key);
+  } else {
+    DCHECK_EQ(kind, kRangeChecked);
+    range_checked_.insert(key);
+  }
+}
+
+void GlobalValueNumbering::UndoTo(size_t mark) {
+  while (undo_log_.size() > mark) {
+    const Fact& fact = undo_log_.back();
+    switch (fact.kind) {
+      case kAvailable:
+        if (fact.old_s_reg_lo == INVALID_SREG) {
+          available_.erase(fact.key);
+        } else {
+          available_.Overwrite(fact.key, std::make_pair(fact.old_s_reg_lo, fact.old_s_reg_hi));
+        }
+        break;
+      case kNullChecked:
+        null_checked_.erase(fact.key);
+        break;
+      case kRangeChecked:
+        range_checked_.erase(fact.key);
+        break;
+    }
+    undo_log_.pop_back();
+  }
+}
+
+void GlobalValueNumbering::EliminateChecks(MIR* mir, int df_attributes) {
+  int old_flags = mir->optimization_flags;
+  int* uses = mir->ssa_rep->uses;
+  if ((df_attributes & DF_HAS_NULL_CHKS) && !(old_flags & MIR_IGNORE_NULL_CHECK)) {
+    int src_idx;
+    if (df_attributes & DF_NULL_CHK_1) {
+      src_idx = 1;
+    } else if (df_attributes & DF_NULL_CHK_2) {
+      src_idx = 2;
+    } else {
+      src_idx = 0;
+    }
+    uint16_t object = GetOperandValue(uses[src_idx]);
+    if (null_checked_.find(object) != null_checked_.end()) {
+      if (cu_->verbose) {
+        LOG(INFO) << "Removing null check for 0x" << std::hex << mir->offset;
+      }
+      mir->optimization_flags |= MIR_IGNORE_NULL_CHECK;
+    } else {
+      AddFact(kNullChecked, object);
+    }
+  }
+  if ((df_attributes & DF_HAS_RANGE_CHKS) && !(old_flags & MIR_IGNORE_RANGE_CHECK)) {
+    int array_idx;
+    if (df_attributes & DF_RANGE_CHK_3) {
+      array_idx = 2;
+    } else if (df_attributes & DF_RANGE_CHK_2) {
+      array_idx = 1;
+    } else {
+      array_idx = 0;
+    }
+    uint32_t key = (GetOperandValue(uses[array_idx]) << 16) | GetOperandValue(uses[array_idx + 1]);
+    if (range_checked_.find(key) != range_checked_.end()) {
+      if (cu_->verbose) {
+        LOG(INFO) << "Removing range check for 0x" << std::hex << mir->offset;
+      }
+      mir->optimization_flags |= MIR_IGNORE_RANGE_CHECK;
+    } else {
+      AddFact(kRangeChecked, key);
+    }
+  }
+  if (mir->optimization_flags != old_flags) {
+    num_eliminated_++;
+    MIR* check_half = GetCheckHalf(mir);
+    if (check_half != NULL) {
+      check_half->optimization_flags |= mir->optimization_flags;
+    }
+  }
+}
+
+/*
+ * Number the value the MIR defines.  Those of pure operations, field gets on the fast path and
+ * array gets are replaceable by a move from an earlier definition of the same value, constants
+ * and copies merely share the value of their source, anything else defines a new value.
+ */
+uint16_t GlobalValueNumbering::GetValueNumber(MIR* mir, int df_attributes, bool* is_replaceable) {
+  SSARepresentation* ssa_rep = mir->ssa_rep;
+  int opcode = mir->dalvikInsn.opcode;
+  bool is_wide = (df_attributes & DF_A_WIDE) != 0;
+  uint16_t res;
+  *is_replaceable = false;
+  if (df_attributes & DF_IS_MOVE) {
+    res = is_wide ? GetOperandValueWide(ssa_rep->uses[0]) : GetOperandValue(ssa_rep->uses[0]);
+  } else if (df_attributes & DF_SETS_CONST) {
+    // Shifted unsigned, a negative constant mustn't be shifted as a signed value.
+    uint32_t vB = mir->dalvikInsn.vB;
+    uint64_t value;
+    switch (opcode) {
+      case Instruction::CONST_HIGH16:
+        value = vB << 16;
+        break;
+      case Instruction::CONST_WIDE:
+        value = mir->dalvikInsn.vB_wide;
+        break;
+      case Instruction::CONST_WIDE_HIGH16:
+        value = static_cast<uint64_t>(vB) << 48;
+        break;
+      default:
+        // Sign extended for CONST_WIDE_16 and CONST_WIDE_32.
+        value = static_cast<int64_t>(static_cast<int32_t>(vB));
+        break;
+    }
+    uint32_t low_word = Low32Bits(value);
+    if (is_wide) {
+      uint32_t high_word = High32Bits(value);
+      uint16_t low_res = LookupValue(Instruction::CONST, Low16Bits(low_word),
+                                     High16Bits(low_word), 1);
+      uint16_t high_res = LookupValue(Instruction::CONST, Low16Bits(high_word),
+                                      High16Bits(high_word), 2);
+      res = LookupValue(Instruction::CONST, low_res, high_res, 3);
+    } else {
+      res = LookupValue(Instruction::CONST, Low16Bits(low_word), High16Bits(low_word), 0);
+    }
+  } else if (IsPureOperation(opcode)) {
+    // The operands in A, B, C order, a wide one by the value of its pair.
+    static const int kUseAttributes[][2] = {
+      { DF_UA, DF_A_WIDE }, { DF_UB, DF_B_WIDE }, { DF_UC, DF_C_WIDE },
+    };
+    uint16_t operands[2] = { NO_VALUE, NO_VALUE };
+    int num_operands = 0;
+    int use = 0;
+    for (size_t i = 0; i < arraysize(kUseAttributes); i++) {
+      if (df_attributes & kUseAttributes[i][0]) {
+        DCHECK_LT(num_operands, 2);
+        bool is_wide_use = (df_attributes & kUseAttributes[i][1]) != 0;
+        operands[num_operands++] = is_wide_use ? GetOperandValueWide(ssa_rep->uses[use]) :
+            GetOperandValue(ssa_rep->uses[use]);
+        use += is_wide_use ? 2 : 1;
+      }
+    }
+    if (opcode >= Instruction::ADD_INT_LIT16) {
+      // The literal is numbered like a constant.
+      DCHECK_EQ(num_operands, 1);
+      uint32_t literal = mir->dalvikInsn.vC;
+      operands[1] = LookupValue(Instruction::CONST, Low16Bits(literal), High16Bits(literal), 0);
+    }
+    res = LookupValue(opcode, operands[0], operands[1], 0);
+    *is_replaceable = true;
+  } else if ((opcode >= Instruction::IGET) && (opcode <= Instruction::IGET_SHORT) &&
+             mir_graph_->IsFastInstanceGet(mir)) {
+    uint16_t base = GetOperandValue(ssa_rep->uses[0]);
+    res = LookupValue(opcode, base, mir->dalvikInsn.vC, heap_version_);
+    *is_replaceable = true;
+  } else if ((opcode >= Instruction::AGET) && (opcode <= Instruction::AGET_SHORT)) {
+    uint16_t array = GetOperandValue(ssa_rep->uses[0]);
+    uint16_t index = GetOperandValue(ssa_rep->uses[1]);
+    res = LookupValue(opcode, array, index, heap_version_);
+    *is_replaceable = true;
+  } else {
+    // A result, Phi, load or allocation: unique to its s_reg.
+    return is_wide ? GetOperandValueWide(ssa_rep->defs[0]) : GetOperandValue(ssa_rep->defs[0]);
+  }
+  if (is_wide) {
+    SetOperandValueWide(ssa_rep->defs[0], res);
+  } else {
+    SetOperandValue(ssa_rep->defs[0], res);
+  }
+  return res;
+}
+
+/*
+ * Replace the MIR by a move from the defs that hold its value.  If it is the work half of a
+ * throwing instruction, the check half is compiled with its operands, so both are rewritten.
+ */
+void GlobalValueNumbering::ReplaceByMove(MIR* mir, int s_reg_lo, int s_reg_hi) {
+  Instruction::Code opcode = mir->dalvikInsn.opcode;
+  bool is_wide = (s_reg_hi != INVALID_SREG);
+  Instruction::Code move;
+  if (is_wide) {
+    move = Instruction::MOVE_WIDE_16;
+  } else if ((opcode == Instruction::IGET_OBJECT) || (opcode == Instruction::AGET_OBJECT)) {
+    move = Instruction::MOVE_OBJECT_16;
+  } else {
+    move = Instruction::MOVE_16;
+  }
+  if (cu_->verbose) {
+    LOG(INFO) << "Replacing " << Instruction::Name(opcode) << " at 0x" << std::hex << mir->offset
+              << " by a move";
+  }
+  SSARepresentation* ssa_rep = mir->ssa_rep;
+  int num_uses = is_wide ? 2 : 1;
+  ssa_rep->num_uses = num_uses;
+  ssa_rep->uses = static_cast<int*>(cu_->arena.Alloc(sizeof(int) * num_uses,
+                                                     ArenaAllocator::kAllocDFInfo));
+  ssa_rep->fp_use = static_cast<bool*>(cu_->arena.Alloc(sizeof(bool) * num_uses,
+                                                        ArenaAllocator::kAllocDFInfo));
+  ssa_rep->uses[0] = s_reg_lo;
+  ssa_rep->fp_use[0] = ssa_rep->fp_def[0];
+  if (is_wide) {
+    ssa_rep->uses[1] = s_reg_hi;
+    ssa_rep->fp_use[1] = ssa_rep->fp_def[0];
+  }
+  mir->dalvikInsn.opcode = move;
+  mir->dalvikInsn.vA = mir_graph_->SRegToVReg(ssa_rep->defs[0]);
+  mir->dalvikInsn.vB = mir_graph_->SRegToVReg(s_reg_lo);
+  mir->dalvikInsn.vC = 0;
+  MIR* check_half = GetCheckHalf(mir);
+  if (check_half != NULL) {
+    check_half->dalvikInsn = mir->dalvikInsn;
+    check_half->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpCheck);
+  }
+  num_eliminated_++;
+}
+
+void GlobalValueNumbering::VisitMIR(MIR* mir) {
+  int opcode = mir->dalvikInsn.opcode;
+  // The check half is numbered with its work half, which begins the next block.
+  if ((mir->ssa_rep == NULL) || (opcode == kMirOpCheck)) {
+    return;
+  }
+  int df_attributes = MIRGraph::oat_data_flow_attributes_[opcode];
+  EliminateChecks(mir, df_attributes);
+  SSARepresentation* ssa_rep = mir->ssa_rep;
+  if (ssa_rep->num_defs != 0) {
+    bool is_replaceable;
+    uint16_t value = GetValueNumber(mir, df_attributes, &is_replaceable);
+    if (is_replaceable) {
+      bool is_wide = (df_attributes & DF_A_WIDE) != 0;
+      SafeMap<uint16_t, std::pair<int, int> >::iterator it = available_.find(value);
+      if ((it != available_.end()) && IsCurrent(it->second.first) &&
+          (!is_wide || IsCurrent(it->second.second))) {
+        ReplaceByMove(mir, it->second.first, it->second.second);
+      } else {
+        // The value isn't held anymore by its earlier defs, if any, but by these.
+        MakeAvailable(value, ssa_rep->defs[0], is_wide ? ssa_rep->defs[1] : INVALID_SREG);
+      }
+    }
+    for (int i = 0; i < ssa_rep->num_defs; i++) {
+      int v_reg = mir_graph_->SRegToVReg(ssa_rep->defs[i]);
+      if ((v_reg >= 0) && (v_reg < cu_->num_dalvik_registers)) {
+        vreg_to_ssa_map_[v_reg] = ssa_rep->defs[i];
+      }
+    }
+  }
+  if (mir_graph_->MayWriteMemory(mir)) {
+    heap_version_ = next_heap_version_++;
+  }
+}
+
+void GlobalValueNumbering::VisitBlock(BasicBlock* bb) {
+  if (bb->catch_entry || ((bb->predecessors->Size() > 1) && MayWriteMemoryBefore(bb))) {
+    heap_version_ = next_heap_version_++;
+  }
+  InitVRegMap(bb);
+  for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+    VisitMIR(mir);
+  }
+}
+
+int GlobalValueNumbering::Run() {
+  // Find the blocks that may write memory, and bound the number of values.
+  may_write_memory_.resize(mir_graph_->GetNumBlocks(), false);
+  size_t num_mirs = 0;
+  AllNodesIterator iter(mir_graph_, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      num_mirs++;
+      if (mir_graph_->MayWriteMemory(mir)) {
+        may_write_memory_[bb->id] = true;
+      }
+    }
+  }
+  // Each s_reg has a narrow and a wide value, each MIR looks up at most four values and each MIR
+  // and block takes at most one heap version.
+  size_t max_values = mir_graph_->GetNumSSARegs() * 2 + num_mirs * 4;
+  size_t max_heap_versions = num_mirs + mir_graph_->GetNumBlocks() + 1;
+  if ((max_values >= ARRAY_REF) || (max_heap_versions >= NO_VALUE)) {
+    if (cu_->verbose) {
+      LOG(INFO) << "Too many values for global value numbering: " << max_values;
+    }
+    return -1;
+  }
+  vreg_to_ssa_map_.resize(cu_->num_dalvik_registers, INVALID_SREG);
+
+  // Preorder walk of the dominator tree, undoing the facts of a block when leaving its subtree.
+  std::vector<Frame> work_stack;
+  BasicBlock* entry_bb = mir_graph_->GetEntryBlock();
+  DCHECK(entry_bb->data_flow_info != NULL);
+  DCHECK(entry_bb->i_dominated != NULL);
+  BasicBlock* bb = entry_bb;
+  while (true) {
+    if (bb != NULL) {
+      Frame frame;
+      frame.bb = bb;
+      frame.undo_mark = undo_log_.size();
+      VisitBlock(bb);
+      frame.heap_version = heap_version_;
+      frame.children = new (&cu_->arena) ArenaBitVector::Iterator(bb->i_dominated);
+      work_stack.push_back(frame);
+    }
+    if (work_stack.empty()) {
+      break;
+    }
+    Frame& top = work_stack.back();
+    bb = NULL;
+    for (int id = top.children->Next(); id != -1; id = top.children->Next()) {
+      BasicBlock* child_bb = mir_graph_->GetBasicBlock(id);
+      if (!child_bb->hidden && (child_bb->data_flow_info != NULL) &&
+          (child_bb->i_dominated != NULL)) {
+        bb = child_bb;
+        break;
+      }
+    }
+    if (bb != NULL) {
+      heap_version_ = top.heap_version;
+    } else {
+      UndoTo(top.undo_mark);
+      work_stack.pop_back();
+    }
+  }
+  DCHECK(undo_log_.empty());
+  return num_eliminated_;
+}
+
+}  // namespace art
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DEX_GLOBAL_VALUE_NUMBERING_H_
+#define ART_COMPILER_DEX_GLOBAL_VALUE_NUMBERING_H_
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "compiler_internals.h"
+#include "local_value_numbering.h"
+
+namespace art {
+
+/*
+ * Dominator based value numbering of the whole method in SSA form.  The dominator tree is walked
+ * in preorder and every value computed, and every null or range check done, in a block is known
+ * in the blocks it dominates.  A computation whose value is already held by a dominating
+ * definition becomes a move from it and a check already done becomes ignored.
+ *
+ * Field and array loads are numbered with a heap version, which changes at every instruction that
+ * may write memory and at every merge that such an instruction may reach, so loads are only
+ * reused when nothing in between can have stored to the heap.  Quick keeps all the SSA names of a
+ * Dalvik register in the register's single home, so a dominating definition is only reused while
+ * its Dalvik register still holds it.
+ */
+class GlobalValueNumbering {
+ public:
+  GlobalValueNumbering(CompilationUnit* cu, MIRGraph* mir_graph);
+
+  // Returns the number of computations and checks eliminated, or -1 if the method has too many
+  // values to number.
+  int Run();
+
+ private:
+  // What the undo log retracts when the walk leaves the dominator subtree that established it.
+  enum FactKind {
+    kAvailable,     // key is a value held by the defs of a dominating MIR.
+    kNullChecked,   // key is a value checked against null.
+    kRangeChecked,  // key is the array value << 16 | the index value.
+  };
+
+  struct Fact {
+    FactKind kind;
+    uint32_t key;
+    // The defs that held an available value before, INVALID_SREG if it wasn't available.
+    int old_s_reg_lo;
+    int old_s_reg_hi;
+  };
+
+  struct Frame {
+    BasicBlock* bb;
+    ArenaBitVector::Iterator* children;
+    size_t undo_mark;
+    // At the end of the block.
+    uint16_t heap_version;
+  };
+
+  uint16_t LookupValue(uint16_t op, uint16_t operand1, uint16_t operand2, uint16_t modifier);
+  uint16_t GetOperandValue(int s_reg);
+  uint16_t GetOperandValueWide(int s_reg);
+  void SetOperandValue(int s_reg, uint16_t value);
+  void SetOperandValueWide(int s_reg, uint16_t value);
+
+  bool MayWriteMemoryBefore(BasicBlock* bb);
+  void InitVRegMap(BasicBlock* bb);
+  void VisitBlock(BasicBlock* bb);
+  void VisitMIR(MIR* mir);
+  void EliminateChecks(MIR* mir, int df_attributes);
+  uint16_t GetValueNumber(MIR* mir, int df_attributes, bool* is_replaceable);
+  bool IsCurrent(int s_reg) const;
+  void ReplaceByMove(MIR* mir, int s_reg_lo, int s_reg_hi);
+  void MakeAvailable(uint16_t value, int s_reg_lo, int s_reg_hi);
+  void AddFact(FactKind kind, uint32_t key);
+  void UndoTo(size_t mark);
+
+  CompilationUnit* const cu_;
+  MIRGraph* const mir_graph_;
+  ValueMap value_map_;
+  SregValueMap sreg_value_map_;
+  SregValueMap sreg_wide_value_map_;
+  // Scoped facts, the low and high s_regs of the defs holding each available value.
+  SafeMap<uint16_t, std::pair<int, int> > available_;
+  std::set<uint16_t> null_checked_;
+  std::set<uint32_t> range_checked_;
+  std::vector<Fact> undo_log_;
+  // The SSA name in each Dalvik register at the MIR being visited, or INVALID_SREG.
+  std::vector<int> vreg_to_ssa_map_;
+  // Indexed by block id.
+  std::vector<bool> may_write_memory_;
+  uint16_t heap_version_;
+  uint16_t next_heap_version_;
+  int num_eliminated_;
+
+  DISALLOW_COPY_AND_ASSIGN(GlobalValueNumbering);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DEX_GLOBAL_VALUE_NUMBERING_H_
@@ -98,6 +98,21 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
        */
       break;
 
+    case kMirOpNullCheck: {
+        // Left by an inlined call to check its receiver.
+        uint16_t reg = GetOperandValue(mir->ssa_rep->uses[0]);
+        if (null_checked_.find(reg) != null_checked_.end()) {
+          if (cu_->verbose) {
+            LOG(INFO) << "Removing null check for 0x" << std::hex << mir->offset;
+          }
+          mir->optimization_flags |= MIR_IGNORE_NULL_CHECK;
+        } else {
+          null_checked_.insert(reg);
+        }
+        mir->meta.throw_insn->optimization_flags |= mir->optimization_flags;
+      }
+      break;
+
     case Instruction::MOVE:
     case Instruction::MOVE_OBJECT:
     case Instruction::MOVE_16:
@@ -291,6 +291,19 @@ struct SuccessorBlockInfo {
   int key;
 };
 
+/*
+ * A natural loop: its header and the blocks that reach a back edge to the header without passing
+ * through the header.  The back edges to the same header make up a single loop.
+ */
+struct Loop {
+  BasicBlock* header;
+  // The only predecessor of the header outside the loop, if it merely falls through to the
+  // header so that code can be appended to it, or NULL.
+  BasicBlock* preheader;
+  ArenaBitVector* blocks;
+  Loop* parent;                     // Innermost enclosing loop, or NULL.
+};
+
 /*
  * Whereas a SSA name describes a definition of a Dalvik vreg, the RegLocation describes
  * the type of an SSA name (and, can also be used by code generators to record where the
@@ -413,6 +426,11 @@ class MIRGraph {
     return dfs_post_order_;
   }
 
+  // The natural loops, outer loops before the loops they enclose.
+  const std::vector<Loop*>& GetLoops() const {
+    return loops_;
+  }
+
   GrowableArray<int>* GetDomPostOrder() {
     return dom_post_order_traversal_;
   }
@@ -571,7 +589,14 @@ class MIRGraph {
 
   void BasicBlockCombine();
   void CodeLayout();
+  void InlineCalls(size_t max_code_units);
   void DumpCheckStats();
+  void GlobalRedundancyElimination();
+  void InsertLoopPreheaders();
+  void LoopInvariantCodeMotion();
+  void RangeCheckElimination();
+  bool MayWriteMemory(MIR* mir);
+  bool IsFastInstanceGet(MIR* mir);
   void PropagateConstants();
   MIR* FindMoveResult(BasicBlock* bb, MIR* mir);
   int SRegToVReg(int ssa_reg) const;
@@ -654,6 +679,7 @@ class MIRGraph {
   void ComputeDefBlockMatrix();
   void ComputeDomPostOrderTraversal(BasicBlock* bb);
   void ComputeDominators();
+  void FindLoops();
   void InsertPhiNodes();
   void DoDFSPreOrderSSARename(BasicBlock* block);
   void SetConstant(int32_t ssa_reg, int value);
@@ -674,6 +700,13 @@ class MIRGraph {
   void DoConstantPropogation(BasicBlock* bb);
   void CountChecks(BasicBlock* bb);
   bool CombineBlocks(BasicBlock* bb);
+  bool InlineCall(BasicBlock* bb, MIR* mir, size_t max_code_units);
+  int HoistLoopInvariants(Loop* loop, GrowableArray<int>* def_blocks);
+  bool IsAddConstant(MIR* mir, int* s_reg, int* constant);
+  bool IsBelowLength(int array_s_reg, int length_s_reg, int constant,
+                     const std::vector<MIR*>& def_mirs);
+  int EliminateLoopRangeChecks(Loop* loop, const std::vector<MIR*>& def_mirs,
+                               const std::vector<BasicBlock*>& def_blocks);
   void AnalyzeBlock(BasicBlock* bb, struct MethodStats* stats);
   bool ComputeSkipCompilation(struct MethodStats* stats, bool skip_default);
 
@@ -715,6 +748,9 @@ class MIRGraph {
   int* opcode_count_;                            // Dex opcode coverage stats.
   int num_ssa_regs_;                             // Number of names following SSA transformation.
   std::vector<BasicBlock*> extended_basic_blocks_;  // Heads of block "traces".
+  std::vector<Loop*> loops_;
+  // Whether the field of an iget is on the fast path and not volatile, by field index.
+  SafeMap<uint32_t, bool> fast_instance_gets_;
   int method_sreg_;
   unsigned int attributes_;
   Checkstats* checkstats_;
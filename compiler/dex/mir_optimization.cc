@@ -14,7 +14,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "compiler_internals.h"
+#include "global_value_numbering.h"
 #include "local_value_numbering.h"
 #include "dataflow_iterator-inl.h"
 
@@ -800,6 +805,989 @@ void MIRGraph::CodeLayout() {
   }
 }
 
+/* The caller's register holding a word of the arguments of an invoke */
+static uint32_t InvokeArg(const DecodedInstruction& invoke, bool is_range, uint32_t arg_word) {
+  return is_range ? invoke.vC + arg_word : invoke.arg[arg_word];
+}
+
+/*
+ * Replace an invoke, the work half of a throwing instruction, by another operation.  The check
+ * half is compiled with the operands of the work half, so both are rewritten.
+ */
+static void RewriteInvoke(MIR* mir, Instruction::Code opcode, uint32_t vA, uint32_t vB,
+                          uint32_t vC) {
+  MIR* check_half = mir->meta.throw_insn;
+  DCHECK_EQ(static_cast<int>(check_half->dalvikInsn.opcode), static_cast<int>(kMirOpCheck));
+  mir->dalvikInsn.opcode = opcode;
+  mir->dalvikInsn.vA = vA;
+  mir->dalvikInsn.vB = vB;
+  mir->dalvikInsn.vC = vC;
+  check_half->dalvikInsn = mir->dalvikInsn;
+  check_half->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpCheck);
+}
+
+/*
+ * Try to replace an invoke of a trivial method - one that does nothing, returns a constant or
+ * one of its arguments, or gets or sets a field of its receiver - by the operation of its body.
+ * Such a body can neither throw nor suspend, so the only exception left is that of a null
+ * receiver, which is raised at the invoke just as by the call and needs no frame of the callee
+ * in the stack walk or in the mapping tables.
+ */
+bool MIRGraph::InlineCall(BasicBlock* bb, MIR* mir, size_t max_code_units) {
+  InvokeType type;
+  bool is_range = false;
+  switch (mir->dalvikInsn.opcode) {
+    case Instruction::INVOKE_DIRECT_RANGE:
+      is_range = true;
+      // Note: intentional fallthrough.
+    case Instruction::INVOKE_DIRECT:
+      type = kDirect;
+      break;
+    case Instruction::INVOKE_STATIC_RANGE:
+      is_range = true;
+      // Note: intentional fallthrough.
+    case Instruction::INVOKE_STATIC:
+      type = kStatic;
+      break;
+    case Instruction::INVOKE_VIRTUAL_RANGE:
+      is_range = true;
+      // Note: intentional fallthrough.
+    case Instruction::INVOKE_VIRTUAL:
+      type = kVirtual;
+      break;
+    default:
+      return false;
+  }
+  const DecodedInstruction& invoke = mir->dalvikInsn;
+  const DexFile::CodeItem* code_item;
+  uint32_t access_flags;
+  if (!cu_->compiler_driver->ComputeInlineTarget(GetCurrentDexCompilationUnit(), mir->offset,
+                                                 type, invoke.vB, code_item, access_flags)) {
+    return false;
+  }
+  if ((code_item->insns_size_in_code_units_ > max_code_units) ||
+      (code_item->tries_size_ != 0) || (code_item->ins_size_ != invoke.vA)) {
+    return false;
+  }
+
+  // The body must be a return, possibly preceded by a single instruction.
+  const Instruction* first = Instruction::At(code_item->insns_);
+  const Instruction* last = first;
+  if (first->SizeInCodeUnits() != code_item->insns_size_in_code_units_) {
+    last = first->Next();
+    if (first->SizeInCodeUnits() + last->SizeInCodeUnits() !=
+        code_item->insns_size_in_code_units_) {
+      return false;
+    }
+  }
+  DecodedInstruction ret(last);
+  Instruction::Code ret_opcode = ret.opcode;
+  if ((ret_opcode != Instruction::RETURN_VOID) && (ret_opcode != Instruction::RETURN) &&
+      (ret_opcode != Instruction::RETURN_OBJECT) && (ret_opcode != Instruction::RETURN_WIDE)) {
+    return false;
+  }
+  bool is_wide = (ret_opcode == Instruction::RETURN_WIDE);
+  bool is_static = (access_flags & kAccStatic) != 0;
+  // The ins are the last registers of the callee, in the order of the arguments.
+  uint32_t first_in = code_item->registers_size_ - code_item->ins_size_;
+  uint32_t receiver = is_static ? 0 : InvokeArg(invoke, is_range, 0);
+  MIR* move_result = FindMoveResult(bb, mir);
+  Instruction::Code move_opcode = Instruction::NOP;
+  uint32_t move_src = 0;
+
+  if (first == last) {
+    if (ret_opcode != Instruction::RETURN_VOID) {
+      // Identity: return an argument.
+      if (ret.vA < first_in) {
+        return false;
+      }
+      uint32_t arg_word = ret.vA - first_in;
+      move_src = InvokeArg(invoke, is_range, arg_word);
+      if (is_wide && (InvokeArg(invoke, is_range, arg_word + 1) != move_src + 1)) {
+        return false;
+      }
+      move_opcode = is_wide ? Instruction::MOVE_WIDE_16 :
+          (ret_opcode == Instruction::RETURN_OBJECT) ? Instruction::MOVE_OBJECT_16 :
+          Instruction::MOVE_16;
+    }
+  } else {
+    DecodedInstruction insn(first);
+    int field_offset;
+    bool is_volatile;
+    switch (insn.opcode) {
+      case Instruction::CONST_4:
+      case Instruction::CONST_16:
+      case Instruction::CONST:
+        // Return a constant.
+        if (is_wide || (ret_opcode == Instruction::RETURN_VOID) || (ret.vA != insn.vA)) {
+          return false;
+        }
+        move_opcode = Instruction::CONST;
+        move_src = insn.vB;
+        break;
+      case Instruction::IGET:
+      case Instruction::IGET_WIDE:
+      case Instruction::IGET_OBJECT:
+      case Instruction::IGET_BOOLEAN:
+      case Instruction::IGET_BYTE:
+      case Instruction::IGET_CHAR:
+      case Instruction::IGET_SHORT:
+        // Return a field of the receiver.
+        if (is_static || (insn.vB != first_in) || (ret_opcode == Instruction::RETURN_VOID) ||
+            (ret.vA != insn.vA) ||
+            !cu_->compiler_driver->ComputeInstanceFieldInfo(insn.vC,
+                                                            GetCurrentDexCompilationUnit(),
+                                                            field_offset, is_volatile, false)) {
+          return false;
+        }
+        if (move_result != NULL) {
+          RewriteInvoke(mir, insn.opcode, move_result->dalvikInsn.vA, receiver, insn.vC);
+          move_result->meta.original_opcode = move_result->dalvikInsn.opcode;
+          move_result->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+          if (cu_->verbose) {
+            LOG(INFO) << "Inlined field get at 0x" << std::hex << mir->offset;
+          }
+          return true;
+        }
+        // Only the null check of an unused get is left.
+        break;
+      case Instruction::IPUT:
+      case Instruction::IPUT_WIDE:
+      case Instruction::IPUT_OBJECT:
+      case Instruction::IPUT_BOOLEAN:
+      case Instruction::IPUT_BYTE:
+      case Instruction::IPUT_CHAR:
+      case Instruction::IPUT_SHORT: {
+        // Set a field of the receiver to an argument.
+        if (is_static || (insn.vB != first_in) || (ret_opcode != Instruction::RETURN_VOID) ||
+            (insn.vA < first_in)) {
+          return false;
+        }
+        uint32_t arg_word = insn.vA - first_in;
+        uint32_t value = InvokeArg(invoke, is_range, arg_word);
+        if ((insn.opcode == Instruction::IPUT_WIDE) &&
+            (InvokeArg(invoke, is_range, arg_word + 1) != value + 1)) {
+          return false;
+        }
+        if (!cu_->compiler_driver->ComputeInstanceFieldInfo(insn.vC,
+                                                            GetCurrentDexCompilationUnit(),
+                                                            field_offset, is_volatile, true)) {
+          return false;
+        }
+        RewriteInvoke(mir, insn.opcode, value, receiver, insn.vC);
+        if (cu_->verbose) {
+          LOG(INFO) << "Inlined field put at 0x" << std::hex << mir->offset;
+        }
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  // Only the null check of the receiver is left of the call.
+  if (is_static) {
+    RewriteInvoke(mir, Instruction::NOP, 0, 0, 0);
+  } else {
+    RewriteInvoke(mir, static_cast<Instruction::Code>(kMirOpNullCheck), receiver, 0, 0);
+  }
+  if ((move_result != NULL) && (move_opcode != Instruction::NOP)) {
+    move_result->dalvikInsn.opcode = move_opcode;
+    move_result->dalvikInsn.vB = move_src;
+  }
+  if (cu_->verbose) {
+    LOG(INFO) << "Inlined call at 0x" << std::hex << mir->offset;
+  }
+  return true;
+}
+
+/*
+ * Inline the calls of trivial methods of at most max_code_units.  The inlined bodies make no
+ * calls of their own, so the inlining doesn't go deeper than the compiled method.
+ */
+void MIRGraph::InlineCalls(size_t max_code_units) {
+  if ((cu_->disable_opt & (1 << kInlineCalls)) || (max_code_units == 0)) {
+    return;
+  }
+  AllNodesIterator iter(this, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (InlineCall(bb, mir, max_code_units)) {
+        cu_->compiler_driver->RecordInlinedCall();
+      }
+    }
+  }
+}
+
+void MIRGraph::GlobalRedundancyElimination() {
+  if (cu_->disable_opt & (1 << kGlobalValueNumbering)) {
+    return;
+  }
+  GlobalValueNumbering gvn(cu_, this);
+  int num_eliminated = gvn.Run();
+  if (cu_->verbose) {
+    LOG(INFO) << "Global value numbering of " << PrettyMethod(cu_->method_idx, *cu_->dex_file)
+              << " eliminated " << num_eliminated;
+  }
+}
+
+bool MIRGraph::IsFastInstanceGet(MIR* mir) {
+  uint32_t field_idx = mir->dalvikInsn.vC;
+  SafeMap<uint32_t, bool>::iterator it = fast_instance_gets_.find(field_idx);
+  if (it != fast_instance_gets_.end()) {
+    return it->second;
+  }
+  int field_offset;
+  bool is_volatile;
+  bool is_fast = cu_->compiler_driver->ComputeInstanceFieldInfo(field_idx,
+                                                                GetCurrentDexCompilationUnit(),
+                                                                field_offset, is_volatile, false);
+  is_fast = is_fast && !is_volatile;
+  fast_instance_gets_.Put(field_idx, is_fast);
+  return is_fast;
+}
+
+/*
+ * Whether the MIR may store to the heap, directly or through code it calls - which includes class
+ * initializers and class loaders - or orders memory accesses of other threads.
+ */
+bool MIRGraph::MayWriteMemory(MIR* mir) {
+  int opcode = mir->dalvikInsn.opcode;
+  if (opcode >= kMirOpFirst) {
+    return false;
+  }
+  if (Instruction::FlagsOf(mir->dalvikInsn.opcode) & Instruction::kInvoke) {
+    return true;
+  }
+  if ((opcode >= Instruction::IGET) && (opcode <= Instruction::IGET_SHORT)) {
+    return !IsFastInstanceGet(mir);
+  }
+  switch (opcode) {
+    case Instruction::CONST_CLASS:
+    case Instruction::MONITOR_ENTER:
+    case Instruction::MONITOR_EXIT:
+    case Instruction::CHECK_CAST:
+    case Instruction::INSTANCE_OF:
+    case Instruction::NEW_INSTANCE:
+    case Instruction::NEW_ARRAY:
+    case Instruction::FILLED_NEW_ARRAY:
+    case Instruction::FILLED_NEW_ARRAY_RANGE:
+    case Instruction::FILL_ARRAY_DATA:
+      return true;
+    default:
+      // Array puts, instance puts, static gets and puts, and anything beyond the arithmetic.
+      return ((opcode >= Instruction::APUT) && (opcode <= Instruction::APUT_SHORT)) ||
+          ((opcode >= Instruction::IPUT) && (opcode <= Instruction::SPUT_SHORT)) ||
+          (opcode > Instruction::USHR_INT_LIT8);
+  }
+}
+
+/* The successors of a block, by its fall through, its taken branch and its successor list */
+static void GetSuccessors(BasicBlock* bb, std::vector<BasicBlock*>* successors) {
+  successors->clear();
+  if (bb->fall_through != NULL) {
+    successors->push_back(bb->fall_through);
+  }
+  if (bb->taken != NULL) {
+    successors->push_back(bb->taken);
+  }
+  if (bb->successor_block_list.block_list_type != kNotUsed) {
+    GrowableArray<SuccessorBlockInfo*>::Iterator iter(bb->successor_block_list.blocks);
+    for (SuccessorBlockInfo* info = iter.Next(); info != NULL; info = iter.Next()) {
+      successors->push_back(info->block);
+    }
+  }
+}
+
+/*
+ * Whether code appended to the block runs just before the successor: the block falls through to
+ * it and ends in neither a branch, a switch nor the check half of a throwing instruction.
+ */
+static bool OnlyFallsThroughTo(BasicBlock* bb, BasicBlock* succ_bb) {
+  return (bb->block_type == kDalvikByteCode) && (bb->fall_through == succ_bb) &&
+      (bb->taken == NULL) && (bb->successor_block_list.block_list_type == kNotUsed) &&
+      ((bb->last_mir_insn == NULL) ||
+       (static_cast<int>(bb->last_mir_insn->dalvikInsn.opcode) != static_cast<int>(kMirOpCheck)));
+}
+
+/*
+ * Give the loops a block to hoist their invariants to, before the dominators and the SSA form are
+ * built.  The loop headers are the targets of the edges that retreat in a depth first walk from
+ * the entry, and their other predecessors enter the loop.  Unless a single one of those only
+ * falls through to the header, they are redirected to a new preheader, which falls through to the
+ * header.  Headers that are switch targets are left alone, as a switch branches to the first code
+ * generated for the header's offset - which would be the preheader's - and so are catch handlers.
+ */
+void MIRGraph::InsertLoopPreheaders() {
+  if (cu_->disable_opt & (1 << kLoopInvariantCodeMotion)) {
+    return;
+  }
+  int num_blocks = GetNumBlocks();
+  std::vector<bool> visited(num_blocks, false);
+  std::vector<bool> on_stack(num_blocks, false);
+  // The sources of the retreating edges to each header.
+  std::vector<std::vector<BasicBlock*> > back_edges(num_blocks);
+  std::vector<BasicBlock*> headers;
+  std::vector<BasicBlock*> successors;
+  // Blocks on the walk's path, with the index of their next successor to visit.
+  std::vector<std::pair<BasicBlock*, size_t> > work_stack;
+  visited[GetEntryBlock()->id] = true;
+  on_stack[GetEntryBlock()->id] = true;
+  work_stack.push_back(std::make_pair(GetEntryBlock(), 0));
+  while (!work_stack.empty()) {
+    BasicBlock* bb = work_stack.back().first;
+    size_t next = work_stack.back().second;
+    GetSuccessors(bb, &successors);
+    if (next == successors.size()) {
+      on_stack[bb->id] = false;
+      work_stack.pop_back();
+      continue;
+    }
+    work_stack.back().second++;
+    BasicBlock* succ_bb = successors[next];
+    if (on_stack[succ_bb->id]) {
+      if (back_edges[succ_bb->id].empty()) {
+        headers.push_back(succ_bb);
+      }
+      back_edges[succ_bb->id].push_back(bb);
+    } else if (!visited[succ_bb->id]) {
+      visited[succ_bb->id] = true;
+      on_stack[succ_bb->id] = true;
+      work_stack.push_back(std::make_pair(succ_bb, 0));
+    }
+  }
+
+  for (size_t i = 0; i < headers.size(); i++) {
+    BasicBlock* header = headers[i];
+    if ((header->block_type != kDalvikByteCode) || header->catch_entry) {
+      continue;
+    }
+    const std::vector<BasicBlock*>& sources = back_edges[header->id];
+    std::vector<BasicBlock*> entries;
+    bool is_switch_target = false;
+    GrowableArray<BasicBlock*>::Iterator iter(header->predecessors);
+    for (BasicBlock* pred_bb = iter.Next(); pred_bb != NULL; pred_bb = iter.Next()) {
+      GetSuccessors(pred_bb, &successors);
+      size_t num_edges = std::count(successors.begin(), successors.end(), header);
+      is_switch_target |= (num_edges != (pred_bb->fall_through == header ? 1U : 0U) +
+                                   (pred_bb->taken == header ? 1U : 0U));
+      if ((std::find(sources.begin(), sources.end(), pred_bb) == sources.end()) &&
+          (std::find(entries.begin(), entries.end(), pred_bb) == entries.end())) {
+        entries.push_back(pred_bb);
+      }
+    }
+    if (entries.empty() || is_switch_target ||
+        ((entries.size() == 1) && OnlyFallsThroughTo(entries[0], header))) {
+      continue;
+    }
+    BasicBlock* preheader = NewMemBB(kDalvikByteCode, num_blocks_++);
+    block_list_.Insert(preheader);
+    preheader->start_offset = header->start_offset;
+    preheader->fall_through = header;
+    // A block without MIRs doesn't branch to its fall through, so the preheader holds a nop.
+    MIR* nop = static_cast<MIR*>(arena_->Alloc(sizeof(MIR), ArenaAllocator::kAllocMIR));
+    nop->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+    nop->meta.original_opcode = Instruction::NOP;
+    nop->offset = header->start_offset;
+    AppendMIR(preheader, nop);
+    for (size_t j = 0; j < entries.size(); j++) {
+      BasicBlock* entry_bb = entries[j];
+      if (entry_bb->fall_through == header) {
+        entry_bb->fall_through = preheader;
+        header->predecessors->Delete(entry_bb);
+        preheader->predecessors->Insert(entry_bb);
+      }
+      if (entry_bb->taken == header) {
+        entry_bb->taken = preheader;
+        header->predecessors->Delete(entry_bb);
+        preheader->predecessors->Insert(entry_bb);
+      }
+    }
+    header->predecessors->Insert(preheader);
+  }
+}
+
+/*
+ * Find the natural loops and the loop nesting depth of the blocks.  A predecessor a block
+ * dominates is the source of a back edge to it, and the loop is the header with the blocks
+ * reaching such a source backwards without passing through the header.  The headers are visited
+ * in preorder, so outer loops come before the loops they enclose.
+ */
+void MIRGraph::FindLoops() {
+  loops_.clear();
+  AllNodesIterator iter(this, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    bb->nesting_depth = 0;
+  }
+  std::vector<BasicBlock*> work_list;
+  PreOrderDfsIterator iter2(this, false /* not iterative */);
+  for (BasicBlock* header = iter2.Next(); header != NULL; header = iter2.Next()) {
+    GrowableArray<BasicBlock*>::Iterator pred_iter(header->predecessors);
+    for (BasicBlock* pred_bb = pred_iter.Next(); pred_bb != NULL; pred_bb = pred_iter.Next()) {
+      if ((pred_bb->dominators != NULL) && pred_bb->dominators->IsBitSet(header->id)) {
+        work_list.push_back(pred_bb);
+      }
+    }
+    if (work_list.empty()) {
+      continue;
+    }
+    Loop* loop = static_cast<Loop*>(arena_->Alloc(sizeof(Loop), ArenaAllocator::kAllocDFInfo));
+    loop->header = header;
+    loop->blocks = new (arena_) ArenaBitVector(arena_, GetNumBlocks(), false, kBitMapMisc);
+    loop->blocks->SetBit(header->id);
+    while (!work_list.empty()) {
+      BasicBlock* bb = work_list.back();
+      work_list.pop_back();
+      if (loop->blocks->IsBitSet(bb->id)) {
+        continue;
+      }
+      loop->blocks->SetBit(bb->id);
+      GrowableArray<BasicBlock*>::Iterator iter3(bb->predecessors);
+      for (BasicBlock* pred_bb = iter3.Next(); pred_bb != NULL; pred_bb = iter3.Next()) {
+        // Unreachable blocks have no dominators.
+        if ((pred_bb->dominators != NULL) && pred_bb->dominators->IsBitSet(header->id)) {
+          work_list.push_back(pred_bb);
+        }
+      }
+    }
+    BasicBlock* preheader = NULL;
+    int num_entries = 0;
+    pred_iter.Reset();
+    for (BasicBlock* pred_bb = pred_iter.Next(); pred_bb != NULL; pred_bb = pred_iter.Next()) {
+      if (!loop->blocks->IsBitSet(pred_bb->id)) {
+        preheader = pred_bb;
+        num_entries++;
+      }
+    }
+    loop->preheader =
+        ((num_entries == 1) && OnlyFallsThroughTo(preheader, header)) ? preheader : NULL;
+    // Loops with other headers either enclose this one or are disjoint from it.
+    loop->parent = NULL;
+    for (size_t i = loops_.size(); i > 0; i--) {
+      if (loops_[i - 1]->blocks->IsBitSet(header->id)) {
+        loop->parent = loops_[i - 1];
+        break;
+      }
+    }
+    ArenaBitVector::Iterator block_iter(loop->blocks);
+    for (int id = block_iter.Next(); id != -1; id = block_iter.Next()) {
+      GetBasicBlock(id)->nesting_depth++;
+    }
+    loops_.push_back(loop);
+  }
+}
+
+/*
+ * Whether the MIR computes its value from its operands alone, without side effects, so that it
+ * can be computed ahead of time.  References are left alone: the GC maps don't know a reference
+ * held by a Dalvik register before the instruction that originally defines it.  Field gets and
+ * array lengths need their reference to be non null.
+ */
+static bool IsHoistable(MIR* mir, int df_attributes, bool* needs_non_null) {
+  int opcode = mir->dalvikInsn.opcode;
+  *needs_non_null = false;
+  if (opcode >= kMirOpFirst) {
+    return false;
+  }
+  if (df_attributes & DF_SETS_CONST) {
+    return true;
+  }
+  switch (opcode) {
+    case Instruction::MOVE:
+    case Instruction::MOVE_FROM16:
+    case Instruction::MOVE_16:
+    case Instruction::MOVE_WIDE:
+    case Instruction::MOVE_WIDE_FROM16:
+    case Instruction::MOVE_WIDE_16:
+      return true;
+    case Instruction::ARRAY_LENGTH:
+    case Instruction::IGET:
+    case Instruction::IGET_WIDE:
+    case Instruction::IGET_BOOLEAN:
+    case Instruction::IGET_BYTE:
+    case Instruction::IGET_CHAR:
+    case Instruction::IGET_SHORT:
+      *needs_non_null = true;
+      return true;
+    default:
+      // Arithmetic, but for the divisions and remainders which throw on a zero divisor.
+      return (((opcode >= Instruction::CMPL_FLOAT) && (opcode <= Instruction::CMP_LONG)) ||
+              ((opcode >= Instruction::NEG_INT) && (opcode <= Instruction::USHR_INT_LIT8))) &&
+          !(Instruction::FlagsOf(mir->dalvikInsn.opcode) & Instruction::kThrow);
+  }
+}
+
+/*
+ * Move the invariant computations of the loop to its preheader.  An operand is invariant if it is
+ * defined outside the loop, which includes the computations hoisted before it.  As all the SSA
+ * names of a Dalvik register share its home, the register a hoisted MIR defines must not be
+ * defined elsewhere in the loop, nor live at its header - which would have given the header a Phi
+ * for it.  The MIR itself becomes a nop, leaving in place its block and the check half of a
+ * throwing instruction.
+ */
+int MIRGraph::HoistLoopInvariants(Loop* loop, GrowableArray<int>* def_blocks) {
+  BasicBlock* preheader = loop->preheader;
+  if (preheader == NULL) {
+    return 0;
+  }
+  std::vector<int> num_vreg_defs(cu_->num_dalvik_registers, 0);
+  bool may_write_memory = false;
+  ArenaBitVector::Iterator iter(loop->blocks);
+  for (int id = iter.Next(); id != -1; id = iter.Next()) {
+    for (MIR* mir = GetBasicBlock(id)->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        int v_reg = SRegToVReg(mir->ssa_rep->defs[i]);
+        if ((v_reg >= 0) && (v_reg < cu_->num_dalvik_registers)) {
+          num_vreg_defs[v_reg]++;
+        }
+      }
+      may_write_memory |= MayWriteMemory(mir);
+    }
+  }
+  // References null checked by the end of the preheader.
+  ArenaBitVector* non_null_v = preheader->data_flow_info->ending_null_check_v;
+
+  int num_hoisted = 0;
+  // Definitions come before their uses in preorder.
+  PreOrderDfsIterator iter2(this, false /* not iterative */);
+  for (BasicBlock* bb = iter2.Next(); bb != NULL; bb = iter2.Next()) {
+    if (!loop->blocks->IsBitSet(bb->id)) {
+      continue;
+    }
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      SSARepresentation* ssa_rep = mir->ssa_rep;
+      if ((ssa_rep == NULL) || (ssa_rep->num_defs == 0)) {
+        continue;
+      }
+      int opcode = mir->dalvikInsn.opcode;
+      int df_attributes = oat_data_flow_attributes_[opcode];
+      bool needs_non_null;
+      if (!IsHoistable(mir, df_attributes, &needs_non_null)) {
+        continue;
+      }
+      if (needs_non_null &&
+          ((non_null_v == NULL) || !non_null_v->IsBitSet(ssa_rep->uses[0]))) {
+        continue;
+      }
+      if ((opcode != Instruction::ARRAY_LENGTH) && needs_non_null &&
+          (may_write_memory || !IsFastInstanceGet(mir))) {
+        continue;
+      }
+      bool is_invariant = true;
+      for (int i = 0; i < ssa_rep->num_uses; i++) {
+        is_invariant &= !loop->blocks->IsBitSet(def_blocks->Get(ssa_rep->uses[i]));
+      }
+      for (int i = 0; i < ssa_rep->num_defs; i++) {
+        int v_reg = SRegToVReg(ssa_rep->defs[i]);
+        is_invariant &= (v_reg >= 0) && (v_reg < cu_->num_dalvik_registers) &&
+            (num_vreg_defs[v_reg] == 1);
+      }
+      if (!is_invariant) {
+        continue;
+      }
+      if (cu_->verbose) {
+        LOG(INFO) << "Hoisting " << Instruction::Name(mir->dalvikInsn.opcode) << " at 0x"
+                  << std::hex << mir->offset << " out of the loop at 0x"
+                  << loop->header->start_offset;
+      }
+      MIR* hoisted = static_cast<MIR*>(arena_->Alloc(sizeof(MIR), ArenaAllocator::kAllocMIR));
+      *hoisted = *mir;
+      hoisted->meta.throw_insn = NULL;
+      // A switch branches to the first code generated for an offset, so the hoisted MIR takes an
+      // offset of the preheader rather than its own.
+      hoisted->offset = (preheader->last_mir_insn != NULL) ? preheader->last_mir_insn->offset :
+          preheader->start_offset;
+      if (needs_non_null) {
+        hoisted->optimization_flags |= MIR_IGNORE_NULL_CHECK;
+      }
+      AppendMIR(preheader, hoisted);
+      for (int i = 0; i < ssa_rep->num_defs; i++) {
+        def_blocks->Put(ssa_rep->defs[i], preheader->id);
+      }
+      mir->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+      mir->meta.original_opcode = hoisted->dalvikInsn.opcode;
+      mir->ssa_rep = static_cast<SSARepresentation*>(arena_->Alloc(sizeof(SSARepresentation),
+                                                                   ArenaAllocator::kAllocDFInfo));
+      num_hoisted++;
+    }
+  }
+  return num_hoisted;
+}
+
+/*
+ * Hoist the loop invariants to the preheaders, inner loops first so that what leaves an inner
+ * loop may leave the loops enclosing it too.  This follows null check elimination, which tells
+ * the references known to be non null in the preheaders.
+ */
+void MIRGraph::LoopInvariantCodeMotion() {
+  if ((cu_->disable_opt & (1 << kLoopInvariantCodeMotion)) || loops_.empty()) {
+    return;
+  }
+  // The block defining each SSA name, the entry block for the incoming ones.
+  int num_ssa_regs = GetNumSSARegs();
+  GrowableArray<int> def_blocks(arena_, num_ssa_regs, kGrowableArrayMisc);
+  for (int i = 0; i < num_ssa_regs; i++) {
+    def_blocks.Insert(GetEntryBlock()->id);
+  }
+  AllNodesIterator iter(this, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        def_blocks.Put(mir->ssa_rep->defs[i], bb->id);
+      }
+    }
+  }
+  int num_hoisted = 0;
+  for (size_t i = loops_.size(); i > 0; i--) {
+    num_hoisted += HoistLoopInvariants(loops_[i - 1], &def_blocks);
+  }
+  if (cu_->verbose && (num_hoisted != 0)) {
+    LOG(INFO) << "Hoisted " << num_hoisted << " loop invariants out of "
+              << PrettyMethod(cu_->method_idx, *cu_->dex_file);
+  }
+}
+
+/* The check half of a throwing instruction split by ProcessCanThrow, or NULL */
+static MIR* GetCheckHalf(MIR* mir) {
+  MIR* check_half = mir->meta.throw_insn;
+  if ((check_half == NULL) ||
+      (static_cast<int>(check_half->dalvikInsn.opcode) != static_cast<int>(kMirOpCheck))) {
+    return NULL;
+  }
+  return check_half;
+}
+
+static bool Dominates(BasicBlock* dom_bb, BasicBlock* bb) {
+  return (bb->dominators != NULL) && bb->dominators->IsBitSet(dom_bb->id);
+}
+
+/*
+ * The condition holding between the operands of the if ending the block whenever it goes to the
+ * successor, and so in all the blocks the successor dominates, or kCondNv if the block doesn't end
+ * in an if or the successor can be reached another way.  The second operand of the comparisons
+ * with zero is INVALID_SREG.
+ */
+static ConditionCode GetBranchCondition(BasicBlock* bb, BasicBlock* succ_bb, int* lhs, int* rhs) {
+  MIR* mir = bb->last_mir_insn;
+  if ((mir == NULL) || (mir->ssa_rep == NULL) || (succ_bb == NULL) ||
+      (bb->taken == bb->fall_through) || (Predecessors(succ_bb) != 1)) {
+    return kCondNv;
+  }
+  ConditionCode cond;
+  switch (mir->dalvikInsn.opcode) {
+    case Instruction::IF_EQ:
+    case Instruction::IF_EQZ:
+      cond = kCondEq;
+      break;
+    case Instruction::IF_NE:
+    case Instruction::IF_NEZ:
+      cond = kCondNe;
+      break;
+    case Instruction::IF_LT:
+    case Instruction::IF_LTZ:
+      cond = kCondLt;
+      break;
+    case Instruction::IF_GE:
+    case Instruction::IF_GEZ:
+      cond = kCondGe;
+      break;
+    case Instruction::IF_GT:
+    case Instruction::IF_GTZ:
+      cond = kCondGt;
+      break;
+    case Instruction::IF_LE:
+    case Instruction::IF_LEZ:
+      cond = kCondLe;
+      break;
+    default:
+      return kCondNv;
+  }
+  *lhs = mir->ssa_rep->uses[0];
+  *rhs = (mir->ssa_rep->num_uses > 1) ? mir->ssa_rep->uses[1] : INVALID_SREG;
+  if (succ_bb == bb->taken) {
+    return cond;
+  }
+  switch (cond) {
+    case kCondEq: return kCondNe;
+    case kCondNe: return kCondEq;
+    case kCondLt: return kCondGe;
+    case kCondGe: return kCondLt;
+    case kCondGt: return kCondLe;
+    default: return kCondGt;
+  }
+}
+
+/*
+ * Whether the MIR adds a constant to an int, and then the int's SSA name and the constant.
+ */
+bool MIRGraph::IsAddConstant(MIR* mir, int* s_reg, int* constant) {
+  SSARepresentation* ssa_rep = mir->ssa_rep;
+  if ((ssa_rep == NULL) || (ssa_rep->num_defs != 1)) {
+    return false;
+  }
+  switch (mir->dalvikInsn.opcode) {
+    case Instruction::ADD_INT_LIT8:
+    case Instruction::ADD_INT_LIT16:
+      *s_reg = ssa_rep->uses[0];
+      *constant = static_cast<int>(mir->dalvikInsn.vC);
+      return true;
+    case Instruction::ADD_INT:
+    case Instruction::ADD_INT_2ADDR:
+      if (IsConst(ssa_rep->uses[1])) {
+        *s_reg = ssa_rep->uses[0];
+        *constant = ConstantValue(ssa_rep->uses[1]);
+        return true;
+      }
+      if (IsConst(ssa_rep->uses[0])) {
+        *s_reg = ssa_rep->uses[1];
+        *constant = ConstantValue(ssa_rep->uses[0]);
+        return true;
+      }
+      return false;
+    case Instruction::SUB_INT:
+    case Instruction::SUB_INT_2ADDR:
+      if (IsConst(ssa_rep->uses[1]) &&
+          (ConstantValue(ssa_rep->uses[1]) != std::numeric_limits<int32_t>::min())) {
+        *s_reg = ssa_rep->uses[0];
+        *constant = -ConstantValue(ssa_rep->uses[1]);
+        return true;
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
+/*
+ * Whether an index less than the bound - the value of the array-length defining length_s_reg or,
+ * for INVALID_SREG, the constant - is less than the length of the array.
+ */
+bool MIRGraph::IsBelowLength(int array_s_reg, int length_s_reg, int constant,
+                             const std::vector<MIR*>& def_mirs) {
+  if (length_s_reg != INVALID_SREG) {
+    MIR* length_mir = def_mirs[length_s_reg];
+    return (length_mir != NULL) && (length_mir->dalvikInsn.opcode == Instruction::ARRAY_LENGTH) &&
+        (length_mir->ssa_rep->uses[0] == array_s_reg);
+  }
+  MIR* array_mir = def_mirs[array_s_reg];
+  return (array_mir != NULL) && (array_mir->dalvikInsn.opcode == Instruction::NEW_ARRAY) &&
+      IsConst(array_mir->ssa_rep->uses[0]) &&
+      (ConstantValue(array_mir->ssa_rep->uses[0]) >= constant);
+}
+
+/*
+ * Remove the range checks of the array accesses indexed by a basic induction variable of the
+ * loop, a Phi of the header stepping by one in the loop.  When it counts up, its initial values
+ * are non negative constants and a test that it is less than an array length or a constant,
+ * which comes before every step and so keeps it from overflowing, gives the upper bound.  When it
+ * counts down, its initial values are less than an array length or a constant and a test that it
+ * is not negative, which comes before every step, gives the lower bound.  The tested bound holds
+ * in the blocks dominated by the successor of the test it was tested for, as all the paths from
+ * the header to them go through that successor.
+ */
+int MIRGraph::EliminateLoopRangeChecks(Loop* loop, const std::vector<MIR*>& def_mirs,
+                                       const std::vector<BasicBlock*>& def_blocks) {
+  int num_eliminated = 0;
+  BasicBlock* header = loop->header;
+  for (MIR* phi = header->first_mir_insn; phi != NULL; phi = phi->next) {
+    if ((static_cast<int>(phi->dalvikInsn.opcode) != kMirOpPhi) ||
+        (phi->ssa_rep->num_defs != 1)) {
+      continue;
+    }
+    int iv_s_reg = phi->ssa_rep->defs[0];
+    int* incoming = reinterpret_cast<int*>(phi->dalvikInsn.vB);
+    std::vector<int> initial_values;
+    std::vector<BasicBlock*> step_blocks;
+    int step = 0;
+    bool is_induction_variable = true;
+    for (int i = 0; i < phi->ssa_rep->num_uses; i++) {
+      int s_reg = phi->ssa_rep->uses[i];
+      if (!loop->blocks->IsBitSet(incoming[i])) {
+        initial_values.push_back(s_reg);
+        continue;
+      }
+      if (s_reg == iv_s_reg) {
+        continue;
+      }
+      MIR* step_mir = def_mirs[s_reg];
+      int base_s_reg;
+      int constant;
+      if ((step_mir == NULL) || !IsAddConstant(step_mir, &base_s_reg, &constant) ||
+          (base_s_reg != iv_s_reg) || ((constant != 1) && (constant != -1)) ||
+          ((step != 0) && (constant != step))) {
+        is_induction_variable = false;
+        break;
+      }
+      step = constant;
+      step_blocks.push_back(def_blocks[s_reg]);
+    }
+    if (!is_induction_variable || (step == 0) || initial_values.empty()) {
+      continue;
+    }
+
+    // The bound of the initial values when counting down, from which it can only go lower.
+    int length_s_reg = INVALID_SREG;
+    int constant_bound = 0;
+    bool is_bounded = true;
+    for (size_t i = 0; is_bounded && (i < initial_values.size()); i++) {
+      int s_reg = initial_values[i];
+      if (step > 0) {
+        is_bounded = IsConst(s_reg) && (ConstantValue(s_reg) >= 0);
+        continue;
+      }
+      int base_s_reg;
+      int constant;
+      if (IsConst(s_reg) && (ConstantValue(s_reg) != std::numeric_limits<int32_t>::max())) {
+        is_bounded = (length_s_reg == INVALID_SREG);
+        constant_bound = std::max(constant_bound, ConstantValue(s_reg) + 1);
+      } else if ((def_mirs[s_reg] != NULL) &&
+                 IsAddConstant(def_mirs[s_reg], &base_s_reg, &constant) && (constant < 0) &&
+                 (def_mirs[base_s_reg] != NULL) &&
+                 (def_mirs[base_s_reg]->dalvikInsn.opcode == Instruction::ARRAY_LENGTH)) {
+        is_bounded = (constant_bound == 0) &&
+            ((length_s_reg == INVALID_SREG) || (length_s_reg == base_s_reg));
+        length_s_reg = base_s_reg;
+      } else {
+        is_bounded = false;
+      }
+    }
+    if (!is_bounded) {
+      continue;
+    }
+
+    ArenaBitVector::Iterator iter(loop->blocks);
+    for (int id = iter.Next(); id != -1; id = iter.Next()) {
+      BasicBlock* test_bb = GetBasicBlock(id);
+      BasicBlock* successors[2] = { test_bb->taken, test_bb->fall_through };
+      for (int i = 0; i < 2; i++) {
+        BasicBlock* succ_bb = successors[i];
+        int lhs;
+        int rhs;
+        ConditionCode cond = GetBranchCondition(test_bb, succ_bb, &lhs, &rhs);
+        if (cond == kCondNv) {
+          continue;
+        }
+        bool is_tested = false;
+        if (step > 0) {
+          // iv < bound or bound > iv.
+          int bound_s_reg = INVALID_SREG;
+          if ((lhs == iv_s_reg) && (cond == kCondLt)) {
+            bound_s_reg = rhs;
+          } else if ((rhs == iv_s_reg) && (cond == kCondGt)) {
+            bound_s_reg = lhs;
+          }
+          if (bound_s_reg == INVALID_SREG) {
+            continue;
+          }
+          is_tested = true;
+          if (IsConst(bound_s_reg)) {
+            length_s_reg = INVALID_SREG;
+            constant_bound = ConstantValue(bound_s_reg);
+          } else {
+            length_s_reg = bound_s_reg;
+          }
+        } else {
+          // iv >= 0, iv > 0 or the converse.
+          if ((lhs == iv_s_reg) && ((cond == kCondGe) || (cond == kCondGt))) {
+            is_tested = (rhs == INVALID_SREG) || (IsConst(rhs) && (ConstantValue(rhs) == 0));
+          } else if ((rhs == iv_s_reg) && ((cond == kCondLe) || (cond == kCondLt))) {
+            is_tested = IsConst(lhs) && (ConstantValue(lhs) == 0);
+          }
+        }
+        if (!is_tested) {
+          continue;
+        }
+        bool guards_steps = true;
+        for (size_t j = 0; j < step_blocks.size(); j++) {
+          guards_steps &= Dominates(succ_bb, step_blocks[j]);
+        }
+        if (!guards_steps) {
+          continue;
+        }
+        ArenaBitVector::Iterator iter2(loop->blocks);
+        for (int id2 = iter2.Next(); id2 != -1; id2 = iter2.Next()) {
+          BasicBlock* bb = GetBasicBlock(id2);
+          if (!Dominates(succ_bb, bb)) {
+            continue;
+          }
+          for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+            int df_attributes = oat_data_flow_attributes_[mir->dalvikInsn.opcode];
+            if (!(df_attributes & DF_HAS_RANGE_CHKS) || (mir->ssa_rep == NULL) ||
+                (mir->optimization_flags & MIR_IGNORE_RANGE_CHECK)) {
+              continue;
+            }
+            int array_idx;
+            if (df_attributes & DF_RANGE_CHK_3) {
+              array_idx = 2;
+            } else if (df_attributes & DF_RANGE_CHK_2) {
+              array_idx = 1;
+            } else {
+              array_idx = 0;
+            }
+            int array_s_reg = mir->ssa_rep->uses[array_idx];
+            if ((mir->ssa_rep->uses[array_idx + 1] != iv_s_reg) ||
+                !IsBelowLength(array_s_reg, length_s_reg, constant_bound, def_mirs)) {
+              continue;
+            }
+            if (cu_->verbose) {
+              LOG(INFO) << "Removing range check for 0x" << std::hex << mir->offset;
+            }
+            mir->optimization_flags |= MIR_IGNORE_RANGE_CHECK;
+            MIR* check_half = GetCheckHalf(mir);
+            if (check_half != NULL) {
+              check_half->optimization_flags |= MIR_IGNORE_RANGE_CHECK;
+            }
+            num_eliminated++;
+          }
+        }
+      }
+    }
+  }
+  return num_eliminated;
+}
+
+/*
+ * Remove the range checks that the induction variables of the loops keep within the bounds of
+ * their arrays.  A counted loop over an array usually tests its index against the array's length
+ * in the loop, so hoisting a combined check out of it would need a second copy of the loop to
+ * fall back to, which isn't done.
+ */
+void MIRGraph::RangeCheckElimination() {
+  if ((cu_->disable_opt & (1 << kRangeCheckElimination)) || loops_.empty()) {
+    return;
+  }
+  // The MIR and block defining each SSA name, NULL for the incoming ones.
+  int num_ssa_regs = GetNumSSARegs();
+  std::vector<MIR*> def_mirs(num_ssa_regs, static_cast<MIR*>(NULL));
+  std::vector<BasicBlock*> def_blocks(num_ssa_regs, GetEntryBlock());
+  AllNodesIterator iter(this, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        def_mirs[mir->ssa_rep->defs[i]] = mir;
+        def_blocks[mir->ssa_rep->defs[i]] = bb;
+      }
+    }
+  }
+  int num_eliminated = 0;
+  for (size_t i = 0; i < loops_.size(); i++) {
+    num_eliminated += EliminateLoopRangeChecks(loops_[i], def_mirs, def_blocks);
+  }
+  if (cu_->verbose && (num_eliminated != 0)) {
+    LOG(INFO) << "Eliminated " << num_eliminated << " range checks in loops of "
+              << PrettyMethod(cu_->method_idx, *cu_->dex_file);
+  }
+}
+
 void MIRGraph::DumpCheckStats() {
   Checkstats* stats =
       static_cast<Checkstats*>(arena_->Alloc(sizeof(Checkstats), ArenaAllocator::kAllocDFInfo));
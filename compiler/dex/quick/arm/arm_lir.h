@@ -223,6 +223,7 @@ enum ArmNativeRegisterPool {
 #define rARM_RET0 r0
 #define rARM_RET1 r1
 #define rARM_INVOKE_TGT rARM_LR
+#define rARM_HIDDEN_ARG r12
 #define rARM_COUNT INVALID_REG
 
 enum ArmShiftEncodings {
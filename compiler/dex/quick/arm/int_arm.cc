@@ -777,15 +777,17 @@ void ArmMir2Lir::GenArrayGet(int opt_flags, OpSize size, RegLocation rl_array,
     data_offset += mir_graph_->ConstantValue(rl_index) << scale;
   }
 
-  /* null object? */
-  GenNullCheck(rl_array.s_reg_low, rl_array.low_reg, opt_flags);
-
   bool needs_range_check = (!(opt_flags & MIR_IGNORE_RANGE_CHECK));
   int reg_len = INVALID_REG;
   if (needs_range_check) {
     reg_len = AllocTemp();
-    /* Get len */
+    /* null object? Get len */
+    GenNullCheckOfAccess(rl_array.s_reg_low, rl_array.low_reg, opt_flags, len_offset);
     LoadWordDisp(rl_array.low_reg, len_offset, reg_len);
+    MarkImplicitNullCheck(opt_flags, len_offset);
+  } else {
+    /* null object? */
+    GenNullCheck(rl_array.s_reg_low, rl_array.low_reg, opt_flags);
   }
   if (rl_dest.wide || rl_dest.fp || constant_index) {
     int reg_ptr;
@@ -877,16 +879,18 @@ void ArmMir2Lir::GenArrayPut(int opt_flags, OpSize size, RegLocation rl_array,
     reg_ptr = AllocTemp();
   }
 
-  /* null object? */
-  GenNullCheck(rl_array.s_reg_low, rl_array.low_reg, opt_flags);
-
   bool needs_range_check = (!(opt_flags & MIR_IGNORE_RANGE_CHECK));
   int reg_len = INVALID_REG;
   if (needs_range_check) {
     reg_len = AllocTemp();
     // NOTE: max live temps(4) here.
-    /* Get len */
+    /* null object? Get len */
+    GenNullCheckOfAccess(rl_array.s_reg_low, rl_array.low_reg, opt_flags, len_offset);
     LoadWordDisp(rl_array.low_reg, len_offset, reg_len);
+    MarkImplicitNullCheck(opt_flags, len_offset);
+  } else {
+    /* null object? */
+    GenNullCheck(rl_array.s_reg_low, rl_array.low_reg, opt_flags);
   }
   /* at this point, reg_ptr points to array, 2 live temps */
   if (rl_src.wide || rl_src.fp || constant_index) {
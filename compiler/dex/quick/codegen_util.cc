@@ -506,6 +506,50 @@ bool Mir2Lir::VerifyCatchEntries() {
 }
 
 
+// Orders mapping table entries by key alone.
+struct MappingTableEntryKeyLess {
+  bool operator()(const std::pair<uint32_t, uint32_t>& lhs,
+                  const std::pair<uint32_t, uint32_t>& rhs) const {
+    return lhs.first < rhs.first;
+  }
+};
+
+// Appends a section of the mapping table, whose (key, value) entries must be sorted by key. See
+// MappingTable for the encoding.
+static void EncodeMappingTableSection(const std::vector<std::pair<uint32_t, uint32_t> >& entries,
+                                      std::vector<uint8_t>* table) {
+  UnsignedLeb128EncodingVector encoded_entries;
+  std::vector<uint32_t> index;
+  uint32_t key = 0;
+  uint32_t value = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (i % MappingTable::kIndexInterval == 0) {
+      if (i != 0) {
+        index.push_back(encoded_entries.GetData().size());
+      }
+      key = 0;
+      value = 0;
+    }
+    DCHECK_GE(entries[i].first, key);
+    encoded_entries.PushBack(entries[i].first - key);
+    int32_t delta = entries[i].second - value;
+    // Zigzag encoded. The delta is shifted left unsigned, which is undefined for a negative int.
+    uint32_t zigzag_delta =
+        (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+    encoded_entries.PushBack(zigzag_delta);
+    key = entries[i].first;
+    value = entries[i].second;
+  }
+  DCHECK_EQ(index.size(), MappingTable::IndexSize(entries.size()));
+  for (size_t i = 0; i < index.size(); ++i) {
+    table->push_back(index[i] & 0xff);
+    table->push_back((index[i] >> 8) & 0xff);
+    table->push_back((index[i] >> 16) & 0xff);
+    table->push_back((index[i] >> 24) & 0xff);
+  }
+  table->insert(table->end(), encoded_entries.GetData().begin(), encoded_entries.GetData().end());
+}
+
 void Mir2Lir::CreateMappingTables() {
   for (LIR* tgt_lir = first_lir_insn_; tgt_lir != NULL; tgt_lir = NEXT_LIR(tgt_lir)) {
     if (!tgt_lir->flags.is_nop && (tgt_lir->opcode == kPseudoSafepointPC)) {
@@ -522,29 +566,54 @@ void Mir2Lir::CreateMappingTables() {
   }
   CHECK_EQ(pc2dex_mapping_table_.size() & 1, 0U);
   CHECK_EQ(dex2pc_mapping_table_.size() & 1, 0U);
-  uint32_t total_entries = (pc2dex_mapping_table_.size() + dex2pc_mapping_table_.size()) / 2;
-  uint32_t pc2dex_entries = pc2dex_mapping_table_.size() / 2;
-  encoded_mapping_table_.PushBack(total_entries);
-  encoded_mapping_table_.PushBack(pc2dex_entries);
-  encoded_mapping_table_.InsertBack(pc2dex_mapping_table_.begin(), pc2dex_mapping_table_.end());
-  encoded_mapping_table_.InsertBack(dex2pc_mapping_table_.begin(), dex2pc_mapping_table_.end());
+  // Key the pc to dex entries by native pc offset and the dex to pc ones by dex pc. The stable
+  // sort keeps the native pc order of the catch entries of a dex pc.
+  std::vector<std::pair<uint32_t, uint32_t> > pc2dex_entries;
+  for (size_t i = 0; i < pc2dex_mapping_table_.size(); i += 2) {
+    pc2dex_entries.push_back(std::make_pair(pc2dex_mapping_table_[i],
+                                            pc2dex_mapping_table_[i + 1]));
+  }
+  std::stable_sort(pc2dex_entries.begin(), pc2dex_entries.end(), MappingTableEntryKeyLess());
+  std::vector<std::pair<uint32_t, uint32_t> > dex2pc_entries;
+  for (size_t i = 0; i < dex2pc_mapping_table_.size(); i += 2) {
+    dex2pc_entries.push_back(std::make_pair(dex2pc_mapping_table_[i + 1],
+                                            dex2pc_mapping_table_[i]));
+  }
+  std::stable_sort(dex2pc_entries.begin(), dex2pc_entries.end(), MappingTableEntryKeyLess());
+  std::vector<uint8_t> pc2dex_section;
+  EncodeMappingTableSection(pc2dex_entries, &pc2dex_section);
+  std::vector<uint8_t> dex2pc_section;
+  EncodeMappingTableSection(dex2pc_entries, &dex2pc_section);
+  UnsignedLeb128EncodingVector header;
+  header.PushBack(pc2dex_entries.size() + dex2pc_entries.size());
+  header.PushBack(pc2dex_entries.size());
+  header.PushBack(pc2dex_section.size());
+  encoded_mapping_table_ = header.GetData();
+  encoded_mapping_table_.insert(encoded_mapping_table_.end(), pc2dex_section.begin(),
+                                pc2dex_section.end());
+  encoded_mapping_table_.insert(encoded_mapping_table_.end(), dex2pc_section.begin(),
+                                dex2pc_section.end());
   if (kIsDebugBuild) {
     // Verify the encoded table holds the expected data.
-    MappingTable table(&encoded_mapping_table_.GetData()[0]);
-    CHECK_EQ(table.TotalSize(), total_entries);
-    CHECK_EQ(table.PcToDexSize(), pc2dex_entries);
-    CHECK_EQ(table.DexToPcSize(), dex2pc_mapping_table_.size() / 2);
+    MappingTable table(&encoded_mapping_table_[0]);
+    CHECK_EQ(table.TotalSize(), pc2dex_entries.size() + dex2pc_entries.size());
+    CHECK_EQ(table.PcToDexSize(), pc2dex_entries.size());
+    CHECK_EQ(table.DexToPcSize(), dex2pc_entries.size());
     MappingTable::PcToDexIterator it = table.PcToDexBegin();
-    for (uint32_t i = 0; i < pc2dex_mapping_table_.size(); ++i, ++it) {
-      CHECK_EQ(pc2dex_mapping_table_.at(i), it.NativePcOffset());
-      ++i;
-      CHECK_EQ(pc2dex_mapping_table_.at(i), it.DexPc());
+    for (uint32_t i = 0; i < pc2dex_entries.size(); ++i, ++it) {
+      CHECK_EQ(pc2dex_entries[i].first, it.NativePcOffset());
+      CHECK_EQ(pc2dex_entries[i].second, it.DexPc());
+      MappingTable::PcToDexIterator found = table.FindPcToDex(pc2dex_entries[i].first);
+      CHECK(found != table.PcToDexEnd());
+      CHECK_EQ(pc2dex_entries[i].first, found.NativePcOffset());
     }
     MappingTable::DexToPcIterator it2 = table.DexToPcBegin();
-    for (uint32_t i = 0; i < dex2pc_mapping_table_.size(); ++i, ++it2) {
-      CHECK_EQ(dex2pc_mapping_table_.at(i), it2.NativePcOffset());
-      ++i;
-      CHECK_EQ(dex2pc_mapping_table_.at(i), it2.DexPc());
+    for (uint32_t i = 0; i < dex2pc_entries.size(); ++i, ++it2) {
+      CHECK_EQ(dex2pc_entries[i].first, it2.DexPc());
+      CHECK_EQ(dex2pc_entries[i].second, it2.NativePcOffset());
+      MappingTable::DexToPcIterator found = table.FindDexToPc(dex2pc_entries[i].first);
+      CHECK(found != table.DexToPcEnd());
+      CHECK_EQ(dex2pc_entries[i].first, found.DexPc());
     }
   }
 }
@@ -1029,7 +1098,7 @@ CompiledMethod* Mir2Lir::GetCompiledMethod() {
   }
   CompiledMethod* result =
       new CompiledMethod(*cu_->compiler_driver, cu_->instruction_set, code_buffer_, frame_size_,
-                         core_spill_mask_, fp_spill_mask_, encoded_mapping_table_.GetData(),
+                         core_spill_mask_, fp_spill_mask_, encoded_mapping_table_,
                          vmap_encoder.GetData(), native_gc_map_);
   return result;
 }
@@ -72,6 +72,43 @@ LIR* Mir2Lir::GenNullCheck(int s_reg, int m_reg, int opt_flags) {
   return GenImmedCheck(kCondEq, m_reg, 0, kThrowNullPointer);
 }
 
+/*
+ * Whether the access of memory at the offset from a reference checks it for null implicitly,
+ * faulting on null: the runtime turns the faults of ARM code within the first page into null
+ * pointer exceptions when built with implicit null checks.
+ */
+bool Mir2Lir::NeedsImplicitNullCheck(int opt_flags, int offset) {
+  if (kUseImplicitNullChecks &&
+      ((cu_->instruction_set == kArm) || (cu_->instruction_set == kThumb2)) &&
+      (offset >= 0) && (offset < kPageSize)) {
+    return (cu_->disable_opt & (1 << kNullCheckElimination)) ||
+        !(opt_flags & MIR_IGNORE_NULL_CHECK);
+  }
+  return false;
+}
+
+/*
+ * Null-check a register that the very next memory access dereferences at the offset, leaving
+ * it to that access when it can check implicitly.  MarkImplicitNullCheck must follow the access.
+ */
+LIR* Mir2Lir::GenNullCheckOfAccess(int s_reg, int m_reg, int opt_flags, int offset) {
+  if (NeedsImplicitNullCheck(opt_flags, offset)) {
+    return NULL;
+  }
+  return GenNullCheck(s_reg, m_reg, opt_flags);
+}
+
+/*
+ * Record the memory access just generated as an implicit null check, with a safepoint for its end
+ * that the runtime returns to from the null pointer exception entrypoint when it faults.  The
+ * safepoint also keeps the access from being moved.
+ */
+void Mir2Lir::MarkImplicitNullCheck(int opt_flags, int offset) {
+  if (NeedsImplicitNullCheck(opt_flags, offset)) {
+    MarkSafepointPC(last_lir_insn_);
+  }
+}
+
 /* Perform check on two registers */
 LIR* Mir2Lir::GenRegRegCheck(ConditionCode c_code, int reg1, int reg2,
                              ThrowKind kind) {
@@ -657,9 +694,10 @@ void Mir2Lir::GenIGet(uint32_t field_idx, int opt_flags, OpSize size,
       StoreValueWide(rl_dest, rl_result);
     } else {
       rl_result = EvalLoc(rl_dest, reg_class, true);
-      GenNullCheck(rl_obj.s_reg_low, rl_obj.low_reg, opt_flags);
+      GenNullCheckOfAccess(rl_obj.s_reg_low, rl_obj.low_reg, opt_flags, field_offset);
       LoadBaseDisp(rl_obj.low_reg, field_offset, rl_result.low_reg,
                    kWord, rl_obj.s_reg_low);
+      MarkImplicitNullCheck(opt_flags, field_offset);
       if (is_volatile) {
         GenMemBarrier(kLoadLoad);
       }
@@ -709,11 +747,12 @@ void Mir2Lir::GenIPut(uint32_t field_idx, int opt_flags, OpSize size,
       FreeTemp(reg_ptr);
     } else {
       rl_src = LoadValue(rl_src, reg_class);
-      GenNullCheck(rl_obj.s_reg_low, rl_obj.low_reg, opt_flags);
+      GenNullCheckOfAccess(rl_obj.s_reg_low, rl_obj.low_reg, opt_flags, field_offset);
       if (is_volatile) {
         GenMemBarrier(kStoreStore);
       }
       StoreBaseDisp(rl_obj.low_reg, field_offset, rl_src.low_reg, kWord);
+      MarkImplicitNullCheck(opt_flags, field_offset);
       if (is_volatile) {
         GenMemBarrier(kLoadLoad);
       }
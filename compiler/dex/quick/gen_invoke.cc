@@ -477,73 +477,99 @@ static int NextVCallInsn(CompilationUnit* cu, CallInfo* info,
 }
 
 /*
- * All invoke-interface calls bounce off of art_quick_invoke_interface_trampoline,
- * which will locate the target and continue on via a tail call.
+ * Emit the next instruction in an invoke-interface sequence through the interface method table
+ * of the receiver's class. The imt slot is chosen by the dex method index of the resolved
+ * interface method, passed in method_idx. The implementation in the slot is only called if the
+ * slot records the interface method the call resolves to in this dex file's cache, otherwise the
+ * receiver may not implement the interface at all and the call goes to the imt conflict method.
+ * Its stub gets the interface method in the hidden argument and goes through
+ * art_quick_invoke_interface_trampoline.
  */
 static int NextInterfaceCallInsn(CompilationUnit* cu, CallInfo* info, int state,
                                  const MethodReference& target_method,
-                                 uint32_t unused, uintptr_t unused2,
-                                 uintptr_t direct_method, InvokeType unused4) {
+                                 uint32_t method_idx, uintptr_t unused,
+                                 uintptr_t unused2, InvokeType unused3) {
   Mir2Lir* cg = static_cast<Mir2Lir*>(cu->cg.get());
-  if (cu->instruction_set != kThumb2) {
-    // Disable sharpening
-    direct_method = 0;
-  }
-  ThreadOffset trampoline = QUICK_ENTRYPOINT_OFFSET(pInvokeInterfaceTrampoline);
-
-  if (direct_method != 0) {
-    switch (state) {
-      case 0:  // Load the trampoline target [sets kInvokeTgt].
-        if (cu->instruction_set != kX86) {
-          cg->LoadWordDisp(cg->TargetReg(kSelf), trampoline.Int32Value(),
-                           cg->TargetReg(kInvokeTgt));
-        }
-        // Get the interface Method* [sets kArg0]
-        if (direct_method != static_cast<unsigned int>(-1)) {
-          cg->LoadConstant(cg->TargetReg(kArg0), direct_method);
-        } else {
-          CHECK_EQ(cu->dex_file, target_method.dex_file);
-          LIR* data_target = cg->ScanLiteralPool(cg->method_literal_list_,
-                                                 target_method.dex_method_index, 0);
-          if (data_target == NULL) {
-            data_target = cg->AddWordData(&cg->method_literal_list_,
-                                          target_method.dex_method_index);
-            data_target->operands[1] = kInterface;
-          }
-          LIR* load_pc_rel = cg->OpPcRelLoad(cg->TargetReg(kArg0), data_target);
-          cg->AppendLIR(load_pc_rel);
-          DCHECK_EQ(cu->instruction_set, kThumb2) << reinterpret_cast<void*>(data_target);
-        }
-        break;
-      default:
-        return -1;
-    }
-  } else {
-    switch (state) {
-      case 0:
-        // Get the current Method* [sets kArg0] - TUNING: remove copy of method if it is promoted.
-        cg->LoadCurrMethodDirect(cg->TargetReg(kArg0));
-        // Load the trampoline target [sets kInvokeTgt].
-        if (cu->instruction_set != kX86) {
-          cg->LoadWordDisp(cg->TargetReg(kSelf), trampoline.Int32Value(),
-                           cg->TargetReg(kInvokeTgt));
-        }
-        break;
-    case 1:  // Get method->dex_cache_resolved_methods_ [set/use kArg0]
-      cg->LoadWordDisp(cg->TargetReg(kArg0),
+  int slot = method_idx % mirror::Class::kImtSize;
+  int array_data_offset = mirror::Array::DataOffset(sizeof(mirror::Object*)).Int32Value();
+  switch (state) {
+    case 0:  // Get the current method [set kHiddenArg]
+      cg->LoadCurrMethodDirect(cg->TargetReg(kHiddenArg));
+      break;
+    case 1:  // Get current_method->dex_cache_resolved_methods_ [use/set kHiddenArg]
+      cg->LoadWordDisp(cg->TargetReg(kHiddenArg),
                        mirror::ArtMethod::DexCacheResolvedMethodsOffset().Int32Value(),
-                       cg->TargetReg(kArg0));
+                       cg->TargetReg(kHiddenArg));
       break;
-    case 2:  // Grab target method* [set/use kArg0]
+    case 2:  // Get the interface method [use kHiddenArg, set kHiddenArg, kHiddenFpArg]
       CHECK_EQ(cu->dex_file, target_method.dex_file);
-      cg->LoadWordDisp(cg->TargetReg(kArg0),
-                       mirror::Array::DataOffset(sizeof(mirror::Object*)).Int32Value() +
-                           (target_method.dex_method_index * 4),
+      if (cu->instruction_set == kX86) {
+        cg->LoadWordDisp(cg->TargetReg(kHiddenArg),
+                         array_data_offset + (target_method.dex_method_index * 4),
+                         cg->TargetReg(kHiddenArg));
+        cg->OpRegCopy(cg->TargetReg(kHiddenFpArg), cg->TargetReg(kHiddenArg));
+      } else {
+        // The offset may be too large for a load and no temp is left for it.
+        cg->LoadConstant(cg->TargetReg(kArg0),
+                         array_data_offset + (target_method.dex_method_index * 4));
+        cg->LoadBaseIndexed(cg->TargetReg(kHiddenArg), cg->TargetReg(kArg0),
+                            cg->TargetReg(kHiddenArg), 0, kWord);
+      }
+      break;
+    case 3: {  // Get "this" [set kArg1]
+      RegLocation rl_arg = info->args[0];
+      cg->LoadValueDirectFixed(rl_arg, cg->TargetReg(kArg1));
+      break;
+    }
+    case 4:  // Is "this" null? [use kArg1]
+      cg->GenNullCheck(info->args[0].s_reg_low, cg->TargetReg(kArg1), info->opt_flags);
+      // Get this->klass_ [use kArg1, set kInvokeTgt]
+      cg->LoadWordDisp(cg->TargetReg(kArg1), mirror::Object::ClassOffset().Int32Value(),
+                       cg->TargetReg(kInvokeTgt));
+      break;
+    case 5:  // Get this->klass_->imtable [use kInvokeTgt, set kInvokeTgt]
+      cg->LoadWordDisp(cg->TargetReg(kInvokeTgt), mirror::Class::ImTableOffset().Int32Value(),
+                       cg->TargetReg(kInvokeTgt));
+      break;
+    case 6: {  // Get target method [use kInvokeTgt, kHiddenArg, set kArg0]
+      int interface_method_offset =
+          array_data_offset + (mirror::Class::ImtInterfaceMethodIndex(slot) * 4);
+      LIR* mismatch;
+      if (cu->instruction_set == kX86) {
+        // kInvokeTgt and kHiddenArg are kArg0, compare in kArg1 and load "this" again.
+        cg->OpRegCopy(cg->TargetReg(kArg1), cg->TargetReg(kHiddenFpArg));
+        cg->OpRegMem(kOpCmp, cg->TargetReg(kArg1), cg->TargetReg(kInvokeTgt),
+                     interface_method_offset);
+        mismatch = cg->OpCondBranch(kCondNe, NULL);
+      } else {
+        cg->LoadWordDisp(cg->TargetReg(kInvokeTgt), interface_method_offset,
+                         cg->TargetReg(kArg0));
+        mismatch = cg->OpCmpBranch(kCondNe, cg->TargetReg(kArg0), cg->TargetReg(kHiddenArg),
+                                   NULL);
+      }
+      cg->LoadWordDisp(cg->TargetReg(kInvokeTgt), array_data_offset + (slot * 4),
+                       cg->TargetReg(kArg0));
+      LIR* done = cg->OpUnconditionalBranch(NULL);
+      mismatch->target = cg->NewLIR0(kPseudoTargetLabel);
+      cg->LoadWordDisp(cg->TargetReg(kInvokeTgt),
+                       array_data_offset + (mirror::Class::kImtConflictMethodIndex * 4),
                        cg->TargetReg(kArg0));
+      done->target = cg->NewLIR0(kPseudoTargetLabel);
+      if (cu->instruction_set == kX86) {
+        cg->LoadValueDirectFixed(info->args[0], cg->TargetReg(kArg1));
+      }
       break;
+    }
+    case 7:  // Get the compiled code address [use kArg0, set kInvokeTgt]
+      if (cu->instruction_set != kX86) {
+        cg->LoadWordDisp(cg->TargetReg(kArg0),
+                         mirror::ArtMethod::GetEntryPointFromCompiledCodeOffset().Int32Value(),
+                         cg->TargetReg(kInvokeTgt));
+        break;
+      }
+      // Intentional fallthrough for X86
     default:
       return -1;
-    }
   }
   return state + 1;
 }
@@ -1378,11 +1404,15 @@ void Mir2Lir::GenInvoke(CallInfo* info) {
                                               direct_code, direct_method,
                                               true) && !SLOW_INVOKE_PATH;
   if (info->type == kInterface) {
+    next_call_insn = fast_path ? NextInterfaceCallInsn : NextInterfaceCallInsnWithAccessCheck;
+    skip_this = fast_path;
     if (fast_path) {
-      p_null_ck = &null_ck;
+      // Keep the hidden argument out of the way of the argument loading.
+      LockTemp(TargetReg(kHiddenArg));
+      if (cu_->instruction_set == kX86) {
+        LockTemp(TargetReg(kHiddenFpArg));
+      }
     }
-    next_call_insn = fast_path ? NextInterfaceCallInsn : NextInterfaceCallInsnWithAccessCheck;
-    skip_this = false;
   } else if (info->type == kDirect) {
     if (fast_path) {
       p_null_ck = &null_ck;
@@ -1422,7 +1452,7 @@ void Mir2Lir::GenInvoke(CallInfo* info) {
   if (cu_->instruction_set != kX86) {
     call_inst = OpReg(kOpBlx, TargetReg(kInvokeTgt));
   } else {
-    if (fast_path && info->type != kInterface) {
+    if (fast_path) {
       call_inst = OpMem(kOpBlx, TargetReg(kArg0),
                         mirror::ArtMethod::GetEntryPointFromCompiledCodeOffset().Int32Value());
     } else {
@@ -291,8 +291,12 @@ void Mir2Lir::ApplyLoadHoisting(LIR* head_lir, LIR* tail_lir) {
     }
 
     uint64_t target_flags = GetTargetInstFlags(this_lir->opcode);
-    /* Skip non-interesting instructions */
+    /*
+     * Skip non-interesting instructions, and the loads that are implicit null checks, which must
+     * stay just before their safepoint.
+     */
     if ((this_lir->flags.is_nop == true) ||
+        (this_lir->def_mask == ENCODE_ALL) ||
         ((target_flags & (REG_DEF0 | REG_DEF1)) == (REG_DEF0 | REG_DEF1)) ||
         !(target_flags & IS_LOAD)) {
       continue;
@@ -277,6 +277,7 @@ enum MipsNativeRegisterPool {
 #define rMIPS_RET0 r_RESULT0
 #define rMIPS_RET1 r_RESULT1
 #define rMIPS_INVOKE_TGT r_T9
+#define rMIPS_HIDDEN_ARG r_T0
 #define rMIPS_COUNT INVALID_REG
 
 enum MipsShiftEncodings {
@@ -203,9 +203,10 @@ void Mir2Lir::CompileDalvikInstruction(MIR* mir, BasicBlock* bb, LIR* label_list
       int len_offset;
       len_offset = mirror::Array::LengthOffset().Int32Value();
       rl_src[0] = LoadValue(rl_src[0], kCoreReg);
-      GenNullCheck(rl_src[0].s_reg_low, rl_src[0].low_reg, opt_flags);
       rl_result = EvalLoc(rl_dest, kCoreReg, true);
+      GenNullCheckOfAccess(rl_src[0].s_reg_low, rl_src[0].low_reg, opt_flags, len_offset);
       LoadWordDisp(rl_src[0].low_reg, len_offset, rl_result.low_reg);
+      MarkImplicitNullCheck(opt_flags, len_offset);
       StoreValue(rl_dest, rl_result);
       break;
 
@@ -680,6 +681,12 @@ void Mir2Lir::HandleExtendedMethodMIR(BasicBlock* bb, MIR* mir) {
     case kMirOpSelect:
       GenSelect(bb, mir);
       break;
+    case kMirOpNullCheck: {
+      RegLocation rl_src = mir_graph_->GetSrc(mir, 0);
+      rl_src = LoadValue(rl_src, kCoreReg);
+      GenNullCheck(rl_src.s_reg_low, rl_src.low_reg, mir->optimization_flags);
+      break;
+    }
     default:
       break;
   }
@@ -206,6 +206,8 @@ enum X86NativeRegisterPool {
 #define rX86_RET0 rAX
 #define rX86_RET1 rDX
 #define rX86_INVOKE_TGT rAX
+#define rX86_HIDDEN_ARG rAX
+#define rX86_HIDDEN_FP_ARG fr0
 #define rX86_LR INVALID_REG
 #define rX86_SUSPEND INVALID_REG
 #define rX86_SELF INVALID_REG
@@ -705,6 +705,9 @@ void MIRGraph::SSATransformation() {
     InsertPhiNodeOperands(bb);
   }
 
+  /* Find the loops and the loop nesting depth of the blocks */
+  FindLoops();
+
   if (cu_->enable_debug & (1 << kDebugDumpCFG)) {
     DumpCFG("/sdcard/3_post_ssa_cfg/", false);
   }
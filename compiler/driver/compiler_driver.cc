@@ -77,7 +77,7 @@ class AOTCompilationStats {
         resolved_instance_fields_(0), unresolved_instance_fields_(0),
         resolved_local_static_fields_(0), resolved_static_fields_(0), unresolved_static_fields_(0),
         type_based_devirtualization_(0),
-        safe_casts_(0), not_safe_casts_(0) {
+        safe_casts_(0), not_safe_casts_(0), inlined_calls_(0) {
     for (size_t i = 0; i <= kMaxInvokeType; i++) {
       resolved_methods_[i] = 0;
       unresolved_methods_[i] = 0;
@@ -97,6 +97,7 @@ class AOTCompilationStats {
     DumpStat(resolved_local_static_fields_, resolved_static_fields_ + unresolved_static_fields_,
              "static fields local to a class");
     DumpStat(safe_casts_, not_safe_casts_, "check-casts removed based on type information");
+    VLOG(compiler) << inlined_calls_ << " calls of trivial methods inlined";
     // Note, the code below subtracts the stat value so that when added to the stat value we have
     // 100% of samples. TODO: clean this up.
     DumpStat(type_based_devirtualization_,
@@ -250,6 +251,17 @@ class AOTCompilationStats {
     not_safe_casts_++;
   }
 
+  // A call was replaced by the body of the trivial method it calls. Not lossy, tests check it.
+  void InlinedCall() {
+    MutexLock mu(Thread::Current(), stats_lock_);
+    inlined_calls_++;
+  }
+
+  size_t GetInlinedCalls() {
+    MutexLock mu(Thread::Current(), stats_lock_);
+    return inlined_calls_;
+  }
+
  private:
   Mutex stats_lock_;
 
@@ -280,6 +292,8 @@ class AOTCompilationStats {
   size_t safe_casts_;
   size_t not_safe_casts_;
 
+  size_t inlined_calls_;
+
   DISALLOW_COPY_AND_ASSIGN(AOTCompilationStats);
 };
 
@@ -1271,6 +1285,9 @@ bool CompilerDriver::ComputeInvokeInfo(const DexCompilationUnit* mUnit, const ui
           }
           if (invoke_type == kVirtual || invoke_type == kSuper) {
             vtable_idx = resolved_method->GetMethodIndex();
+          } else if (invoke_type == kInterface) {
+            // The interface method table slot is chosen by the interface method's dex index.
+            vtable_idx = resolved_method->GetDexMethodIndex();
           }
           GetCodeAndMethodForDirectCall(invoke_type, invoke_type, referrer_class, resolved_method,
                                         direct_code, direct_method, update_stats);
@@ -1289,6 +1306,79 @@ bool CompilerDriver::ComputeInvokeInfo(const DexCompilationUnit* mUnit, const ui
   return false;  // Incomplete knowledge needs slow path.
 }
 
+bool CompilerDriver::ComputeInlineTarget(const DexCompilationUnit* mUnit, const uint32_t dex_pc,
+                                         InvokeType invoke_type, uint32_t method_idx,
+                                         const DexFile::CodeItem*& code_item,
+                                         uint32_t& access_flags) {
+  ScopedObjectAccess soa(Thread::Current());
+  code_item = NULL;
+  access_flags = 0;
+  mirror::ArtMethod* resolved_method =
+      ComputeMethodReferencedFromCompilingMethod(soa, mUnit, method_idx, invoke_type);
+  if (resolved_method != NULL) {
+    mirror::Class* referrer_class =
+        ComputeCompilingMethodsClass(soa, resolved_method->GetDeclaringClass()->GetDexCache(),
+                                     mUnit);
+    bool icce = resolved_method->CheckIncompatibleClassChange(invoke_type);
+    mirror::Class* methods_class = resolved_method->GetDeclaringClass();
+    mirror::ArtMethod* target = NULL;
+    if (referrer_class != NULL && !icce && referrer_class->CanAccess(methods_class) &&
+        referrer_class->CanAccessMember(methods_class, resolved_method->GetAccessFlags())) {
+      switch (invoke_type) {
+        case kDirect:
+          target = resolved_method;
+          break;
+        case kStatic:
+          // The class of the referrer being initialized implies that of its super classes is.
+          if (referrer_class->IsSubClass(methods_class)) {
+            target = resolved_method;
+          }
+          break;
+        case kVirtual:
+          if (resolved_method->IsFinal() || methods_class->IsFinal()) {
+            target = resolved_method;
+          } else {
+            // Did the verifier find the receiver type precisely enough to know the target?
+            const MethodReference caller_method(mUnit->GetDexFile(), mUnit->GetDexMethodIndex());
+            const MethodReference* devirt_map_target =
+                verifier::MethodVerifier::GetDevirtMap(caller_method, dex_pc);
+            if (devirt_map_target != NULL && devirt_map_target->dex_file == mUnit->GetDexFile()) {
+              mirror::ClassLoader* class_loader =
+                  soa.Decode<mirror::ClassLoader*>(mUnit->GetClassLoader());
+              target = mUnit->GetClassLinker()->ResolveMethod(*devirt_map_target->dex_file,
+                                                              devirt_map_target->dex_method_index,
+                                                              referrer_class->GetDexCache(),
+                                                              class_loader, NULL, kVirtual);
+            }
+          }
+          break;
+        default:
+          // Interface and super calls are never inlined.
+          break;
+      }
+    }
+    if (target != NULL && !target->IsNative() && !target->IsAbstract() &&
+        !target->IsSynchronized() && target->GetDeclaringClass()->IsVerified() &&
+        target->GetDeclaringClass()->GetDexCache()->GetDexFile() == mUnit->GetDexFile()) {
+      code_item = mUnit->GetDexFile()->GetCodeItem(target->GetCodeItemOffset());
+      access_flags = target->GetAccessFlags();
+    }
+  }
+  // Clean up any exception left by method/invoke_type resolution
+  if (soa.Self()->IsExceptionPending()) {
+    soa.Self()->ClearException();
+  }
+  return code_item != NULL;
+}
+
+void CompilerDriver::RecordInlinedCall() {
+  stats_->InlinedCall();
+}
+
+size_t CompilerDriver::GetInlinedCallCount() const {
+  return stats_->GetInlinedCalls();
+}
+
 bool CompilerDriver::IsSafeCast(const MethodReference& mr, uint32_t dex_pc) {
   bool result = verifier::MethodVerifier::IsSafeCast(mr, dex_pc);
   if (result) {
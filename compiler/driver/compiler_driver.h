@@ -188,6 +188,18 @@ class CompilerDriver {
                          uintptr_t& direct_code, uintptr_t& direct_method, bool update_stats)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
+  // Can the method called by an invoke be inlined? Finds the code item and access flags of the
+  // method the invoke always calls, when it is defined in the dex file of the compiling method
+  // and its class is verified.
+  bool ComputeInlineTarget(const DexCompilationUnit* mUnit, const uint32_t dex_pc,
+                           InvokeType invoke_type, uint32_t method_idx,
+                           const DexFile::CodeItem*& code_item, uint32_t& access_flags)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
+  // Counts the calls replaced by the body of their callee, see MIRGraph::InlineCalls.
+  void RecordInlinedCall();
+  size_t GetInlinedCallCount() const;
+
   bool IsSafeCast(const MethodReference& mr, uint32_t dex_pc);
 
   // Record patch information for later fix up.
@@ -165,6 +165,35 @@ TEST_F(CompilerDriverTest, AbstractMethodErrorStub) {
   Thread::Current()->ClearException();
 }
 
+TEST_F(CompilerDriverTest, InlineTrivialMethods) {
+  TEST_DISABLED_FOR_PORTABLE();
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    CompileDirectMethod(NULL, "java.lang.Object", "<init>", "()V");
+    class_loader = LoadDex("Inline");
+  }
+  ASSERT_TRUE(class_loader != NULL);
+  size_t inlined_calls = compiler_driver_->GetInlinedCallCount();
+  EnsureCompiled(class_loader, "Inline", "sum", "(LInline;)J", false);
+  // The eleven calls in sum and the one in nullReceiver, the constructor's call of Object.<init>
+  // is in another dex file.
+  EXPECT_EQ(inlined_calls + 12, compiler_driver_->GetInlinedCallCount());
+
+  jmethodID constructor = env_->GetMethodID(class_, "<init>", "(IJLjava/lang/Object;)V");
+  jobject receiver = env_->NewObject(class_, constructor, 1, static_cast<jlong>(2), NULL);
+  ASSERT_TRUE(receiver != NULL);
+  // The getters, setters, identities and constant are inlined into sum.
+  EXPECT_EQ(2 + 4 + 42, env_->CallStaticLongMethod(class_, mid_, receiver));
+  EXPECT_EQ(env_->ExceptionCheck(), JNI_FALSE);
+
+  // The call of an inlined method on null still throws, within the caller's try block.
+  jmethodID null_receiver = env_->GetStaticMethodID(class_, "nullReceiver", "(LInline;)Z");
+  ASSERT_TRUE(null_receiver != NULL);
+  EXPECT_EQ(JNI_TRUE, env_->CallStaticBooleanMethod(class_, null_receiver, NULL));
+  EXPECT_EQ(env_->ExceptionCheck(), JNI_FALSE);
+}
+
 // TODO: need check-cast test (when stub complete & we can throw/catch
 
 }  // namespace art
@@ -116,8 +116,8 @@ bool ImageWriter::Write(const std::string& image_filename,
   heap->CollectGarbage(false);  // Remove garbage.
   // Trim size of alloc spaces.
   for (const auto& space : heap->GetContinuousSpaces()) {
-    if (space->IsDlMallocSpace()) {
-      space->AsDlMallocSpace()->Trim();
+    if (space->IsMallocSpace()) {
+      space->AsMallocSpace()->Trim();
     }
   }
 
@@ -185,7 +185,7 @@ void ImageWriter::RecordImageAllocations() {
 bool ImageWriter::AllocMemory() {
   size_t size = 0;
   for (const auto& space : Runtime::Current()->GetHeap()->GetContinuousSpaces()) {
-    if (space->IsDlMallocSpace()) {
+    if (space->IsMallocSpace()) {
       size += space->Size();
     }
   }
@@ -339,6 +339,19 @@ void ImageWriter::DumpImageClasses() {
   }
 }
 
+void ImageWriter::InternStringsCallback(Object* obj, void* /*arg*/) {
+  if (obj->GetClass()->IsStringClass()) {
+    obj->AsString()->Intern();
+  }
+}
+
+void ImageWriter::InternStrings() {
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  heap->FlushAllocStack();
+  heap->GetLiveBitmap()->Walk(InternStringsCallback, this);
+}
+
 void ImageWriter::CalculateNewObjectOffsetsCallback(Object* obj, void* arg) {
   DCHECK(obj != NULL);
   DCHECK(arg != NULL);
@@ -387,6 +400,7 @@ ObjectArray<Object>* ImageWriter::CreateImageRoots() const {
                   ObjectArray<Object>::Alloc(self, object_array_class,
                                              ImageHeader::kImageRootsMax));
   image_roots->Set(ImageHeader::kResolutionMethod, runtime->GetResolutionMethod());
+  image_roots->Set(ImageHeader::kImtConflictMethod, runtime->GetImtConflictMethod());
   image_roots->Set(ImageHeader::kCalleeSaveMethod,
                    runtime->GetCalleeSaveMethod(Runtime::kSaveAll));
   image_roots->Set(ImageHeader::kRefsOnlySaveMethod,
@@ -399,6 +413,8 @@ ObjectArray<Object>* ImageWriter::CreateImageRoots() const {
                    dex_caches);
   image_roots->Set(ImageHeader::kClassRoots,
                    class_linker->GetClassRoots());
+  image_roots->Set(ImageHeader::kInternedStrings,
+                   runtime->GetInternTable()->CreateImageTable(self));
   for (int i = 0; i < ImageHeader::kImageRootsMax; i++) {
     CHECK(image_roots->Get(i) != NULL);
   }
@@ -408,6 +424,7 @@ ObjectArray<Object>* ImageWriter::CreateImageRoots() const {
 void ImageWriter::CalculateNewObjectOffsets(size_t oat_loaded_size, size_t oat_data_offset) {
   CHECK_NE(0U, oat_loaded_size);
   Thread* self = Thread::Current();
+  InternStrings();
   SirtRef<ObjectArray<Object> > image_roots(self, CreateImageRoots());
 
   gc::Heap* heap = Runtime::Current()->GetHeap();
@@ -524,6 +541,9 @@ void ImageWriter::FixupMethod(const ArtMethod* orig, ArtMethod* copy) {
 #else
     copy->SetEntryPointFromCompiledCode(GetOatAddress(quick_resolution_trampoline_offset_));
 #endif
+  } else if (UNLIKELY(orig == Runtime::Current()->GetImtConflictMethod())) {
+    // The conflict stub lives in libart, ImageSpace::Init points the method at it.
+    copy->SetEntryPointFromCompiledCode(NULL);
   } else {
     // We assume all methods have code. If they don't currently then we set them to the use the
     // resolution trampoline. Abstract methods never have code and so we need to make sure their
@@ -86,12 +86,14 @@ static void usage() {
 
 const char* image_roots_descriptions_[] = {
   "kResolutionMethod",
+  "kImtConflictMethod",
   "kCalleeSaveMethod",
   "kRefsOnlySaveMethod",
   "kRefsAndArgsSaveMethod",
   "kOatLocation",
   "kDexCaches",
   "kClassRoots",
+  "kInternedStrings",
 };
 
 class OatDumper {
@@ -116,6 +118,9 @@ class OatDumper {
     os << "INSTRUCTION SET:\n";
     os << oat_header.GetInstructionSet() << "\n\n";
 
+    os << "IMPLICIT NULL CHECKS:\n";
+    os << oat_header.HasImplicitNullChecks() << "\n\n";
+
     os << "DEX FILE COUNT:\n";
     os << oat_header.GetDexFileCount() << "\n\n";
 
@@ -502,12 +507,10 @@ class OatDumper {
                                size_t offset, bool suspend_point_mapping) {
     MappingTable table(oat_method.GetMappingTable());
     if (suspend_point_mapping && table.PcToDexSize() > 0) {
-      typedef MappingTable::PcToDexIterator It;
-      for (It cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
-        if (offset == cur.NativePcOffset()) {
-          os << StringPrintf("suspend point dex PC: 0x%04x\n", cur.DexPc());
-          return cur.DexPc();
-        }
+      MappingTable::PcToDexIterator found = table.FindPcToDex(offset);
+      if (found != table.PcToDexEnd()) {
+        os << StringPrintf("suspend point dex PC: 0x%04x\n", found.DexPc());
+        return found.DexPc();
       }
     } else if (!suspend_point_mapping && table.DexToPcSize() > 0) {
       typedef MappingTable::DexToPcIterator It;
@@ -994,7 +997,8 @@ class ImageDumper {
           indent_os << StringPrintf("OAT CODE: %p\n", oat_code);
         }
       } else if (method->IsAbstract() || method->IsCalleeSaveMethod() ||
-          method->IsResolutionMethod() || MethodHelper(method).IsClassInitializer()) {
+          method->IsResolutionMethod() || method->IsImtConflictMethod() ||
+          MethodHelper(method).IsClassInitializer()) {
         DCHECK(method->GetNativeGcMap() == NULL) << PrettyMethod(method);
         DCHECK(method->GetMappingTable() == NULL) << PrettyMethod(method);
       } else {
@@ -18,12 +18,15 @@
 
 #include "asm_support_arm.h"
 #include "base/logging.h"
+#include "stack.h"
 
 namespace art {
 
 void Thread::InitCpu() {
   CHECK_EQ(THREAD_FLAGS_OFFSET, OFFSETOF_MEMBER(Thread, state_and_flags_));
   CHECK_EQ(THREAD_EXCEPTION_OFFSET, OFFSETOF_MEMBER(Thread, exception_));
+  CHECK_EQ(SHADOWFRAME_NUMBER_OF_VREGS_OFFSET, ShadowFrame::NumberOfVRegsOffset());
+  CHECK_EQ(SHADOWFRAME_VREGS_OFFSET, ShadowFrame::VRegsOffset());
 }
 
 }  // namespace art
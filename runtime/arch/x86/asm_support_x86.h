@@ -19,6 +19,8 @@
 
 #include "asm_support.h"
 
+// Offset of field Thread::state_and_flags_ verified in InitCpu
+#define THREAD_FLAGS_OFFSET 0
 // Offset of field Thread::self_ verified in InitCpu
 #define THREAD_SELF_OFFSET 40
 // Offset of field Thread::exception_ verified in InitCpu
@@ -21,6 +21,7 @@
 
 #include "asm_support_x86.h"
 #include "base/macros.h"
+#include "stack.h"
 #include "thread.h"
 #include "thread_list.h"
 
@@ -133,7 +134,10 @@ void Thread::InitCpu() {
   CHECK_EQ(self_check, this);
 
   // Sanity check other offsets.
+  CHECK_EQ(THREAD_FLAGS_OFFSET, OFFSETOF_MEMBER(Thread, state_and_flags_));
   CHECK_EQ(THREAD_EXCEPTION_OFFSET, OFFSETOF_MEMBER(Thread, exception_));
+  CHECK_EQ(SHADOWFRAME_NUMBER_OF_VREGS_OFFSET, ShadowFrame::NumberOfVRegsOffset());
+  CHECK_EQ(SHADOWFRAME_VREGS_OFFSET, ShadowFrame::VRegsOffset());
 }
 
 }  // namespace art
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CATCH_BLOCK_CACHE_H_
+#define ART_RUNTIME_CATCH_BLOCK_CACHE_H_
+
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "globals.h"
+
+namespace art {
+namespace mirror {
+  class ArtMethod;
+  class Class;
+}  // namespace mirror
+
+// A small direct mapped cache of the results of ArtMethod::FindCatchBlock, so that throwing the
+// same exception through the same frames doesn't decode the try items and check the catch types
+// again. Each thread has its own, so it needs no synchronization.
+//
+// Entries stay valid for the life of the thread, see Heap::IsMovableObjectClass. Results that
+// depended on an unresolved catch type aren't cached as the type may be resolved later.
+class CatchBlockCache {
+ public:
+  static const size_t kSize = 32;
+
+  CatchBlockCache() {
+    Clear();
+  }
+
+  // Returns true and the handler dex pc and whether it lacks a move-exception if the method's
+  // handler for the exception class at the dex pc is cached.
+  bool Lookup(const mirror::ArtMethod* method, uint32_t dex_pc,
+              const mirror::Class* exception_type, uint32_t* handler_dex_pc,
+              bool* has_no_move_exception) const {
+    const Entry& entry = entries_[Index(method, dex_pc, exception_type)];
+    if (entry.method != method || entry.dex_pc != dex_pc ||
+        entry.exception_type != exception_type) {
+      return false;
+    }
+    *handler_dex_pc = entry.handler_dex_pc;
+    *has_no_move_exception = entry.has_no_move_exception;
+    return true;
+  }
+
+  void Insert(const mirror::ArtMethod* method, uint32_t dex_pc,
+              const mirror::Class* exception_type, uint32_t handler_dex_pc,
+              bool has_no_move_exception) {
+    Entry& entry = entries_[Index(method, dex_pc, exception_type)];
+    entry.method = method;
+    entry.dex_pc = dex_pc;
+    entry.exception_type = exception_type;
+    entry.handler_dex_pc = handler_dex_pc;
+    entry.has_no_move_exception = has_no_move_exception;
+  }
+
+  void Clear() {
+    for (size_t i = 0; i < kSize; ++i) {
+      entries_[i].method = NULL;
+      entries_[i].exception_type = NULL;
+    }
+  }
+
+ private:
+  struct Entry {
+    const mirror::ArtMethod* method;
+    uint32_t dex_pc;
+    const mirror::Class* exception_type;
+    uint32_t handler_dex_pc;
+    bool has_no_move_exception;
+  };
+
+  static size_t Index(const mirror::ArtMethod* method, uint32_t dex_pc,
+                      const mirror::Class* exception_type) {
+    size_t hash = (reinterpret_cast<uintptr_t>(method) ^
+                   reinterpret_cast<uintptr_t>(exception_type)) / kObjectAlignment;
+    return (hash * 31 + dex_pc) % kSize;
+  }
+
+  Entry entries_[kSize];
+
+  DISALLOW_COPY_AND_ASSIGN(CatchBlockCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CATCH_BLOCK_CACHE_H_
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "catch_block_cache.h"
+
+#include "common_test.h"
+#include "dex_file.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+
+namespace art {
+
+class CatchBlockCacheTest : public CommonTest {};
+
+TEST_F(CatchBlockCacheTest, LookupAndInsert) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object = class_linker_->FindSystemClass("Ljava/lang/Object;");
+  mirror::Class* throwable = class_linker_->FindSystemClass("Ljava/lang/Throwable;");
+  mirror::Class* error = class_linker_->FindSystemClass("Ljava/lang/Error;");
+  mirror::ArtMethod* method = object->FindVirtualMethod("hashCode", "()I");
+  ASSERT_TRUE(method != NULL);
+
+  CatchBlockCache cache;
+  uint32_t handler_dex_pc = 0;
+  bool has_no_move_exception = false;
+  EXPECT_FALSE(cache.Lookup(method, 4, throwable, &handler_dex_pc, &has_no_move_exception));
+
+  cache.Insert(method, 4, throwable, 12, true);
+  EXPECT_TRUE(cache.Lookup(method, 4, throwable, &handler_dex_pc, &has_no_move_exception));
+  EXPECT_EQ(12U, handler_dex_pc);
+  EXPECT_TRUE(has_no_move_exception);
+  EXPECT_FALSE(cache.Lookup(method, 5, throwable, &handler_dex_pc, &has_no_move_exception));
+  EXPECT_FALSE(cache.Lookup(method, 4, error, &handler_dex_pc, &has_no_move_exception));
+
+  // Not finding a handler is cached too.
+  cache.Insert(method, 4, error, DexFile::kDexNoIndex, false);
+  EXPECT_TRUE(cache.Lookup(method, 4, error, &handler_dex_pc, &has_no_move_exception));
+  EXPECT_EQ(DexFile::kDexNoIndex, handler_dex_pc);
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Lookup(method, 4, throwable, &handler_dex_pc, &has_no_move_exception));
+  EXPECT_FALSE(cache.Lookup(method, 4, error, &handler_dex_pc, &has_no_move_exception));
+}
+
+}  // namespace art
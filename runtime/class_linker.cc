@@ -191,6 +191,7 @@ ClassLinker::ClassLinker(InternTable* intern_table)
       failed_dex_cache_class_lookups_(0),
       class_roots_(NULL),
       array_iftable_(NULL),
+      default_imt_(NULL),
       init_done_(false),
       dex_caches_dirty_(false),
       class_table_dirty_(false),
@@ -304,6 +305,11 @@ void ClassLinker::InitFromCompiler(const std::vector<const DexFile*>& boot_class
 
   mirror::ArtMethod::SetClass(java_lang_reflect_ArtMethod.get());
 
+  // Linking any class implementing an interface fills its imtable, which needs the imt conflict
+  // method. When starting from an image it comes from the image roots instead.
+  Runtime* runtime = Runtime::Current();
+  runtime->SetImtConflictMethod(runtime->CreateImtConflictMethod());
+
   // Set up array classes for string, field, method
   SirtRef<mirror::Class> object_array_string(self, AllocClass(self, java_lang_Class.get(),
                                                               sizeof(mirror::Class)));
@@ -320,6 +326,15 @@ void ClassLinker::InitFromCompiler(const std::vector<const DexFile*>& boot_class
   object_array_art_field->SetComponentType(java_lang_reflect_ArtField.get());
   SetClassRoot(kJavaLangReflectArtFieldArrayClass, object_array_art_field.get());
 
+  // Create the interface method table of the classes without interface methods, every slot
+  // dispatches through the iftable.
+  default_imt_ = AllocArtMethodArray(self, mirror::Class::kImtLength);
+  CHECK(default_imt_ != NULL);
+  for (size_t i = 0; i < mirror::Class::kImtSize; ++i) {
+    default_imt_->Set(i, runtime->GetImtConflictMethod());
+  }
+  default_imt_->Set(mirror::Class::kImtConflictMethodIndex, runtime->GetImtConflictMethod());
+
   // Setup boot_class_path_ and register class_path now that we can use AllocObjectArray to create
   // DexCache instances. Needs to be after String, Field, Method arrays since AllocDexCache uses
   // these roots.
@@ -521,6 +536,7 @@ void ClassLinker::FinishInit() {
   }
 
   CHECK(array_iftable_ != NULL);
+  CHECK(default_imt_ != NULL);
 
   // disable the slow paths in FindClass and CreatePrimitiveClass now
   // that Object, Class, and Object[] are setup
@@ -1072,6 +1088,9 @@ void ClassLinker::InitFromImage() {
   // reinit array_iftable_ from any array class instance, they should be ==
   array_iftable_ = GetClassRoot(kObjectArrayClass)->GetIfTable();
   DCHECK(array_iftable_ == GetClassRoot(kBooleanArrayClass)->GetIfTable());
+  // likewise for default_imt_, which java.lang.Object has too
+  default_imt_ = GetClassRoot(kObjectArrayClass)->GetImTable();
+  DCHECK(default_imt_ == GetClassRoot(kJavaLangObject)->GetImTable());
   // String class root was set above
   mirror::ArtField::SetClass(GetClassRoot(kJavaLangReflectArtField));
   mirror::BooleanArray::SetArrayClass(GetClassRoot(kBooleanArrayClass));
@@ -1094,13 +1113,13 @@ void ClassLinker::InitFromImage() {
 // reinit references to when reinitializing a ClassLinker from a
 // mapped image.
 void ClassLinker::VisitRoots(RootVisitor* visitor, void* arg, bool only_dirty, bool clean_dirty) {
-  visitor(class_roots_, arg);
+  class_roots_ = down_cast<mirror::ObjectArray<mirror::Class>*>(visitor(class_roots_, arg));
   Thread* self = Thread::Current();
   {
     ReaderMutexLock mu(self, dex_lock_);
     if (!only_dirty || dex_caches_dirty_) {
-      for (mirror::DexCache* dex_cache : dex_caches_) {
-        visitor(dex_cache, arg);
+      for (mirror::DexCache*& dex_cache : dex_caches_) {
+        dex_cache = down_cast<mirror::DexCache*>(visitor(dex_cache, arg));
       }
       if (clean_dirty) {
         dex_caches_dirty_ = false;
@@ -1111,9 +1130,7 @@ void ClassLinker::VisitRoots(RootVisitor* visitor, void* arg, bool only_dirty, b
   {
     ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
     if (!only_dirty || class_table_dirty_) {
-      for (const std::pair<size_t, mirror::Class*>& it : class_table_) {
-        visitor(it.second, arg);
-      }
+      class_table_.VisitRoots(visitor, arg);
       if (clean_dirty) {
         class_table_dirty_ = false;
       }
@@ -1123,7 +1140,8 @@ void ClassLinker::VisitRoots(RootVisitor* visitor, void* arg, bool only_dirty, b
     // handle image roots by using the MS/CMS rescanning of dirty cards.
   }
 
-  visitor(array_iftable_, arg);
+  array_iftable_ = down_cast<mirror::IfTable*>(visitor(array_iftable_, arg));
+  default_imt_ = down_cast<mirror::ObjectArray<mirror::ArtMethod>*>(visitor(default_imt_, arg));
 }
 
 void ClassLinker::VisitClasses(ClassVisitor* visitor, void* arg) {
@@ -1131,11 +1149,7 @@ void ClassLinker::VisitClasses(ClassVisitor* visitor, void* arg) {
     MoveImageClassesToClassTable();
   }
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  for (const std::pair<size_t, mirror::Class*>& it : class_table_) {
-    if (!visitor(it.second, arg)) {
-      return;
-    }
-  }
+  class_table_.VisitClasses(visitor, arg);
 }
 
 static bool GetClassesVisitor(mirror::Class* c, void* arg) {
@@ -2137,6 +2151,10 @@ mirror::Class* ClassLinker::CreateArrayClass(const char* descriptor,
   // (remember not to free them for arrays).
   CHECK(array_iftable_ != NULL);
   new_class->SetIfTable(array_iftable_);
+  // Arrays implement no interface methods, invoke-interface on them ends in an
+  // IncompatibleClassChangeError.
+  CHECK(default_imt_ != NULL);
+  new_class->SetImTable(default_imt_);
 
   // Inherit access flags from the component type.
   int access_flags = new_class->GetComponentType()->GetAccessFlags();
@@ -2202,8 +2220,7 @@ mirror::Class* ClassLinker::InsertClass(const char* descriptor, mirror::Class* k
     LOG(INFO) << "Loaded class " << descriptor << source;
   }
   WriterMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  mirror::Class* existing =
-      LookupClassFromTableLocked(descriptor, klass->GetClassLoader(), hash);
+  mirror::Class* existing = class_table_.Lookup(descriptor, klass->GetClassLoader(), hash);
   if (existing != NULL) {
     return existing;
   }
@@ -2216,7 +2233,7 @@ mirror::Class* ClassLinker::InsertClass(const char* descriptor, mirror::Class* k
     }
   }
   Runtime::Current()->GetHeap()->VerifyObject(klass);
-  class_table_.insert(std::make_pair(hash, klass));
+  class_table_.Insert(klass, hash);
   class_table_dirty_ = true;
   return NULL;
 }
@@ -2224,34 +2241,21 @@ mirror::Class* ClassLinker::InsertClass(const char* descriptor, mirror::Class* k
 bool ClassLinker::RemoveClass(const char* descriptor, const mirror::ClassLoader* class_loader) {
   size_t hash = Hash(descriptor);
   WriterMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  ClassHelper kh;
-  for (auto it = class_table_.lower_bound(hash), end = class_table_.end(); it != end && it->first == hash;
-       ++it) {
-    mirror::Class* klass = it->second;
-    kh.ChangeClass(klass);
-    if (strcmp(kh.GetDescriptor(), descriptor) == 0 && klass->GetClassLoader() == class_loader) {
-      class_table_.erase(it);
-      return true;
-    }
-  }
-  return false;
+  return class_table_.Remove(descriptor, class_loader, hash);
 }
 
 mirror::Class* ClassLinker::LookupClass(const char* descriptor,
                                         const mirror::ClassLoader* class_loader) {
   size_t hash = Hash(descriptor);
-  {
-    ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-    mirror::Class* result = LookupClassFromTableLocked(descriptor, class_loader, hash);
-    if (result != NULL) {
-      return result;
-    }
+  mirror::Class* result = class_table_.Lookup(descriptor, class_loader, hash);
+  if (result != NULL) {
+    return result;
   }
   if (class_loader != NULL || !dex_cache_image_class_lookup_required_) {
     return NULL;
   } else {
     // Lookup failed but need to search dex_caches_.
-    mirror::Class* result = LookupClassFromImage(descriptor);
+    result = LookupClassFromImage(descriptor);
     if (result != NULL) {
       InsertClass(descriptor, result, hash);
     } else {
@@ -2267,31 +2271,6 @@ mirror::Class* ClassLinker::LookupClass(const char* descriptor,
   }
 }
 
-mirror::Class* ClassLinker::LookupClassFromTableLocked(const char* descriptor,
-                                                       const mirror::ClassLoader* class_loader,
-                                                       size_t hash) {
-  ClassHelper kh(NULL, this);
-  auto end = class_table_.end();
-  for (auto it = class_table_.lower_bound(hash); it != end && it->first == hash; ++it) {
-    mirror::Class* klass = it->second;
-    kh.ChangeClass(klass);
-    if (klass->GetClassLoader() == class_loader && strcmp(descriptor, kh.GetDescriptor()) == 0) {
-      if (kIsDebugBuild) {
-        // Check for duplicates in the table.
-        for (++it; it != end && it->first == hash; ++it) {
-          mirror::Class* klass2 = it->second;
-          kh.ChangeClass(klass2);
-          CHECK(!(strcmp(descriptor, kh.GetDescriptor()) == 0 && klass2->GetClassLoader() == class_loader))
-          << PrettyClass(klass) << " " << klass << " " << klass->GetClassLoader() << " "
-          << PrettyClass(klass2) << " " << klass2 << " " << klass2->GetClassLoader();
-        }
-      }
-      return klass;
-    }
-  }
-  return NULL;
-}
-
 static mirror::ObjectArray<mirror::DexCache>* GetImageDexCaches()
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
   gc::space::ImageSpace* image = Runtime::Current()->GetHeap()->GetImageSpace();
@@ -2320,12 +2299,12 @@ void ClassLinker::MoveImageClassesToClassTable() {
         DCHECK(klass->GetClassLoader() == NULL);
         const char* descriptor = kh.GetDescriptor();
         size_t hash = Hash(descriptor);
-        mirror::Class* existing = LookupClassFromTableLocked(descriptor, NULL, hash);
+        mirror::Class* existing = class_table_.Lookup(descriptor, NULL, hash);
         if (existing != NULL) {
           CHECK(existing == klass) << PrettyClassAndClassLoader(existing) << " != "
               << PrettyClassAndClassLoader(klass);
         } else {
-          class_table_.insert(std::make_pair(hash, klass));
+          class_table_.Insert(klass, hash);
         }
       }
     }
@@ -2383,16 +2362,7 @@ void ClassLinker::LookupClasses(const char* descriptor, std::vector<mirror::Clas
     MoveImageClassesToClassTable();
   }
   size_t hash = Hash(descriptor);
-  ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  ClassHelper kh(NULL, this);
-  for (auto it = class_table_.lower_bound(hash), end = class_table_.end();
-      it != end && it->first == hash; ++it) {
-    mirror::Class* klass = it->second;
-    kh.ChangeClass(klass);
-    if (strcmp(descriptor, kh.GetDescriptor()) == 0) {
-      result.push_back(klass);
-    }
-  }
+  class_table_.LookupAll(descriptor, hash, result);
 }
 
 void ClassLinker::VerifyClass(mirror::Class* klass) {
@@ -3498,6 +3468,7 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
     // Class implements no interfaces.
     DCHECK_EQ(klass->GetIfTableCount(), 0);
     DCHECK(klass->GetIfTable() == NULL);
+    klass->SetImTable(default_imt_);
     return true;
   }
   if (ifcount == super_ifcount) {
@@ -3513,6 +3484,7 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
     if (!has_non_marker_interface) {
       // Class just inherits marker interfaces from parent so recycle parent's iftable.
       klass->SetIfTable(super_iftable);
+      klass->SetImTable(default_imt_);
       return true;
     }
   }
@@ -3585,6 +3557,7 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
 
   // If we're an interface, we don't need the vtable pointers, so we're done.
   if (klass->IsInterface()) {
+    klass->SetImTable(default_imt_);
     return true;
   }
   std::vector<mirror::ArtMethod*> miranda_list;
@@ -3646,10 +3619,7 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
               CHECK(self->IsExceptionPending());  // OOME.
               return false;
             }
-#ifdef MOVING_GARBAGE_COLLECTOR
-            // TODO: If a methods move then the miranda_list may hold stale references.
-            UNIMPLEMENTED(FATAL);
-#endif
+            // Methods are never moved, the miranda_list can't hold stale references.
             miranda_list.push_back(miranda_method.get());
           }
           method_array->Set(j, miranda_method.get());
@@ -3701,6 +3671,70 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
 
 //  klass->DumpClass(std::cerr, Class::kDumpClassFullDetail);
 
+  return LinkImTable(klass);
+}
+
+bool ClassLinker::LinkImTable(SirtRef<mirror::Class>& klass) {
+  Thread* self = Thread::Current();
+  SirtRef<mirror::ObjectArray<mirror::ArtMethod> >
+      imtable(self, AllocArtMethodArray(self, mirror::Class::kImtLength));
+  if (UNLIKELY(imtable.get() == NULL)) {
+    CHECK(self->IsExceptionPending());  // OOME.
+    return false;
+  }
+  mirror::ArtMethod* imt_conflict_method = Runtime::Current()->GetImtConflictMethod();
+  mirror::IfTable* iftable = klass->GetIfTable();
+  bool has_interface_methods = false;
+  for (int32_t i = 0; i < klass->GetIfTableCount(); ++i) {
+    mirror::Class* interface = iftable->GetInterface(i);
+    size_t num_methods = interface->NumVirtualMethods();
+    if (num_methods == 0) {
+      continue;
+    }
+    has_interface_methods = true;
+    mirror::ObjectArray<mirror::ArtMethod>* method_array = iftable->GetMethodArray(i);
+    for (size_t j = 0; j < num_methods; ++j) {
+      mirror::ArtMethod* interface_method = interface->GetVirtualMethod(j);
+      uint32_t imt_index = interface_method->GetDexMethodIndex() % mirror::Class::kImtSize;
+      mirror::ArtMethod* current = imtable->Get(imt_index);
+      if (current == NULL) {
+        imtable->Set(imt_index, method_array->Get(j));
+        imtable->Set(mirror::Class::ImtInterfaceMethodIndex(imt_index), interface_method);
+      } else if (current != imt_conflict_method) {
+        // A slot only records one interface method, even if another has the same implementation.
+        imtable->Set(imt_index, imt_conflict_method);
+        imtable->Set(mirror::Class::ImtInterfaceMethodIndex(imt_index), NULL);
+      }
+    }
+  }
+  if (!has_interface_methods) {
+    // Only marker interfaces.
+    klass->SetImTable(default_imt_);
+    return true;
+  }
+  // Empty slots are only reached by calls which end in an IncompatibleClassChangeError, the
+  // iftable lookup behind the conflict method throws it.
+  for (size_t i = 0; i < mirror::Class::kImtSize; ++i) {
+    if (imtable->Get(i) == NULL) {
+      imtable->Set(i, imt_conflict_method);
+    }
+  }
+  imtable->Set(mirror::Class::kImtConflictMethodIndex, imt_conflict_method);
+  // Share the super class' table when it is the same, which is common for classes which only
+  // inherit their interfaces.
+  mirror::ObjectArray<mirror::ArtMethod>* super_imtable =
+      klass->HasSuperClass() ? klass->GetSuperClass()->GetImTable() : NULL;
+  if (super_imtable != NULL) {
+    bool same = true;
+    for (size_t i = 0; i < mirror::Class::kImtLength && same; ++i) {
+      same = super_imtable->Get(i) == imtable->Get(i);
+    }
+    if (same) {
+      klass->SetImTable(super_imtable);
+      return true;
+    }
+  }
+  klass->SetImTable(imtable.get());
   return true;
 }
 
@@ -4230,16 +4264,14 @@ void ClassLinker::DumpAllClasses(int flags) {
   }
   // TODO: at the time this was written, it wasn't safe to call PrettyField with the ClassLinker
   // lock held, because it might need to resolve a field's type, which would try to take the lock.
-  std::vector<mirror::Class*> all_classes;
+  std::set<mirror::Class*> all_classes;
   {
     ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-    for (const std::pair<size_t, mirror::Class*>& it : class_table_) {
-      all_classes.push_back(it.second);
-    }
+    class_table_.VisitClasses(GetClassesVisitor, &all_classes);
   }
 
-  for (size_t i = 0; i < all_classes.size(); ++i) {
-    all_classes[i]->DumpClass(std::cerr, flags);
+  for (mirror::Class* klass : all_classes) {
+    klass->DumpClass(std::cerr, flags);
   }
 }
 
@@ -4248,7 +4280,7 @@ void ClassLinker::DumpForSigQuit(std::ostream& os) {
     MoveImageClassesToClassTable();
   }
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  os << "Loaded classes: " << class_table_.size() << " allocated classes\n";
+  os << "Loaded classes: " << class_table_.Size() << " allocated classes\n";
 }
 
 size_t ClassLinker::NumLoadedClasses() {
@@ -4256,7 +4288,7 @@ size_t ClassLinker::NumLoadedClasses() {
     MoveImageClassesToClassTable();
   }
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  return class_table_.size();
+  return class_table_.Size();
 }
 
 pid_t ClassLinker::GetClassesLockOwner() {
@@ -23,6 +23,7 @@
 
 #include "base/macros.h"
 #include "base/mutex.h"
+#include "class_table.h"
 #include "dex_file.h"
 #include "gtest/gtest.h"
 #include "root_visitor.h"
@@ -30,6 +31,7 @@
 
 namespace art {
 namespace gc {
+class Heap;
 namespace space {
   class ImageSpace;
 }  // namespace space
@@ -47,8 +49,6 @@ class InternTable;
 class ObjectLock;
 template<class T> class SirtRef;
 
-typedef bool (ClassVisitor)(mirror::Class* c, void* arg);
-
 class ClassLinker {
  public:
   // Creates the class linker by bootstrapping from dex files.
@@ -473,6 +473,10 @@ class ClassLinker {
                             mirror::ObjectArray<mirror::Class>* interfaces)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Builds the interface method table of a class from its iftable, see Class::imtable_.
+  bool LinkImTable(SirtRef<mirror::Class>& klass)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   bool LinkStaticFields(SirtRef<mirror::Class>& klass)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   bool LinkInstanceFields(SirtRef<mirror::Class>& klass)
@@ -528,11 +532,9 @@ class ClassLinker {
   std::vector<const OatFile*> oat_files_ GUARDED_BY(dex_lock_);
 
 
-  // multimap from a string hash code of a class descriptor to
-  // mirror::Class* instances. Results should be compared for a matching
-  // Class::descriptor_ and Class::class_loader_.
-  typedef std::multimap<size_t, mirror::Class*> Table;
-  Table class_table_ GUARDED_BY(Locks::classlinker_classes_lock_);
+  // The loaded classes by descriptor hash. Lookups are lock free, modifications need the
+  // classlinker_classes_lock_.
+  ClassTable class_table_;
 
   // Do we need to search dex caches to find image classes?
   bool dex_cache_image_class_lookup_required_;
@@ -540,11 +542,6 @@ class ClassLinker {
   // the classes into the class_table_ to avoid dex cache based searches.
   AtomicInteger failed_dex_cache_class_lookups_;
 
-  mirror::Class* LookupClassFromTableLocked(const char* descriptor,
-                                            const mirror::ClassLoader* class_loader,
-                                            size_t hash)
-      SHARED_LOCKS_REQUIRED(Locks::classlinker_classes_lock_, Locks::mutator_lock_);
-
   void MoveImageClassesToClassTable() LOCKS_EXCLUDED(Locks::classlinker_classes_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   mirror::Class* LookupClassFromImage(const char* descriptor)
@@ -612,6 +609,10 @@ class ClassLinker {
 
   mirror::IfTable* array_iftable_;
 
+  // The interface method table of all classes which don't implement interface methods, every
+  // slot holds the imt conflict method and records no interface method.
+  mirror::ObjectArray<mirror::ArtMethod>* default_imt_;
+
   bool init_done_;
   bool dex_caches_dirty_ GUARDED_BY(dex_lock_);
   bool class_table_dirty_ GUARDED_BY(Locks::classlinker_classes_lock_);
@@ -622,6 +623,7 @@ class ClassLinker {
   const void* quick_resolution_trampoline_;
 
   friend class ImageWriter;  // for GetClassRoots
+  friend class gc::Heap;  // for GetClassRoot, to keep dex caches and class loaders in place
   FRIEND_TEST(ClassLinkerTest, ClassRootDescriptors);
   FRIEND_TEST(mirror::DexCacheTest, Open);
   FRIEND_TEST(ExceptionTest, FindExceptionHandler);
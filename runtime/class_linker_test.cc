@@ -19,6 +19,7 @@
 #include <string>
 
 #include "UniquePtr.h"
+#include "atomic_integer.h"
 #include "class_linker-inl.h"
 #include "common_test.h"
 #include "dex_file.h"
@@ -34,6 +35,7 @@
 #include "mirror/proxy.h"
 #include "mirror/stack_trace_element.h"
 #include "sirt_ref.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -140,6 +142,8 @@ class ClassLinkerTest : public CommonTest {
     EXPECT_EQ(2, array->GetIfTableCount());
     mirror::IfTable* iftable = array->GetIfTable();
     ASSERT_TRUE(iftable != NULL);
+    // Compiled code dispatches invoke-interface through the table without a null check.
+    EXPECT_TRUE(array->GetImTable() != NULL);
     kh.ChangeClass(kh.GetDirectInterface(0));
     EXPECT_STREQ(kh.GetDescriptor(), "Ljava/lang/Cloneable;");
     kh.ChangeClass(array);
@@ -223,6 +227,23 @@ class ClassLinkerTest : public CommonTest {
         EXPECT_EQ(interface->NumVirtualMethods(), iftable->GetMethodArrayCount(i));
       }
     }
+    mirror::ObjectArray<mirror::ArtMethod>* imtable = klass->GetImTable();
+    ASSERT_TRUE(imtable != NULL);
+    ASSERT_EQ(mirror::Class::kImtLength, static_cast<size_t>(imtable->GetLength()));
+    mirror::ArtMethod* imt_conflict_method = Runtime::Current()->GetImtConflictMethod();
+    EXPECT_EQ(imt_conflict_method, imtable->Get(mirror::Class::kImtConflictMethodIndex));
+    for (size_t i = 0; i < mirror::Class::kImtSize; ++i) {
+      mirror::ArtMethod* implementation = imtable->Get(i);
+      mirror::ArtMethod* interface_method =
+          imtable->Get(mirror::Class::ImtInterfaceMethodIndex(i));
+      ASSERT_TRUE(implementation != NULL);
+      if (interface_method == NULL) {
+        EXPECT_EQ(imt_conflict_method, implementation);
+      } else {
+        EXPECT_EQ(i, interface_method->GetDexMethodIndex() % mirror::Class::kImtSize);
+        EXPECT_EQ(implementation, klass->FindVirtualMethodForInterface(interface_method));
+      }
+    }
     if (klass->IsAbstract()) {
       EXPECT_FALSE(klass->IsFinal());
     } else {
@@ -340,8 +361,9 @@ class ClassLinkerTest : public CommonTest {
     }
   }
 
-  static void TestRootVisitor(const mirror::Object* root, void*) {
+  static mirror::Object* TestRootVisitor(mirror::Object* root, void*) {
     EXPECT_TRUE(root != NULL);
+    return root;
   }
 };
 
@@ -496,6 +518,7 @@ struct ClassOffsets : public CheckOffsets<mirror::Class> {
     offsets.push_back(CheckOffset(OFFSETOF_MEMBER(mirror::Class, direct_methods_),                "directMethods"));
     offsets.push_back(CheckOffset(OFFSETOF_MEMBER(mirror::Class, ifields_),                       "iFields"));
     offsets.push_back(CheckOffset(OFFSETOF_MEMBER(mirror::Class, iftable_),                       "ifTable"));
+    offsets.push_back(CheckOffset(OFFSETOF_MEMBER(mirror::Class, imtable_),                       "imTable"));
     offsets.push_back(CheckOffset(OFFSETOF_MEMBER(mirror::Class, name_),                          "name"));
     offsets.push_back(CheckOffset(OFFSETOF_MEMBER(mirror::Class, sfields_),                       "sFields"));
     offsets.push_back(CheckOffset(OFFSETOF_MEMBER(mirror::Class, super_class_),                   "superClass"));
@@ -1056,4 +1079,75 @@ TEST_F(ClassLinkerTest, ClassRootDescriptors) {
   }
 }
 
+static bool CollectDescriptorsVisitor(mirror::Class* klass, void* arg)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  std::vector<std::string>* descriptors = reinterpret_cast<std::vector<std::string>*>(arg);
+  if (klass->GetClassLoader() == NULL) {
+    descriptors->push_back(ClassHelper(klass).GetDescriptor());
+  }
+  return true;
+}
+
+class LookupClassTask : public Task {
+ public:
+  LookupClassTask(ClassLinker* class_linker, const std::vector<std::string>* descriptors,
+                  size_t iterations, AtomicInteger* found)
+      : class_linker_(class_linker), descriptors_(descriptors), iterations_(iterations),
+        found_(found) {}
+
+  void Run(Thread* self) {
+    ScopedObjectAccess soa(self);
+    int32_t found = 0;
+    for (size_t i = 0; i < iterations_; ++i) {
+      for (const std::string& descriptor : *descriptors_) {
+        if (class_linker_->LookupClass(descriptor.c_str(), NULL) != NULL) {
+          ++found;
+        }
+      }
+      // Misses probe until an empty slot.
+      EXPECT_TRUE(class_linker_->LookupClass("LNoSuchClass;", NULL) == NULL);
+    }
+    found_->fetch_add(found);
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+ private:
+  ClassLinker* const class_linker_;
+  const std::vector<std::string>* const descriptors_;
+  const size_t iterations_;
+  AtomicInteger* const found_;
+};
+
+// Lookups don't take the classes lock, check they scale across threads and report the rate.
+TEST_F(ClassLinkerTest, ConcurrentLookupClass) {
+  Thread* self = Thread::Current();
+  std::vector<std::string> descriptors;
+  {
+    ScopedObjectAccess soa(self);
+    class_linker_->VisitClasses(CollectDescriptorsVisitor, &descriptors);
+  }
+  ASSERT_FALSE(descriptors.empty());
+  const int32_t kNumThreads = 4;
+  const size_t kIterations = 50;
+  for (int32_t num_threads = 1; num_threads <= kNumThreads; num_threads *= 2) {
+    ThreadPool thread_pool(num_threads);
+    AtomicInteger found(0);
+    for (int32_t i = 0; i < num_threads; ++i) {
+      thread_pool.AddTask(self, new LookupClassTask(class_linker_, &descriptors, kIterations,
+                                                    &found));
+    }
+    uint64_t start = NanoTime();
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, false, false);
+    uint64_t duration = NanoTime() - start;
+    size_t lookups = num_threads * kIterations * descriptors.size();
+    EXPECT_EQ(lookups, static_cast<size_t>(found));
+    LOG(INFO) << num_threads << " threads: " << lookups << " lookups in "
+        << PrettyDuration(duration) << ", " << (lookups * 1000 / std::max<uint64_t>(duration, 1)) << " lookups/us";
+  }
+}
+
 }  // namespace art
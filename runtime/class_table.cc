@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_table.h"
+
+#include <string.h>
+
+#include "atomic.h"
+#include "base/stl_util.h"
+#include "mirror/class-inl.h"
+#include "object_utils.h"
+#include "utils.h"
+
+namespace art {
+
+mirror::Class* const ClassTable::kRemoved = reinterpret_cast<mirror::Class*>(1);
+
+ClassTable::Array::Array(size_t capacity)
+    : mask(capacity - 1), entries(new Entry[capacity]) {
+  DCHECK(IsPowerOfTwo(capacity));
+  for (size_t i = 0; i < capacity; ++i) {
+    entries[i].hash = 0;
+    entries[i].klass = NULL;
+  }
+}
+
+ClassTable::Array::~Array() {
+  delete[] entries;
+}
+
+ClassTable::ClassTable()
+    : array_(new Array(kMinCapacity)), num_classes_(0), num_used_slots_(0) {
+}
+
+ClassTable::~ClassTable() {
+  delete array_;
+  STLDeleteElements(&retired_arrays_);
+}
+
+mirror::Class* ClassTable::Lookup(const char* descriptor, const mirror::ClassLoader* class_loader,
+                                  size_t hash) const {
+  const Array* array = array_;
+  ClassHelper kh;
+  for (size_t i = hash & array->mask; ; i = (i + 1) & array->mask) {
+    mirror::Class* klass = array->entries[i].klass;
+    if (klass == NULL) {
+      return NULL;
+    }
+    if (klass == kRemoved || array->entries[i].hash != hash) {
+      continue;
+    }
+    kh.ChangeClass(klass);
+    if (klass->GetClassLoader() == class_loader && strcmp(descriptor, kh.GetDescriptor()) == 0) {
+      if (kIsDebugBuild) {
+        // Check for duplicates in the table.
+        for (size_t j = (i + 1) & array->mask; array->entries[j].klass != NULL;
+             j = (j + 1) & array->mask) {
+          mirror::Class* klass2 = array->entries[j].klass;
+          if (klass2 == kRemoved || array->entries[j].hash != hash) {
+            continue;
+          }
+          kh.ChangeClass(klass2);
+          CHECK(!(strcmp(descriptor, kh.GetDescriptor()) == 0 &&
+                  klass2->GetClassLoader() == class_loader))
+              << PrettyClass(klass) << " " << klass << " " << klass->GetClassLoader() << " "
+              << PrettyClass(klass2) << " " << klass2 << " " << klass2->GetClassLoader();
+        }
+      }
+      return klass;
+    }
+  }
+}
+
+void ClassTable::LookupAll(const char* descriptor, size_t hash,
+                           std::vector<mirror::Class*>& result) const {
+  const Array* array = array_;
+  ClassHelper kh;
+  for (size_t i = hash & array->mask; array->entries[i].klass != NULL; i = (i + 1) & array->mask) {
+    mirror::Class* klass = array->entries[i].klass;
+    if (klass == kRemoved || array->entries[i].hash != hash) {
+      continue;
+    }
+    kh.ChangeClass(klass);
+    if (strcmp(descriptor, kh.GetDescriptor()) == 0) {
+      result.push_back(klass);
+    }
+  }
+}
+
+void ClassTable::Insert(mirror::Class* klass, size_t hash) {
+  DCHECK(klass != NULL);
+  EnsureCapacity();
+  Array* array = array_;
+  size_t i = hash & array->mask;
+  while (array->entries[i].klass != NULL) {
+    i = (i + 1) & array->mask;
+  }
+  array->entries[i].hash = hash;
+  // Lookups must see the hash of a published class.
+  ANDROID_MEMBAR_STORE();
+  array->entries[i].klass = klass;
+  ++num_classes_;
+  ++num_used_slots_;
+}
+
+bool ClassTable::Remove(const char* descriptor, const mirror::ClassLoader* class_loader,
+                        size_t hash) {
+  Array* array = array_;
+  ClassHelper kh;
+  for (size_t i = hash & array->mask; array->entries[i].klass != NULL; i = (i + 1) & array->mask) {
+    mirror::Class* klass = array->entries[i].klass;
+    if (klass == kRemoved || array->entries[i].hash != hash) {
+      continue;
+    }
+    kh.ChangeClass(klass);
+    if (klass->GetClassLoader() == class_loader && strcmp(descriptor, kh.GetDescriptor()) == 0) {
+      array->entries[i].klass = kRemoved;
+      --num_classes_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClassTable::VisitRoots(RootVisitor* visitor, void* arg) {
+  Array* array = array_;
+  for (size_t i = 0; i <= array->mask; ++i) {
+    mirror::Class* klass = array->entries[i].klass;
+    if (klass != NULL && klass != kRemoved) {
+      array->entries[i].klass = down_cast<mirror::Class*>(visitor(klass, arg));
+    }
+  }
+}
+
+bool ClassTable::VisitClasses(ClassVisitor* visitor, void* arg) const {
+  const Array* array = array_;
+  for (size_t i = 0; i <= array->mask; ++i) {
+    mirror::Class* klass = array->entries[i].klass;
+    if (klass != NULL && klass != kRemoved && !visitor(klass, arg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ClassTable::EnsureCapacity() {
+  Array* old_array = array_;
+  if ((num_used_slots_ + 1) * 2 <= old_array->mask + 1) {
+    return;
+  }
+  // Leave the new array at most a quarter full, dropping the tombstones.
+  size_t capacity = RoundUpToPowerOfTwo((num_classes_ + 1) * 4);
+  Array* new_array = new Array(capacity > kMinCapacity ? capacity : kMinCapacity);
+  for (size_t i = 0; i <= old_array->mask; ++i) {
+    mirror::Class* klass = old_array->entries[i].klass;
+    if (klass == NULL || klass == kRemoved) {
+      continue;
+    }
+    size_t hash = old_array->entries[i].hash;
+    size_t j = hash & new_array->mask;
+    while (new_array->entries[j].klass != NULL) {
+      j = (j + 1) & new_array->mask;
+    }
+    new_array->entries[j].hash = hash;
+    new_array->entries[j].klass = klass;
+  }
+  // Lookups must see the filled array.
+  ANDROID_MEMBAR_STORE();
+  array_ = new_array;
+  retired_arrays_.push_back(old_array);
+  num_used_slots_ = num_classes_;
+}
+
+}  // namespace art
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CLASS_TABLE_H_
+#define ART_RUNTIME_CLASS_TABLE_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "root_visitor.h"
+
+namespace art {
+namespace mirror {
+  class Class;
+  class ClassLoader;
+}  // namespace mirror
+
+typedef bool (ClassVisitor)(mirror::Class* c, void* arg);
+
+// The loaded classes of the ClassLinker, keyed by the hash of their descriptor. Entries must be
+// compared for a matching descriptor and class loader.
+//
+// An open addressed table of (hash, class) pairs in a single array, kept at most half full.
+// Lookups don't take any lock. Modifications are serialized by the classlinker_classes_lock_:
+// a new entry has its hash written before the class is published and removed entries become
+// tombstones which are only dropped when the table is rebuilt. A rebuilt array is published
+// after it is filled, the outgrown arrays may still be probed by lookups so they are kept until
+// the table is destroyed. As the capacity at least doubles with every rebuild of a growing table
+// they add up to less than the live array.
+class ClassTable {
+ public:
+  ClassTable();
+  ~ClassTable();
+
+  // Returns the class with the given descriptor and class loader or NULL. Lock free, a class
+  // inserted concurrently may or may not be found.
+  mirror::Class* Lookup(const char* descriptor, const mirror::ClassLoader* class_loader,
+                        size_t hash) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Appends the classes with the given descriptor, of any class loader, to result.
+  void LookupAll(const char* descriptor, size_t hash, std::vector<mirror::Class*>& result) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // The caller must have checked that no class of the same descriptor and loader is present.
+  void Insert(mirror::Class* klass, size_t hash)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::classlinker_classes_lock_);
+
+  // Returns true if the class was found and removed.
+  bool Remove(const char* descriptor, const mirror::ClassLoader* class_loader, size_t hash)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::classlinker_classes_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Updates every class with the visitor's result, a linear walk of the array.
+  void VisitRoots(RootVisitor* visitor, void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::classlinker_classes_lock_);
+
+  // Stops early and returns false if the visitor returns false.
+  bool VisitClasses(ClassVisitor* visitor, void* arg) const
+      SHARED_LOCKS_REQUIRED(Locks::classlinker_classes_lock_);
+
+  size_t Size() const {
+    return num_classes_;
+  }
+
+ private:
+  struct Entry {
+    size_t hash;
+    // NULL for a slot which was never used, kRemoved for a tombstone.
+    mirror::Class* volatile klass;
+  };
+
+  struct Array {
+    explicit Array(size_t capacity);
+    ~Array();
+
+    const size_t mask;
+    Entry* const entries;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Array);
+  };
+
+  static const size_t kMinCapacity = 1024;
+
+  static mirror::Class* const kRemoved;
+
+  // Makes room for one more entry, rebuilding the array if it would become more than half full.
+  void EnsureCapacity() EXCLUSIVE_LOCKS_REQUIRED(Locks::classlinker_classes_lock_);
+
+  Array* volatile array_;
+  std::vector<Array*> retired_arrays_ GUARDED_BY(Locks::classlinker_classes_lock_);
+  // Live entries.
+  size_t num_classes_;
+  // Live entries and tombstones.
+  size_t num_used_slots_ GUARDED_BY(Locks::classlinker_classes_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(ClassTable);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CLASS_TABLE_H_
@@ -24,6 +24,7 @@
 #include <sys/file.h>
 #include <sys/stat.h>
 
+#include "atomic.h"
 #include "base/logging.h"
 #include "base/stringprintf.h"
 #include "class_linker.h"
@@ -270,6 +271,7 @@ const DexFile* DexFile::OpenMemory(const byte* base,
 }
 
 DexFile::~DexFile() {
+  delete class_def_index_;
   // We don't call DeleteGlobalRef on dex_object_ because we're only called by DestroyJavaVM, and
   // that's only called after DetachCurrentThread, which means there's no JNIEnv. We could
   // re-attach, but cleaning up these global references is not obviously useful. It's not as if
@@ -336,6 +338,21 @@ const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor) const {
   if (num_class_defs == 0) {
     return NULL;
   }
+  if (num_class_defs >= kMinClassDefsForIndex) {
+    const ClassDefIndex* index = GetClassDefIndex();
+    const std::vector<ClassDefIndex::Entry>& table = index->descriptor_table;
+    uint32_t hash = ComputeModifiedUtf8Hash(descriptor);
+    size_t mask = table.size() - 1;
+    for (size_t i = hash & mask; table[i].class_def_idx != kDexNoIndex; i = (i + 1) & mask) {
+      if (table[i].hash == hash) {
+        const ClassDef& class_def = GetClassDef(table[i].class_def_idx);
+        if (strcmp(GetClassDescriptor(class_def), descriptor) == 0) {
+          return &class_def;
+        }
+      }
+    }
+    return NULL;
+  }
   const StringId* string_id = FindStringId(descriptor);
   if (string_id == NULL) {
     return NULL;
@@ -344,7 +361,19 @@ const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor) const {
   if (type_id == NULL) {
     return NULL;
   }
-  uint16_t type_idx = GetIndexForTypeId(*type_id);
+  return FindClassDef(GetIndexForTypeId(*type_id));
+}
+
+const DexFile::ClassDef* DexFile::FindClassDef(uint16_t type_idx) const {
+  size_t num_class_defs = NumClassDefs();
+  if (num_class_defs >= kMinClassDefsForIndex) {
+    const ClassDefIndex* index = GetClassDefIndex();
+    if (type_idx >= index->type_table.size()) {
+      return NULL;
+    }
+    uint16_t class_def_idx = index->type_table[type_idx];
+    return class_def_idx != kDexNoIndex16 ? &GetClassDef(class_def_idx) : NULL;
+  }
   for (size_t i = 0; i < num_class_defs; ++i) {
     const ClassDef& class_def = GetClassDef(i);
     if (class_def.class_idx_ == type_idx) {
@@ -354,15 +383,41 @@ const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor) const {
   return NULL;
 }
 
-const DexFile::ClassDef* DexFile::FindClassDef(uint16_t type_idx) const {
+const DexFile::ClassDefIndex* DexFile::GetClassDefIndex() const {
+  ClassDefIndex* index = class_def_index_;
+  if (LIKELY(index != NULL)) {
+    return index;
+  }
+  MutexLock mu(Thread::Current(), class_def_index_lock_);
+  index = class_def_index_;
+  if (index != NULL) {
+    return index;
+  }
   size_t num_class_defs = NumClassDefs();
-  for (size_t i = 0; i < num_class_defs; ++i) {
-    const ClassDef& class_def = GetClassDef(i);
-    if (class_def.class_idx_ == type_idx) {
-      return &class_def;
+  index = new ClassDefIndex;
+  ClassDefIndex::Entry empty = { 0, kDexNoIndex };
+  index->descriptor_table.resize(RoundUpToPowerOfTwo(num_class_defs * 2), empty);
+  index->type_table.resize(NumTypeIds(), kDexNoIndex16);
+  size_t mask = index->descriptor_table.size() - 1;
+  for (size_t class_def_idx = 0; class_def_idx < num_class_defs; ++class_def_idx) {
+    const ClassDef& class_def = GetClassDef(class_def_idx);
+    // A verified dex file never defines a class twice, keep the first definition regardless.
+    if (index->type_table[class_def.class_idx_] != kDexNoIndex16) {
+      continue;
     }
+    index->type_table[class_def.class_idx_] = class_def_idx;
+    uint32_t hash = ComputeModifiedUtf8Hash(GetClassDescriptor(class_def));
+    size_t i = hash & mask;
+    while (index->descriptor_table[i].class_def_idx != kDexNoIndex) {
+      i = (i + 1) & mask;
+    }
+    index->descriptor_table[i].hash = hash;
+    index->descriptor_table[i].class_def_idx = class_def_idx;
   }
-  return NULL;
+  // Readers don't take the lock, make the contents visible before the pointer.
+  ANDROID_MEMBAR_STORE();
+  class_def_index_ = index;
+  return index;
 }
 
 const DexFile::FieldId* DexFile::FindFieldId(const DexFile::TypeId& declaring_klass,
@@ -596,7 +596,8 @@ class DexFile {
     return StringByTypeIdx(class_def.class_idx_);
   }
 
-  // Looks up a class definition by its class descriptor.
+  // Looks up a class definition by its class descriptor. Goes through the class def index once
+  // the dex file has more than a handful of class definitions.
   const ClassDef* FindClassDef(const char* descriptor) const;
 
   // Looks up a class definition by its type index.
@@ -850,7 +851,9 @@ class DexFile {
         field_ids_(0),
         method_ids_(0),
         proto_ids_(0),
-        class_defs_(0) {
+        class_defs_(0),
+        class_def_index_(NULL),
+        class_def_index_lock_("DEX class def index lock") {
     CHECK(begin_ != NULL) << GetLocation();
     CHECK_GT(size_, 0U) << GetLocation();
   }
@@ -864,6 +867,24 @@ class DexFile {
   // Returns true if the header magic and version numbers are of the expected values.
   bool CheckMagicAndVersion() const;
 
+  // Maps class descriptors and type indexes of the classes defined in this file to their class
+  // def index. The descriptor table is open addressed, keyed by the descriptor's String hash and
+  // at most half full; the type table is indexed directly by type index.
+  struct ClassDefIndex {
+    struct Entry {
+      uint32_t hash;
+      uint32_t class_def_idx;  // kDexNoIndex for an empty slot.
+    };
+    std::vector<Entry> descriptor_table;
+    std::vector<uint16_t> type_table;  // kDexNoIndex16 for types not defined here.
+  };
+
+  // Dex files with fewer class definitions are searched linearly.
+  static const size_t kMinClassDefsForIndex = 8;
+
+  // Returns the class def index, building it on first use.
+  const ClassDefIndex* GetClassDefIndex() const;
+
   void DecodeDebugInfo0(const CodeItem* code_item, bool is_static, uint32_t method_idx,
       DexDebugNewPositionCb position_cb, DexDebugNewLocalCb local_cb,
       void* context, const byte* stream, LocalInfo* local_in_reg) const;
@@ -910,6 +931,12 @@ class DexFile {
 
   // Points to the base of the class definition list.
   const ClassDef* class_defs_;
+
+  // Built lazily by GetClassDefIndex, immutable once published.
+  mutable ClassDefIndex* volatile class_def_index_;
+
+  // Serializes building the class def index.
+  mutable Mutex class_def_index_lock_;
 };
 
 // Iterate over a dex file's ProtoId's paramters
@@ -137,6 +137,32 @@ TEST_F(DexFileTest, ClassDefs) {
   EXPECT_STREQ("LNested;", raw->GetClassDescriptor(c1));
 }
 
+TEST_F(DexFileTest, FindClassDef) {
+  // Large enough to go through the class def index.
+  ASSERT_GE(java_lang_dex_file_->NumClassDefs(), 8U);
+  for (size_t i = 0; i < java_lang_dex_file_->NumClassDefs(); i++) {
+    const DexFile::ClassDef& class_def = java_lang_dex_file_->GetClassDef(i);
+    const char* descriptor = java_lang_dex_file_->GetClassDescriptor(class_def);
+    EXPECT_EQ(&class_def, java_lang_dex_file_->FindClassDef(descriptor)) << descriptor;
+    EXPECT_EQ(&class_def, java_lang_dex_file_->FindClassDef(class_def.class_idx_)) << descriptor;
+  }
+  EXPECT_TRUE(java_lang_dex_file_->FindClassDef("Ljava/lang/NoSuchClass;") == NULL);
+  EXPECT_TRUE(java_lang_dex_file_->FindClassDef("[Ljava/lang/Object;") == NULL);
+  EXPECT_TRUE(java_lang_dex_file_->FindClassDef("I") == NULL);
+
+  // Small enough to be searched linearly.
+  ScopedObjectAccess soa(Thread::Current());
+  const DexFile* raw(OpenTestDexFile("Nested"));
+  ASSERT_TRUE(raw != NULL);
+  ASSERT_LT(raw->NumClassDefs(), 8U);
+  for (size_t i = 0; i < raw->NumClassDefs(); i++) {
+    const DexFile::ClassDef& class_def = raw->GetClassDef(i);
+    EXPECT_EQ(&class_def, raw->FindClassDef(raw->GetClassDescriptor(class_def)));
+    EXPECT_EQ(&class_def, raw->FindClassDef(class_def.class_idx_));
+  }
+  EXPECT_TRUE(raw->FindClassDef("LNoSuchClass;") == NULL);
+}
+
 TEST_F(DexFileTest, CreateMethodSignature) {
   ScopedObjectAccess soa(Thread::Current());
   const DexFile* raw(OpenTestDexFile("CreateMethodSignature"));
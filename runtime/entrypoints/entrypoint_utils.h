@@ -393,6 +393,14 @@ static inline const void* GetResolutionTrampoline(ClassLinker* class_linker) {
 #endif
 }
 
+// Entry point of the imt conflict method. Compiled code passes the interface method from the
+// caller's dex cache as a hidden argument, the stub continues in
+// art_quick_invoke_interface_trampoline with it.
+extern "C" void art_quick_imt_conflict_trampoline(mirror::ArtMethod*);
+static inline const void* GetQuickImtConflictTrampoline() {
+  return reinterpret_cast<void*>(art_quick_imt_conflict_trampoline);
+}
+
 extern "C" void art_portable_proxy_invoke_handler();
 static inline const void* GetPortableProxyInvokeHandler() {
   return reinterpret_cast<void*>(art_portable_proxy_invoke_handler);
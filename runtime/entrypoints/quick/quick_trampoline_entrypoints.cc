@@ -27,6 +27,7 @@
 #include "mirror/object_array-inl.h"
 #include "object_utils.h"
 #include "runtime.h"
+#include "sirt_ref.h"
 
 
 
@@ -423,12 +424,23 @@ class RememberFoGcArgumentVisitor : public QuickArgumentVisitor {
 
   virtual void Visit() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     if (IsParamAReference()) {
-      soa_->AddLocalReference<jobject>(*reinterpret_cast<mirror::Object**>(GetParamAddress()));
+      mirror::Object** param_address = reinterpret_cast<mirror::Object**>(GetParamAddress());
+      jobject reference = soa_->AddLocalReference<jobject>(*param_address);
+      references_.push_back(std::make_pair(reference, param_address));
+    }
+  }
+
+  // A moving collection may have run since the arguments were visited, write the possibly moved
+  // objects back to the spilled argument registers and stack slots.
+  void FixupReferences() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    for (const auto& pair : references_) {
+      *pair.second = soa_->Decode<mirror::Object*>(pair.first);
     }
   }
 
  private:
   ScopedObjectAccessUnchecked* soa_;
+  std::vector<std::pair<jobject, mirror::Object**> > references_;
 
   DISALLOW_COPY_AND_ASSIGN(RememberFoGcArgumentVisitor);
 };
@@ -523,6 +535,8 @@ extern "C" const void* artQuickResolutionTrampoline(mirror::ArtMethod* called,
   RememberFoGcArgumentVisitor visitor(sp, invoke_type == kStatic, shorty, shorty_len, &soa);
   visitor.VisitArguments();
   thread->EndAssertNoThreadSuspension(old_cause);
+  // Resolution and class initialization may allocate and move the receiver.
+  SirtRef<mirror::Object> receiver_ref(thread, invoke_type == kStatic ? NULL : receiver);
   // Resolve method filling in dex cache.
   if (called->IsRuntimeMethod()) {
     called = linker->ResolveMethod(dex_method_idx, caller, invoke_type);
@@ -533,9 +547,9 @@ extern "C" const void* artQuickResolutionTrampoline(mirror::ArtMethod* called,
     CHECK(!called->CheckIncompatibleClassChange(invoke_type));
     // Refine called method based on receiver.
     if (invoke_type == kVirtual) {
-      called = receiver->GetClass()->FindVirtualMethodForVirtual(called);
+      called = receiver_ref->GetClass()->FindVirtualMethodForVirtual(called);
     } else if (invoke_type == kInterface) {
-      called = receiver->GetClass()->FindVirtualMethodForInterface(called);
+      called = receiver_ref->GetClass()->FindVirtualMethodForInterface(called);
     }
     // Ensure that the called method's class is initialized.
     mirror::Class* called_class = called->GetDeclaringClass();
@@ -556,11 +570,8 @@ extern "C" const void* artQuickResolutionTrampoline(mirror::ArtMethod* called,
     }
   }
   CHECK_EQ(code == NULL, thread->IsExceptionPending());
-#ifdef MOVING_GARBAGE_COLLECTOR
-  // TODO: locally saved objects may have moved during a GC during resolution. Need to update the
-  //       registers so that the stale objects aren't passed to the method we've resolved.
-    UNIMPLEMENTED(WARNING);
-#endif
+  // Don't pass stale objects to the method we've resolved.
+  visitor.FixupReferences();
   // Place called method in callee-save frame to be placed as first argument to quick method.
   *sp = called;
   return code;
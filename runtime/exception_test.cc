@@ -54,15 +54,15 @@ class ExceptionTest : public CommonTest {
       fake_code_.push_back(0x70 | i);
     }
 
-    fake_mapping_data_.PushBack(4);  // first element is count
-    fake_mapping_data_.PushBack(4);  // total (non-length) elements
-    fake_mapping_data_.PushBack(2);  // count of pc to dex elements
-                                      // ---  pc to dex table
+    fake_mapping_data_.PushBack(2);  // total entries
+    fake_mapping_data_.PushBack(1);  // count of pc to dex entries
+    fake_mapping_data_.PushBack(2);  // bytes of the pc to dex section
+                                      // ---  pc to dex section, no index
     fake_mapping_data_.PushBack(3);  // offset 3
-    fake_mapping_data_.PushBack(3);  // maps to dex offset 3
-                                      // ---  dex to pc table
-    fake_mapping_data_.PushBack(3);  // offset 3
-    fake_mapping_data_.PushBack(3);  // maps to dex offset 3
+    fake_mapping_data_.PushBack(6);  // maps to dex offset 3, zigzag encoded
+                                      // ---  dex to pc section, no index
+    fake_mapping_data_.PushBack(3);  // dex offset 3
+    fake_mapping_data_.PushBack(6);  // maps to offset 3, zigzag encoded
 
     fake_vmap_table_data_.PushBack(0);
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fault_handler.h"
+
+#include <signal.h>
+#include <string.h>
+#include <sys/ucontext.h>
+
+#include "base/logging.h"
+#include "entrypoints/entrypoint_utils.h"
+#include "gc/heap.h"
+#include "globals.h"
+#include "mapping_table.h"
+#include "mirror/art_method-inl.h"
+#include "runtime.h"
+#include "thread.h"
+#include "utils.h"
+
+#if defined(ART_USE_IMPLICIT_NULL_CHECKS) && defined(__arm__)
+extern "C" void art_quick_throw_null_pointer_exception();
+#endif
+
+namespace art {
+
+#if defined(ART_USE_IMPLICIT_NULL_CHECKS) && defined(__arm__)
+
+static struct sigaction old_segv_action;
+
+// Returns the native pc offset of the end of the instruction at the pc if it is an implicit null
+// check of the compiled code of the method at the bottom of the stack, or 0. The method is checked
+// to be one before looking into it, as the fault may come from other code. Nothing here may lock
+// or allocate, so only the entry point of the method is looked at. Faults while it is a trampoline
+// or an instrumentation stub are left to the previous handler.
+static uint32_t GetImplicitNullCheckReturnOffset(uintptr_t sp, uintptr_t pc, const void** code)
+    NO_THREAD_SAFETY_ANALYSIS {
+  mirror::ArtMethod* method = *reinterpret_cast<mirror::ArtMethod**>(sp);
+  Runtime* runtime = Runtime::Current();
+  if (method == NULL || !IsAligned<kObjectAlignment>(method) ||
+      runtime->GetHeap()->FindContinuousSpaceFromObject(method, true) == NULL ||
+      method->GetClass() != mirror::ArtMethod::GetJavaLangReflectArtMethod() ||
+      method->IsNative() || method->IsRuntimeMethod() || method->IsProxyMethod()) {
+    return 0;
+  }
+  *code = method->GetEntryPointFromCompiledCode();
+  if (*code == NULL || *code == GetQuickResolutionTrampoline(runtime->GetClassLinker()) ||
+      *code == GetQuickToInterpreterBridge() || *code == GetQuickInstrumentationEntryPoint()) {
+    return 0;
+  }
+  uintptr_t code_start = reinterpret_cast<uintptr_t>(*code) & ~1;  // Clear the Thumb bit.
+  // The size of the code precedes it.
+  uint32_t code_size = reinterpret_cast<const uint32_t*>(code_start)[-1];
+  if (pc < code_start || pc >= code_start + code_size) {
+    return 0;
+  }
+  // The first halfword of a 32-bit Thumb2 instruction starts with 0b11101, 0b11110 or 0b11111.
+  uint16_t first_halfword = *reinterpret_cast<const uint16_t*>(pc);
+  uint32_t instruction_size = (first_halfword & 0xf800) >= 0xe800 ? 4 : 2;
+  uint32_t return_offset = pc - code_start + instruction_size;
+  MappingTable table(method->GetMappingTable());
+  if (table.FindPcToDex(return_offset) == table.PcToDexEnd()) {
+    return 0;
+  }
+  return return_offset;
+}
+
+static void HandleSegv(int signal_number, siginfo_t* info, void* raw_context) {
+  struct sigcontext* context = &reinterpret_cast<ucontext_t*>(raw_context)->uc_mcontext;
+  Thread* self = Thread::Current();
+  if (reinterpret_cast<uintptr_t>(info->si_addr) < static_cast<uintptr_t>(kPageSize) &&
+      self != NULL && self->GetState() == kRunnable) {
+    const void* code;
+    uint32_t return_offset = GetImplicitNullCheckReturnOffset(context->arm_sp, context->arm_pc,
+                                                              &code);
+    if (return_offset != 0) {
+      // Return into the entrypoint as if the faulting instruction had called it. Quick code
+      // reserves lr and saves it in its frame, so nothing live is lost.
+      context->arm_lr = reinterpret_cast<uintptr_t>(code) + return_offset;
+      context->arm_pc = reinterpret_cast<uintptr_t>(art_quick_throw_null_pointer_exception) & ~1;
+      return;
+    }
+  }
+  if ((old_segv_action.sa_flags & SA_SIGINFO) != 0) {
+    old_segv_action.sa_sigaction(signal_number, info, raw_context);
+  } else if (old_segv_action.sa_handler != SIG_DFL && old_segv_action.sa_handler != SIG_IGN) {
+    old_segv_action.sa_handler(signal_number);
+  } else {
+    // Returning faults again, now with the default action.
+    sigaction(SIGSEGV, &old_segv_action, NULL);
+  }
+}
+
+#endif
+
+void InitImplicitNullCheckHandler() {
+#if defined(ART_USE_IMPLICIT_NULL_CHECKS) && defined(__arm__)
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  sigemptyset(&action.sa_mask);
+  action.sa_sigaction = HandleSegv;
+  // Use the three-argument sa_sigaction handler.
+  action.sa_flags |= SA_SIGINFO;
+  // Use the alternate signal stack so we can catch stack overflows.
+  action.sa_flags |= SA_ONSTACK;
+  CHECK_EQ(sigaction(SIGSEGV, &action, &old_segv_action), 0);
+#endif
+}
+
+}  // namespace art
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_FAULT_HANDLER_H_
+#define ART_RUNTIME_FAULT_HANDLER_H_
+
+namespace art {
+
+// With ART_USE_IMPLICIT_NULL_CHECKS, the ARM code of the Quick compiler doesn't test a reference
+// for null before a field or array length access within the first page of the object. The access
+// faults instead, and the pc to dex mapping of the method has an entry for the end of the faulting
+// instruction, as if it were a call. The SIGSEGV handler installed here turns such a fault into a
+// call of the null pointer exception entrypoint returning there, and passes the other faults on to
+// the handler installed before it. Without implicit null checks it installs nothing.
+void InitImplicitNullCheckHandler();
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_FAULT_HANDLER_H_
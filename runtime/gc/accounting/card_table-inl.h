@@ -23,6 +23,12 @@
 #include "space_bitmap.h"
 #include "utils.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 namespace art {
 namespace gc {
 namespace accounting {
@@ -41,6 +47,45 @@ static inline bool byte_cas(byte old_value, byte new_value, byte* address) {
   return success;
 }
 
+// Number of cards looked at together when skipping over clean parts of the card table.
+static const size_t kCardBlockSize = 32;
+
+// Returns card_cur advanced past the leading blocks of kCardBlockSize cards which are all younger
+// than minimum_age, never past card_end. The cards at the returned address still need to be
+// checked one by one or a word at a time. Without SSE2 or NEON the word loops of the callers do
+// all of the skipping.
+static inline byte* SkipYoungCardBlocks(byte* card_cur, const byte* card_end,
+                                        const byte minimum_age) {
+#if defined(__SSE2__)
+  // There is no unsigned byte compare, a card is at least minimum_age if max(card, age) == card.
+  const __m128i age = _mm_set1_epi8(static_cast<char>(minimum_age));
+  while (card_cur + kCardBlockSize <= card_end) {
+    const __m128i* block = reinterpret_cast<const __m128i*>(card_cur);
+    __m128i low = _mm_loadu_si128(block);
+    __m128i high = _mm_loadu_si128(block + 1);
+    __m128i old_enough = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(low, age), low),
+                                      _mm_cmpeq_epi8(_mm_max_epu8(high, age), high));
+    if (_mm_movemask_epi8(old_enough) != 0) {
+      break;
+    }
+    card_cur += kCardBlockSize;
+  }
+#elif defined(__ARM_NEON__)
+  const uint8x16_t age = vdupq_n_u8(minimum_age);
+  while (card_cur + kCardBlockSize <= card_end) {
+    uint8x16_t old_enough = vorrq_u8(vcgeq_u8(vld1q_u8(card_cur), age),
+                                     vcgeq_u8(vld1q_u8(card_cur + 16), age));
+    uint32x4_t words = vreinterpretq_u32_u8(old_enough);
+    uint32x2_t half = vorr_u32(vget_low_u32(words), vget_high_u32(words));
+    if ((vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0) {
+      break;
+    }
+    card_cur += kCardBlockSize;
+  }
+#endif
+  return card_cur;
+}
+
 template <typename Visitor>
 inline size_t CardTable::Scan(SpaceBitmap* bitmap, byte* scan_begin, byte* scan_end,
                               const Visitor& visitor, const byte minimum_age) const {
@@ -68,6 +113,12 @@ inline size_t CardTable::Scan(SpaceBitmap* bitmap, byte* scan_begin, byte* scan_
   uintptr_t* word_end = reinterpret_cast<uintptr_t*>(aligned_end);
   for (uintptr_t* word_cur = reinterpret_cast<uintptr_t*>(card_cur); word_cur < word_end;
       ++word_cur) {
+    // Blocks are a multiple of the word size so word_cur stays aligned.
+    word_cur = reinterpret_cast<uintptr_t*>(
+        SkipYoungCardBlocks(reinterpret_cast<byte*>(word_cur), aligned_end, minimum_age));
+    if (UNLIKELY(word_cur >= word_end)) {
+      break;
+    }
     while (LIKELY(*word_cur == 0)) {
       ++word_cur;
       if (UNLIKELY(word_cur >= word_end)) {
@@ -158,6 +209,12 @@ inline void CardTable::ModifyCardsAtomic(byte* scan_begin, byte* scan_end, const
 
   // TODO: Parallelize.
   while (word_cur < word_end) {
+    // Clean cards are left alone, skip whole blocks of them.
+    word_cur = reinterpret_cast<uintptr_t*>(
+        SkipYoungCardBlocks(reinterpret_cast<byte*>(word_cur), card_end, kCardClean + 1));
+    if (UNLIKELY(word_cur >= word_end)) {
+      break;
+    }
     while ((expected_word = *word_cur) != 0) {
       new_word =
           (visitor((expected_word >> 0) & 0xFF) << 0) |
@@ -49,6 +49,9 @@ class CardTable {
   static const size_t kCardSize = (1 << kCardShift);
   static const uint8_t kCardClean = 0x0;
   static const uint8_t kCardDirty = 0x70;
+  // A dirty card whose objects a concurrent collection already scanned while the mutators were
+  // running. Still counts as dirty for the next collection, which ages it like a dirty card.
+  static const uint8_t kCardPreCleaned = kCardDirty - 2;
 
   static CardTable* Create(const byte* heap_begin, size_t heap_capacity);
 
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "card_table.h"
+
+#include "card_table-inl.h"
+#include "common_test.h"
+#include "scoped_thread_state_change.h"
+#include "space_bitmap-inl.h"
+#include "UniquePtr.h"
+
+#include <stdint.h>
+#include <set>
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+class CardTableTest : public CommonTest {
+};
+
+class CardVisitor {
+ public:
+  CardVisitor(CardTable* card_table, std::set<const byte*>* cards)
+      : card_table_(card_table), cards_(cards) {}
+
+  void operator()(const mirror::Object* obj) const {
+    EXPECT_TRUE(cards_->insert(card_table_->CardFromAddr(obj)).second);
+  }
+
+ private:
+  CardTable* const card_table_;
+  std::set<const byte*>* const cards_;
+};
+
+class AgeCardVisitor {
+ public:
+  byte operator()(byte card) const {
+    return card == CardTable::kCardDirty ? card - 1 : CardTable::kCardClean;
+  }
+};
+
+class ModifiedCardVisitor {
+ public:
+  explicit ModifiedCardVisitor(size_t* count) : count_(count) {}
+
+  void operator()(byte*, byte expected, byte new_value) const {
+    EXPECT_NE(expected, new_value);
+    ++*count_;
+  }
+
+ private:
+  size_t* const count_;
+};
+
+// Scan skips blocks of clean cards at once, check that it still finds every card which is old
+// enough, whatever its position in a block.
+TEST_F(CardTableTest, Scan) {
+  ScopedObjectAccess soa(Thread::Current());
+  WriterMutexLock mu(soa.Self(), *Locks::heap_bitmap_lock_);
+  byte* heap_begin = reinterpret_cast<byte*>(0x10000000);
+  size_t heap_capacity = 16 * MB;
+  UniquePtr<CardTable> card_table(CardTable::Create(heap_begin, heap_capacity));
+  UniquePtr<SpaceBitmap> bitmap(SpaceBitmap::Create("test bitmap", heap_begin, heap_capacity));
+  ASSERT_TRUE(card_table.get() != NULL);
+  ASSERT_TRUE(bitmap.get() != NULL);
+
+  // One object per card, some cards are dirty and some aged. Runs of dirty cards start at every
+  // offset of a 32 card block and cross into the next block.
+  const size_t num_cards = heap_capacity / CardTable::kCardSize;
+  std::set<const byte*> dirty_cards;
+  std::set<const byte*> aged_cards;
+  for (size_t i = 0; i < num_cards; ++i) {
+    byte* addr = heap_begin + i * CardTable::kCardSize;
+    bitmap->Set(reinterpret_cast<mirror::Object*>(addr));
+    size_t block = i / 64;
+    size_t in_block = i % 64;
+    if (block < 64 && in_block >= block && in_block < block + 3) {
+      card_table->MarkCard(addr);
+      dirty_cards.insert(card_table->CardFromAddr(addr));
+    } else if (i % 1021 == 0) {
+      *card_table->CardFromAddr(addr) = CardTable::kCardDirty - 1;
+      aged_cards.insert(card_table->CardFromAddr(addr));
+    }
+  }
+
+  // The scanned range starts and ends in the middle of a word of cards.
+  byte* scan_begin = heap_begin;
+  byte* scan_end = heap_begin + heap_capacity;
+  for (size_t skip = 0; skip < 3; ++skip) {
+    std::set<const byte*> scanned;
+    size_t count = card_table->Scan(bitmap.get(), scan_begin, scan_end,
+                                    CardVisitor(card_table.get(), &scanned));
+    std::set<const byte*> expected(dirty_cards.lower_bound(card_table->CardFromAddr(scan_begin)),
+                                   dirty_cards.lower_bound(card_table->CardFromAddr(scan_end)));
+    EXPECT_EQ(expected.size(), count);
+    EXPECT_TRUE(scanned == expected);
+
+    scanned.clear();
+    count = card_table->Scan(bitmap.get(), scan_begin, scan_end,
+                             CardVisitor(card_table.get(), &scanned), CardTable::kCardDirty - 1);
+    expected.insert(aged_cards.lower_bound(card_table->CardFromAddr(scan_begin)),
+                    aged_cards.lower_bound(card_table->CardFromAddr(scan_end)));
+    EXPECT_EQ(expected.size(), count);
+    EXPECT_TRUE(scanned == expected);
+
+    scan_begin += CardTable::kCardSize;
+    scan_end -= 3 * CardTable::kCardSize;
+  }
+
+  // Ageing the cards only touches the ones which weren't clean.
+  size_t modified = 0;
+  card_table->ModifyCardsAtomic(heap_begin, heap_begin + heap_capacity, AgeCardVisitor(),
+                                ModifiedCardVisitor(&modified));
+  EXPECT_EQ(dirty_cards.size() + aged_cards.size(), modified);
+  for (size_t i = 0; i < num_cards; ++i) {
+    const byte* card = card_table->CardFromAddr(heap_begin + i * CardTable::kCardSize);
+    byte expected =
+        dirty_cards.count(card) != 0 ? CardTable::kCardDirty - 1 : CardTable::kCardClean;
+    EXPECT_EQ(expected, *card);
+  }
+}
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
@@ -43,7 +43,7 @@ class ModUnionClearCardSetVisitor {
   }
 
   inline void operator()(byte* card, byte expected_value, byte new_value) const {
-    if (expected_value == CardTable::kCardDirty) {
+    if (expected_value == CardTable::kCardDirty || expected_value == CardTable::kCardPreCleaned) {
       cleared_cards_->insert(card);
     }
   }
@@ -59,7 +59,7 @@ class ModUnionClearCardVisitor {
   }
 
   void operator()(byte* card, byte expected_card, byte new_card) const {
-    if (expected_card == CardTable::kCardDirty) {
+    if (expected_card == CardTable::kCardDirty || expected_card == CardTable::kCardPreCleaned) {
       cleared_cards_->push_back(card);
     }
   }
@@ -233,6 +233,13 @@ void ModUnionTableReferenceCache::Dump(std::ostream& os) {
   }
 }
 
+void ModUnionTableReferenceCache::Invalidate() {
+  for (const auto& it : references_) {
+    cleared_cards_.insert(const_cast<byte*>(it.first));
+  }
+  references_.clear();
+}
+
 void ModUnionTableReferenceCache::Update() {
   Heap* heap = GetHeap();
   CardTable* card_table = heap->GetCardTable();
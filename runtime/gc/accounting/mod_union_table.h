@@ -76,6 +76,10 @@ class ModUnionTable {
 
   virtual void Dump(std::ostream& os) = 0;
 
+  // Forget any cached information which depends on object addresses, called after a moving
+  // collection. The cards stay recorded so the next update recomputes them.
+  virtual void Invalidate() = 0;
+
   Heap* GetHeap() const {
     return heap_;
   }
@@ -112,6 +116,9 @@ class ModUnionTableReferenceCache : public ModUnionTable {
 
   void Dump(std::ostream& os);
 
+  // Turns every card with cached references back into a cleared card.
+  void Invalidate();
+
  protected:
   // Cleared card array, used to update the mod-union table.
   ModUnionTable::CardSet cleared_cards_;
@@ -143,6 +150,9 @@ class ModUnionTableCardCache : public ModUnionTable {
 
   void Dump(std::ostream& os);
 
+  // Only cards are cached.
+  void Invalidate() {}
+
  protected:
   // Cleared card array, used to update the mod-union table.
   CardSet cleared_cards_;
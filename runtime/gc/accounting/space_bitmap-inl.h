@@ -21,6 +21,12 @@
 #include "cutils/atomic-inline.h"
 #include "utils.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 namespace art {
 namespace gc {
 namespace accounting {
@@ -53,6 +59,73 @@ inline bool SpaceBitmap::Test(const mirror::Object* obj) const {
   return (bitmap_begin_[OffsetToIndex(offset)] & OffsetToMask(offset)) != 0;
 }
 
+// True if none of the kWordsPerBlock words starting at words has a bit set.
+static inline bool IsEmptyBlock(const word* words) {
+#if defined(__SSE2__)
+  const __m128i* v = reinterpret_cast<const __m128i*>(words);
+  __m128i bits = _mm_or_si128(_mm_loadu_si128(v), _mm_loadu_si128(v + 1));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(__ARM_NEON__)
+  const uint32_t* v = reinterpret_cast<const uint32_t*>(words);
+  uint32x4_t bits = vorrq_u32(vld1q_u32(v), vld1q_u32(v + 4));
+  uint32x2_t half = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+  return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) == 0;
+#else
+  word bits = 0;
+  for (size_t i = 0; i < 32 / sizeof(word); ++i) {
+    bits |= words[i];
+  }
+  return bits == 0;
+#endif
+}
+
+// True if no bit of the block is set in live while being clear in mark.
+static inline bool IsGarbageFreeBlock(const word* live, const word* mark) {
+#if defined(__SSE2__)
+  const __m128i* l = reinterpret_cast<const __m128i*>(live);
+  const __m128i* m = reinterpret_cast<const __m128i*>(mark);
+  __m128i garbage = _mm_or_si128(_mm_andnot_si128(_mm_loadu_si128(m), _mm_loadu_si128(l)),
+                                 _mm_andnot_si128(_mm_loadu_si128(m + 1), _mm_loadu_si128(l + 1)));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(garbage, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(__ARM_NEON__)
+  const uint32_t* l = reinterpret_cast<const uint32_t*>(live);
+  const uint32_t* m = reinterpret_cast<const uint32_t*>(mark);
+  uint32x4_t garbage = vorrq_u32(vbicq_u32(vld1q_u32(l), vld1q_u32(m)),
+                                 vbicq_u32(vld1q_u32(l + 4), vld1q_u32(m + 4)));
+  uint32x2_t half = vorr_u32(vget_low_u32(garbage), vget_high_u32(garbage));
+  return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) == 0;
+#else
+  word garbage = 0;
+  for (size_t i = 0; i < 32 / sizeof(word); ++i) {
+    garbage |= live[i] & ~mark[i];
+  }
+  return garbage == 0;
+#endif
+}
+
+inline size_t SpaceBitmap::FindNonZeroWord(const word* words, size_t begin, size_t end) {
+  size_t i = begin;
+  while (i + kWordsPerBlock <= end && IsEmptyBlock(words + i)) {
+    i += kWordsPerBlock;
+  }
+  while (i < end && words[i] == 0) {
+    ++i;
+  }
+  return i;
+}
+
+inline size_t SpaceBitmap::FindGarbageWord(const word* live, const word* mark, size_t begin,
+                                           size_t end) {
+  size_t i = begin;
+  while (i + kWordsPerBlock <= end && IsGarbageFreeBlock(live + i, mark + i)) {
+    i += kWordsPerBlock;
+  }
+  while (i < end && (live[i] & ~mark[i]) == 0) {
+    ++i;
+  }
+  return i;
+}
+
 template <typename Visitor>
 void SpaceBitmap::VisitMarkedRange(uintptr_t visit_begin, uintptr_t visit_end,
                                    const Visitor& visitor) const {
@@ -85,17 +158,16 @@ void SpaceBitmap::VisitMarkedRange(uintptr_t visit_begin, uintptr_t visit_end,
   }
   word_start++;
 
-  for (size_t i = word_start; i < word_end; i++) {
+  for (size_t i = FindNonZeroWord(bitmap_begin_, word_start, word_end); i < word_end;
+       i = FindNonZeroWord(bitmap_begin_, i + 1, word_end)) {
     size_t w = bitmap_begin_[i];
-    if (w != 0) {
-      uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
-      do {
-        const size_t shift = CLZ(w);
-        mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
-        visitor(obj);
-        w ^= static_cast<size_t>(kWordHighBitMask) >> shift;
-      } while (w != 0);
-    }
+    uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
+    do {
+      const size_t shift = CLZ(w);
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
+      visitor(obj);
+      w ^= static_cast<size_t>(kWordHighBitMask) >> shift;
+    } while (w != 0);
   }
 
   // Handle the right edge, and also the left edge if both edges are on the same word.
@@ -104,19 +104,18 @@ void SpaceBitmap::Walk(SpaceBitmap::Callback* callback, void* arg) {
   CHECK(bitmap_begin_ != NULL);
   CHECK(callback != NULL);
 
-  uintptr_t end = OffsetToIndex(HeapLimit() - heap_begin_ - 1);
+  const size_t end = OffsetToIndex(HeapLimit() - heap_begin_ - 1) + 1;
   word* bitmap_begin = bitmap_begin_;
-  for (uintptr_t i = 0; i <= end; ++i) {
+  for (size_t i = FindNonZeroWord(bitmap_begin, 0, end); i < end;
+       i = FindNonZeroWord(bitmap_begin, i + 1, end)) {
     word w = bitmap_begin[i];
-    if (w != 0) {
-      uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
-      do {
-        const size_t shift = CLZ(w);
-        mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
-        (*callback)(obj, arg);
-        w ^= static_cast<size_t>(kWordHighBitMask) >> shift;
-      } while (w != 0);
-    }
+    uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
+    do {
+      const size_t shift = CLZ(w);
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
+      (*callback)(obj, arg);
+      w ^= static_cast<size_t>(kWordHighBitMask) >> shift;
+    } while (w != 0);
   }
 }
 
@@ -146,25 +145,25 @@ void SpaceBitmap::SweepWalk(const SpaceBitmap& live_bitmap,
   mirror::Object* pointer_buf[buffer_size];
   mirror::Object** pb = &pointer_buf[0];
   size_t start = OffsetToIndex(sweep_begin - live_bitmap.heap_begin_);
-  size_t end = OffsetToIndex(sweep_end - live_bitmap.heap_begin_ - 1);
-  CHECK_LT(end, live_bitmap.Size() / kWordSize);
+  size_t end = OffsetToIndex(sweep_end - live_bitmap.heap_begin_ - 1) + 1;
+  CHECK_LE(end, live_bitmap.Size() / kWordSize);
   word* live = live_bitmap.bitmap_begin_;
   word* mark = mark_bitmap.bitmap_begin_;
-  for (size_t i = start; i <= end; i++) {
+  // Runs of words without garbage, live & ~mark == 0, are skipped a block at a time.
+  for (size_t i = FindGarbageWord(live, mark, start, end); i < end;
+       i = FindGarbageWord(live, mark, i + 1, end)) {
     word garbage = live[i] & ~mark[i];
-    if (UNLIKELY(garbage != 0)) {
-      uintptr_t ptr_base = IndexToOffset(i) + live_bitmap.heap_begin_;
-      do {
-        const size_t shift = CLZ(garbage);
-        garbage ^= static_cast<size_t>(kWordHighBitMask) >> shift;
-        *pb++ = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
-      } while (garbage != 0);
-      // Make sure that there are always enough slots available for an
-      // entire word of one bits.
-      if (pb >= &pointer_buf[buffer_size - kBitsPerWord]) {
-        (*callback)(pb - &pointer_buf[0], &pointer_buf[0], arg);
-        pb = &pointer_buf[0];
-      }
+    uintptr_t ptr_base = IndexToOffset(i) + live_bitmap.heap_begin_;
+    do {
+      const size_t shift = CLZ(garbage);
+      garbage ^= static_cast<size_t>(kWordHighBitMask) >> shift;
+      *pb++ = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
+    } while (garbage != 0);
+    // Make sure that there are always enough slots available for an
+    // entire word of one bits.
+    if (pb >= &pointer_buf[buffer_size - kBitsPerWord]) {
+      (*callback)(pb - &pointer_buf[0], &pointer_buf[0], arg);
+      pb = &pointer_buf[0];
     }
   }
   if (pb > &pointer_buf[0]) {
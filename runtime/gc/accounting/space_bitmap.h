@@ -190,6 +190,16 @@ class SpaceBitmap {
 
   bool Modify(const mirror::Object* obj, bool do_set);
 
+  // Empty parts of a bitmap are skipped 256 bits at a time, with SSE2 or NEON when available.
+  static const size_t kWordsPerBlock = 32 / sizeof(word);
+
+  // Returns the index of the first non-zero word in [begin, end), or end.
+  static size_t FindNonZeroWord(const word* words, size_t begin, size_t end);
+
+  // Returns the index of the first word in [begin, end) which has bits set in live that are clear
+  // in mark, or end.
+  static size_t FindGarbageWord(const word* live, const word* mark, size_t begin, size_t end);
+
   // Backing storage for bitmap.
   UniquePtr<MemMap> mem_map_;
 
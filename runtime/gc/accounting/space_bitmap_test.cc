@@ -19,9 +19,12 @@
 #include "common_test.h"
 #include "globals.h"
 #include "space_bitmap-inl.h"
+#include "utils.h"
 #include "UniquePtr.h"
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <set>
 
 namespace art {
 namespace gc {
@@ -88,6 +91,175 @@ TEST_F(SpaceBitmapTest, ScanRange) {
   }
 }
 
+static void CountCallback(mirror::Object*, void* arg) {
+  ++*reinterpret_cast<size_t*>(arg);
+}
+
+static void CollectCallback(mirror::Object* obj, void* arg) {
+  reinterpret_cast<std::set<const mirror::Object*>*>(arg)->insert(obj);
+}
+
+static void CountSweepCallback(size_t num_ptrs, mirror::Object**, void* arg) {
+  *reinterpret_cast<size_t*>(arg) += num_ptrs;
+}
+
+static void CollectSweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg) {
+  std::set<const mirror::Object*>* objects =
+      reinterpret_cast<std::set<const mirror::Object*>*>(arg);
+  for (size_t i = 0; i < num_ptrs; ++i) {
+    EXPECT_TRUE(objects->insert(ptrs[i]).second);
+  }
+}
+
+class CountVisitor {
+ public:
+  explicit CountVisitor(size_t* count) : count_(count) {}
+
+  void operator()(const mirror::Object*) const {
+    ++*count_;
+  }
+
+ private:
+  size_t* const count_;
+};
+
+class CollectVisitor {
+ public:
+  explicit CollectVisitor(std::set<const mirror::Object*>* objects) : objects_(objects) {}
+
+  void operator()(const mirror::Object* obj) const {
+    objects_->insert(obj);
+  }
+
+ private:
+  std::set<const mirror::Object*>* const objects_;
+};
+
+// Walk, VisitMarkedRange and SweepWalk skip empty blocks of words, check that they still find
+// every bit next to and across block boundaries.
+TEST_F(SpaceBitmapTest, SkipEmptyBlocks) {
+  byte* heap_begin = reinterpret_cast<byte*>(0x10000000);
+  size_t heap_capacity = 1 * MB;
+  UniquePtr<SpaceBitmap> live(SpaceBitmap::Create("live bitmap", heap_begin, heap_capacity));
+  UniquePtr<SpaceBitmap> mark(SpaceBitmap::Create("mark bitmap", heap_begin, heap_capacity));
+  ASSERT_TRUE(live.get() != NULL);
+  ASSERT_TRUE(mark.get() != NULL);
+
+  const size_t num_bits = heap_capacity / SpaceBitmap::kAlignment;
+  const size_t block_bits = 256;
+  srand(1);
+  std::set<const mirror::Object*> expected_live;
+  std::set<const mirror::Object*> expected_garbage;
+  for (size_t i = 0; i < num_bits; ++i) {
+    size_t in_block = i % block_bits;
+    // A few random bits, plus the first and last bits of every few blocks and of the words
+    // around them.
+    bool set = rand() % 512 == 0 ||
+        ((i / block_bits) % 5 == 3 && (in_block < 2 || in_block >= block_bits - 2 ||
+                                       in_block % kBitsPerWord == 0));
+    if (!set) {
+      continue;
+    }
+    const mirror::Object* obj =
+        reinterpret_cast<mirror::Object*>(heap_begin + i * SpaceBitmap::kAlignment);
+    live->Set(obj);
+    expected_live.insert(obj);
+    if (rand() % 3 == 0) {
+      expected_garbage.insert(obj);
+    } else {
+      mark->Set(obj);
+    }
+  }
+
+  std::set<const mirror::Object*> walked;
+  live->Walk(CollectCallback, &walked);
+  EXPECT_TRUE(walked == expected_live);
+
+  std::set<const mirror::Object*> visited;
+  live->VisitMarkedRange(reinterpret_cast<uintptr_t>(heap_begin),
+                         reinterpret_cast<uintptr_t>(heap_begin + heap_capacity),
+                         CollectVisitor(&visited));
+  EXPECT_TRUE(visited == expected_live);
+
+  // Start and end the range away from word boundaries.
+  uintptr_t begin = reinterpret_cast<uintptr_t>(heap_begin) + 37 * SpaceBitmap::kAlignment;
+  uintptr_t end = reinterpret_cast<uintptr_t>(heap_begin + heap_capacity) -
+      101 * SpaceBitmap::kAlignment;
+  visited.clear();
+  live->VisitMarkedRange(begin, end, CollectVisitor(&visited));
+  std::set<const mirror::Object*> expected_range(
+      expected_live.lower_bound(reinterpret_cast<const mirror::Object*>(begin)),
+      expected_live.lower_bound(reinterpret_cast<const mirror::Object*>(end)));
+  EXPECT_TRUE(visited == expected_range);
+
+  std::set<const mirror::Object*> swept;
+  SpaceBitmap::SweepWalk(*live, *mark, reinterpret_cast<uintptr_t>(heap_begin),
+                         reinterpret_cast<uintptr_t>(heap_begin + heap_capacity),
+                         CollectSweepCallback, &swept);
+  EXPECT_TRUE(swept == expected_garbage);
+}
+
+// Not a correctness test, logs how fast the bitmaps are walked and swept for a heap with few and
+// one with many objects.
+TEST_F(SpaceBitmapTest, WalkThroughput) {
+  byte* heap_begin = reinterpret_cast<byte*>(0x10000000);
+  size_t heap_capacity = 64 * MB;
+  UniquePtr<SpaceBitmap> live(SpaceBitmap::Create("live bitmap", heap_begin, heap_capacity));
+  UniquePtr<SpaceBitmap> mark(SpaceBitmap::Create("mark bitmap", heap_begin, heap_capacity));
+  ASSERT_TRUE(live.get() != NULL);
+  ASSERT_TRUE(mark.get() != NULL);
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(heap_begin);
+  const uintptr_t end = begin + heap_capacity;
+  const size_t bitmap_bytes = heap_capacity / SpaceBitmap::kAlignment / kBitsPerByte;
+  const size_t kIterations = 10;
+
+  // One object in 4096 and one in 2, half of them garbage.
+  const size_t strides[] = { 4096, 2 };
+  for (size_t s = 0; s < arraysize(strides); ++s) {
+    live->Clear();
+    mark->Clear();
+    size_t num_objects = 0;
+    for (uintptr_t addr = begin; addr < end; addr += strides[s] * SpaceBitmap::kAlignment) {
+      const mirror::Object* obj = reinterpret_cast<mirror::Object*>(addr);
+      live->Set(obj);
+      if (num_objects % 2 == 0) {
+        mark->Set(obj);
+      }
+      ++num_objects;
+    }
+
+    uint64_t start_time = NanoTime();
+    for (size_t i = 0; i < kIterations; ++i) {
+      size_t count = 0;
+      live->VisitMarkedRange(begin, end, CountVisitor(&count));
+      EXPECT_EQ(num_objects, count);
+    }
+    uint64_t visit_time = NanoTime() - start_time;
+
+    start_time = NanoTime();
+    for (size_t i = 0; i < kIterations; ++i) {
+      size_t count = 0;
+      live->Walk(CountCallback, &count);
+      EXPECT_EQ(num_objects, count);
+    }
+    uint64_t walk_time = NanoTime() - start_time;
+
+    start_time = NanoTime();
+    for (size_t i = 0; i < kIterations; ++i) {
+      size_t count = 0;
+      SpaceBitmap::SweepWalk(*live, *mark, begin, end, CountSweepCallback, &count);
+      EXPECT_EQ(num_objects / 2, count);
+    }
+    uint64_t sweep_time = NanoTime() - start_time;
+
+    const double mb = static_cast<double>(bitmap_bytes * kIterations) / MB;
+    LOG(INFO) << "One object in " << strides[s] << ": "
+              << "VisitMarkedRange " << mb * 1e9 / std::max<uint64_t>(visit_time, 1) << " MB/s, "
+              << "Walk " << mb * 1e9 / std::max<uint64_t>(walk_time, 1) << " MB/s, "
+              << "SweepWalk " << mb * 1e9 / std::max<uint64_t>(sweep_time, 1) << " MB/s";
+  }
+}
+
 }  // namespace accounting
 }  // namespace gc
 }  // namespace art
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ACCOUNTING_WORK_STEALING_DEQUE_H_
+#define ART_RUNTIME_GC_ACCOUNTING_WORK_STEALING_DEQUE_H_
+
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/stl_util.h"
+#include "cutils/atomic.h"
+#include "cutils/atomic-inline.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+// A Chase-Lev work stealing deque. The owning thread pushes and pops at the bottom, any other
+// thread may steal from the top. The buffer grows when full, outgrown buffers may still be read
+// by thieves so they are kept until Reset.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t initial_capacity)
+      : top_(0),
+        bottom_(0),
+        buffer_(new Buffer(RoundUpToPowerOfTwo(initial_capacity))) {
+  }
+
+  ~WorkStealingDeque() {
+    delete buffer_;
+    STLDeleteElements(&retired_buffers_);
+  }
+
+  // Only called by the owner.
+  void PushBottom(T value) {
+    int32_t bottom = bottom_;
+    int32_t top = top_;
+    Buffer* buffer = buffer_;
+    if (UNLIKELY(static_cast<size_t>(bottom - top) >= buffer->Capacity())) {
+      buffer = Grow(buffer, top, bottom);
+    }
+    buffer->Put(bottom, value);
+    // Publish the value before the new bottom.
+    ANDROID_MEMBAR_STORE();
+    bottom_ = bottom + 1;
+  }
+
+  // Only called by the owner, returns false if the deque is empty.
+  bool PopBottom(T* value) {
+    int32_t bottom = bottom_ - 1;
+    Buffer* buffer = buffer_;
+    bottom_ = bottom;
+    // Thieves must see the reservation of the bottom element before we look at the top.
+    ANDROID_MEMBAR_FULL();
+    int32_t top = top_;
+    if (bottom < top) {
+      bottom_ = top;
+      return false;
+    }
+    *value = buffer->Get(bottom);
+    if (bottom > top) {
+      return true;
+    }
+    // Last element, race the thieves for it.
+    bool won = android_atomic_cas(top, top + 1, &top_) == 0;
+    bottom_ = top + 1;
+    return won;
+  }
+
+  // May be called by any thread. Returns false if the deque looked empty or another thread took
+  // the top element first.
+  bool Steal(T* value) {
+    int32_t top = top_;
+    ANDROID_MEMBAR_FULL();
+    int32_t bottom = bottom_;
+    // Acquire, the buffer and the slot may only be read after the bottom which published them.
+    ANDROID_MEMBAR_FULL();
+    if (top >= bottom) {
+      return false;
+    }
+    Buffer* buffer = buffer_;
+    T result = buffer->Get(top);
+    if (android_atomic_cas(top, top + 1, &top_) != 0) {
+      return false;
+    }
+    *value = result;
+    return true;
+  }
+
+  bool IsEmpty() const {
+    return bottom_ <= top_;
+  }
+
+  size_t Size() const {
+    int32_t size = bottom_ - top_;
+    return size > 0 ? size : 0;
+  }
+
+  // Not thread safe, no other thread may access the deque.
+  void Reset() {
+    top_ = 0;
+    bottom_ = 0;
+    STLDeleteElements(&retired_buffers_);
+  }
+
+ private:
+  class Buffer {
+   public:
+    explicit Buffer(size_t capacity) : mask_(capacity - 1), data_(new T[capacity]) {
+      DCHECK(IsPowerOfTwo(capacity));
+    }
+
+    ~Buffer() {
+      delete[] data_;
+    }
+
+    size_t Capacity() const {
+      return mask_ + 1;
+    }
+
+    T Get(int32_t index) const {
+      return data_[index & mask_];
+    }
+
+    void Put(int32_t index, T value) {
+      data_[index & mask_] = value;
+    }
+
+   private:
+    const size_t mask_;
+    T* const data_;
+
+    DISALLOW_COPY_AND_ASSIGN(Buffer);
+  };
+
+  Buffer* Grow(Buffer* old_buffer, int32_t top, int32_t bottom) {
+    Buffer* new_buffer = new Buffer(old_buffer->Capacity() * 2);
+    for (int32_t i = top; i < bottom; ++i) {
+      new_buffer->Put(i, old_buffer->Get(i));
+    }
+    ANDROID_MEMBAR_STORE();
+    buffer_ = new_buffer;
+    retired_buffers_.push_back(old_buffer);
+    return new_buffer;
+  }
+
+  volatile int32_t top_;
+  volatile int32_t bottom_;
+  Buffer* volatile buffer_;
+  // Only touched by the owner.
+  std::vector<Buffer*> retired_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ACCOUNTING_WORK_STEALING_DEQUE_H_
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "work_stealing_deque.h"
+
+#include "common_test.h"
+#include "thread_pool.h"
+#include "UniquePtr.h"
+
+#include <stdint.h>
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+class WorkStealingDequeTest : public CommonTest {
+};
+
+TEST_F(WorkStealingDequeTest, PopIsLifoStealIsFifo) {
+  WorkStealingDeque<size_t> deque(4);
+  EXPECT_TRUE(deque.IsEmpty());
+  // Grows past the initial capacity.
+  for (size_t i = 0; i < 100; ++i) {
+    deque.PushBottom(i);
+  }
+  EXPECT_EQ(100U, deque.Size());
+  size_t value = 0;
+  ASSERT_TRUE(deque.PopBottom(&value));
+  EXPECT_EQ(99U, value);
+  ASSERT_TRUE(deque.Steal(&value));
+  EXPECT_EQ(0U, value);
+  ASSERT_TRUE(deque.Steal(&value));
+  EXPECT_EQ(1U, value);
+  for (size_t i = 98; i >= 2; --i) {
+    ASSERT_TRUE(deque.PopBottom(&value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_TRUE(deque.IsEmpty());
+  EXPECT_FALSE(deque.PopBottom(&value));
+  EXPECT_FALSE(deque.Steal(&value));
+  deque.Reset();
+  deque.PushBottom(7);
+  ASSERT_TRUE(deque.PopBottom(&value));
+  EXPECT_EQ(7U, value);
+}
+
+class StealTask : public Task {
+ public:
+  StealTask(WorkStealingDeque<size_t>* deque, AtomicInteger* done, AtomicInteger* sum)
+      : deque_(deque), done_(done), sum_(sum) {}
+
+  void Run(Thread* self) {
+    size_t value;
+    while (*done_ == 0 || !deque_->IsEmpty()) {
+      if (deque_->Steal(&value)) {
+        sum_->fetch_add(value);
+      }
+    }
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+ private:
+  WorkStealingDeque<size_t>* const deque_;
+  AtomicInteger* const done_;
+  AtomicInteger* const sum_;
+};
+
+// Every pushed value is taken exactly once, either by the owner or by one of the thieves.
+TEST_F(WorkStealingDequeTest, ConcurrentSteal) {
+  Thread* self = Thread::Current();
+  static const size_t kNumThieves = 4;
+  static const size_t kNumValues = 10000;
+  WorkStealingDeque<size_t> deque(16);
+  AtomicInteger done(0);
+  AtomicInteger sum(0);
+  UniquePtr<ThreadPool> thread_pool(new ThreadPool(kNumThieves));
+  for (size_t i = 0; i < kNumThieves; ++i) {
+    thread_pool->AddTask(self, new StealTask(&deque, &done, &sum));
+  }
+  thread_pool->StartWorkers(self);
+  size_t value;
+  for (size_t i = 1; i <= kNumValues; ++i) {
+    deque.PushBottom(i);
+    if (i % 3 == 0 && deque.PopBottom(&value)) {
+      sum.fetch_add(value);
+    }
+  }
+  while (deque.PopBottom(&value)) {
+    sum.fetch_add(value);
+  }
+  done = 1;
+  thread_pool->Wait(self, false, false);
+  EXPECT_EQ(static_cast<int32_t>(kNumValues * (kNumValues + 1) / 2), sum.load());
+}
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
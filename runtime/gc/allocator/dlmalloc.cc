@@ -37,6 +37,11 @@ static void art_heap_usage_error(const char* function, void* p);
 #pragma GCC diagnostic warning "-Wstrict-aliasing"
 #pragma GCC diagnostic warning "-Wempty-body"
 
+COMPILE_ASSERT(kDlmallocChunkOverhead == CHUNK_OVERHEAD, dlmalloc_chunk_overhead_mismatch);
+COMPILE_ASSERT(kDlmallocChunkAlignMask == CHUNK_ALIGN_MASK, dlmalloc_chunk_align_mask_mismatch);
+COMPILE_ASSERT(kDlmallocMinChunkSize == MIN_CHUNK_SIZE, dlmalloc_min_chunk_size_mismatch);
+COMPILE_ASSERT(kDlmallocPinuseBit == PINUSE_BIT, dlmalloc_pinuse_bit_mismatch);
+COMPILE_ASSERT(kDlmallocCinuseBit == CINUSE_BIT, dlmalloc_cinuse_bit_mismatch);
 
 static void art_heap_corruption(const char* function) {
   LOG(FATAL) << "Corrupt heap detected in: " << function;
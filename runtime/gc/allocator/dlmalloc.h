@@ -37,4 +37,21 @@ extern "C" int  dlmalloc_trim(size_t);
 // pages back to the kernel.
 extern "C" void DlmallocMadviseCallback(void* start, void* end, size_t used_bytes, void* /*arg*/);
 
+// Chunk layout of the dlmalloc configuration above. These mirror private malloc.c macros so that
+// DlMallocSpace can split a thread-local allocation buffer into valid in-use chunks without
+// calling into the mspace. Kept in sync with malloc.c by compile time asserts in dlmalloc.cc.
+static const size_t kDlmallocChunkOverhead = sizeof(size_t);
+static const size_t kDlmallocChunkAlignMask = 2 * sizeof(size_t) - 1;
+static const size_t kDlmallocMinChunkSize = 4 * sizeof(size_t);
+static const size_t kDlmallocPinuseBit = 1;
+static const size_t kDlmallocCinuseBit = 2;
+
+// Equivalent of malloc.c's request2size: the chunk size used for a request of num_bytes.
+static inline size_t DlmallocRequestToChunkSize(size_t num_bytes) {
+  if (num_bytes < kDlmallocMinChunkSize - kDlmallocChunkOverhead - 1) {
+    return kDlmallocMinChunkSize;
+  }
+  return (num_bytes + kDlmallocChunkOverhead + kDlmallocChunkAlignMask) & ~kDlmallocChunkAlignMask;
+}
+
 #endif  // ART_RUNTIME_GC_ALLOCATOR_DLMALLOC_H_
@@ -0,0 +1,706 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rosalloc.h"
+
+#include <algorithm>
+
+#include "thread.h"
+
+namespace art {
+namespace gc {
+namespace allocator {
+
+COMPILE_ASSERT(RosAlloc::kNumThreadLocalSizeBrackets == kRosAllocNumThreadLocalSizeBrackets,
+               rosalloc_thread_local_size_brackets_mismatch);
+
+// The minimum number of bytes the footprint grows by, to amortize the cost of MoreCore.
+static const size_t kMinGrowthIncrement = 64 * KB;
+
+size_t RosAlloc::bracket_sizes_[kNumOfSizeBrackets];
+size_t RosAlloc::num_of_pages_[kNumOfSizeBrackets];
+size_t RosAlloc::num_of_slots_[kNumOfSizeBrackets];
+size_t RosAlloc::header_sizes_[kNumOfSizeBrackets];
+size_t RosAlloc::bulk_free_bit_map_offsets_[kNumOfSizeBrackets];
+size_t RosAlloc::thread_local_free_bit_map_offsets_[kNumOfSizeBrackets];
+bool RosAlloc::initialized_ = false;
+
+RosAlloc::RosAlloc(void* base, size_t initial_footprint, size_t initial_footprint_limit,
+                   size_t max_capacity)
+    : base_(reinterpret_cast<byte*>(base)), footprint_(initial_footprint),
+      capacity_(initial_footprint_limit), max_capacity_(max_capacity),
+      lock_("rosalloc global lock", kRosAllocGlobalLock),
+      bulk_free_lock_("rosalloc bulk free lock", kRosAllocBulkFreeLock) {
+  CHECK(IsAligned<kPageSize>(base_));
+  CHECK(IsAligned<kPageSize>(footprint_));
+  CHECK(IsAligned<kPageSize>(max_capacity_));
+  CHECK_LE(footprint_, capacity_);
+  CHECK_LE(capacity_, max_capacity_);
+  if (!initialized_) {
+    Initialize();
+  }
+  for (size_t i = 0; i < kNumOfSizeBrackets; ++i) {
+    size_bracket_locks_[i].reset(new Mutex("a rosalloc size bracket lock", kRosAllocBracketLock));
+    current_runs_[i] = NULL;
+  }
+  size_t num_of_pages = max_capacity_ / kPageSize;
+  page_map_mem_map_.reset(MemMap::MapAnonymous("rosalloc page map", NULL,
+                                               RoundUp(num_of_pages, kPageSize),
+                                               PROT_READ | PROT_WRITE));
+  CHECK(page_map_mem_map_.get() != NULL) << "Couldn't allocate the rosalloc page map";
+  page_map_ = page_map_mem_map_->Begin();
+  // The initially committed memory is a single free page run.
+  if (footprint_ > 0) {
+    FreePageRun* fpr = reinterpret_cast<FreePageRun*>(base_);
+    fpr->magic_num_ = kMagicNumFree;
+    fpr->byte_size_ = footprint_;
+    free_page_runs_.insert(fpr);
+  }
+}
+
+void RosAlloc::Initialize() {
+  for (size_t i = 0; i < kNumOfSizeBrackets; ++i) {
+    if (i < kNumOfSizeBrackets - 2) {
+      bracket_sizes_[i] = kQuantumSize * (i + 1);
+    } else if (i == kNumOfSizeBrackets - 2) {
+      bracket_sizes_[i] = 1 * KB;
+    } else {
+      bracket_sizes_[i] = 2 * KB;
+    }
+    if (i < 8) {
+      num_of_pages_[i] = 1;
+    } else if (i < 16) {
+      num_of_pages_[i] = 2;
+    } else if (i < kNumOfSizeBrackets - 2) {
+      num_of_pages_[i] = 4;
+    } else if (i == kNumOfSizeBrackets - 2) {
+      num_of_pages_[i] = 8;
+    } else {
+      num_of_pages_[i] = 16;
+    }
+  }
+  const size_t fixed_header_size = OFFSETOF_MEMBER(Run, alloc_bit_map_);
+  for (size_t i = 0; i < kNumOfSizeBrackets; ++i) {
+    const size_t run_size = kPageSize * num_of_pages_[i];
+    const size_t bracket_size = bracket_sizes_[i];
+    // Find the largest number of slots for which the header, three bitmaps and the slots fit.
+    size_t num_of_slots = run_size / bracket_size;
+    size_t header_size = 0;
+    size_t bit_map_size = 0;
+    for (; num_of_slots > 0; --num_of_slots) {
+      bit_map_size = RoundUp(num_of_slots, 32) / 8;
+      header_size = RoundUp(fixed_header_size + 3 * bit_map_size, kObjectAlignment);
+      if (header_size + num_of_slots * bracket_size <= run_size) {
+        break;
+      }
+    }
+    CHECK_GT(num_of_slots, 0U);
+    num_of_slots_[i] = num_of_slots;
+    header_sizes_[i] = header_size;
+    bulk_free_bit_map_offsets_[i] = fixed_header_size + bit_map_size;
+    thread_local_free_bit_map_offsets_[i] = fixed_header_size + 2 * bit_map_size;
+  }
+  initialized_ = true;
+}
+
+void* RosAlloc::Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated) {
+  if (UNLIKELY(num_bytes > kLargeSizeThreshold)) {
+    return AllocLargeObject(self, num_bytes, bytes_allocated);
+  }
+  size_t bracket_size;
+  size_t idx = SizeToIndexAndBracketSize(num_bytes, &bracket_size);
+  void* slot_addr;
+  if (LIKELY(idx < kNumThreadLocalSizeBrackets)) {
+    // Only this thread allocates from its thread-local run, no locking is needed.
+    Run* thread_local_run = reinterpret_cast<Run*>(self->GetRosAllocRun(idx));
+    slot_addr = thread_local_run != NULL ? thread_local_run->AllocSlot() : NULL;
+    if (UNLIKELY(slot_addr == NULL)) {
+      MutexLock mu(self, *size_bracket_locks_[idx]);
+      // Pick up the slots other threads freed since the run became thread-local, otherwise
+      // retire the run and take another one.
+      if (thread_local_run == NULL || !thread_local_run->MergeThreadLocalFreeBitMapToAllocBitMap()) {
+        if (thread_local_run != NULL) {
+          // A full run isn't tracked until one of its slots is freed.
+          DCHECK(thread_local_run->IsFull());
+          thread_local_run->is_thread_local_ = 0;
+        }
+        thread_local_run = RefillRun(self, idx);
+        self->SetRosAllocRun(idx, thread_local_run);
+        if (UNLIKELY(thread_local_run == NULL)) {
+          return NULL;
+        }
+        thread_local_run->is_thread_local_ = 1;
+      }
+      slot_addr = thread_local_run->AllocSlot();
+      DCHECK(slot_addr != NULL);
+    }
+  } else {
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    slot_addr = AllocFromCurrentRunUnlocked(self, idx);
+  }
+  if (LIKELY(slot_addr != NULL)) {
+    *bytes_allocated = bracket_size;
+  }
+  return slot_addr;
+}
+
+void* RosAlloc::AllocLargeObject(Thread* self, size_t num_bytes, size_t* bytes_allocated) {
+  size_t num_pages = RoundUp(num_bytes, kPageSize) / kPageSize;
+  void* result;
+  {
+    MutexLock mu(self, lock_);
+    result = AllocPages(self, num_pages, kPageMapLargeObject);
+  }
+  if (result != NULL) {
+    *bytes_allocated = num_pages * kPageSize;
+  }
+  return result;
+}
+
+void* RosAlloc::AllocFromCurrentRunUnlocked(Thread* self, size_t idx) {
+  Run* current_run = current_runs_[idx];
+  void* slot_addr = current_run != NULL ? current_run->AllocSlot() : NULL;
+  if (UNLIKELY(slot_addr == NULL)) {
+    // The current run is full, it isn't tracked until one of its slots is freed.
+    current_run = RefillRun(self, idx);
+    current_runs_[idx] = current_run;
+    if (UNLIKELY(current_run == NULL)) {
+      return NULL;
+    }
+    slot_addr = current_run->AllocSlot();
+    DCHECK(slot_addr != NULL);
+  }
+  return slot_addr;
+}
+
+RosAlloc::Run* RosAlloc::RefillRun(Thread* self, size_t idx) {
+  std::set<Run*>& non_full_runs = non_full_runs_[idx];
+  if (!non_full_runs.empty()) {
+    // Prefer the lowest address to keep the heap compact.
+    Run* run = *non_full_runs.begin();
+    non_full_runs.erase(non_full_runs.begin());
+    if (kCheckRuns) {
+      CHECK_EQ(run->magic_num_, kMagicNum);
+      CHECK(!run->IsFull());
+    }
+    return run;
+  }
+  return AllocRun(self, idx);
+}
+
+RosAlloc::Run* RosAlloc::AllocRun(Thread* self, size_t idx) {
+  Run* new_run;
+  {
+    MutexLock mu(self, lock_);
+    new_run = reinterpret_cast<Run*>(AllocPages(self, num_of_pages_[idx], kPageMapRun));
+  }
+  if (new_run != NULL) {
+    new_run->magic_num_ = kMagicNum;
+    new_run->size_bracket_idx_ = idx;
+    new_run->is_thread_local_ = 0;
+    new_run->to_be_bulk_freed_ = 0;
+    new_run->first_search_vec_idx_ = 0;
+    new_run->InitBitMaps();
+  }
+  return new_run;
+}
+
+void* RosAlloc::AllocPages(Thread* self, size_t num_pages, byte page_map_kind) {
+  const size_t req_byte_size = num_pages * kPageSize;
+  FreePageRun* result = NULL;
+  // First fit in address order.
+  for (auto it = free_page_runs_.begin(); it != free_page_runs_.end(); ++it) {
+    FreePageRun* fpr = *it;
+    if (kCheckRuns) {
+      CHECK_EQ(fpr->magic_num_, kMagicNumFree);
+    }
+    if (fpr->byte_size_ >= req_byte_size) {
+      free_page_runs_.erase(it);
+      result = fpr;
+      break;
+    }
+  }
+  if (result == NULL) {
+    // Grow the footprint, extending the last free page run if it ends at the footprint.
+    FreePageRun* last_free_page_run = NULL;
+    size_t last_free_page_run_size = 0;
+    if (!free_page_runs_.empty()) {
+      FreePageRun* fpr = *free_page_runs_.rbegin();
+      if (fpr->End() == base_ + footprint_) {
+        last_free_page_run = fpr;
+        last_free_page_run_size = fpr->byte_size_;
+      }
+    }
+    const size_t needed = req_byte_size - last_free_page_run_size;
+    if (footprint_ + needed > capacity_) {
+      return NULL;
+    }
+    const size_t increment = std::min(std::max(needed, kMinGrowthIncrement),
+                                      capacity_ - footprint_);
+    DCHECK(IsAligned<kPageSize>(increment));
+    art_heap_rosalloc_morecore(this, increment);
+    if (last_free_page_run != NULL) {
+      free_page_runs_.erase(last_free_page_run);
+      result = last_free_page_run;
+      result->byte_size_ += increment;
+    } else {
+      result = reinterpret_cast<FreePageRun*>(base_ + footprint_);
+      result->magic_num_ = kMagicNumFree;
+      result->byte_size_ = increment;
+    }
+    footprint_ += increment;
+  }
+  // Put back the unused remainder.
+  if (result->byte_size_ > req_byte_size) {
+    FreePageRun* remainder = reinterpret_cast<FreePageRun*>(result->Begin() + req_byte_size);
+    remainder->magic_num_ = kMagicNumFree;
+    remainder->byte_size_ = result->byte_size_ - req_byte_size;
+    free_page_runs_.insert(remainder);
+  }
+  result->magic_num_ = 0;
+  const size_t page_map_idx = ToPageMapIndex(result);
+  page_map_[page_map_idx] = page_map_kind;
+  for (size_t i = 1; i < num_pages; ++i) {
+    // The part kinds directly follow their head kinds.
+    page_map_[page_map_idx + i] = page_map_kind + 1;
+  }
+  return result;
+}
+
+size_t RosAlloc::FreePages(Thread* self, void* ptr) {
+  const size_t pm_idx = ToPageMapIndex(ptr);
+  const byte kind = page_map_[pm_idx];
+  DCHECK(kind == kPageMapRun || kind == kPageMapLargeObject) << static_cast<int>(kind);
+  const byte part_kind = kind + 1;
+  page_map_[pm_idx] = kPageMapEmpty;
+  size_t num_pages = 1;
+  const size_t pm_end = footprint_ / kPageSize;
+  for (size_t i = pm_idx + 1; i < pm_end && page_map_[i] == part_kind; ++i) {
+    page_map_[i] = kPageMapEmpty;
+    ++num_pages;
+  }
+  FreePageRun* fpr = reinterpret_cast<FreePageRun*>(ptr);
+  fpr->magic_num_ = kMagicNumFree;
+  fpr->byte_size_ = num_pages * kPageSize;
+  InsertFreePageRun(fpr);
+  return num_pages * kPageSize;
+}
+
+void RosAlloc::InsertFreePageRun(FreePageRun* fpr) {
+  // Coalesce with the following free page run.
+  auto higher_it = free_page_runs_.upper_bound(fpr);
+  if (higher_it != free_page_runs_.end() && (*higher_it)->Begin() == fpr->End()) {
+    FreePageRun* higher = *higher_it;
+    fpr->byte_size_ += higher->byte_size_;
+    higher->magic_num_ = 0;
+    free_page_runs_.erase(higher_it);
+  }
+  // Coalesce with the preceding free page run, which keeps its position in the set.
+  auto lower_it = free_page_runs_.lower_bound(fpr);
+  if (lower_it != free_page_runs_.begin()) {
+    --lower_it;
+    FreePageRun* lower = *lower_it;
+    if (lower->End() == fpr->Begin()) {
+      lower->byte_size_ += fpr->byte_size_;
+      fpr->magic_num_ = 0;
+      return;
+    }
+  }
+  free_page_runs_.insert(fpr);
+}
+
+RosAlloc::Run* RosAlloc::RunForPage(size_t pm_idx) {
+  while (page_map_[pm_idx] == kPageMapRunPart) {
+    DCHECK_GT(pm_idx, 0U);
+    --pm_idx;
+  }
+  DCHECK_EQ(page_map_[pm_idx], kPageMapRun);
+  Run* run = reinterpret_cast<Run*>(base_ + pm_idx * kPageSize);
+  if (kCheckRuns) {
+    CHECK_EQ(run->magic_num_, kMagicNum);
+  }
+  return run;
+}
+
+size_t RosAlloc::Free(Thread* self, void* ptr) {
+  const size_t pm_idx = RoundDownToPageMapIndex(ptr);
+  Run* run;
+  {
+    MutexLock mu(self, lock_);
+    switch (page_map_[pm_idx]) {
+      case kPageMapLargeObject:
+        return FreePages(self, ptr);
+      case kPageMapRun:
+      case kPageMapRunPart:
+        run = RunForPage(pm_idx);
+        break;
+      default:
+        LOG(FATAL) << "Unreachable - page map kind: " << static_cast<int>(page_map_[pm_idx])
+                   << " for " << ptr;
+        return 0;
+    }
+  }
+  return FreeFromRun(self, ptr, run);
+}
+
+size_t RosAlloc::FreeFromRun(Thread* self, void* ptr, Run* run) {
+  const size_t idx = run->size_bracket_idx_;
+  MutexLock mu(self, *size_bracket_locks_[idx]);
+  if (run->is_thread_local_) {
+    // The owner merges the slot back when its run gets full.
+    return run->MarkThreadLocalFreeBitMap(ptr);
+  }
+  bool was_full = run->IsFull();
+  run->FreeSlot(ptr);
+  RecycleRun(self, run, was_full);
+  return bracket_sizes_[idx];
+}
+
+void RosAlloc::RecycleRun(Thread* self, Run* run, bool was_full) {
+  const size_t idx = run->size_bracket_idx_;
+  DCHECK(!run->is_thread_local_);
+  if (run->IsAllFree()) {
+    if (run == current_runs_[idx]) {
+      // Don't let an empty current run pin its pages, a fresh one is picked on the next allocation.
+      current_runs_[idx] = NULL;
+    } else if (!was_full) {
+      non_full_runs_[idx].erase(run);
+    }
+    run->magic_num_ = 0;
+    MutexLock mu(self, lock_);
+    FreePages(self, run);
+  } else if (was_full && run != current_runs_[idx]) {
+    non_full_runs_[idx].insert(run);
+  }
+}
+
+size_t RosAlloc::BulkFree(Thread* self, void** ptrs, size_t num_ptrs) {
+  // Only one bulk free at a time may use the runs' bulk free bitmaps.
+  MutexLock bulk_mu(self, bulk_free_lock_);
+  size_t freed_bytes = 0;
+  std::vector<Run*> runs;
+  {
+    MutexLock mu(self, lock_);
+    for (size_t i = 0; i < num_ptrs; ++i) {
+      void* ptr = ptrs[i];
+      const size_t pm_idx = RoundDownToPageMapIndex(ptr);
+      const byte kind = page_map_[pm_idx];
+      // Like dlmalloc's bulk free, clear the entries as they are freed.
+      ptrs[i] = NULL;
+      if (kind == kPageMapLargeObject) {
+        freed_bytes += FreePages(self, ptr);
+        continue;
+      }
+      DCHECK(kind == kPageMapRun || kind == kPageMapRunPart) << static_cast<int>(kind);
+      Run* run = RunForPage(pm_idx);
+      freed_bytes += run->MarkBulkFreeBitMap(ptr);
+      if (!run->to_be_bulk_freed_) {
+        run->to_be_bulk_freed_ = 1;
+        runs.push_back(run);
+      }
+    }
+  }
+  // Apply the bulk free bitmaps a run at a time.
+  for (Run* run : runs) {
+    const size_t idx = run->size_bracket_idx_;
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    run->to_be_bulk_freed_ = 0;
+    if (run->is_thread_local_) {
+      run->UnionBulkFreeBitMapToThreadLocalFreeBitMap();
+    } else {
+      bool was_full = run->IsFull();
+      run->MergeBulkFreeBitMapIntoAllocBitMap();
+      RecycleRun(self, run, was_full);
+    }
+  }
+  return freed_bytes;
+}
+
+size_t RosAlloc::UsableSize(const void* ptr) {
+  size_t pm_idx = RoundDownToPageMapIndex(ptr);
+  MutexLock mu(Thread::Current(), lock_);
+  switch (page_map_[pm_idx]) {
+    case kPageMapLargeObject: {
+      size_t num_pages = 1;
+      const size_t pm_end = footprint_ / kPageSize;
+      for (size_t i = pm_idx + 1; i < pm_end && page_map_[i] == kPageMapLargeObjectPart; ++i) {
+        ++num_pages;
+      }
+      return num_pages * kPageSize;
+    }
+    case kPageMapRun:
+    case kPageMapRunPart:
+      return bracket_sizes_[RunForPage(pm_idx)->size_bracket_idx_];
+    default:
+      LOG(FATAL) << "Unreachable - page map kind: " << static_cast<int>(page_map_[pm_idx])
+                 << " for " << ptr;
+      return 0;
+  }
+}
+
+void RosAlloc::RevokeThreadLocalRuns(Thread* thread) {
+  Thread* self = Thread::Current();
+  for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
+    Run* run = reinterpret_cast<Run*>(thread->GetRosAllocRun(idx));
+    if (run == NULL) {
+      continue;
+    }
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    DCHECK(run->is_thread_local_);
+    run->MergeThreadLocalFreeBitMapToAllocBitMap();
+    run->is_thread_local_ = 0;
+    thread->SetRosAllocRun(idx, NULL);
+    // The run wasn't in any list while it was thread-local, so treat it as if it had been full.
+    if (!run->IsFull()) {
+      RecycleRun(self, run, true);
+    }
+  }
+}
+
+size_t RosAlloc::Trim() {
+  MutexLock mu(Thread::Current(), lock_);
+  size_t reclaimed = 0;
+  // Give the free pages at the end of the footprint back, keeping at least the first page.
+  if (!free_page_runs_.empty()) {
+    FreePageRun* last = *free_page_runs_.rbegin();
+    if (last->End() == base_ + footprint_) {
+      size_t decrement = last->byte_size_;
+      free_page_runs_.erase(last);
+      if (last->Begin() == base_) {
+        decrement -= kPageSize;
+        last->byte_size_ = kPageSize;
+        free_page_runs_.insert(last);
+      } else {
+        last->magic_num_ = 0;
+      }
+      if (decrement > 0) {
+        art_heap_rosalloc_morecore(this, -static_cast<intptr_t>(decrement));
+        footprint_ -= decrement;
+        reclaimed += decrement;
+      }
+    }
+  }
+  // Advise the kernel that it can have the pages of the other free page runs, except for the first
+  // page of each which holds the run's header.
+  for (FreePageRun* fpr : free_page_runs_) {
+    if (fpr->byte_size_ > kPageSize) {
+      size_t length = fpr->byte_size_ - kPageSize;
+      if (UNLIKELY(madvise(fpr->Begin() + kPageSize, length, MADV_DONTNEED) != 0)) {
+        PLOG(FATAL) << "madvise failed during heap trimming";
+      }
+      reclaimed += length;
+    }
+  }
+  return reclaimed;
+}
+
+void RosAlloc::InspectAll(void (*handler)(void* start, void* end, size_t used_bytes,
+                                          void* callback_arg),
+                          void* arg) {
+  MutexLock mu(Thread::Current(), lock_);
+  const size_t pm_end = footprint_ / kPageSize;
+  for (size_t i = 0; i < pm_end;) {
+    byte* start = base_ + i * kPageSize;
+    switch (page_map_[i]) {
+      case kPageMapEmpty: {
+        FreePageRun* fpr = reinterpret_cast<FreePageRun*>(start);
+        DCHECK(free_page_runs_.find(fpr) != free_page_runs_.end());
+        handler(fpr->Begin(), fpr->End(), 0, arg);
+        i += fpr->byte_size_ / kPageSize;
+        break;
+      }
+      case kPageMapLargeObject: {
+        size_t num_pages = 1;
+        while (i + num_pages < pm_end && page_map_[i + num_pages] == kPageMapLargeObjectPart) {
+          ++num_pages;
+        }
+        handler(start, start + num_pages * kPageSize, num_pages * kPageSize, arg);
+        i += num_pages;
+        break;
+      }
+      case kPageMapRun: {
+        Run* run = reinterpret_cast<Run*>(start);
+        run->InspectAllSlots(handler, arg);
+        i += num_of_pages_[run->size_bracket_idx_];
+        break;
+      }
+      default:
+        LOG(FATAL) << "Unreachable - page map kind: " << static_cast<int>(page_map_[i]);
+        return;
+    }
+  }
+}
+
+size_t RosAlloc::Footprint() {
+  MutexLock mu(Thread::Current(), lock_);
+  return footprint_;
+}
+
+size_t RosAlloc::FootprintLimit() {
+  MutexLock mu(Thread::Current(), lock_);
+  return capacity_;
+}
+
+void RosAlloc::SetFootprintLimit(size_t new_capacity) {
+  MutexLock mu(Thread::Current(), lock_);
+  new_capacity = std::min(RoundUp(new_capacity, kPageSize), max_capacity_);
+  // Don't let the footprint limit go below the current footprint.
+  capacity_ = std::max(new_capacity, footprint_);
+}
+
+void RosAlloc::Run::InitBitMaps() {
+  const size_t num_vec = NumVecs();
+  memset(alloc_bit_map_, 0, 3 * num_vec * sizeof(uint32_t));
+  const size_t num_slots = num_of_slots_[size_bracket_idx_];
+  if (num_slots % 32 != 0) {
+    alloc_bit_map_[num_vec - 1] = ~0U << (num_slots % 32);
+  }
+}
+
+void* RosAlloc::Run::AllocSlot() {
+  const size_t num_vec = NumVecs();
+  for (size_t v = first_search_vec_idx_; v < num_vec; ++v) {
+    uint32_t vec = alloc_bit_map_[v];
+    if (~vec != 0) {
+      size_t bit = CTZ(~vec);
+      alloc_bit_map_[v] = vec | (1U << bit);
+      first_search_vec_idx_ = v;
+      byte* slot_addr = FirstSlot() + (v * 32 + bit) * bracket_sizes_[size_bracket_idx_];
+      return slot_addr;
+    }
+  }
+  first_search_vec_idx_ = num_vec;
+  return NULL;
+}
+
+size_t RosAlloc::Run::SlotIndex(void* ptr) {
+  const size_t bracket_size = bracket_sizes_[size_bracket_idx_];
+  const size_t offset = reinterpret_cast<byte*>(ptr) - FirstSlot();
+  DCHECK_EQ(offset % bracket_size, 0U) << ptr;
+  const size_t slot_idx = offset / bracket_size;
+  DCHECK_LT(slot_idx, num_of_slots_[size_bracket_idx_]);
+  return slot_idx;
+}
+
+void RosAlloc::Run::FreeSlot(void* ptr) {
+  const size_t slot_idx = SlotIndex(ptr);
+  const size_t v = slot_idx / 32;
+  const uint32_t mask = 1U << (slot_idx % 32);
+  DCHECK_NE(alloc_bit_map_[v] & mask, 0U) << "Double free of " << ptr;
+  alloc_bit_map_[v] &= ~mask;
+  first_search_vec_idx_ = std::min(first_search_vec_idx_, static_cast<uint32_t>(v));
+}
+
+size_t RosAlloc::Run::MarkBulkFreeBitMap(void* ptr) {
+  const size_t slot_idx = SlotIndex(ptr);
+  BulkFreeBitMap()[slot_idx / 32] |= 1U << (slot_idx % 32);
+  return bracket_sizes_[size_bracket_idx_];
+}
+
+size_t RosAlloc::Run::MarkThreadLocalFreeBitMap(void* ptr) {
+  const size_t slot_idx = SlotIndex(ptr);
+  ThreadLocalFreeBitMap()[slot_idx / 32] |= 1U << (slot_idx % 32);
+  return bracket_sizes_[size_bracket_idx_];
+}
+
+void RosAlloc::Run::MergeBulkFreeBitMapIntoAllocBitMap() {
+  const size_t num_vec = NumVecs();
+  uint32_t* bulk_free_bit_map = BulkFreeBitMap();
+  for (size_t v = 0; v < num_vec; ++v) {
+    uint32_t freed = bulk_free_bit_map[v];
+    if (freed != 0) {
+      DCHECK_EQ(alloc_bit_map_[v] & freed, freed);
+      alloc_bit_map_[v] &= ~freed;
+      bulk_free_bit_map[v] = 0;
+      first_search_vec_idx_ = std::min(first_search_vec_idx_, static_cast<uint32_t>(v));
+    }
+  }
+}
+
+void RosAlloc::Run::UnionBulkFreeBitMapToThreadLocalFreeBitMap() {
+  const size_t num_vec = NumVecs();
+  uint32_t* bulk_free_bit_map = BulkFreeBitMap();
+  uint32_t* thread_local_free_bit_map = ThreadLocalFreeBitMap();
+  for (size_t v = 0; v < num_vec; ++v) {
+    thread_local_free_bit_map[v] |= bulk_free_bit_map[v];
+    bulk_free_bit_map[v] = 0;
+  }
+}
+
+bool RosAlloc::Run::MergeThreadLocalFreeBitMapToAllocBitMap() {
+  const size_t num_vec = NumVecs();
+  uint32_t* thread_local_free_bit_map = ThreadLocalFreeBitMap();
+  bool changed = false;
+  for (size_t v = 0; v < num_vec; ++v) {
+    uint32_t freed = thread_local_free_bit_map[v];
+    if (freed != 0) {
+      alloc_bit_map_[v] &= ~freed;
+      thread_local_free_bit_map[v] = 0;
+      first_search_vec_idx_ = std::min(first_search_vec_idx_, static_cast<uint32_t>(v));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool RosAlloc::Run::IsAllFree() {
+  const size_t num_vec = NumVecs();
+  const size_t num_slots = num_of_slots_[size_bracket_idx_];
+  const uint32_t tail_mask = num_slots % 32 != 0 ? ~0U << (num_slots % 32) : 0U;
+  for (size_t v = 0; v < num_vec - 1; ++v) {
+    if (alloc_bit_map_[v] != 0) {
+      return false;
+    }
+  }
+  return alloc_bit_map_[num_vec - 1] == tail_mask;
+}
+
+bool RosAlloc::Run::IsFull() {
+  const size_t num_vec = NumVecs();
+  for (size_t v = 0; v < num_vec; ++v) {
+    if (~alloc_bit_map_[v] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t RosAlloc::Run::NumAllocatedSlots() {
+  const size_t num_vec = NumVecs();
+  const size_t num_slots = num_of_slots_[size_bracket_idx_];
+  size_t count = 0;
+  for (size_t v = 0; v < num_vec; ++v) {
+    count += __builtin_popcount(alloc_bit_map_[v]);
+  }
+  // Discount the always set bits past the last slot.
+  return count - (num_vec * 32 - num_slots);
+}
+
+void RosAlloc::Run::InspectAllSlots(void (*handler)(void* start, void* end, size_t used_bytes,
+                                                    void* callback_arg),
+                                    void* arg) {
+  const size_t bracket_size = bracket_sizes_[size_bracket_idx_];
+  const size_t num_slots = num_of_slots_[size_bracket_idx_];
+  byte* slot_addr = FirstSlot();
+  for (size_t i = 0; i < num_slots; ++i, slot_addr += bracket_size) {
+    bool is_allocated = (alloc_bit_map_[i / 32] & (1U << (i % 32))) != 0;
+    handler(slot_addr, slot_addr + bracket_size, is_allocated ? bracket_size : 0, arg);
+  }
+}
+
+}  // namespace allocator
+}  // namespace gc
+}  // namespace art
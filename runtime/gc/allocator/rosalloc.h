@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATOR_ROSALLOC_H_
+#define ART_RUNTIME_GC_ALLOCATOR_ROSALLOC_H_
+
+#include <set>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/mman.h>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/mutex.h"
+#include "globals.h"
+#include "mem_map.h"
+#include "UniquePtr.h"
+#include "utils.h"
+
+namespace art {
+
+class Thread;
+
+namespace gc {
+namespace allocator {
+
+// A "runs of slots" memory allocator. Small requests are rounded up to one of kNumOfSizeBrackets
+// size brackets and served from a run, a group of contiguous pages holding equally sized slots
+// whose allocation state is kept in a bitmap in the run's header. The smallest brackets are
+// served from runs owned by the allocating thread so they need no locking. Requests larger than
+// the largest bracket are served as whole pages. Pages are tracked with a byte per page in the
+// page map, free pages are kept as address ordered runs that are coalesced on free.
+class RosAlloc {
+ public:
+  // The number of size brackets.
+  static const size_t kNumOfSizeBrackets = 34;
+
+  // The number of smaller size brackets, up to 128 bytes, that are served from thread-local runs.
+  // Sync this with kRosAllocNumThreadLocalSizeBrackets in thread.h.
+  static const size_t kNumThreadLocalSizeBrackets = 8;
+
+  // The bracket sizes are multiples of this up to kMaxRegularBracketSize, then 1KB and 2KB.
+  static const size_t kQuantumSize = 16;
+  static const size_t kMaxRegularBracketSize = 512;
+
+  // Requests larger than this are allocated as whole pages.
+  static const size_t kLargeSizeThreshold = 2 * KB;
+
+  // If true, check the run magic numbers and free page run invariants.
+  static constexpr bool kCheckRuns = kIsDebugBuild;
+
+  // Create an allocator managing the memory starting at base. The first initial_footprint bytes
+  // must be accessible, the allocator obtains more via art_heap_rosalloc_morecore as it grows
+  // up to the footprint limit, which starts at initial_footprint_limit.
+  RosAlloc(void* base, size_t initial_footprint, size_t initial_footprint_limit,
+           size_t max_capacity);
+
+  // Allocate num_bytes, the memory is not zeroed. Returns NULL if the request can't be satisfied
+  // without growing beyond the footprint limit.
+  void* Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated)
+      LOCKS_EXCLUDED(lock_);
+
+  // Free a single allocation. Returns the number of bytes freed.
+  size_t Free(Thread* self, void* ptr) LOCKS_EXCLUDED(bulk_free_lock_, lock_);
+
+  // Free a batch of allocations, as done by the sweepers. The slots are first marked in each run's
+  // bulk free bitmap, then merged into the run's allocation bitmap a word at a time. Returns the
+  // number of bytes freed.
+  size_t BulkFree(Thread* self, void** ptrs, size_t num_ptrs)
+      LOCKS_EXCLUDED(bulk_free_lock_, lock_);
+
+  // Returns the size of the slot or page run holding ptr.
+  size_t UsableSize(const void* ptr);
+
+  // Hand thread's thread-local runs back to the allocator. The thread must either be the caller
+  // or be suspended.
+  void RevokeThreadLocalRuns(Thread* thread);
+
+  // Release the free pages at the end of the footprint back to the system and madvise the other
+  // free page runs. Returns the number of bytes reclaimed.
+  size_t Trim() LOCKS_EXCLUDED(lock_);
+
+  // Call handler for each run slot, large object and free page run. num_bytes is zero for free
+  // memory. Thread-local runs are read without synchronization, so callers wanting exact results
+  // must suspend the mutators.
+  void InspectAll(void (*handler)(void* start, void* end, size_t used_bytes, void* callback_arg),
+                  void* arg) LOCKS_EXCLUDED(lock_);
+
+  size_t Footprint() LOCKS_EXCLUDED(lock_);
+  size_t FootprintLimit() LOCKS_EXCLUDED(lock_);
+  void SetFootprintLimit(size_t bytes) LOCKS_EXCLUDED(lock_);
+
+  // Returns the bracket index and size used for a request of num_bytes.
+  static size_t SizeToIndexAndBracketSize(size_t num_bytes, size_t* bracket_size) {
+    DCHECK_LE(num_bytes, kLargeSizeThreshold);
+    if (LIKELY(num_bytes <= kMaxRegularBracketSize)) {
+      size_t size = RoundUp(num_bytes == 0 ? 1 : num_bytes, kQuantumSize);
+      *bracket_size = size;
+      return size / kQuantumSize - 1;
+    } else if (num_bytes <= 1 * KB) {
+      *bracket_size = 1 * KB;
+      return kNumOfSizeBrackets - 2;
+    } else {
+      *bracket_size = 2 * KB;
+      return kNumOfSizeBrackets - 1;
+    }
+  }
+
+  static size_t BracketSize(size_t idx) {
+    return bracket_sizes_[idx];
+  }
+
+ private:
+  // The page map states. kPageMapEmpty pages are free or beyond the footprint.
+  enum PageMapKind {
+    kPageMapEmpty = 0,
+    kPageMapRun,
+    kPageMapRunPart,
+    kPageMapLargeObject,
+    kPageMapLargeObjectPart,
+  };
+
+  // A run of free pages. The header lives in the first page which is never madvised.
+  class FreePageRun {
+   public:
+    uint32_t magic_num_;
+    size_t byte_size_;
+
+    byte* Begin() {
+      return reinterpret_cast<byte*>(this);
+    }
+    byte* End() {
+      return Begin() + byte_size_;
+    }
+  };
+
+  // A run of slots of a single size bracket. The header is followed by three bitmaps of
+  // num_of_slots_ bits each, the allocation bitmap, the bulk free bitmap and the thread-local
+  // free bitmap, then by the slots themselves.
+  class Run {
+   public:
+    uint8_t magic_num_;
+    uint8_t size_bracket_idx_;
+    // Set while the run is owned by a thread. Only the owner allocates from it and frees from other
+    // threads go to the thread-local free bitmap instead of the allocation bitmap.
+    uint8_t is_thread_local_;
+    // Set while the run is in the list of runs of an ongoing BulkFree.
+    uint8_t to_be_bulk_freed_;
+    // Index of the first allocation bitmap word that may have a clear bit.
+    uint32_t first_search_vec_idx_;
+    uint32_t alloc_bit_map_[0];
+
+    uint32_t* BulkFreeBitMap() {
+      return reinterpret_cast<uint32_t*>(reinterpret_cast<byte*>(this) +
+                                         bulk_free_bit_map_offsets_[size_bracket_idx_]);
+    }
+    uint32_t* ThreadLocalFreeBitMap() {
+      return reinterpret_cast<uint32_t*>(reinterpret_cast<byte*>(this) +
+                                         thread_local_free_bit_map_offsets_[size_bracket_idx_]);
+    }
+    byte* FirstSlot() {
+      return reinterpret_cast<byte*>(this) + header_sizes_[size_bracket_idx_];
+    }
+    size_t NumVecs() const {
+      return RoundUp(num_of_slots_[size_bracket_idx_], 32) / 32;
+    }
+
+    // Clear the bitmaps and mark the bits past the last slot as allocated so that they are never
+    // handed out.
+    void InitBitMaps();
+    // Returns a free slot or NULL if the run is full.
+    void* AllocSlot();
+    // Free a slot of a run that isn't thread-local.
+    void FreeSlot(void* ptr);
+    // Mark ptr in the bulk free bitmap. Returns the bracket size.
+    size_t MarkBulkFreeBitMap(void* ptr);
+    // Mark ptr in the thread-local free bitmap. Returns the bracket size.
+    size_t MarkThreadLocalFreeBitMap(void* ptr);
+    // Clear the bits of the bulk free bitmap from the allocation bitmap.
+    void MergeBulkFreeBitMapIntoAllocBitMap();
+    // Move the bits of the bulk free bitmap to the thread-local free bitmap.
+    void UnionBulkFreeBitMapToThreadLocalFreeBitMap();
+    // Clear the bits of the thread-local free bitmap from the allocation bitmap. Returns true if
+    // any slot was freed.
+    bool MergeThreadLocalFreeBitMapToAllocBitMap();
+    bool IsAllFree();
+    bool IsFull();
+    size_t NumAllocatedSlots();
+    // Call handler for each slot of the run.
+    void InspectAllSlots(void (*handler)(void* start, void* end, size_t used_bytes,
+                                         void* callback_arg),
+                         void* arg);
+
+   private:
+    size_t SlotIndex(void* ptr);
+  };
+
+  static const uint8_t kMagicNum = 42;
+  static const uint32_t kMagicNumFree = 43;
+
+  // Per bracket run geometry, computed once by Initialize().
+  static size_t bracket_sizes_[kNumOfSizeBrackets];
+  static size_t num_of_pages_[kNumOfSizeBrackets];
+  static size_t num_of_slots_[kNumOfSizeBrackets];
+  static size_t header_sizes_[kNumOfSizeBrackets];
+  static size_t bulk_free_bit_map_offsets_[kNumOfSizeBrackets];
+  static size_t thread_local_free_bit_map_offsets_[kNumOfSizeBrackets];
+  static bool initialized_;
+  static void Initialize();
+
+  size_t ToPageMapIndex(const void* addr) const {
+    DCHECK_GE(reinterpret_cast<const byte*>(addr), base_);
+    size_t byte_offset = reinterpret_cast<const byte*>(addr) - base_;
+    DCHECK_EQ(byte_offset % kPageSize, 0U);
+    return byte_offset / kPageSize;
+  }
+  size_t RoundDownToPageMapIndex(const void* addr) const {
+    DCHECK(base_ <= addr && addr < base_ + max_capacity_);
+    return (reinterpret_cast<uintptr_t>(addr) - reinterpret_cast<uintptr_t>(base_)) / kPageSize;
+  }
+
+  // Returns the run containing the page with index pm_idx.
+  Run* RunForPage(size_t pm_idx);
+
+  // Allocate num_pages contiguous pages, growing the footprint if needed.
+  void* AllocPages(Thread* self, size_t num_pages, byte page_map_kind)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Free the run or large object starting at ptr. Returns the number of bytes freed.
+  size_t FreePages(Thread* self, void* ptr) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void InsertFreePageRun(FreePageRun* fpr) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  void* AllocLargeObject(Thread* self, size_t num_bytes, size_t* bytes_allocated)
+      LOCKS_EXCLUDED(lock_);
+  // Allocate a fresh run for bracket idx.
+  Run* AllocRun(Thread* self, size_t idx) LOCKS_EXCLUDED(lock_);
+  // Take a non full run of bracket idx, or allocate a fresh one. The bracket lock must be held.
+  Run* RefillRun(Thread* self, size_t idx);
+  // Allocate from the shared current run of bracket idx. The bracket lock must be held.
+  void* AllocFromCurrentRunUnlocked(Thread* self, size_t idx);
+  // Put a run whose bitmaps changed back in the right list, or free it if it became empty. The
+  // bracket lock must be held.
+  void RecycleRun(Thread* self, Run* run, bool was_full);
+  size_t FreeFromRun(Thread* self, void* ptr, Run* run) LOCKS_EXCLUDED(lock_);
+
+  // The start of the managed memory.
+  byte* const base_;
+
+  // The footprint in bytes of the currently committed memory.
+  size_t footprint_ GUARDED_BY(lock_);
+
+  // The maximum footprint, adjusted by SetFootprintLimit.
+  size_t capacity_ GUARDED_BY(lock_);
+
+  // The size of the reserved memory the page map covers.
+  const size_t max_capacity_;
+
+  // The shared runs of the larger brackets, guarded by the bracket locks.
+  Run* current_runs_[kNumOfSizeBrackets];
+  // The runs with free slots that no thread owns and aren't current, guarded by the bracket locks.
+  std::set<Run*> non_full_runs_[kNumOfSizeBrackets];
+  UniquePtr<Mutex> size_bracket_locks_[kNumOfSizeBrackets];
+
+  // The address ordered free page runs.
+  std::set<FreePageRun*> free_page_runs_ GUARDED_BY(lock_);
+
+  // One PageMapKind byte per page.
+  UniquePtr<MemMap> page_map_mem_map_;
+  byte* page_map_;
+
+  // Guards the page map, the free page runs and the footprint. Acquired after the bracket locks.
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+
+  // Serializes BulkFree calls, acquired before the bracket locks.
+  Mutex bulk_free_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+
+  DISALLOW_COPY_AND_ASSIGN(RosAlloc);
+};
+
+// Callback from rosalloc when it needs to increase or decrease the footprint. Implemented by the
+// alloc space owning the allocator.
+void* art_heap_rosalloc_morecore(RosAlloc* rosalloc, intptr_t increment);
+
+}  // namespace allocator
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATOR_ROSALLOC_H_
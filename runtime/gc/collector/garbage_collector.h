@@ -22,6 +22,7 @@
 #include "base/timing_logger.h"
 
 #include <stdint.h>
+#include <ostream>
 #include <vector>
 
 namespace art {
@@ -72,7 +73,35 @@ class GarbageCollector {
     return cumulative_timings_;
   }
 
-  void ResetCumulativeStatistics();
+  virtual void ResetCumulativeStatistics();
+
+  // Dumps collector specific cumulative statistics after the common ones.
+  virtual void DumpPerformanceInfo(std::ostream& os) {}
+
+  // Appends collector specific details of the last run to the GC log line.
+  virtual void DumpLogInfo(std::ostream& os) const {}
+
+  // How many objects and bytes the last run freed, outside and inside of the large object space.
+  virtual size_t GetFreedBytes() const = 0;
+  virtual size_t GetFreedObjects() const = 0;
+  virtual size_t GetFreedLargeObjectBytes() const = 0;
+  virtual size_t GetFreedLargeObjects() const = 0;
+
+  uint64_t GetTotalTimeNs() const {
+    return total_time_ns_;
+  }
+
+  uint64_t GetTotalPausedTimeNs() const {
+    return total_paused_time_ns_;
+  }
+
+  uint64_t GetTotalFreedObjects() const {
+    return total_freed_objects_;
+  }
+
+  uint64_t GetTotalFreedBytes() const {
+    return total_freed_bytes_;
+  }
 
   // Swap the live and mark bitmaps of spaces that are active for the collector. For partial GC,
   // this is the allocation space, for full GC then we swap the zygote bitmaps too.
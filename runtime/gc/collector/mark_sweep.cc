@@ -19,16 +19,19 @@
 #include <functional>
 #include <numeric>
 #include <climits>
+#include <limits>
 #include <vector>
 
 #include "base/bounded_fifo.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/mutex-inl.h"
+#include "base/stl_util.h"
 #include "base/timing_logger.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/accounting/work_stealing_deque.h"
 #include "gc/heap.h"
 #include "gc/space/image_space.h"
 #include "gc/space/large_object_space.h"
@@ -74,6 +77,20 @@ constexpr bool kParallelRecursiveMark = true;
 // ProcessMarkStack with very small mark stacks.
 constexpr size_t kMinimumParallelMarkStackSize = 128;
 constexpr bool kParallelProcessMarkStack = true;
+// Initial capacity of the per thread mark deques, they grow as needed.
+constexpr size_t kMarkDequeInitialCapacity = 4 * KB;
+constexpr bool kParallelSweep = true;
+// Sweep chunks start and end on page boundaries, so that no two chunks share a bitmap word, and
+// are at least this big to amortize the task overhead.
+constexpr size_t kMinimumSweepChunkSize = 256 * KB;
+// Don't sweep the large object space in parallel unless there are at least this many objects.
+constexpr size_t kMinimumParallelLargeObjectSweep = 64;
+
+// Concurrent pre-cleaning options. Passes stop once a pass finds fewer dirty cards than the
+// threshold, or when the mutators dirty cards faster than they get cleaned.
+constexpr bool kPreCleanCards = true;
+constexpr size_t kMaxPreCleanPasses = 4;
+constexpr size_t kPreCleanDirtyCardThreshold = 64;
 
 // Profiling and information flags.
 constexpr bool kCountClassesMarked = false;
@@ -146,7 +163,12 @@ MarkSweep::MarkSweep(Heap* heap, bool is_concurrent, const std::string& name_pre
       large_object_lock_("mark sweep large object lock", kMarkSweepLargeObjectLock),
       mark_stack_lock_("mark sweep mark stack lock", kMarkSweepMarkStackLock),
       is_concurrent_(is_concurrent),
-      clear_soft_references_(false) {
+      clear_soft_references_(false),
+      num_mark_deques_(0) {
+}
+
+MarkSweep::~MarkSweep() {
+  STLDeleteElements(&mark_deques_);
 }
 
 void MarkSweep::InitializePhase() {
@@ -174,6 +196,9 @@ void MarkSweep::InitializePhase() {
   work_chunks_created_ = 0;
   work_chunks_deleted_ = 0;
   reference_count_ = 0;
+  pre_clean_passes_ = 0;
+  pre_cleaned_cards_ = 0;
+  paused_dirty_cards_ = 0;
   java_lang_Class_ = Class::GetJavaLangClass();
   CHECK(java_lang_Class_ != nullptr);
 
@@ -196,6 +221,11 @@ bool MarkSweep::HandleDirtyObjectsPhase() {
   Thread* self = Thread::Current();
   Locks::mutator_lock_->AssertExclusiveHeld(self);
 
+  // Account the objects in the thread-local allocation buffers before anything gets swept.
+  timings_.StartSplit("RevokeAllThreadLocalBuffers");
+  heap_->RevokeAllThreadLocalBuffers();
+  timings_.EndSplit();
+
   {
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
 
@@ -204,6 +234,7 @@ bool MarkSweep::HandleDirtyObjectsPhase() {
 
     // Scan dirty objects, this is only required if we are not doing concurrent GC.
     RecursiveMarkDirtyObjects(true, accounting::CardTable::kCardDirty);
+    paused_dirty_cards_ = cards_scanned_;
   }
 
   ProcessReferences(self);
@@ -266,6 +297,61 @@ void MarkSweep::MarkingPhase() {
 
   heap_->UpdateAndMarkModUnion(this, timings_, GetGcType());
   MarkReachableObjects();
+
+  if (kPreCleanCards && IsConcurrent()) {
+    PreCleanCards();
+  }
+}
+
+// Turns the dirty cards into pre-cleaned ones. Aged cards were dirtied before the collection
+// started and are already taken care of, they become clean.
+class PreCleanCardVisitor {
+ public:
+  byte operator()(byte card) const {
+    if (card == accounting::CardTable::kCardDirty) {
+      return accounting::CardTable::kCardPreCleaned;
+    } else if (card == accounting::CardTable::kCardDirty - 1) {
+      return accounting::CardTable::kCardClean;
+    }
+    return card;
+  }
+};
+
+class CountDirtyCardVisitor {
+ public:
+  explicit CountDirtyCardVisitor(size_t* count) : count_(count) {}
+
+  void operator()(byte* /* card */, byte expected_value, byte /* new_value */) const {
+    if (expected_value == accounting::CardTable::kCardDirty) {
+      ++*count_;
+    }
+  }
+
+ private:
+  size_t* const count_;
+};
+
+void MarkSweep::PreCleanCards() {
+  accounting::CardTable* card_table = GetHeap()->GetCardTable();
+  size_t last_dirty_cards = std::numeric_limits<size_t>::max();
+  while (pre_clean_passes_ < kMaxPreCleanPasses) {
+    base::TimingLogger::ScopedSplit split("PreCleanCards", &timings_);
+    // A card must be cleaned before its objects get scanned, a mutator writing to one of them
+    // afterwards dirties it again.
+    size_t dirty_cards = 0;
+    for (const auto& space : GetHeap()->GetContinuousSpaces()) {
+      card_table->ModifyCardsAtomic(space->Begin(), space->End(), PreCleanCardVisitor(),
+                                    CountDirtyCardVisitor(&dirty_cards));
+    }
+    ++pre_clean_passes_;
+    pre_cleaned_cards_ += dirty_cards;
+    // Also picks up the cards which were dirtied again in the meantime.
+    RecursiveMarkDirtyObjects(false, accounting::CardTable::kCardPreCleaned);
+    if (dirty_cards < kPreCleanDirtyCardThreshold || dirty_cards >= last_dirty_cards) {
+      break;
+    }
+    last_dirty_cards = dirty_cards;
+  }
 }
 
 void MarkSweep::MarkThreadRoots(Thread* self) {
@@ -290,6 +376,10 @@ void MarkSweep::ReclaimPhase() {
   Thread* self = Thread::Current();
 
   if (!IsConcurrent()) {
+    // All mutators are suspended, account the objects in their allocation buffers before sweeping.
+    timings_.StartSplit("RevokeAllThreadLocalBuffers");
+    heap_->RevokeAllThreadLocalBuffers();
+    timings_.EndSplit();
     ProcessReferences(self);
   }
 
@@ -519,24 +609,27 @@ void MarkSweep::MarkRoot(const Object* obj) {
   }
 }
 
-void MarkSweep::MarkRootParallelCallback(const Object* root, void* arg) {
+Object* MarkSweep::MarkRootParallelCallback(Object* root, void* arg) {
   DCHECK(root != NULL);
   DCHECK(arg != NULL);
   reinterpret_cast<MarkSweep*>(arg)->MarkObjectNonNullParallel(root);
+  return root;
 }
 
-void MarkSweep::MarkObjectCallback(const Object* root, void* arg) {
+Object* MarkSweep::MarkObjectCallback(Object* root, void* arg) {
   DCHECK(root != NULL);
   DCHECK(arg != NULL);
   MarkSweep* mark_sweep = reinterpret_cast<MarkSweep*>(arg);
   mark_sweep->MarkObjectNonNull(root);
+  return root;
 }
 
-void MarkSweep::ReMarkObjectVisitor(const Object* root, void* arg) {
+Object* MarkSweep::ReMarkObjectVisitor(Object* root, void* arg) {
   DCHECK(root != NULL);
   DCHECK(arg != NULL);
   MarkSweep* mark_sweep = reinterpret_cast<MarkSweep*>(arg);
   mark_sweep->MarkObjectNonNull(root);
+  return root;
 }
 
 void MarkSweep::VerifyRootCallback(const Object* root, void* arg, size_t vreg,
@@ -599,8 +692,8 @@ void MarkSweep::VerifyImageRootVisitor(Object* root, void* arg) {
 }
 
 void MarkSweep::BindLiveToMarkBitmap(space::ContinuousSpace* space) {
-  CHECK(space->IsDlMallocSpace());
-  space::DlMallocSpace* alloc_space = space->AsDlMallocSpace();
+  CHECK(space->IsMallocSpace());
+  space::MallocSpace* alloc_space = space->AsMallocSpace();
   accounting::SpaceBitmap* live_bitmap = space->GetLiveBitmap();
   accounting::SpaceBitmap* mark_bitmap = alloc_space->mark_bitmap_.release();
   GetHeap()->GetMarkBitmap()->ReplaceBitmap(mark_bitmap, live_bitmap);
@@ -788,6 +881,7 @@ void MarkSweep::ScanGrayObjects(bool paused, byte minimum_age) {
   accounting::CardTable* card_table = GetHeap()->GetCardTable();
   ThreadPool* thread_pool = GetHeap()->GetThreadPool();
   size_t thread_count = GetThreadCount(paused);
+  cards_scanned_ = 0;
   // The parallel version with only one thread is faster for card scanning, TODO: fix.
   if (kParallelCardScan && thread_count > 0) {
     Thread* self = Thread::Current();
@@ -804,7 +898,6 @@ void MarkSweep::ScanGrayObjects(bool paused, byte minimum_age) {
     const size_t mark_stack_delta = std::min(CardScanTask::kMaxSize / 2,
                                              mark_stack_size / mark_stack_tasks + 1);
     size_t ref_card_count = 0;
-    cards_scanned_ = 0;
     for (const auto& space : GetHeap()->GetContinuousSpaces()) {
       byte* card_begin = space->Begin();
       byte* card_end = space->End();
@@ -868,7 +961,8 @@ void MarkSweep::ScanGrayObjects(bool paused, byte minimum_age) {
           break;
         }
       ScanObjectVisitor visitor(this);
-      card_table->Scan(space->GetMarkBitmap(), space->Begin(), space->End(), visitor, minimum_age);
+      cards_scanned_.fetch_add(card_table->Scan(space->GetMarkBitmap(), space->Begin(),
+                                                space->End(), visitor, minimum_age));
       timings_.EndSplit();
     }
   }
@@ -990,8 +1084,11 @@ void MarkSweep::RecursiveMark() {
   ProcessMarkStack(false);
 }
 
-bool MarkSweep::IsMarkedCallback(const Object* object, void* arg) {
-  return reinterpret_cast<MarkSweep*>(arg)->IsMarked(object);
+Object* MarkSweep::IsMarkedCallback(Object* object, void* arg) {
+  if (reinterpret_cast<MarkSweep*>(arg)->IsMarked(object)) {
+    return object;
+  }
+  return NULL;
 }
 
 void MarkSweep::RecursiveMarkDirtyObjects(bool paused, byte minimum_age) {
@@ -1005,7 +1102,7 @@ void MarkSweep::ReMarkRoots() {
   timings_.EndSplit();
 }
 
-void MarkSweep::SweepJniWeakGlobals(IsMarkedTester is_marked, void* arg) {
+void MarkSweep::SweepJniWeakGlobals(::art::IsMarkedCallback* is_marked, void* arg) {
   Runtime::Current()->GetJavaVM()->SweepWeakGlobals(is_marked, arg);
 }
 
@@ -1036,10 +1133,10 @@ void MarkSweep::SweepSystemWeaks() {
   timings_.EndSplit();
 }
 
-bool MarkSweep::VerifyIsLiveCallback(const Object* obj, void* arg) {
+Object* MarkSweep::VerifyIsLiveCallback(Object* obj, void* arg) {
   reinterpret_cast<MarkSweep*>(arg)->VerifyIsLive(obj);
   // We don't actually want to sweep the object, so lets return "marked"
-  return true;
+  return obj;
 }
 
 void MarkSweep::VerifyIsLive(const Object* obj) {
@@ -1069,6 +1166,10 @@ struct SweepCallbackContext {
   MarkSweep* mark_sweep;
   space::AllocSpace* space;
   Thread* self;
+  // Garbage handed out by SweepWalk, freed kSweepArrayChunkFreeSize objects at a time so that
+  // concurrent sweepers take the allocator lock less often.
+  size_t pending_count;
+  Object* pending[kSweepArrayChunkFreeSize];
 };
 
 class CheckpointMarkThreadRoots : public Closure {
@@ -1112,25 +1213,31 @@ void MarkSweep::MarkRootsCheckpoint(Thread* self) {
 
 void MarkSweep::SweepCallback(size_t num_ptrs, Object** ptrs, void* arg) {
   SweepCallbackContext* context = static_cast<SweepCallbackContext*>(arg);
-  MarkSweep* mark_sweep = context->mark_sweep;
-  Heap* heap = mark_sweep->GetHeap();
-  space::AllocSpace* space = context->space;
-  Thread* self = context->self;
-  Locks::heap_bitmap_lock_->AssertExclusiveHeld(self);
+  DCHECK_LE(num_ptrs, kSweepArrayChunkFreeSize);
+  if (context->pending_count + num_ptrs > kSweepArrayChunkFreeSize) {
+    FlushSweepCallbackContext(context);
+  }
+  std::copy(ptrs, ptrs + num_ptrs, &context->pending[context->pending_count]);
+  context->pending_count += num_ptrs;
+}
+
+void MarkSweep::FlushSweepCallbackContext(SweepCallbackContext* context) {
+  size_t freed_objects = context->pending_count;
+  if (freed_objects == 0) {
+    return;
+  }
   // Use a bulk free, that merges consecutive objects before freeing or free per object?
   // Documentation suggests better free performance with merging, but this may be at the expensive
   // of allocation.
-  size_t freed_objects = num_ptrs;
-  // AllocSpace::FreeList clears the value in ptrs, so perform after clearing the live bit
-  size_t freed_bytes = space->FreeList(self, num_ptrs, ptrs);
-  heap->RecordFree(freed_objects, freed_bytes);
-  mark_sweep->freed_objects_.fetch_add(freed_objects);
-  mark_sweep->freed_bytes_.fetch_add(freed_bytes);
+  size_t freed_bytes = context->space->FreeList(context->self, freed_objects, context->pending);
+  context->pending_count = 0;
+  // The heap is told about the freed memory once the whole sweep is done.
+  context->mark_sweep->freed_objects_.fetch_add(freed_objects);
+  context->mark_sweep->freed_bytes_.fetch_add(freed_bytes);
 }
 
 void MarkSweep::ZygoteSweepCallback(size_t num_ptrs, Object** ptrs, void* arg) {
   SweepCallbackContext* context = static_cast<SweepCallbackContext*>(arg);
-  Locks::heap_bitmap_lock_->AssertExclusiveHeld(context->self);
   Heap* heap = context->mark_sweep->GetHeap();
   // We don't free any actual memory to avoid dirtying the shared zygote pages.
   for (size_t i = 0; i < num_ptrs; ++i) {
@@ -1141,7 +1248,7 @@ void MarkSweep::ZygoteSweepCallback(size_t num_ptrs, Object** ptrs, void* arg) {
 }
 
 void MarkSweep::SweepArray(accounting::ObjectStack* allocations, bool swap_bitmaps) {
-  space::DlMallocSpace* space = heap_->GetAllocSpace();
+  space::MallocSpace* space = heap_->GetAllocSpace();
   timings_.StartSplit("SweepArray");
   // Newly allocated objects MUST be in the alloc space and those are the only objects which we are
   // going to free.
@@ -1218,14 +1325,69 @@ void MarkSweep::SweepArray(accounting::ObjectStack* allocations, bool swap_bitma
   timings_.EndSplit();
 }
 
+void MarkSweep::SweepRange(Thread* self, space::ContinuousSpace* space,
+                           accounting::SpaceBitmap* live_bitmap,
+                           accounting::SpaceBitmap* mark_bitmap, uintptr_t begin, uintptr_t end) {
+  SweepCallbackContext scc;
+  scc.mark_sweep = this;
+  scc.space = space->AsMallocSpace();
+  scc.self = self;
+  scc.pending_count = 0;
+  if (!space->IsZygoteSpace()) {
+    // Bitmaps are pre-swapped for optimization which enables sweeping with the heap unlocked.
+    accounting::SpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, begin, end,
+                                       &SweepCallback, reinterpret_cast<void*>(&scc));
+    FlushSweepCallbackContext(&scc);
+  } else {
+    // Zygote sweep takes care of dirtying cards and clearing live bits, does not free actual
+    // memory.
+    accounting::SpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, begin, end,
+                                       &ZygoteSweepCallback, reinterpret_cast<void*>(&scc));
+  }
+}
+
+class SweepTask : public Task {
+ public:
+  SweepTask(MarkSweep* mark_sweep, space::ContinuousSpace* space,
+            accounting::SpaceBitmap* live_bitmap, accounting::SpaceBitmap* mark_bitmap,
+            uintptr_t begin, uintptr_t end)
+      : mark_sweep_(mark_sweep),
+        space_(space),
+        live_bitmap_(live_bitmap),
+        mark_bitmap_(mark_bitmap),
+        begin_(begin),
+        end_(end) {
+  }
+
+ protected:
+  MarkSweep* const mark_sweep_;
+  space::ContinuousSpace* const space_;
+  accounting::SpaceBitmap* const live_bitmap_;
+  accounting::SpaceBitmap* const mark_bitmap_;
+  const uintptr_t begin_;
+  const uintptr_t end_;
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+  // The thread running the collection holds the heap bitmap lock for us.
+  virtual void Run(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+    mark_sweep_->SweepRange(self, space_, live_bitmap_, mark_bitmap_, begin_, end_);
+  }
+};
+
 void MarkSweep::Sweep(bool swap_bitmaps) {
   DCHECK(mark_stack_->IsEmpty());
   base::TimingLogger::ScopedSplit("Sweep", &timings_);
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  size_t thread_count = GetThreadCount(!IsConcurrent());
+  const bool parallel = kParallelSweep && thread_count > 1;
+  const size_t freed_objects_before = freed_objects_;
+  const size_t freed_bytes_before = freed_bytes_;
 
   const bool partial = (GetGcType() == kGcTypePartial);
-  SweepCallbackContext scc;
-  scc.mark_sweep = this;
-  scc.self = Thread::Current();
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
     // We always sweep always collect spaces.
     bool sweep_space = (space->GetGcRetentionPolicy() == space::kGcRetentionPolicyAlwaysCollect);
@@ -1236,30 +1398,92 @@ void MarkSweep::Sweep(bool swap_bitmaps) {
     if (sweep_space) {
       uintptr_t begin = reinterpret_cast<uintptr_t>(space->Begin());
       uintptr_t end = reinterpret_cast<uintptr_t>(space->End());
-      scc.space = space->AsDlMallocSpace();
       accounting::SpaceBitmap* live_bitmap = space->GetLiveBitmap();
       accounting::SpaceBitmap* mark_bitmap = space->GetMarkBitmap();
       if (swap_bitmaps) {
         std::swap(live_bitmap, mark_bitmap);
       }
-      if (!space->IsZygoteSpace()) {
-        base::TimingLogger::ScopedSplit split("SweepAllocSpace", &timings_);
-        // Bitmaps are pre-swapped for optimization which enables sweeping with the heap unlocked.
-        accounting::SpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, begin, end,
-                                           &SweepCallback, reinterpret_cast<void*>(&scc));
+      if (parallel) {
+        // Split the space into a few chunks per thread, the workers and this thread sweep them
+        // once every space has been queued.
+        const size_t delta = std::max(RoundUp((end - begin) / (thread_count * 2), kPageSize),
+                                      kMinimumSweepChunkSize);
+        while (begin != end) {
+          uintptr_t start = begin;
+          begin += std::min(delta, end - begin);
+          thread_pool->AddTask(self, new SweepTask(this, space, live_bitmap, mark_bitmap, start,
+                                                   begin));
+        }
       } else {
-        base::TimingLogger::ScopedSplit split("SweepZygote", &timings_);
-        // Zygote sweep takes care of dirtying cards and clearing live bits, does not free actual
-        // memory.
-        accounting::SpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, begin, end,
-                                           &ZygoteSweepCallback, reinterpret_cast<void*>(&scc));
+        base::TimingLogger::ScopedSplit split(
+            space->IsZygoteSpace() ? "SweepZygote" : "SweepAllocSpace", &timings_);
+        SweepRange(self, space, live_bitmap, mark_bitmap, begin, end);
       }
     }
   }
 
+  if (parallel) {
+    base::TimingLogger::ScopedSplit split("ParallelSweep", &timings_);
+    thread_pool->SetMaxActiveWorkers(thread_count - 1);
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, true, true);
+    thread_pool->StopWorkers(self);
+  }
+  GetHeap()->RecordFree(freed_objects_ - freed_objects_before, freed_bytes_ - freed_bytes_before);
+
   SweepLargeObjects(swap_bitmaps);
 }
 
+class LargeObjectSweepTask : public Task {
+ public:
+  LargeObjectSweepTask(MarkSweep* mark_sweep, accounting::SpaceSetMap* mark_objects,
+                       const Object* const* begin, const Object* const* end)
+      : mark_sweep_(mark_sweep),
+        mark_objects_(mark_objects),
+        begin_(begin),
+        end_(end) {
+  }
+
+ protected:
+  MarkSweep* const mark_sweep_;
+  accounting::SpaceSetMap* const mark_objects_;
+  const Object* const* const begin_;
+  const Object* const* const end_;
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+  virtual void Run(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+    mark_sweep_->SweepLargeObjectRange(self, mark_objects_, begin_, end_);
+  }
+};
+
+void MarkSweep::SweepLargeObjectRange(Thread* self, accounting::SpaceSetMap* mark_objects,
+                                      const Object* const* begin, const Object* const* end) {
+  space::LargeObjectSpace* large_object_space = GetHeap()->GetLargeObjectsSpace();
+  Object* pending[kSweepArrayChunkFreeSize];
+  size_t pending_count = 0;
+  size_t freed_objects = 0;
+  size_t freed_bytes = 0;
+  for (const Object* const* it = begin; it != end; ++it) {
+    if (!mark_objects->Test(*it)) {
+      pending[pending_count++] = const_cast<Object*>(*it);
+      if (pending_count == kSweepArrayChunkFreeSize) {
+        freed_bytes += large_object_space->FreeList(self, pending_count, pending);
+        freed_objects += pending_count;
+        pending_count = 0;
+      }
+    }
+  }
+  if (pending_count != 0) {
+    freed_bytes += large_object_space->FreeList(self, pending_count, pending);
+    freed_objects += pending_count;
+  }
+  freed_large_objects_.fetch_add(freed_objects);
+  freed_large_object_bytes_.fetch_add(freed_bytes);
+}
+
 void MarkSweep::SweepLargeObjects(bool swap_bitmaps) {
   base::TimingLogger::ScopedSplit("SweepLargeObjects", &timings_);
   // Sweep large objects
@@ -1269,24 +1493,38 @@ void MarkSweep::SweepLargeObjects(bool swap_bitmaps) {
   if (swap_bitmaps) {
     std::swap(large_live_objects, large_mark_objects);
   }
-  // O(n*log(n)) but hopefully there are not too many large objects.
-  size_t freed_objects = 0;
-  size_t freed_bytes = 0;
+  const size_t freed_objects_before = freed_large_objects_;
+  const size_t freed_bytes_before = freed_large_object_bytes_;
+  // Freeing doesn't touch the live set, take a snapshot so that it can be split into chunks.
+  const accounting::SpaceSetMap::Objects& live_objects = large_live_objects->GetObjects();
+  std::vector<const Object*> objects(live_objects.begin(), live_objects.end());
+  const Object* const* begin = objects.empty() ? NULL : &objects[0];
+  const Object* const* end = begin + objects.size();
   Thread* self = Thread::Current();
-  for (const Object* obj : large_live_objects->GetObjects()) {
-    if (!large_mark_objects->Test(obj)) {
-      freed_bytes += large_object_space->Free(self, const_cast<Object*>(obj));
-      ++freed_objects;
+  size_t thread_count = GetThreadCount(!IsConcurrent());
+  if (kParallelSweep && thread_count > 1 && objects.size() >= kMinimumParallelLargeObjectSweep) {
+    // Unmapping dominates here, it happens outside of the large object space lock.
+    ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+    const size_t delta = RoundUp(objects.size(), thread_count) / thread_count;
+    while (begin != end) {
+      const Object* const* start = begin;
+      begin += std::min(delta, static_cast<size_t>(end - begin));
+      thread_pool->AddTask(self, new LargeObjectSweepTask(this, large_mark_objects, start, begin));
     }
+    thread_pool->SetMaxActiveWorkers(thread_count - 1);
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, true, true);
+    thread_pool->StopWorkers(self);
+  } else {
+    SweepLargeObjectRange(self, large_mark_objects, begin, end);
   }
-  freed_large_objects_.fetch_add(freed_objects);
-  freed_large_object_bytes_.fetch_add(freed_bytes);
-  GetHeap()->RecordFree(freed_objects, freed_bytes);
+  GetHeap()->RecordFree(freed_large_objects_ - freed_objects_before,
+                        freed_large_object_bytes_ - freed_bytes_before);
 }
 
 void MarkSweep::CheckReference(const Object* obj, const Object* ref, MemberOffset offset, bool is_static) {
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
-    if (space->IsDlMallocSpace() && space->Contains(ref)) {
+    if (space->IsMallocSpace() && space->Contains(ref)) {
       DCHECK(IsMarked(obj));
 
       bool is_marked = IsMarked(ref);
@@ -1399,25 +1637,113 @@ void MarkSweep::ScanObject(const Object* obj) {
   ScanObjectVisit(obj, visitor);
 }
 
+class WorkStealingMarkTask : public Task {
+ public:
+  WorkStealingMarkTask(MarkSweep* mark_sweep, size_t index)
+      : mark_sweep_(mark_sweep),
+        index_(index) {
+  }
+
+ protected:
+  MarkSweep* const mark_sweep_;
+  const size_t index_;
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+  // The thread running the collection holds the heap bitmap lock for us.
+  virtual void Run(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+    mark_sweep_->ProcessMarkDeque(index_);
+  }
+};
+
+bool MarkSweep::HasMarkDequeWork() const {
+  for (size_t i = 0; i < num_mark_deques_; ++i) {
+    if (!mark_deques_[i]->IsEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool MarkSweep::StealMarkWork(size_t index, const Object** obj) {
+  for (size_t i = 1; i < num_mark_deques_; ++i) {
+    if (mark_deques_[(index + i) % num_mark_deques_]->Steal(obj)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void MarkSweep::ProcessMarkDeque(size_t index) {
+  accounting::WorkStealingDeque<const Object*>* deque = mark_deques_[index];
+  uint64_t objects_marked = 0;
+  ++active_markers_;
+  for (;;) {
+    // Drain our own deque depth first, newly marked children go on its bottom.
+    const Object* obj;
+    while (deque->PopBottom(&obj)) {
+      ScanObjectVisit(obj, [this, deque](const Object* /* obj */, const Object* ref,
+                                         const MemberOffset& /* offset */,
+                                         bool /* is_static */) ALWAYS_INLINE {
+        if (ref != nullptr && MarkObjectParallel(ref)) {
+          deque->PushBottom(ref);
+        }
+      });
+      ++objects_marked;
+    }
+    // Take the oldest object of another marker, likely the root of a large unexplored subgraph.
+    if (StealMarkWork(index, &obj)) {
+      deque->PushBottom(obj);
+      continue;
+    }
+    // Only markers with a non empty deque produce work, so once every marker is idle and all
+    // deques are empty marking is done. Idle markers become active again before stealing.
+    --active_markers_;
+    for (;;) {
+      if (active_markers_ == 0 && !HasMarkDequeWork()) {
+        objects_marked_per_worker_[index] += objects_marked;
+        return;
+      }
+      if (HasMarkDequeWork()) {
+        ++active_markers_;
+        break;
+      }
+      sched_yield();
+    }
+  }
+}
+
 void MarkSweep::ProcessMarkStackParallel(size_t thread_count) {
   Thread* self = Thread::Current();
   ThreadPool* thread_pool = GetHeap()->GetThreadPool();
-  const size_t chunk_size = std::min(mark_stack_->Size() / thread_count + 1,
-                                     static_cast<size_t>(MarkStackTask<false>::kMaxSize));
-  CHECK_GT(chunk_size, 0U);
-  // Split the current mark stack up into work tasks.
-  for (mirror::Object **it = mark_stack_->Begin(), **end = mark_stack_->End(); it < end; ) {
-    const size_t delta = std::min(static_cast<size_t>(end - it), chunk_size);
-    thread_pool->AddTask(self, new MarkStackTask<false>(thread_pool, this, delta,
-                                                        const_cast<const mirror::Object**>(it)));
-    it += delta;
+  while (mark_deques_.size() < thread_count) {
+    mark_deques_.push_back(new accounting::WorkStealingDeque<const Object*>(
+        kMarkDequeInitialCapacity));
+    objects_marked_per_worker_.push_back(0);
+  }
+  num_mark_deques_ = thread_count;
+  // Deal the mark stack out to the markers, none of them is running yet.
+  size_t index = 0;
+  for (mirror::Object **it = mark_stack_->Begin(), **end = mark_stack_->End(); it < end; ++it) {
+    mark_deques_[index]->PushBottom(*it);
+    index = (index + 1) % thread_count;
+  }
+  mark_stack_->Reset();
+  active_markers_ = 0;
+  for (size_t i = 0; i < thread_count; ++i) {
+    thread_pool->AddTask(self, new WorkStealingMarkTask(this, i));
   }
   thread_pool->SetMaxActiveWorkers(thread_count - 1);
   thread_pool->StartWorkers(self);
   thread_pool->Wait(self, true, true);
   thread_pool->StopWorkers(self);
-  mark_stack_->Reset();
-  CHECK_EQ(work_chunks_created_, work_chunks_deleted_) << " some of the work chunks were leaked";
+  for (size_t i = 0; i < thread_count; ++i) {
+    DCHECK(mark_deques_[i]->IsEmpty());
+    mark_deques_[i]->Reset();
+  }
+  num_mark_deques_ = 0;
 }
 
 // Scan anything that's on the mark stack.
@@ -1602,8 +1928,8 @@ void MarkSweep::ProcessReferences(Object** soft_references, bool clear_soft,
 void MarkSweep::UnBindBitmaps() {
   base::TimingLogger::ScopedSplit split("UnBindBitmaps", &timings_);
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
-    if (space->IsDlMallocSpace()) {
-      space::DlMallocSpace* alloc_space = space->AsDlMallocSpace();
+    if (space->IsMallocSpace()) {
+      space::MallocSpace* alloc_space = space->AsMallocSpace();
       if (alloc_space->temp_bitmap_.get() != NULL) {
         // At this point, the temp_bitmap holds our old mark bitmap.
         accounting::SpaceBitmap* new_bitmap = alloc_space->temp_bitmap_.release();
@@ -1616,6 +1942,35 @@ void MarkSweep::UnBindBitmaps() {
   }
 }
 
+void MarkSweep::ResetCumulativeStatistics() {
+  GarbageCollector::ResetCumulativeStatistics();
+  std::fill(objects_marked_per_worker_.begin(), objects_marked_per_worker_.end(), 0);
+}
+
+void MarkSweep::DumpPerformanceInfo(std::ostream& os) {
+  uint64_t total = std::accumulate(objects_marked_per_worker_.begin(),
+                                   objects_marked_per_worker_.end(), static_cast<uint64_t>(0));
+  if (total == 0) {
+    return;
+  }
+  uint64_t max = *std::max_element(objects_marked_per_worker_.begin(),
+                                   objects_marked_per_worker_.end());
+  os << GetName() << " parallel mark objects per worker:";
+  for (uint64_t count : objects_marked_per_worker_) {
+    os << " " << count;
+  }
+  // 1.0 means perfectly balanced, the worker count means one worker did everything.
+  os << " (max/mean " << static_cast<double>(max) * objects_marked_per_worker_.size() / total
+     << ")\n";
+}
+
+void MarkSweep::DumpLogInfo(std::ostream& os) const {
+  if (IsConcurrent()) {
+    os << ", pre-cleaned " << pre_cleaned_cards_ << " cards in " << pre_clean_passes_
+       << " passes, " << paused_dirty_cards_ << " dirty cards left for the pause";
+  }
+}
+
 void MarkSweep::FinishPhase() {
   base::TimingLogger::ScopedSplit split("FinishPhase", &timings_);
   // Can't enqueue references if we hold the mutator lock.
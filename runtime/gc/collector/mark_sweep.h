@@ -41,6 +41,7 @@ namespace gc {
 
 namespace accounting {
   template <typename T> class AtomicStack;
+  template <typename T> class WorkStealingDeque;
   class MarkIfReachesAllocspaceVisitor;
   class ModUnionClearCardVisitor;
   class ModUnionVisitor;
@@ -48,6 +49,7 @@ namespace accounting {
   class MarkStackChunk;
   typedef AtomicStack<mirror::Object*> ObjectStack;
   class SpaceBitmap;
+  class SpaceSetMap;
 }  // namespace accounting
 
 namespace space {
@@ -58,11 +60,13 @@ class Heap;
 
 namespace collector {
 
+struct SweepCallbackContext;
+
 class MarkSweep : public GarbageCollector {
  public:
   explicit MarkSweep(Heap* heap, bool is_concurrent, const std::string& name_prefix = "");
 
-  ~MarkSweep() {}
+  ~MarkSweep();
 
   virtual void InitializePhase();
   virtual bool IsConcurrent() const;
@@ -70,6 +74,9 @@ class MarkSweep : public GarbageCollector {
   virtual void MarkingPhase() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   virtual void ReclaimPhase() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   virtual void FinishPhase();
+  virtual void ResetCumulativeStatistics();
+  virtual void DumpPerformanceInfo(std::ostream& os);
+  virtual void DumpLogInfo(std::ostream& os) const;
   virtual void MarkReachableObjects()
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
@@ -129,6 +136,12 @@ class MarkSweep : public GarbageCollector {
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Scans the cards dirtied during the concurrent mark while the mutators are still running,
+  // repeating while that shrinks the dirty set, so that the pause only has to handle the rest.
+  void PreCleanCards()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Remarks the root set after completing the concurrent mark.
   void ReMarkRoots()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
@@ -166,45 +179,29 @@ class MarkSweep : public GarbageCollector {
   void ScanObjectVisit(const mirror::Object* obj, const MarkVisitor& visitor)
       NO_THREAD_SAFETY_ANALYSIS;
 
-  size_t GetFreedBytes() const {
+  virtual size_t GetFreedBytes() const {
     return freed_bytes_;
   }
 
-  size_t GetFreedLargeObjectBytes() const {
+  virtual size_t GetFreedLargeObjectBytes() const {
     return freed_large_object_bytes_;
   }
 
-  size_t GetFreedObjects() const {
+  virtual size_t GetFreedObjects() const {
     return freed_objects_;
   }
 
-  size_t GetFreedLargeObjects() const {
+  virtual size_t GetFreedLargeObjects() const {
     return freed_large_objects_;
   }
 
-  uint64_t GetTotalTimeNs() const {
-    return total_time_ns_;
-  }
-
-  uint64_t GetTotalPausedTimeNs() const {
-    return total_paused_time_ns_;
-  }
-
-  uint64_t GetTotalFreedObjects() const {
-    return total_freed_objects_;
-  }
-
-  uint64_t GetTotalFreedBytes() const {
-    return total_freed_bytes_;
-  }
-
   // Everything inside the immune range is assumed to be marked.
   void SetImmuneRange(mirror::Object* begin, mirror::Object* end);
 
   void SweepSystemWeaks()
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
-  static bool VerifyIsLiveCallback(const mirror::Object* obj, void* arg)
+  static mirror::Object* VerifyIsLiveCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
   void VerifySystemWeaks()
@@ -219,11 +216,11 @@ class MarkSweep : public GarbageCollector {
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_,
                             Locks::mutator_lock_);
 
-  static void MarkObjectCallback(const mirror::Object* root, void* arg)
+  static mirror::Object* MarkObjectCallback(mirror::Object* root, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
-  static void MarkRootParallelCallback(const mirror::Object* root, void* arg);
+  static mirror::Object* MarkRootParallelCallback(mirror::Object* root, void* arg);
 
   // Marks an object.
   void MarkObject(const mirror::Object* obj)
@@ -242,13 +239,14 @@ class MarkSweep : public GarbageCollector {
   // Returns true if the object has its bit set in the mark bitmap.
   bool IsMarked(const mirror::Object* object) const;
 
-  static bool IsMarkedCallback(const mirror::Object* object, void* arg)
+  // Returns the object if it is marked, NULL otherwise.
+  static mirror::Object* IsMarkedCallback(mirror::Object* object, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
   static bool IsMarkedArrayCallback(const mirror::Object* object, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
-  static void ReMarkObjectVisitor(const mirror::Object* root, void* arg)
+  static mirror::Object* ReMarkObjectVisitor(mirror::Object* root, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
@@ -282,8 +280,24 @@ class MarkSweep : public GarbageCollector {
   // Returns true if we need to add obj to a mark stack.
   bool MarkObjectParallel(const mirror::Object* obj) NO_THREAD_SAFETY_ANALYSIS;
 
+  // Queues the garbage of a sweep walk, freeing it in batches.
   static void SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+  static void FlushSweepCallbackContext(SweepCallbackContext* context)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+
+  // Sweeps [begin, end) of a space, may run on a GC worker thread while the thread running the
+  // collection holds the heap bitmap lock. Begin and end must not share a bitmap word with
+  // another range swept concurrently.
+  void SweepRange(Thread* self, space::ContinuousSpace* space,
+                  accounting::SpaceBitmap* live_bitmap, accounting::SpaceBitmap* mark_bitmap,
+                  uintptr_t begin, uintptr_t end)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+
+  // Frees the unmarked large objects of [begin, end).
+  void SweepLargeObjectRange(Thread* self, accounting::SpaceSetMap* mark_objects,
+                             const mirror::Object* const* begin, const mirror::Object* const* end)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
   // Special sweep for zygote that just marks objects / dirties cards.
   static void ZygoteSweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg)
@@ -368,10 +382,21 @@ class MarkSweep : public GarbageCollector {
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Marks the closure of the mark stack with one work stealing deque per thread.
   void ProcessMarkStackParallel(size_t thread_count)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Run by the parallel marker owning mark_deques_[index] until no marker has work left.
+  void ProcessMarkDeque(size_t index)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Steals the oldest object of another marker's deque.
+  bool StealMarkWork(size_t index, const mirror::Object** obj);
+
+  bool HasMarkDequeWork() const;
+
   void EnqueueFinalizerReferences(mirror::Object** ref)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -390,7 +415,7 @@ class MarkSweep : public GarbageCollector {
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  void SweepJniWeakGlobals(IsMarkedTester is_marked, void* arg)
+  void SweepJniWeakGlobals(::art::IsMarkedCallback* is_marked, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
   // Whether or not we count how many of each type of object were scanned.
@@ -439,10 +464,24 @@ class MarkSweep : public GarbageCollector {
   AtomicInteger work_chunks_deleted_;
   AtomicInteger reference_count_;
   AtomicInteger cards_scanned_;
+  // Pre-cleaning passes of the last run, and the cards they cleaned in total.
+  size_t pre_clean_passes_;
+  size_t pre_cleaned_cards_;
+  // Dirty cards left over for the pause.
+  size_t paused_dirty_cards_;
 
   // Verification.
   size_t live_stack_freeze_size_;
 
+  // One deque per parallel marker, grown to the largest thread count seen.
+  std::vector<accounting::WorkStealingDeque<const mirror::Object*>*> mark_deques_;
+  // How many of mark_deques_ the current ProcessMarkStackParallel uses.
+  size_t num_mark_deques_;
+  // Number of parallel markers which may still push work.
+  AtomicInteger active_markers_;
+  // Objects scanned by each parallel marker, summed over all collections.
+  std::vector<uint64_t> objects_marked_per_worker_;
+
   UniquePtr<Barrier> gc_barrier_;
   Mutex large_object_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   Mutex mark_stack_lock_ ACQUIRED_AFTER(Locks::classlinker_classes_lock_);
@@ -458,6 +497,7 @@ class MarkSweep : public GarbageCollector {
   friend class CheckReferenceVisitor;
   friend class art::gc::Heap;
   friend class InternTableEntryIsUnmarked;
+  friend class LargeObjectSweepTask;
   friend class MarkIfReachesAllocspaceVisitor;
   friend class ModUnionCheckReferences;
   friend class ModUnionClearCardVisitor;
@@ -468,6 +508,8 @@ class MarkSweep : public GarbageCollector {
   friend class ModUnionScanImageRootVisitor;
   friend class ScanBitmapVisitor;
   friend class ScanImageRootVisitor;
+  friend class WorkStealingMarkTask;
+  friend class SweepTask;
   template<bool kUseFinger> friend class MarkStackTask;
   friend class FifoMarkStackChunk;
 
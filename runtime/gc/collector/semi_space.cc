@@ -0,0 +1,744 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "semi_space.h"
+
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/mutex-inl.h"
+#include "base/timing_logger.h"
+#include "gc/accounting/atomic_stack.h"
+#include "gc/accounting/card_table-inl.h"
+#include "gc/accounting/heap_bitmap.h"
+#include "gc/accounting/mod_union_table.h"
+#include "gc/accounting/space_bitmap-inl.h"
+#include "gc/heap.h"
+#include "gc/space/bump_pointer_space.h"
+#include "gc/space/bump_pointer_space-inl.h"
+#include "gc/space/image_space.h"
+#include "gc/space/large_object_space.h"
+#include "gc/space/space-inl.h"
+#include "intern_table.h"
+#include "jni_internal.h"
+#include "mark_sweep-inl.h"
+#include "monitor.h"
+#include "mirror/art_field-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "mirror/object_array-inl.h"
+#include "runtime.h"
+#include "thread-inl.h"
+#include "thread_list.h"
+
+using ::art::mirror::Class;
+using ::art::mirror::Object;
+
+namespace art {
+namespace gc {
+namespace collector {
+
+SemiSpace::SemiSpace(Heap* heap, bool generational, const std::string& name_prefix)
+    : GarbageCollector(heap,
+                       name_prefix + (name_prefix.empty() ? "" : " ") + "semi space"),
+      from_space_(NULL),
+      to_space_(NULL),
+      to_alloc_space_(NULL),
+      non_moving_space_(NULL),
+      from_mark_bitmap_(NULL),
+      to_live_bitmap_(NULL),
+      to_mark_bitmap_(NULL),
+      non_moving_mark_bitmap_(NULL),
+      mark_stack_(NULL),
+      immune_begin_(NULL),
+      immune_end_(NULL),
+      soft_reference_list_(NULL),
+      weak_reference_list_(NULL),
+      finalizer_reference_list_(NULL),
+      phantom_reference_list_(NULL),
+      cleared_reference_list_(NULL),
+      bytes_moved_(0),
+      objects_moved_(0),
+      freed_bytes_(0),
+      freed_objects_(0),
+      freed_large_object_bytes_(0),
+      freed_large_objects_(0),
+      generational_(generational),
+      clear_soft_references_(false),
+      skipped_(false) {
+}
+
+void SemiSpace::SetSpaces(space::ContinuousSpace* from_space, space::ContinuousSpace* to_space) {
+  DCHECK(from_space != NULL);
+  DCHECK(to_space != NULL);
+  DCHECK_NE(from_space, to_space);
+  DCHECK(from_space->IsBumpPointerSpace() || from_space->IsMallocSpace());
+  DCHECK(to_space->IsBumpPointerSpace() || to_space->IsMallocSpace());
+  from_space_ = from_space;
+  to_space_ = to_space;
+}
+
+void SemiSpace::InitializePhase() {
+  timings_.Reset();
+  base::TimingLogger::ScopedSplit split("InitializePhase", &timings_);
+  CHECK(from_space_ != NULL && to_space_ != NULL) << "SetSpaces must be called before running";
+  mark_stack_ = heap_->mark_stack_.get();
+  DCHECK(mark_stack_ != NULL);
+  non_moving_space_ = heap_->GetAllocSpace();
+  if (to_space_->IsBumpPointerSpace()) {
+    to_alloc_space_ = to_space_->AsBumpPointerSpace();
+  } else {
+    DCHECK_EQ(to_space_, non_moving_space_);
+    to_alloc_space_ = non_moving_space_;
+  }
+  from_mark_bitmap_ = from_space_->GetMarkBitmap();
+  to_live_bitmap_ = to_space_->GetLiveBitmap();
+  to_mark_bitmap_ = to_space_->GetMarkBitmap();
+  non_moving_mark_bitmap_ = non_moving_space_->GetMarkBitmap();
+  // The image and zygote spaces are never collected, they are sorted before the alloc space.
+  const space::ContinuousSpace* first_space = heap_->GetContinuousSpaces().front();
+  immune_begin_ = reinterpret_cast<Object*>(first_space->Begin());
+  immune_end_ = reinterpret_cast<Object*>(non_moving_space_->Begin());
+  soft_reference_list_ = NULL;
+  weak_reference_list_ = NULL;
+  finalizer_reference_list_ = NULL;
+  phantom_reference_list_ = NULL;
+  cleared_reference_list_ = NULL;
+  bytes_moved_ = 0;
+  objects_moved_ = 0;
+  unpromoted_objects_.clear();
+  freed_bytes_ = 0;
+  freed_objects_ = 0;
+  freed_large_object_bytes_ = 0;
+  freed_large_objects_ = 0;
+  skipped_ = false;
+}
+
+void SemiSpace::MarkingPhase() {
+  base::TimingLogger::ScopedSplit split("MarkingPhase", &timings_);
+  Thread* self = Thread::Current();
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+
+  // Native code may be holding direct pointers into the elements of pinned arrays, bail out
+  // without moving anything.
+  if (heap_->IsMovingGcDisabled(self)) {
+    skipped_ = true;
+    return;
+  }
+
+  // Account the objects in the thread-local allocation buffers before anything gets moved.
+  timings_.NewSplit("RevokeAllThreadLocalBuffers");
+  heap_->RevokeAllThreadLocalBuffers();
+
+  WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+  // Give the new objects of the alloc space and the large object space their live bits so that
+  // the unreached ones get swept.
+  timings_.NewSplit("FlushAllocStack");
+  heap_->FlushAllocStack();
+
+  timings_.NewSplit("MarkRoots");
+  Runtime::Current()->VisitRoots(MarkRootCallback, this, false, true);
+
+  if (generational_) {
+    timings_.NewSplit("ScanRememberedSet");
+    ScanRememberedSet();
+  } else {
+    timings_.NewSplit("ScanImmuneSpaces");
+    ScanImmuneSpaces();
+  }
+
+  timings_.NewSplit("ProcessMarkStack");
+  ProcessMarkStack();
+
+  ProcessReferences();
+
+  timings_.NewSplit("SweepSystemWeaks");
+  SweepSystemWeaks();
+}
+
+inline bool SemiSpace::IsImmune(const Object* obj) const {
+  return obj >= immune_begin_ && obj < immune_end_;
+}
+
+inline Object* SemiSpace::GetForwardingAddressInFromSpace(Object* obj) const {
+  DCHECK(from_space_->HasAddress(obj));
+  // Pinned objects of the alloc space stay where they are, the others store the address of their
+  // copy in the lock word. Survivors which couldn't be promoted store their own address.
+  if (from_space_ == non_moving_space_ && !heap_->IsMovableObject(obj)) {
+    return obj;
+  }
+  return reinterpret_cast<Object*>(*obj->GetRawLockWordAddress());
+}
+
+Object* SemiSpace::Copy(Object* obj) {
+  Thread* self = Thread::Current();
+  const size_t object_size = obj->SizeOf();
+  const uint32_t lock_word = *obj->GetRawLockWordAddress();
+  const uint32_t hash_state = LW_HASH_STATE(lock_word);
+  // A hashed object keeps its identity hash code, its original address, after its last field.
+  const size_t copy_size = object_size + (LW_IS_HASHED(lock_word) ? sizeof(uint32_t) : 0);
+  size_t bytes_allocated = 0;
+  // Promoted objects become live right away, the alloc space isn't swept by a minor collection.
+  accounting::SpaceBitmap* bitmap = to_space_->IsBumpPointerSpace() || generational_
+      ? to_live_bitmap_ : to_mark_bitmap_;
+  Object* forward = to_alloc_space_->Alloc(self, copy_size, &bytes_allocated);
+  if (UNLIKELY(forward == NULL) && from_space_ != non_moving_space_) {
+    // The to-space is full, keep the survivor in the alloc space instead. That doesn't work when
+    // evacuating the alloc space itself since the copy would look like a forwarded object.
+    forward = non_moving_space_->AllocWithGrowth(self, copy_size, &bytes_allocated);
+    bitmap = generational_ ? non_moving_space_->GetLiveBitmap() : non_moving_mark_bitmap_;
+  }
+  if (UNLIKELY(forward == NULL) && from_space_ == heap_->nursery_space_) {
+    // The old generation is full, the survivor stays in the nursery for now. Its lock word is
+    // given back once nothing reads forwarding addresses any more.
+    unpromoted_objects_.push_back(std::make_pair(obj, lock_word));
+    *obj->GetRawLockWordAddress() = reinterpret_cast<uint32_t>(obj);
+    return obj;
+  }
+  CHECK(forward != NULL) << "Ran out of space copying " << PrettyTypeOf(obj) << " of "
+                         << copy_size << " bytes";
+  memcpy(forward, obj, object_size);
+  uint32_t* hash_address =
+      reinterpret_cast<uint32_t*>(reinterpret_cast<byte*>(forward) + object_size);
+  if (hash_state == LW_HASH_STATE_HASHED) {
+    *hash_address = reinterpret_cast<uint32_t>(obj);
+    *forward->GetRawLockWordAddress() =
+        lock_word | (LW_HASH_STATE_HASHED_AND_MOVED << LW_HASH_STATE_SHIFT);
+  } else if (hash_state == LW_HASH_STATE_HASHED_AND_MOVED) {
+    *hash_address =
+        *reinterpret_cast<uint32_t*>(reinterpret_cast<byte*>(obj) + object_size);
+  }
+  // The lock word of the original now holds the forwarding address, the copy kept the lock state.
+  *obj->GetRawLockWordAddress() = reinterpret_cast<uint32_t>(forward);
+  bitmap->Set(forward);
+  bytes_moved_ += bytes_allocated;
+  ++objects_moved_;
+  return forward;
+}
+
+Object* SemiSpace::MarkObject(Object* obj) {
+  if (obj == NULL) {
+    return NULL;
+  }
+  if (from_space_->HasAddress(obj)) {
+    if (from_mark_bitmap_->Test(obj)) {
+      return GetForwardingAddressInFromSpace(obj);
+    }
+    from_mark_bitmap_->Set(obj);
+    if (from_space_ == non_moving_space_ && !heap_->IsMovableObject(obj)) {
+      PushOnMarkStack(obj);
+      return obj;
+    }
+    Object* forward = Copy(obj);
+    PushOnMarkStack(forward);
+    return forward;
+  }
+  if (generational_) {
+    // Old objects are neither traced nor freed by a minor collection.
+    return obj;
+  }
+  if (to_space_ != non_moving_space_ && to_space_->HasAddress(obj)) {
+    // Already a copy.
+    return obj;
+  }
+  if (non_moving_space_->HasAddress(obj)) {
+    if (!non_moving_mark_bitmap_->Test(obj)) {
+      non_moving_mark_bitmap_->Set(obj);
+      PushOnMarkStack(obj);
+    }
+    return obj;
+  }
+  if (IsImmune(obj)) {
+    return obj;
+  }
+  accounting::SpaceSetMap* large_objects = heap_->GetLargeObjectsSpace()->GetMarkObjects();
+  if (!large_objects->Test(obj)) {
+    large_objects->Set(obj);
+    PushOnMarkStack(obj);
+  }
+  return obj;
+}
+
+Object* SemiSpace::GetMarkedForwardingAddress(Object* obj) const {
+  if (from_space_->HasAddress(obj)) {
+    return from_mark_bitmap_->Test(obj) ? GetForwardingAddressInFromSpace(obj) : NULL;
+  }
+  if (generational_) {
+    return obj;
+  }
+  if (to_space_ != non_moving_space_ && to_space_->HasAddress(obj)) {
+    return obj;
+  }
+  if (non_moving_space_->HasAddress(obj)) {
+    return non_moving_mark_bitmap_->Test(obj) ? obj : NULL;
+  }
+  if (IsImmune(obj)) {
+    return obj;
+  }
+  return heap_->GetLargeObjectsSpace()->GetMarkObjects()->Test(obj) ? obj : NULL;
+}
+
+Object* SemiSpace::MarkRootCallback(Object* root, void* arg) {
+  DCHECK(root != NULL);
+  DCHECK(arg != NULL);
+  return reinterpret_cast<SemiSpace*>(arg)->MarkObject(root);
+}
+
+Object* SemiSpace::MarkedForwardingAddressCallback(Object* object, void* arg) {
+  return reinterpret_cast<SemiSpace*>(arg)->GetMarkedForwardingAddress(object);
+}
+
+void SemiSpace::PushOnMarkStack(Object* obj) {
+  if (UNLIKELY(mark_stack_->Size() >= mark_stack_->Capacity())) {
+    std::vector<Object*> temp(mark_stack_->Begin(), mark_stack_->End());
+    mark_stack_->Resize(mark_stack_->Capacity() * 2);
+    for (const auto& o : temp) {
+      mark_stack_->PushBack(o);
+    }
+  }
+  mark_stack_->PushBack(obj);
+}
+
+class SemiSpaceScanObjectVisitor {
+ public:
+  explicit SemiSpaceScanObjectVisitor(SemiSpace* const semi_space) ALWAYS_INLINE
+      : semi_space_(semi_space) {}
+
+  // TODO: Fixme when anotatalysis works with visitors.
+  void operator()(const Object* obj, const Object* ref, const MemberOffset& offset,
+                  bool /* is_static */) const ALWAYS_INLINE NO_THREAD_SAFETY_ANALYSIS {
+    Object* new_ref = semi_space_->MarkObject(const_cast<Object*>(ref));
+    if (new_ref != ref) {
+      const_cast<Object*>(obj)->SetFieldObject(offset, new_ref, false);
+    }
+  }
+
+ private:
+  SemiSpace* const semi_space_;
+};
+
+void SemiSpace::ScanObject(Object* obj) {
+  DCHECK(obj != NULL);
+  SemiSpaceScanObjectVisitor visitor(this);
+  MarkSweep::VisitObjectReferences(obj, visitor);
+  Class* klass = obj->GetClass();
+  if (UNLIKELY(klass->IsReferenceClass())) {
+    DelayReferenceReferent(klass, obj);
+  }
+}
+
+class SemiSpaceScanImmuneVisitor {
+ public:
+  explicit SemiSpaceScanImmuneVisitor(SemiSpace* const semi_space) : semi_space_(semi_space) {}
+
+  void operator()(Object* obj) const NO_THREAD_SAFETY_ANALYSIS {
+    semi_space_->ScanObject(obj);
+  }
+
+ private:
+  SemiSpace* const semi_space_;
+};
+
+void SemiSpace::ScanImmuneSpaces() {
+  // There are no cards for references from the image and zygote spaces into a bump pointer space
+  // which would be precise enough, scan all of their objects instead.
+  SemiSpaceScanImmuneVisitor visitor(this);
+  for (const auto& space : heap_->GetContinuousSpaces()) {
+    if ((space->IsImageSpace() || space->IsZygoteSpace()) && space->End() > space->Begin()) {
+      space->GetLiveBitmap()->VisitMarkedRange(reinterpret_cast<uintptr_t>(space->Begin()),
+                                               reinterpret_cast<uintptr_t>(space->End()),
+                                               visitor);
+      ProcessMarkStack();
+    }
+  }
+}
+
+void SemiSpace::ScanRememberedSet() {
+  // Every reference from an old object to a young one was stored after the last collection, when
+  // the nursery was empty, so the card of the old object is dirty. Objects promoted by this
+  // collection are on the mark stack instead. After a promotion failure the nursery wasn't empty,
+  // references to the objects left in it may be on aged cards, so every old object is visited.
+  accounting::CardTable* card_table = heap_->GetCardTable();
+  SemiSpaceScanImmuneVisitor visitor(this);
+  const bool scan_all_objects = heap_->nursery_promotion_failed_;
+  for (const auto& space : heap_->GetContinuousSpaces()) {
+    if (space == from_space_ || space->IsBumpPointerSpace() || space->End() == space->Begin()) {
+      continue;
+    }
+    if (scan_all_objects) {
+      space->GetLiveBitmap()->VisitMarkedRange(reinterpret_cast<uintptr_t>(space->Begin()),
+                                               reinterpret_cast<uintptr_t>(space->End()),
+                                               visitor);
+    } else {
+      card_table->Scan(space->GetLiveBitmap(), space->Begin(), space->End(), visitor,
+                       accounting::CardTable::kCardDirty);
+    }
+    ProcessMarkStack();
+  }
+  // The old objects only refer to old objects again. Age the cards, the image and zygote ones are
+  // remembered in their mod-union tables.
+  heap_->ProcessCards(timings_);
+}
+
+void SemiSpace::ProcessMarkStack() {
+  while (!mark_stack_->IsEmpty()) {
+    ScanObject(mark_stack_->PopBack());
+  }
+}
+
+// Process the "referent" field in a java.lang.ref.Reference. A referent which has already been
+// reached gets its new address, otherwise the reference is put on the appropriate list.
+void SemiSpace::DelayReferenceReferent(Class* klass, Object* obj) {
+  DCHECK(klass != NULL);
+  DCHECK(klass->IsReferenceClass());
+  Object* referent = heap_->GetReferenceReferent(obj);
+  if (referent == NULL) {
+    return;
+  }
+  Object* forward = GetMarkedForwardingAddress(referent);
+  if (forward != NULL) {
+    if (forward != referent) {
+      heap_->SetReferenceReferent(obj, forward);
+    }
+    return;
+  }
+  // Every mutator is suspended and the scan is single threaded, no need for the queue locks.
+  if (heap_->IsEnqueued(obj)) {
+    return;
+  }
+  if (klass->IsSoftReferenceClass()) {
+    heap_->EnqueuePendingReference(obj, &soft_reference_list_);
+  } else if (klass->IsWeakReferenceClass()) {
+    heap_->EnqueuePendingReference(obj, &weak_reference_list_);
+  } else if (klass->IsFinalizerReferenceClass()) {
+    heap_->EnqueuePendingReference(obj, &finalizer_reference_list_);
+  } else if (klass->IsPhantomReferenceClass()) {
+    heap_->EnqueuePendingReference(obj, &phantom_reference_list_);
+  } else {
+    LOG(FATAL) << "Invalid reference type " << PrettyClass(klass)
+               << " " << std::hex << klass->GetAccessFlags();
+  }
+}
+
+void SemiSpace::PreserveSomeSoftReferences(Object** list) {
+  DCHECK(list != NULL);
+  Object* clear = NULL;
+  size_t counter = 0;
+  DCHECK(mark_stack_->IsEmpty());
+  timings_.StartSplit("PreserveSomeSoftReferences");
+  while (*list != NULL) {
+    Object* ref = heap_->DequeuePendingReference(list);
+    Object* referent = heap_->GetReferenceReferent(ref);
+    if (referent == NULL) {
+      // Referent was cleared by the user during marking.
+      continue;
+    }
+    Object* forward = GetMarkedForwardingAddress(referent);
+    if (forward == NULL && ((++counter) & 1)) {
+      // Referent is white and biased toward saving, evacuate it.
+      forward = MarkObject(referent);
+    }
+    if (forward != NULL) {
+      if (forward != referent) {
+        heap_->SetReferenceReferent(ref, forward);
+      }
+    } else {
+      // Referent is white, queue it for clearing.
+      heap_->EnqueuePendingReference(ref, &clear);
+    }
+  }
+  *list = clear;
+  timings_.EndSplit();
+
+  // Restart the mark with the newly black references added to the root set.
+  ProcessMarkStack();
+}
+
+void SemiSpace::ClearWhiteReferences(Object** list) {
+  DCHECK(list != NULL);
+  while (*list != NULL) {
+    Object* ref = heap_->DequeuePendingReference(list);
+    Object* referent = heap_->GetReferenceReferent(ref);
+    if (referent == NULL) {
+      continue;
+    }
+    Object* forward = GetMarkedForwardingAddress(referent);
+    if (forward == NULL) {
+      // Referent is white, clear it.
+      heap_->ClearReferenceReferent(ref);
+      if (heap_->IsEnqueuable(ref)) {
+        heap_->EnqueueReference(ref, &cleared_reference_list_);
+      }
+    } else if (forward != referent) {
+      // The referent was reached after the reference was scanned.
+      heap_->SetReferenceReferent(ref, forward);
+    }
+  }
+  DCHECK(*list == NULL);
+}
+
+void SemiSpace::EnqueueFinalizerReferences(Object** list) {
+  DCHECK(list != NULL);
+  timings_.StartSplit("EnqueueFinalizerReferences");
+  MemberOffset zombie_offset = heap_->GetFinalizerReferenceZombieOffset();
+  bool has_enqueued = false;
+  while (*list != NULL) {
+    Object* ref = heap_->DequeuePendingReference(list);
+    Object* referent = heap_->GetReferenceReferent(ref);
+    if (referent == NULL) {
+      continue;
+    }
+    Object* forward = GetMarkedForwardingAddress(referent);
+    if (forward == NULL) {
+      forward = MarkObject(referent);
+      // If the referent is non-null the reference must queuable.
+      DCHECK(heap_->IsEnqueuable(ref));
+      ref->SetFieldObject(zombie_offset, forward, false);
+      heap_->ClearReferenceReferent(ref);
+      heap_->EnqueueReference(ref, &cleared_reference_list_);
+      has_enqueued = true;
+    } else if (forward != referent) {
+      heap_->SetReferenceReferent(ref, forward);
+    }
+  }
+  timings_.EndSplit();
+  if (has_enqueued) {
+    ProcessMarkStack();
+  }
+  DCHECK(*list == NULL);
+}
+
+// Same policy as MarkSweep::ProcessReferences.
+void SemiSpace::ProcessReferences() {
+  base::TimingLogger::ScopedSplit split("ProcessReferences", &timings_);
+  CHECK(mark_stack_->IsEmpty());
+  if (!clear_soft_references_ && !Runtime::Current()->IsZygote()) {
+    PreserveSomeSoftReferences(&soft_reference_list_);
+  }
+  ClearWhiteReferences(&soft_reference_list_);
+  ClearWhiteReferences(&weak_reference_list_);
+  EnqueueFinalizerReferences(&finalizer_reference_list_);
+  ClearWhiteReferences(&soft_reference_list_);
+  ClearWhiteReferences(&weak_reference_list_);
+  ClearWhiteReferences(&phantom_reference_list_);
+  DCHECK(soft_reference_list_ == NULL);
+  DCHECK(weak_reference_list_ == NULL);
+  DCHECK(finalizer_reference_list_ == NULL);
+  DCHECK(phantom_reference_list_ == NULL);
+}
+
+void SemiSpace::SweepSystemWeaks() {
+  Runtime* runtime = Runtime::Current();
+  runtime->GetInternTable()->SweepInternTableWeaks(MarkedForwardingAddressCallback, this);
+  runtime->GetMonitorList()->SweepMonitorList(MarkedForwardingAddressCallback, this);
+  runtime->GetJavaVM()->SweepWeakGlobals(MarkedForwardingAddressCallback, this);
+}
+
+void SemiSpace::ReclaimPhase() {
+  if (skipped_) {
+    return;
+  }
+  base::TimingLogger::ScopedSplit split("ReclaimPhase", &timings_);
+  Thread* self = Thread::Current();
+  {
+    WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    Reclaim();
+  }
+  // Mutators must not allocate into a space which is being evacuated into, switch spaces before
+  // the world is restarted.
+  timings_.NewSplit("SemiSpaceCollectionFinished");
+  heap_->SemiSpaceCollectionFinished(from_space_, to_space_);
+}
+
+void SemiSpace::Reclaim() {
+  // The copies were allocated behind the back of Heap::AllocObject.
+  heap_->num_bytes_allocated_.fetch_add(bytes_moved_);
+
+  if (!generational_) {
+    Sweep();
+
+    timings_.NewSplit("SwapBitmaps");
+    SwapBitmaps();
+  }
+
+  if (PromotionFailed()) {
+    timings_.NewSplit("RestoreUnpromotedObjects");
+    RestoreUnpromotedObjects();
+  } else if (from_space_->IsBumpPointerSpace()) {
+    timings_.NewSplit("ClearFromSpace");
+    space::BumpPointerSpace* from_space = from_space_->AsBumpPointerSpace();
+    const size_t from_objects = from_space->GetObjectsAllocated();
+    const size_t from_bytes = from_space->Size();
+    heap_->RecordFree(from_objects, from_bytes);
+    freed_objects_ += from_objects;
+    freed_bytes_ += from_bytes;
+    from_space->Clear();
+  }
+
+  // Only count what didn't survive, the survivors were freed from the from-space and allocated
+  // again in the to-space.
+  freed_objects_ = freed_objects_ > objects_moved_ ? freed_objects_ - objects_moved_ : 0;
+  freed_bytes_ = freed_bytes_ > bytes_moved_ ? freed_bytes_ - bytes_moved_ : 0;
+
+  // The cached references of the mod-union tables may point to old addresses. They never point
+  // into the nursery, which is closed while mark sweep updates the tables.
+  if (!generational_) {
+    timings_.NewSplit("InvalidateModUnionTables");
+    heap_->image_mod_union_table_->Invalidate();
+    heap_->zygote_mod_union_table_->Invalidate();
+  }
+}
+
+void SemiSpace::RestoreUnpromotedObjects() {
+  // The nursery can't be emptied, the originals of the promoted objects and the dead objects stay
+  // behind until a later collection clears it. Only the unpromoted objects keep their live bits.
+  accounting::SpaceBitmap* live_bitmap = from_space_->GetLiveBitmap();
+  live_bitmap->Clear();
+  from_space_->GetMarkBitmap()->Clear();
+  size_t unpromoted_bytes = 0;
+  for (const auto& unpromoted : unpromoted_objects_) {
+    Object* obj = unpromoted.first;
+    *obj->GetRawLockWordAddress() = unpromoted.second;
+    live_bitmap->Set(obj);
+    unpromoted_bytes += obj->SizeOf();
+  }
+  LOG(WARNING) << "Promotion failed, " << unpromoted_objects_.size() << " objects ("
+               << PrettySize(unpromoted_bytes) << ") stay in " << from_space_->GetName();
+}
+
+class SemiSpaceUnmarkMovedVisitor {
+ public:
+  SemiSpaceUnmarkMovedVisitor(Heap* heap, accounting::SpaceBitmap* mark_bitmap)
+      : heap_(heap), mark_bitmap_(mark_bitmap) {}
+
+  void operator()(Object* obj) const NO_THREAD_SAFETY_ANALYSIS {
+    if (heap_->IsMovableObject(obj)) {
+      mark_bitmap_->Clear(obj);
+    }
+  }
+
+ private:
+  Heap* const heap_;
+  accounting::SpaceBitmap* const mark_bitmap_;
+};
+
+void SemiSpace::Sweep() {
+  DCHECK(mark_stack_->IsEmpty());
+  base::TimingLogger::ScopedSplit split("Sweep", &timings_);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(non_moving_space_->Begin());
+  uintptr_t end = reinterpret_cast<uintptr_t>(non_moving_space_->End());
+  accounting::SpaceBitmap* live_bitmap = non_moving_space_->GetLiveBitmap();
+  if (from_space_ == non_moving_space_ && end > begin) {
+    // Objects which were copied out of the alloc space are marked as reached, unmark them so
+    // they get freed along with the dead ones. The copies were allocated elsewhere.
+    SemiSpaceUnmarkMovedVisitor visitor(heap_, non_moving_mark_bitmap_);
+    non_moving_mark_bitmap_->VisitMarkedRange(begin, end, visitor);
+  }
+  accounting::SpaceBitmap::SweepWalk(*live_bitmap, *non_moving_mark_bitmap_, begin, end,
+                                     &SweepCallback, reinterpret_cast<void*>(this));
+  SweepLargeObjects();
+}
+
+void SemiSpace::SweepCallback(size_t num_ptrs, Object** ptrs, void* arg) {
+  SemiSpace* semi_space = reinterpret_cast<SemiSpace*>(arg);
+  Thread* self = Thread::Current();
+  Locks::heap_bitmap_lock_->AssertExclusiveHeld(self);
+  size_t freed_bytes = semi_space->non_moving_space_->FreeList(self, num_ptrs, ptrs);
+  semi_space->heap_->RecordFree(num_ptrs, freed_bytes);
+  semi_space->freed_objects_ += num_ptrs;
+  semi_space->freed_bytes_ += freed_bytes;
+}
+
+void SemiSpace::SweepLargeObjects() {
+  base::TimingLogger::ScopedSplit split("SweepLargeObjects", &timings_);
+  space::LargeObjectSpace* large_object_space = heap_->GetLargeObjectsSpace();
+  accounting::SpaceSetMap* large_live_objects = large_object_space->GetLiveObjects();
+  accounting::SpaceSetMap* large_mark_objects = large_object_space->GetMarkObjects();
+  size_t freed_objects = 0;
+  size_t freed_bytes = 0;
+  Thread* self = Thread::Current();
+  for (const Object* obj : large_live_objects->GetObjects()) {
+    if (!large_mark_objects->Test(obj)) {
+      freed_bytes += large_object_space->Free(self, const_cast<Object*>(obj));
+      ++freed_objects;
+    }
+  }
+  freed_large_objects_ += freed_objects;
+  freed_large_object_bytes_ += freed_bytes;
+  heap_->RecordFree(freed_objects, freed_bytes);
+}
+
+void SemiSpace::SwapBitmaps() {
+  // Only the spaces which were marked in place are swapped, the immune spaces were never marked
+  // and the bump pointer spaces keep their live bits up to date as objects are copied.
+  accounting::SpaceBitmap* live_bitmap = non_moving_space_->GetLiveBitmap();
+  accounting::SpaceBitmap* mark_bitmap = non_moving_space_->GetMarkBitmap();
+  heap_->GetLiveBitmap()->ReplaceBitmap(live_bitmap, mark_bitmap);
+  heap_->GetMarkBitmap()->ReplaceBitmap(mark_bitmap, live_bitmap);
+  non_moving_space_->SwapBitmaps();
+  non_moving_mark_bitmap_ = non_moving_space_->GetMarkBitmap();
+
+  space::LargeObjectSpace* large_object_space = heap_->GetLargeObjectsSpace();
+  accounting::SpaceSetMap* live_set = large_object_space->GetLiveObjects();
+  accounting::SpaceSetMap* mark_set = large_object_space->GetMarkObjects();
+  heap_->GetLiveBitmap()->ReplaceObjectSet(live_set, mark_set);
+  heap_->GetMarkBitmap()->ReplaceObjectSet(mark_set, live_set);
+  large_object_space->SwapBitmaps();
+}
+
+void SemiSpace::FinishPhase() {
+  base::TimingLogger::ScopedSplit split("FinishPhase", &timings_);
+  Heap* heap = GetHeap();
+  // Can't enqueue references if we hold the mutator lock.
+  timings_.NewSplit("EnqueueClearedReferences");
+  heap->EnqueueClearedReferences(&cleared_reference_list_);
+
+  if (!skipped_) {
+    timings_.NewSplit("GrowForUtilization");
+    heap->GrowForUtilization(GetGcType(), GetDurationNs());
+  }
+
+  timings_.NewSplit("RequestHeapTrim");
+  heap->RequestHeapTrim();
+
+  // Update the cumulative statistics
+  total_time_ns_ += GetDurationNs();
+  total_paused_time_ns_ += std::accumulate(GetPauseTimes().begin(), GetPauseTimes().end(), 0,
+                                           std::plus<uint64_t>());
+  total_freed_objects_ += GetFreedObjects() + GetFreedLargeObjects();
+  total_freed_bytes_ += GetFreedBytes() + GetFreedLargeObjectBytes();
+
+  // Ensure that the mark stack is empty.
+  CHECK(mark_stack_->IsEmpty());
+
+  // Update the cumulative loggers.
+  cumulative_timings_.Start();
+  cumulative_timings_.AddLogger(timings_);
+  cumulative_timings_.End();
+
+  // Clear the mark bits of the spaces which were marked in place.
+  non_moving_space_->GetMarkBitmap()->Clear();
+  to_space_->GetMarkBitmap()->Clear();
+  heap->GetLargeObjectsSpace()->GetMarkObjects()->Clear();
+  mark_stack_->Reset();
+}
+
+}  // namespace collector
+}  // namespace gc
+}  // namespace art
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_COLLECTOR_SEMI_SPACE_H_
+#define ART_RUNTIME_GC_COLLECTOR_SEMI_SPACE_H_
+
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "garbage_collector.h"
+#include "offsets.h"
+#include "root_visitor.h"
+#include "UniquePtr.h"
+
+namespace art {
+
+namespace mirror {
+  class Class;
+  class Object;
+}  // namespace mirror
+
+class Thread;
+
+namespace gc {
+
+namespace accounting {
+  template <typename T> class AtomicStack;
+  typedef AtomicStack<mirror::Object*> ObjectStack;
+  class SpaceBitmap;
+}  // namespace accounting
+
+namespace space {
+  class AllocSpace;
+  class ContinuousSpace;
+  class MallocSpace;
+}  // namespace space
+
+class Heap;
+
+namespace collector {
+
+// A stop-the-world copying collector. Every reachable movable object of the from-space is
+// evacuated into the to-space, references to it are updated and the from-space is emptied
+// afterwards. Objects of the non-moving alloc space and the large object space are marked and
+// swept in place, the image and zygote spaces are scanned for references into the from-space.
+//
+// A generational semi-space collector only evacuates the nursery, promoting its survivors into the
+// alloc space. Every object outside of the nursery is assumed to be live, the objects on dirty
+// cards act as the remembered set, so a collection costs in proportion to the live young objects.
+//
+// Survivors of the nursery which don't fit into the alloc space stay in the nursery, forwarded to
+// themselves, and the nursery is only emptied by a later collection.
+class SemiSpace : public GarbageCollector {
+ public:
+  explicit SemiSpace(Heap* heap, bool generational = false, const std::string& name_prefix = "");
+
+  ~SemiSpace() {}
+
+  virtual void InitializePhase();
+  virtual bool IsConcurrent() const {
+    return false;
+  }
+  virtual void MarkingPhase() EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+  virtual void ReclaimPhase() EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+  virtual void FinishPhase();
+  virtual GcType GetGcType() const {
+    return generational_ ? kGcTypeSticky : kGcTypeFull;
+  }
+
+  bool IsGenerational() const {
+    return generational_;
+  }
+
+  // Sets the space to evacuate and the space which receives the survivors. The from-space is
+  // either a bump pointer space or the alloc space, the to-space either a bump pointer space or
+  // the alloc space. Must be called before every run.
+  void SetSpaces(space::ContinuousSpace* from_space, space::ContinuousSpace* to_space);
+
+  // True if the last run bailed out without moving anything since native code had pinned arrays.
+  bool WasSkipped() const {
+    return skipped_;
+  }
+
+  // True if the last run left survivors in the nursery since the alloc space was full.
+  bool PromotionFailed() const {
+    return !unpromoted_objects_.empty();
+  }
+
+  virtual size_t GetFreedBytes() const {
+    return freed_bytes_;
+  }
+
+  virtual size_t GetFreedObjects() const {
+    return freed_objects_;
+  }
+
+  virtual size_t GetFreedLargeObjectBytes() const {
+    return freed_large_object_bytes_;
+  }
+
+  virtual size_t GetFreedLargeObjects() const {
+    return freed_large_objects_;
+  }
+
+  // Returns the new address of the object, copying it into the to-space if it hasn't been
+  // reached yet. Objects outside of the from-space are marked in place.
+  mirror::Object* MarkObject(mirror::Object* obj)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // Returns NULL if the object is dead, otherwise its address after the collection.
+  mirror::Object* GetMarkedForwardingAddress(mirror::Object* obj) const
+      SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  static mirror::Object* MarkRootCallback(mirror::Object* root, void* arg)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  static mirror::Object* MarkedForwardingAddressCallback(mirror::Object* object, void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+ protected:
+  // The image and zygote spaces, never collected and only scanned for references.
+  bool IsImmune(const mirror::Object* obj) const;
+
+  // Reads the address of the copy of a reached from-space object, an object which couldn't be
+  // promoted is its own copy.
+  mirror::Object* GetForwardingAddressInFromSpace(mirror::Object* obj) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Visits every object of the image and zygote spaces, updating their references.
+  void ScanImmuneSpaces()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // Visits the objects on the dirty cards of the spaces outside of the nursery, the only ones
+  // which can refer to young objects, then clears the cards. The image and zygote cards are kept
+  // in their mod-union tables for the next mark sweep. After a promotion failure the objects left
+  // in the nursery may be referred to from clean cards, every old object is visited instead.
+  void ScanRememberedSet()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // Updates the references of obj, delaying the referent of java.lang.ref.References.
+  void ScanObject(mirror::Object* obj)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  void ProcessMarkStack()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  mirror::Object* Copy(mirror::Object* obj)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  void PushOnMarkStack(mirror::Object* obj);
+
+  // Same as in MarkSweep, except that surviving referents have their address updated.
+  void DelayReferenceReferent(mirror::Class* klass, mirror::Object* obj)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+  void ProcessReferences()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+  void PreserveSomeSoftReferences(mirror::Object** list)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+  void ClearWhiteReferences(mirror::Object** list)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+  void EnqueueFinalizerReferences(mirror::Object** list)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  void SweepSystemWeaks()
+      SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // Frees the dead objects and empties the from-space, called with the heap bitmap lock held.
+  void Reclaim() EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // Gives the objects which couldn't be promoted their lock words back, they are the only live
+  // objects of the nursery from now on.
+  void RestoreUnpromotedObjects()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // Frees the dead objects of the alloc space and the large object space.
+  void Sweep() EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+  void SweepLargeObjects() EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+  static void SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+
+  // Swaps the live and mark bitmaps of the spaces which were swept in place.
+  void SwapBitmaps() EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+
+  space::ContinuousSpace* from_space_;
+  space::ContinuousSpace* to_space_;
+  // The to-space as an allocator, a bump pointer space or the alloc space.
+  space::AllocSpace* to_alloc_space_;
+  // The alloc space, its objects are marked and swept in place unless it is the from-space.
+  space::MallocSpace* non_moving_space_;
+
+  accounting::SpaceBitmap* from_mark_bitmap_;
+  accounting::SpaceBitmap* to_live_bitmap_;
+  accounting::SpaceBitmap* to_mark_bitmap_;
+  accounting::SpaceBitmap* non_moving_mark_bitmap_;
+
+  accounting::ObjectStack* mark_stack_;
+
+  mirror::Object* immune_begin_;
+  mirror::Object* immune_end_;
+
+  mirror::Object* soft_reference_list_;
+  mirror::Object* weak_reference_list_;
+  mirror::Object* finalizer_reference_list_;
+  mirror::Object* phantom_reference_list_;
+  mirror::Object* cleared_reference_list_;
+
+  size_t bytes_moved_;
+  size_t objects_moved_;
+
+  // The survivors of the nursery which didn't fit into the alloc space, along with their lock
+  // words. Their lock words hold their own address until the collection is done.
+  std::vector<std::pair<mirror::Object*, uint32_t> > unpromoted_objects_;
+  size_t freed_bytes_;
+  size_t freed_objects_;
+  size_t freed_large_object_bytes_;
+  size_t freed_large_objects_;
+
+  // Only the from-space is collected, see the class comment. The heap turns it off for a run which
+  // has to sweep the alloc space as well.
+  bool generational_;
+
+  bool clear_soft_references_;
+  bool skipped_;
+
+ private:
+  friend class art::gc::Heap;
+  friend class SemiSpaceScanImmuneVisitor;
+
+  DISALLOW_COPY_AND_ASSIGN(SemiSpace);
+};
+
+}  // namespace collector
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_COLLECTOR_SEMI_SPACE_H_
@@ -24,6 +24,7 @@
 #include <valgrind.h>
 
 #include "base/stl_util.h"
+#include "class_linker.h"
 #include "common_throws.h"
 #include "cutils/sched_policy.h"
 #include "debugger.h"
@@ -34,13 +35,17 @@
 #include "gc/accounting/space_bitmap-inl.h"
 #include "gc/collector/mark_sweep-inl.h"
 #include "gc/collector/partial_mark_sweep.h"
+#include "gc/collector/semi_space.h"
 #include "gc/collector/sticky_mark_sweep.h"
+#include "gc/space/bump_pointer_space-inl.h"
 #include "gc/space/dlmalloc_space-inl.h"
 #include "gc/space/image_space.h"
 #include "gc/space/large_object_space.h"
+#include "gc/space/rosalloc_space-inl.h"
 #include "gc/space/space-inl.h"
 #include "image.h"
 #include "invoke_arg_array_builder.h"
+#include "jni_internal.h"
 #include "mirror/art_field-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object.h"
@@ -70,7 +75,8 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
            double target_utilization, size_t capacity, const std::string& original_image_file_name,
            bool concurrent_gc, size_t parallel_gc_threads, size_t conc_gc_threads,
            bool low_memory_mode, size_t long_pause_log_threshold, size_t long_gc_log_threshold,
-           bool ignore_max_footprint)
+           bool ignore_max_footprint, bool use_tlab, bool use_rosalloc,
+           bool use_background_compaction, size_t nursery_size)
     : alloc_space_(NULL),
       card_table_(NULL),
       concurrent_gc_(concurrent_gc),
@@ -80,6 +86,15 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
       long_pause_log_threshold_(long_pause_log_threshold),
       long_gc_log_threshold_(long_gc_log_threshold),
       ignore_max_footprint_(ignore_max_footprint),
+      use_tlab_(use_tlab),
+      use_rosalloc_(use_rosalloc && RUNNING_ON_VALGRIND == 0),
+      use_background_compaction_(use_background_compaction),
+      collector_type_(kCollectorTypeMS),
+      bump_pointer_space_(NULL),
+      temp_space_(NULL),
+      nursery_space_(NULL),
+      close_nursery_(false),
+      nursery_promotion_failed_(false),
       have_zygote_space_(false),
       soft_ref_queue_lock_(NULL),
       weak_ref_queue_lock_(NULL),
@@ -136,6 +151,8 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
       total_wait_time_(0),
       total_allocation_time_(0),
       verify_object_mode_(kHeapVerificationNotPermitted),
+      semi_space_collector_(NULL),
+      nursery_collector_(NULL),
       running_on_valgrind_(RUNNING_ON_VALGRIND) {
   if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
     LOG(INFO) << "Heap() entering";
@@ -162,14 +179,58 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
     }
   }
 
-  alloc_space_ = space::DlMallocSpace::Create(Runtime::Current()->IsZygote() ? "zygote space" : "alloc space",
-                                              initial_size,
-                                              growth_limit, capacity,
-                                              requested_alloc_space_begin);
+  const char* alloc_space_name = Runtime::Current()->IsZygote() ? "zygote space" : "alloc space";
+  if (use_rosalloc_) {
+    alloc_space_ = space::RosAllocSpace::Create(alloc_space_name, initial_size, growth_limit,
+                                                capacity, requested_alloc_space_begin);
+  } else {
+    alloc_space_ = space::DlMallocSpace::Create(alloc_space_name, initial_size, growth_limit,
+                                                capacity, requested_alloc_space_begin);
+  }
   CHECK(alloc_space_ != NULL) << "Failed to create alloc space";
   alloc_space_->SetFootprintLimit(alloc_space_->Capacity());
   AddContinuousSpace(alloc_space_);
 
+  if (use_background_compaction_) {
+    // Reserve the two semi-spaces right after the alloc space so that they are covered by the card
+    // table and stay out of the immune region. They only join the continuous spaces once the
+    // process goes to the background.
+    byte* bump_pointer_space_begin = alloc_space_->Begin() + alloc_space_->NonGrowthLimitCapacity();
+    bump_pointer_space_ = space::BumpPointerSpace::Create("bump pointer space", capacity,
+                                                          bump_pointer_space_begin);
+    if (bump_pointer_space_ != NULL && bump_pointer_space_->Begin() == bump_pointer_space_begin) {
+      byte* temp_space_begin = bump_pointer_space_->Begin() + bump_pointer_space_->Capacity();
+      temp_space_ = space::BumpPointerSpace::Create("bump pointer space 2", capacity,
+                                                    temp_space_begin);
+    }
+    if (temp_space_ == NULL || bump_pointer_space_->Begin() != bump_pointer_space_begin ||
+        temp_space_->Begin() != bump_pointer_space_->Begin() + bump_pointer_space_->Capacity()) {
+      LOG(WARNING) << "Failed to reserve the bump pointer spaces after the alloc space, "
+                   << "background compaction disabled";
+      delete bump_pointer_space_;
+      delete temp_space_;
+      bump_pointer_space_ = NULL;
+      temp_space_ = NULL;
+      use_background_compaction_ = false;
+    }
+  }
+
+  if (nursery_size != 0 && use_background_compaction_) {
+    LOG(WARNING) << "A nursery can't be combined with background compaction, ignoring it";
+    nursery_size = 0;
+  }
+  if (nursery_size != 0) {
+    // Like the bump pointer spaces of the background compaction, the nursery follows the alloc
+    // space so that the card table covers it.
+    byte* nursery_begin = alloc_space_->Begin() + alloc_space_->NonGrowthLimitCapacity();
+    nursery_space_ = space::BumpPointerSpace::Create("nursery space", nursery_size, nursery_begin);
+    if (nursery_space_ == NULL || nursery_space_->Begin() != nursery_begin) {
+      LOG(WARNING) << "Failed to reserve the nursery after the alloc space, continuing without";
+      delete nursery_space_;
+      nursery_space_ = NULL;
+    }
+  }
+
   // Allocate the large object space.
   const bool kUseFreeListSpaceForLOS = false;
   if (kUseFreeListSpaceForLOS) {
@@ -183,8 +244,14 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
   // Compute heap capacity. Continuous spaces are sorted in order of Begin().
   byte* heap_begin = continuous_spaces_.front()->Begin();
   size_t heap_capacity = continuous_spaces_.back()->End() - continuous_spaces_.front()->Begin();
-  if (continuous_spaces_.back()->IsDlMallocSpace()) {
-    heap_capacity += continuous_spaces_.back()->AsDlMallocSpace()->NonGrowthLimitCapacity();
+  if (continuous_spaces_.back()->IsMallocSpace()) {
+    heap_capacity += continuous_spaces_.back()->AsMallocSpace()->NonGrowthLimitCapacity();
+  }
+  if (temp_space_ != NULL) {
+    heap_capacity = temp_space_->Begin() + temp_space_->Capacity() - heap_begin;
+  }
+  if (nursery_space_ != NULL) {
+    heap_capacity = nursery_space_->Begin() + nursery_space_->Capacity() - heap_begin;
   }
 
   // Allocate the card table.
@@ -236,6 +303,15 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
     mark_sweep_collectors_.push_back(new collector::PartialMarkSweep(this, concurrent));
     mark_sweep_collectors_.push_back(new collector::StickyMarkSweep(this, concurrent));
   }
+  semi_space_collector_ = new collector::SemiSpace(this);
+  if (nursery_space_ != NULL) {
+    nursery_collector_ = new collector::SemiSpace(this, true, "generational");
+    // The zygote opens the nursery once it has created its zygote space, objects which end up in
+    // there are never moved.
+    if (!Runtime::Current()->IsZygote()) {
+      OpenNursery();
+    }
+  }
 
   CHECK_NE(max_allowed_footprint_, 0U);
   if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
@@ -380,8 +456,8 @@ void Heap::AddContinuousSpace(space::ContinuousSpace* space) {
   DCHECK(space->GetMarkBitmap() != NULL);
   mark_bitmap_->AddContinuousSpaceBitmap(space->GetMarkBitmap());
   continuous_spaces_.push_back(space);
-  if (space->IsDlMallocSpace() && !space->IsLargeObjectSpace()) {
-    alloc_space_ = space->AsDlMallocSpace();
+  if (space->IsMallocSpace() && !space->IsLargeObjectSpace()) {
+    alloc_space_ = space->AsMallocSpace();
   }
 
   // Ensure that spaces remain sorted in increasing order of start address (required for CMS finger)
@@ -400,12 +476,71 @@ void Heap::AddContinuousSpace(space::ContinuousSpace* space) {
     } else if (space->IsZygoteSpace()) {
       DCHECK(!seen_alloc);
       seen_zygote = true;
-    } else if (space->IsDlMallocSpace()) {
+    } else if (space->IsMallocSpace()) {
       seen_alloc = true;
     }
   }
 }
 
+void Heap::RemoveContinuousSpace(space::ContinuousSpace* space) {
+  WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  DCHECK(space != NULL);
+  live_bitmap_->RemoveContinuousSpaceBitmap(space->GetLiveBitmap());
+  mark_bitmap_->RemoveContinuousSpaceBitmap(space->GetMarkBitmap());
+  auto it = std::find(continuous_spaces_.begin(), continuous_spaces_.end(), space);
+  DCHECK(it != continuous_spaces_.end());
+  continuous_spaces_.erase(it);
+}
+
+void Heap::SemiSpaceCollectionFinished(space::ContinuousSpace* from_space,
+                                       space::ContinuousSpace* to_space) {
+  if (from_space == nursery_space_) {
+    // The survivors were promoted into the alloc space. Mark sweep can't deal with the nursery,
+    // close it before collecting the old generation. Survivors which didn't fit are all that is
+    // left in the nursery, it stays open then.
+    DCHECK_EQ(collector_type_, kCollectorTypeGSS);
+    DCHECK_EQ(to_space, alloc_space_);
+    nursery_promotion_failed_ = nursery_space_->Size() != 0;
+    if (close_nursery_ && !nursery_promotion_failed_) {
+      RemoveContinuousSpace(nursery_space_);
+      collector_type_ = kCollectorTypeMS;
+    }
+  } else if (from_space == alloc_space_) {
+    // Entering the background, the survivors are in the bump pointer space.
+    DCHECK_EQ(collector_type_, kCollectorTypeMS);
+    DCHECK_EQ(to_space, bump_pointer_space_);
+    AddContinuousSpace(bump_pointer_space_);
+    AddContinuousSpace(temp_space_);
+    collector_type_ = kCollectorTypeSS;
+  } else if (to_space == alloc_space_) {
+    // Back in the foreground, both bump pointer spaces are empty.
+    DCHECK_EQ(collector_type_, kCollectorTypeSS);
+    RemoveContinuousSpace(bump_pointer_space_);
+    RemoveContinuousSpace(temp_space_);
+    collector_type_ = kCollectorTypeMS;
+  } else {
+    DCHECK_EQ(from_space, bump_pointer_space_);
+    DCHECK_EQ(to_space, temp_space_);
+    std::swap(bump_pointer_space_, temp_space_);
+  }
+}
+
+bool Heap::HasRoomForPromotion() const {
+  // Fragmentation and the extra word of moved hashed objects aren't accounted for, the collector
+  // leaves what doesn't fit in the nursery.
+  const size_t used = alloc_space_->GetBytesAllocated();
+  const size_t capacity = alloc_space_->Capacity();
+  return used <= capacity && capacity - used >= nursery_space_->Size();
+}
+
+void Heap::OpenNursery() {
+  DCHECK(nursery_space_ != NULL);
+  DCHECK_EQ(collector_type_, kCollectorTypeMS);
+  DCHECK_EQ(nursery_space_->Size(), 0U);
+  AddContinuousSpace(nursery_space_);
+  collector_type_ = kCollectorTypeGSS;
+}
+
 void Heap::RegisterGCAllocation(size_t bytes) {
   if (this != NULL) {
     gc_memory_overhead_.fetch_add(bytes);
@@ -435,7 +570,13 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
 
   // Dump cumulative loggers for each GC type.
   uint64_t total_paused_time = 0;
-  for (const auto& collector : mark_sweep_collectors_) {
+  std::vector<collector::GarbageCollector*> collectors(mark_sweep_collectors_.begin(),
+                                                       mark_sweep_collectors_.end());
+  collectors.push_back(semi_space_collector_);
+  if (nursery_collector_ != NULL) {
+    collectors.push_back(nursery_collector_);
+  }
+  for (const auto& collector : collectors) {
     CumulativeLogger& logger = collector->GetCumulativeTimings();
     if (logger.GetTotalNs() != 0) {
       os << Dumpable<CumulativeLogger>(logger);
@@ -450,6 +591,7 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
          << " objects with total size " << PrettySize(freed_bytes) << "\n"
          << collector->GetName() << " throughput: " << freed_objects / seconds << "/s / "
          << PrettySize(freed_bytes / seconds) << "/s\n";
+      collector->DumpPerformanceInfo(os);
       total_duration += total_ns;
       total_paused_time += total_pause_ns;
     }
@@ -483,6 +625,8 @@ Heap::~Heap() {
   }
 
   STLDeleteElements(&mark_sweep_collectors_);
+  delete semi_space_collector_;
+  delete nursery_collector_;
 
   // If we don't reset then the mark stack complains in it's destructor.
   allocation_stack_->Reset();
@@ -493,6 +637,15 @@ Heap::~Heap() {
   // heap lock held. We know though that no non-daemon threads are executing, and we know that
   // all daemon threads are suspended, and we also know that the threads list have been deleted, so
   // those threads can't resume. We're the only running thread, and we can do whatever we like...
+  // The bump pointer spaces are owned by the heap even while they are in the continuous spaces.
+  continuous_spaces_.erase(std::remove_if(continuous_spaces_.begin(), continuous_spaces_.end(),
+                                          [](const space::ContinuousSpace* space) {
+                                            return space->IsBumpPointerSpace();
+                                          }),
+                           continuous_spaces_.end());
+  delete bump_pointer_space_;
+  delete temp_space_;
+  delete nursery_space_;
   STLDeleteElements(&continuous_spaces_);
   STLDeleteElements(&discontinuous_spaces_);
   delete gc_complete_lock_;
@@ -554,11 +707,13 @@ static void MSpaceChunkCallback(void* start, void* end, size_t used_bytes, void*
   }
 }
 
-mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_count) {
+mirror::Object* Heap::AllocObjectInternal(Thread* self, mirror::Class* c, size_t byte_count,
+                                          bool movable) {
   DCHECK(c == NULL || (c->IsClassClass() && byte_count >= sizeof(mirror::Class)) ||
          (c->IsVariableSize() || c->GetObjectSize() == byte_count) ||
          strlen(ClassHelper(c).GetDescriptor()) == 0);
   DCHECK_GE(byte_count, sizeof(mirror::Object));
+  DCHECK(movable || c->IsPrimitiveArray());
 
   mirror::Object* obj = NULL;
   size_t bytes_allocated = 0;
@@ -571,8 +726,9 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
   // Zygote resulting in it being prematurely freed.
   // We can only do this for primitive objects since large objects will not be within the card table
   // range. This also means that we rely on SetClass not dirtying the object's card.
-  bool large_object_allocation =
-      byte_count >= large_object_threshold_ && have_zygote_space_ && c->IsPrimitiveArray();
+  // Non-movable arrays go there too since the alloc space gets evacuated when compacting.
+  bool large_object_allocation = (byte_count >= large_object_threshold_ || !movable) &&
+      have_zygote_space_ && c->IsPrimitiveArray();
   if (UNLIKELY(large_object_allocation)) {
     obj = Allocate(self, large_object_space_, byte_count, &bytes_allocated);
     // Make sure that our large object didn't get placed anywhere within the space interval or else
@@ -580,8 +736,19 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
     DCHECK(obj == NULL ||
            reinterpret_cast<byte*>(obj) < continuous_spaces_.front()->Begin() ||
            reinterpret_cast<byte*>(obj) >= continuous_spaces_.back()->End());
+  } else if (collector_type_ == kCollectorTypeSS && movable && IsMovableObjectClass(c)) {
+    obj = Allocate(self, bump_pointer_space_, byte_count, &bytes_allocated);
+  } else if (collector_type_ == kCollectorTypeGSS && byte_count < large_object_threshold_ &&
+             movable && IsMovableObjectClass(c)) {
+    // Big objects are pretenured, copying them around isn't worth it and they could fill up the
+    // nursery on their own.
+    obj = Allocate(self, nursery_space_, byte_count, &bytes_allocated);
   } else {
-    obj = Allocate(self, alloc_space_, byte_count, &bytes_allocated);
+    if (use_rosalloc_) {
+      obj = Allocate(self, alloc_space_->AsRosAllocSpace(), byte_count, &bytes_allocated);
+    } else {
+      obj = Allocate(self, alloc_space_->AsDlMallocSpace(), byte_count, &bytes_allocated);
+    }
     // Ensure that we did not allocate into a zygote space.
     DCHECK(obj == NULL || !have_zygote_space_ || !FindSpaceFromObject(obj, false)->IsZygoteSpace());
   }
@@ -591,7 +758,7 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
 
     // Record allocation after since we want to use the atomic add for the atomic fence to guard
     // the SetClass since we do not want the class to appear NULL in another thread.
-    RecordAllocation(bytes_allocated, obj);
+    obj = RecordAllocation(bytes_allocated, obj);
 
     if (Dbg::IsAllocTrackingEnabled()) {
       Dbg::RecordAllocation(c, byte_count);
@@ -600,6 +767,7 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
       // The SirtRef is necessary since the calls in RequestConcurrentGC are a safepoint.
       SirtRef<mirror::Object> ref(self, obj);
       RequestConcurrentGC(self);
+      obj = ref.get();
     }
     if (kDesiredHeapVerification > kNoHeapVerification) {
       VerifyObject(obj);
@@ -619,8 +787,8 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
     if (!large_object_allocation && total_bytes_free >= byte_count) {
       size_t max_contiguous_allocation = 0;
       for (const auto& space : continuous_spaces_) {
-        if (space->IsDlMallocSpace()) {
-          space->AsDlMallocSpace()->Walk(MSpaceChunkCallback, &max_contiguous_allocation);
+        if (space->IsMallocSpace()) {
+          space->AsMallocSpace()->Walk(MSpaceChunkCallback, &max_contiguous_allocation);
         }
       }
       oss << "; failed due to fragmentation (largest possible contiguous allocation "
@@ -631,6 +799,41 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
   }
 }
 
+bool Heap::IsMovableObjectClass(const mirror::Class* klass) const {
+  if (klass->IsClassClass() || klass->IsArtMethodClass() || klass->IsArtFieldClass()) {
+    return false;
+  }
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  return klass != class_linker->GetClassRoot(ClassLinker::kJavaLangDexCache) &&
+      !class_linker->GetClassRoot(ClassLinker::kJavaLangClassLoader)->IsAssignableFrom(klass);
+}
+
+bool Heap::IsMovableObject(const mirror::Object* obj) const {
+  return IsMovableObjectClass(obj->GetClass());
+}
+
+bool Heap::IsNonMovable(const mirror::Object* obj) const {
+  if (!IsMovableObject(obj)) {
+    return true;
+  }
+  space::ContinuousSpace* space = FindContinuousSpaceFromObject(obj, true);
+  if (space == NULL) {
+    // Large objects are never moved.
+    return true;
+  }
+  if (space->IsImageSpace() || space->IsZygoteSpace()) {
+    return true;
+  }
+  // The alloc space is only evacuated once there is a zygote space, it becomes the zygote space.
+  return space == alloc_space_ && (!have_zygote_space_ || !use_background_compaction_);
+}
+
+bool Heap::IsMovingGcDisabled(Thread* self) {
+  JavaVMExt* vm = Runtime::Current()->GetJavaVM();
+  MutexLock mu(self, vm->pins_lock);
+  return vm->pin_table.Size() != 0;
+}
+
 bool Heap::IsHeapAddress(const mirror::Object* obj) {
   // Note: we deliberately don't take the lock here, and mustn't test anything that would
   // require taking the lock.
@@ -771,7 +974,7 @@ void Heap::VerifyHeap() {
   GetLiveBitmap()->Walk(Heap::VerificationCallback, this);
 }
 
-inline void Heap::RecordAllocation(size_t size, mirror::Object* obj) {
+inline mirror::Object* Heap::RecordAllocation(size_t size, mirror::Object* obj) {
   DCHECK(obj != NULL);
   DCHECK_GT(size, 0u);
   num_bytes_allocated_.fetch_add(size);
@@ -789,9 +992,15 @@ inline void Heap::RecordAllocation(size_t size, mirror::Object* obj) {
 
   // This is safe to do since the GC will never free objects which are neither in the allocation
   // stack or the live bitmap.
-  while (!allocation_stack_->AtomicPushBack(obj)) {
-    CollectGarbageInternal(collector::kGcTypeSticky, kGcCauseForAlloc, false);
+  if (UNLIKELY(!allocation_stack_->AtomicPushBack(obj))) {
+    // The object isn't reachable from anywhere yet, keep it alive and up to date across the GCs.
+    SirtRef<mirror::Object> ref(Thread::Current(), obj);
+    do {
+      CollectGarbageInternal(collector::kGcTypeSticky, kGcCauseForAlloc, false);
+    } while (!allocation_stack_->AtomicPushBack(ref.get()));
+    obj = ref.get();
   }
+  return obj;
 }
 
 void Heap::RecordFree(size_t freed_objects, size_t freed_bytes) {
@@ -816,7 +1025,8 @@ inline bool Heap::IsOutOfMemoryOnAllocation(size_t alloc_size, bool grow) {
     if (UNLIKELY(new_footprint > growth_limit_)) {
       return true;
     }
-    if (!concurrent_gc_) {
+    // The semi-space collector is never started ahead of time.
+    if (!concurrent_gc_ || collector_type_ == kCollectorTypeSS) {
       if (!grow) {
         return true;
       } else {
@@ -842,12 +1052,50 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self, space::DlMallocSpace* s
     return NULL;
   }
   if (LIKELY(!running_on_valgrind_)) {
+    if (use_tlab_ && alloc_size <= kMaxTLABAllocationSize) {
+      mirror::Object* obj = space->AllocThreadLocal(self, alloc_size, bytes_allocated);
+      if (LIKELY(obj != NULL)) {
+        return obj;
+      }
+      // The buffer is exhausted, revoke it and try to get a fresh one before falling back to a
+      // regular allocation.
+      if (space->AllocNewThreadLocalBuffer(self, kDefaultTLABSize)) {
+        obj = space->AllocThreadLocal(self, alloc_size, bytes_allocated);
+        DCHECK(obj != NULL);
+        return obj;
+      }
+    }
     return space->AllocNonvirtual(self, alloc_size, bytes_allocated);
   } else {
     return space->Alloc(self, alloc_size, bytes_allocated);
   }
 }
 
+// RosAllocSpace-specific version.
+inline mirror::Object* Heap::TryToAllocate(Thread* self, space::RosAllocSpace* space, size_t alloc_size,
+                                           bool grow, size_t* bytes_allocated) {
+  if (UNLIKELY(IsOutOfMemoryOnAllocation(alloc_size, grow))) {
+    return NULL;
+  }
+  // The smaller size brackets are already served from thread-local runs, the TLABs only apply to
+  // dlmalloc.
+  return space->AllocNonvirtual(self, alloc_size, bytes_allocated);
+}
+
+// BumpPointerSpace-specific version.
+inline mirror::Object* Heap::TryToAllocate(Thread* self, space::BumpPointerSpace* space,
+                                           size_t alloc_size, bool grow,
+                                           size_t* bytes_allocated) {
+  if (UNLIKELY(IsOutOfMemoryOnAllocation(alloc_size, grow))) {
+    return NULL;
+  }
+  mirror::Object* obj = space->AllocNonvirtual(alloc_size);
+  if (LIKELY(obj != NULL)) {
+    *bytes_allocated = RoundUp(alloc_size, space::BumpPointerSpace::kAlignment);
+  }
+  return obj;
+}
+
 template <class T>
 inline mirror::Object* Heap::Allocate(Thread* self, T* space, size_t alloc_size,
                                       size_t* bytes_allocated) {
@@ -872,6 +1120,7 @@ mirror::Object* Heap::AllocateInternalWithGc(Thread* self, space::AllocSpace* sp
   collector::GcType last_gc = WaitForConcurrentGcToComplete(self);
   if (last_gc != collector::kGcTypeNone) {
     // A GC was in progress and we blocked, retry allocation now that memory has been freed.
+    space = GetSpaceAfterGc(space);
     ptr = TryToAllocate(self, space, alloc_size, false, bytes_allocated);
     if (ptr != NULL) {
       return ptr;
@@ -885,9 +1134,11 @@ mirror::Object* Heap::AllocateInternalWithGc(Thread* self, space::AllocSpace* sp
     collector::GcType gc_type = static_cast<collector::GcType>(i);
     switch (gc_type) {
       case collector::kGcTypeSticky: {
+          // Minor collections empty the nursery no matter how big the alloc space is.
           const size_t alloc_space_size = alloc_space_->Size();
-          run_gc = alloc_space_size > min_alloc_space_size_for_sticky_gc_ &&
-              alloc_space_->Capacity() - alloc_space_size >= min_remaining_space_for_sticky_gc_;
+          run_gc = collector_type_ == kCollectorTypeGSS ||
+              (alloc_space_size > min_alloc_space_size_for_sticky_gc_ &&
+               alloc_space_->Capacity() - alloc_space_size >= min_remaining_space_for_sticky_gc_);
           break;
         }
       case collector::kGcTypePartial:
@@ -907,6 +1158,7 @@ mirror::Object* Heap::AllocateInternalWithGc(Thread* self, space::AllocSpace* sp
       i = static_cast<size_t>(gc_type_ran);
 
       // Did we free sufficient memory for the allocation to succeed?
+      space = GetSpaceAfterGc(space);
       ptr = TryToAllocate(self, space, alloc_size, false, bytes_allocated);
       if (ptr != NULL) {
         return ptr;
@@ -931,9 +1183,30 @@ mirror::Object* Heap::AllocateInternalWithGc(Thread* self, space::AllocSpace* sp
 
   // We don't need a WaitForConcurrentGcToComplete here either.
   CollectGarbageInternal(collector::kGcTypeFull, kGcCauseForAlloc, true);
+  space = GetSpaceAfterGc(space);
   return TryToAllocate(self, space, alloc_size, true, bytes_allocated);
 }
 
+space::AllocSpace* Heap::GetSpaceAfterGc(space::AllocSpace* space) const {
+  // A semi-space collection swaps the bump pointer spaces, going back to mark sweep moves every
+  // object into the alloc space.
+  if (space == bump_pointer_space_ || space == temp_space_) {
+    if (collector_type_ == kCollectorTypeSS) {
+      return bump_pointer_space_;
+    }
+    return alloc_space_;
+  }
+  // The nursery is closed while the old generation is being collected. When native code pinned
+  // arrays or the alloc space was too full the nursery couldn't be emptied, pretenure rather than
+  // fail the allocation.
+  if (space == nursery_space_ &&
+      (collector_type_ != kCollectorTypeGSS || nursery_collector_->WasSkipped() ||
+       nursery_promotion_failed_)) {
+    return alloc_space_;
+  }
+  return space;
+}
+
 void Heap::SetTargetHeapUtilization(float target) {
   DCHECK_GT(target, 0.0f);  // asserted in Java code
   DCHECK_LT(target, 1.0f);
@@ -945,8 +1218,10 @@ size_t Heap::GetObjectsAllocated() const {
   typedef std::vector<space::ContinuousSpace*>::const_iterator It;
   for (It it = continuous_spaces_.begin(), end = continuous_spaces_.end(); it != end; ++it) {
     space::ContinuousSpace* space = *it;
-    if (space->IsDlMallocSpace()) {
-      total += space->AsDlMallocSpace()->GetObjectsAllocated();
+    if (space->IsMallocSpace()) {
+      total += space->AsMallocSpace()->GetObjectsAllocated();
+    } else if (space->IsBumpPointerSpace()) {
+      total += space->AsBumpPointerSpace()->GetObjectsAllocated();
     }
   }
   typedef std::vector<space::DiscontinuousSpace*>::const_iterator It2;
@@ -962,8 +1237,10 @@ size_t Heap::GetObjectsAllocatedEver() const {
   typedef std::vector<space::ContinuousSpace*>::const_iterator It;
   for (It it = continuous_spaces_.begin(), end = continuous_spaces_.end(); it != end; ++it) {
     space::ContinuousSpace* space = *it;
-    if (space->IsDlMallocSpace()) {
-      total += space->AsDlMallocSpace()->GetTotalObjectsAllocated();
+    if (space->IsMallocSpace()) {
+      total += space->AsMallocSpace()->GetTotalObjectsAllocated();
+    } else if (space->IsBumpPointerSpace()) {
+      total += space->AsBumpPointerSpace()->GetTotalObjectsAllocated();
     }
   }
   typedef std::vector<space::DiscontinuousSpace*>::const_iterator It2;
@@ -979,8 +1256,10 @@ size_t Heap::GetBytesAllocatedEver() const {
   typedef std::vector<space::ContinuousSpace*>::const_iterator It;
   for (It it = continuous_spaces_.begin(), end = continuous_spaces_.end(); it != end; ++it) {
     space::ContinuousSpace* space = *it;
-    if (space->IsDlMallocSpace()) {
-      total += space->AsDlMallocSpace()->GetTotalBytesAllocated();
+    if (space->IsMallocSpace()) {
+      total += space->AsMallocSpace()->GetTotalBytesAllocated();
+    } else if (space->IsBumpPointerSpace()) {
+      total += space->AsBumpPointerSpace()->GetTotalBytesAllocated();
     }
   }
   typedef std::vector<space::DiscontinuousSpace*>::const_iterator It2;
@@ -1146,9 +1425,13 @@ void Heap::PreZygoteFork() {
     FlushAllocStack();
   }
 
+  // The allocation buffers belong to the current alloc space which is about to become the zygote
+  // space. The zygote is single threaded at this point so it is safe to revoke them all.
+  RevokeAllThreadLocalBuffers();
+
   // Turns the current alloc space into a Zygote space and obtain the new alloc space composed
   // of the remaining available heap memory.
-  space::DlMallocSpace* zygote_space = alloc_space_;
+  space::MallocSpace* zygote_space = alloc_space_;
   alloc_space_ = zygote_space->CreateZygoteSpace("alloc space");
   alloc_space_->SetFootprintLimit(alloc_space_->Capacity());
 
@@ -1157,12 +1440,32 @@ void Heap::PreZygoteFork() {
   AddContinuousSpace(alloc_space_);
   have_zygote_space_ = true;
 
+  // Nothing moves into the zygote space any more, start allocating young objects.
+  if (nursery_space_ != NULL) {
+    OpenNursery();
+  }
+
   // Reset the cumulative loggers since we now have a few additional timing phases.
   for (const auto& collector : mark_sweep_collectors_) {
     collector->ResetCumulativeStatistics();
   }
 }
 
+void Heap::RevokeThreadLocalBuffers(Thread* thread) {
+  if (use_tlab_ || use_rosalloc_) {
+    alloc_space_->RevokeThreadLocalBuffer(thread);
+  }
+}
+
+void Heap::RevokeAllThreadLocalBuffers() {
+  if (use_tlab_ || use_rosalloc_) {
+    MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+    for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+      alloc_space_->RevokeThreadLocalBuffer(thread);
+    }
+  }
+}
+
 void Heap::FlushAllocStack() {
   MarkAllocStack(alloc_space_->GetLiveBitmap(), large_object_space_->GetLiveObjects(),
                  allocation_stack_.get());
@@ -1177,6 +1480,10 @@ void Heap::MarkAllocStack(accounting::SpaceBitmap* bitmap, accounting::SpaceSetM
     DCHECK(obj != NULL);
     if (LIKELY(bitmap->HasAddress(obj))) {
       bitmap->Set(obj);
+    } else if (collector_type_ == kCollectorTypeSS && bump_pointer_space_->HasAddress(obj)) {
+      bump_pointer_space_->GetLiveBitmap()->Set(obj);
+    } else if (collector_type_ == kCollectorTypeGSS && nursery_space_->HasAddress(obj)) {
+      nursery_space_->GetLiveBitmap()->Set(obj);
     } else {
       large_objects->Set(obj);
     }
@@ -1237,30 +1544,78 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type, GcCaus
     VLOG(heap) << "Allocation rate: " << PrettySize(allocation_rate_) << "/s";
   }
 
-  if (gc_type == collector::kGcTypeSticky &&
+  if (gc_type == collector::kGcTypeSticky && collector_type_ != kCollectorTypeGSS &&
       alloc_space_->Size() < min_alloc_space_size_for_sticky_gc_) {
     gc_type = collector::kGcTypePartial;
   }
 
+  collector::GarbageCollector* collector = NULL;
+  if (use_background_compaction_ && have_zygote_space_ &&
+      (collector_type_ == kCollectorTypeSS || !care_about_pause_times_)) {
+    // Background processes compact their heap with the semi-space collector. Coming back to the
+    // foreground moves every object into the alloc space and switches back to mark sweep, the
+    // switch itself happens while the world is stopped.
+    gc_type = collector::kGcTypeFull;
+    if (collector_type_ == kCollectorTypeMS) {
+      semi_space_collector_->SetSpaces(alloc_space_, bump_pointer_space_);
+    } else if (care_about_pause_times_) {
+      semi_space_collector_->SetSpaces(bump_pointer_space_, alloc_space_);
+    } else {
+      semi_space_collector_->SetSpaces(bump_pointer_space_, temp_space_);
+    }
+    semi_space_collector_->clear_soft_references_ = clear_soft_references;
+    collector = semi_space_collector_;
+  } else if (collector_type_ == kCollectorTypeGSS) {
+    // Sticky collections only promote the survivors of the nursery. The others empty the nursery
+    // the same way first, and then collect the old generation with mark sweep. When the survivors
+    // may not fit into the alloc space, mark sweep couldn't run while some of them are left in the
+    // nursery. The semi-space collection traces the whole heap and sweeps the alloc space itself
+    // then.
+    const bool whole_heap = !HasRoomForPromotion();
+    if (whole_heap) {
+      gc_type = collector::kGcTypeFull;
+    }
+    nursery_collector_->SetSpaces(nursery_space_, alloc_space_);
+    nursery_collector_->generational_ = !whole_heap;
+    nursery_collector_->clear_soft_references_ = clear_soft_references;
+    close_nursery_ = gc_type != collector::kGcTypeSticky && !whole_heap;
+    collector = nursery_collector_;
+  } else {
+    collector::MarkSweep* mark_sweep = FindMarkSweepCollector(gc_type);
+    mark_sweep->clear_soft_references_ = clear_soft_references;
+    collector = mark_sweep;
+  }
+
   DCHECK_LT(gc_type, collector::kGcTypeMax);
   DCHECK_NE(gc_type, collector::kGcTypeNone);
   DCHECK_LE(gc_cause, kGcCauseExplicit);
 
   ATRACE_BEGIN(gc_cause_and_type_strings[gc_cause][gc_type]);
 
-  collector::MarkSweep* collector = NULL;
-  for (const auto& cur_collector : mark_sweep_collectors_) {
-    if (cur_collector->IsConcurrent() == concurrent_gc_ && cur_collector->GetGcType() == gc_type) {
-      collector = cur_collector;
-      break;
-    }
-  }
-  CHECK(collector != NULL)
-      << "Could not find garbage collector with concurrent=" << concurrent_gc_
-      << " and type=" << gc_type;
-
-  collector->clear_soft_references_ = clear_soft_references;
   collector->Run();
+  if (collector == nursery_collector_ && close_nursery_ && !nursery_collector_->WasSkipped() &&
+      !nursery_promotion_failed_) {
+    DCHECK_EQ(collector_type_, kCollectorTypeMS);
+    close_nursery_ = false;
+    total_objects_freed_ever_ += collector->GetFreedObjects();
+    total_bytes_freed_ever_ += collector->GetFreedBytes();
+    collector::MarkSweep* mark_sweep = FindMarkSweepCollector(gc_type);
+    mark_sweep->clear_soft_references_ = clear_soft_references;
+    collector = mark_sweep;
+    collector->Run();
+    // Mutators read the collector type without holding a lock, only switch back to the nursery
+    // while they are suspended.
+    ThreadList* thread_list = Runtime::Current()->GetThreadList();
+    thread_list->SuspendAll();
+    OpenNursery();
+    thread_list->ResumeAll();
+  }
+  close_nursery_ = false;
+  if ((collector == semi_space_collector_ || collector == nursery_collector_) &&
+      down_cast<collector::SemiSpace*>(collector)->WasSkipped()) {
+    LOG(WARNING) << "Skipped " << collector->GetName() << " collection, primitive arrays are "
+                 << "pinned by native code, staying with " << collector_type_;
+  }
   total_objects_freed_ever_ += collector->GetFreedObjects();
   total_bytes_freed_ever_ += collector->GetFreedBytes();
   if (care_about_pause_times_) {
@@ -1284,6 +1639,8 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type, GcCaus
             pause_string << PrettyDuration((pauses[i] / 1000) * 1000)
                          << ((i != pauses.size() - 1) ? ", " : "");
         }
+        std::ostringstream log_info;
+        collector->DumpLogInfo(log_info);
         LOG(INFO) << gc_cause << " " << collector->GetName()
                   << " GC freed "  <<  collector->GetFreedObjects() << "("
                   << PrettySize(collector->GetFreedBytes()) << ") AllocSpace objects, "
@@ -1291,7 +1648,7 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type, GcCaus
                   << PrettySize(collector->GetFreedLargeObjectBytes()) << ") LOS objects, "
                   << percent_free << "% free, " << PrettySize(current_heap_size) << "/"
                   << PrettySize(total_memory) << ", " << "paused " << pause_string.str()
-                  << " total " << PrettyDuration((duration / 1000) * 1000);
+                  << " total " << PrettyDuration((duration / 1000) * 1000) << log_info.str();
         if (VLOG_IS_ON(heap)) {
             LOG(INFO) << Dumpable<base::TimingLogger>(collector->GetTimings());
         }
@@ -1313,6 +1670,17 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type, GcCaus
   return gc_type;
 }
 
+collector::MarkSweep* Heap::FindMarkSweepCollector(collector::GcType gc_type) const {
+  for (const auto& cur_collector : mark_sweep_collectors_) {
+    if (cur_collector->IsConcurrent() == concurrent_gc_ && cur_collector->GetGcType() == gc_type) {
+      return cur_collector;
+    }
+  }
+  LOG(FATAL) << "Could not find garbage collector with concurrent=" << concurrent_gc_
+             << " and type=" << gc_type;
+  return NULL;
+}
+
 void Heap::UpdateAndMarkModUnion(collector::MarkSweep* mark_sweep, base::TimingLogger& timings,
                                  collector::GcType gc_type) {
   if (gc_type == collector::kGcTypeSticky) {
@@ -1340,11 +1708,12 @@ void Heap::UpdateAndMarkModUnion(collector::MarkSweep* mark_sweep, base::TimingL
   image_mod_union_table_->MarkReferences(mark_sweep);
 }
 
-static void RootMatchesObjectVisitor(const mirror::Object* root, void* arg) {
+static mirror::Object* RootMatchesObjectVisitor(mirror::Object* root, void* arg) {
   mirror::Object* obj = reinterpret_cast<mirror::Object*>(arg);
   if (root == obj) {
     LOG(INFO) << "Object " << obj << " is a root";
   }
+  return root;
 }
 
 class ScanVisitor {
@@ -1393,8 +1762,8 @@ class VerifyReferenceVisitor {
 
         // Attmept to find the class inside of the recently freed objects.
         space::ContinuousSpace* ref_space = heap_->FindContinuousSpaceFromObject(ref, true);
-        if (ref_space->IsDlMallocSpace()) {
-          space::DlMallocSpace* space = ref_space->AsDlMallocSpace();
+        if (ref_space->IsMallocSpace()) {
+          space::MallocSpace* space = ref_space->AsMallocSpace();
           mirror::Class* ref_class = space->FindRecentFreedObject(ref);
           if (ref_class != nullptr) {
             LOG(ERROR) << "Reference " << ref << " found as a recently freed object with class "
@@ -1459,9 +1828,10 @@ class VerifyReferenceVisitor {
     return heap_->IsLiveObjectLocked(obj, true, false, true);
   }
 
-  static void VerifyRoots(const mirror::Object* root, void* arg) {
+  static mirror::Object* VerifyRoots(mirror::Object* root, void* arg) {
     VerifyReferenceVisitor* visitor = reinterpret_cast<VerifyReferenceVisitor*>(arg);
     (*visitor)(NULL, root, MemberOffset(0), true);
+    return root;
   }
 
  private:
@@ -1543,9 +1913,11 @@ class VerifyReferenceCardVisitor {
       if (!card_table->AddrIsInCardTable(obj)) {
         LOG(ERROR) << "Object " << obj << " is not in the address range of the card table";
         *failed_ = true;
-      } else if (!card_table->IsDirty(obj)) {
+      } else if (!card_table->IsDirty(obj) &&
+                 card_table->GetCard(obj) != accounting::CardTable::kCardPreCleaned) {
         // Card should be either kCardDirty if it got re-dirtied after we aged it, or
-        // kCardDirty - 1 if it didnt get touched since we aged it.
+        // kCardDirty - 1 if it didnt get touched since we aged it. The last concurrent GC may
+        // have pre-cleaned it.
         accounting::ObjectStack* live_stack = heap_->live_stack_.get();
         if (live_stack->ContainsSorted(const_cast<mirror::Object*>(ref))) {
           if (live_stack->ContainsSorted(const_cast<mirror::Object*>(obj))) {
@@ -1826,7 +2198,10 @@ void Heap::GrowForUtilization(collector::GcType gc_type, uint64_t gc_duration) {
   if (!ignore_max_footprint_) {
     SetIdealFootprint(target_size);
 
-    if (concurrent_gc_) {
+    if (collector_type_ == kCollectorTypeSS) {
+      // The semi-space collector only runs when an allocation hits the footprint.
+      concurrent_start_bytes_ = std::numeric_limits<size_t>::max();
+    } else if (concurrent_gc_) {
       // Calculate when to perform the next ConcurrentGC.
 
       // Calculate the estimated GC duration.
@@ -1881,6 +2256,12 @@ mirror::Object* Heap::GetReferenceReferent(mirror::Object* reference) {
   return reference->GetFieldObject<mirror::Object*>(reference_referent_offset_, true);
 }
 
+void Heap::SetReferenceReferent(mirror::Object* reference, mirror::Object* referent) {
+  DCHECK(reference != NULL);
+  DCHECK_NE(reference_referent_offset_.Uint32Value(), 0U);
+  reference->SetFieldObject(reference_referent_offset_, referent, true);
+}
+
 void Heap::ClearReferenceReferent(mirror::Object* reference) {
   DCHECK(reference != NULL);
   DCHECK_NE(reference_referent_offset_.Uint32Value(), 0U);
@@ -2032,7 +2413,9 @@ void Heap::RequestHeapTrim() {
   uint64_t ms_time = MilliTime();
   float utilization =
       static_cast<float>(alloc_space_->GetBytesAllocated()) / alloc_space_->Size();
-  if ((utilization > 0.75f && !IsLowMemoryMode()) || ((ms_time - last_trim_time_ms_) < 2 * 1000)) {
+  // With background compaction the process state must be polled however utilized the heap is.
+  if ((utilization > 0.75f && !IsLowMemoryMode() && !use_background_compaction_) ||
+      ((ms_time - last_trim_time_ms_) < 2 * 1000)) {
     // Don't bother trimming the alloc space if it's more than 75% utilized and low memory mode is
     // not enabled, or if a heap trim occurred in the last two seconds.
     return;
@@ -2066,6 +2449,12 @@ void Heap::RequestHeapTrim() {
 
 size_t Heap::Trim() {
   // Handle a requested heap trim on a thread outside of the main GC thread.
+  if (use_background_compaction_ && collector_type_ == kCollectorTypeMS &&
+      !care_about_pause_times_) {
+    // The process went to the background, evacuate the alloc space into the bump pointer space
+    // which also switches the heap over to the semi-space collector.
+    CollectGarbageInternal(collector::kGcTypeFull, kGcCauseBackground, false);
+  }
   return alloc_space_->Trim();
 }
 
@@ -2133,9 +2522,9 @@ int64_t Heap::GetTotalMemory() const {
   for (const auto& space : continuous_spaces_) {
     if (space->IsImageSpace()) {
       // Currently don't include the image space.
-    } else if (space->IsDlMallocSpace()) {
+    } else if (space->IsMallocSpace()) {
       // Zygote or alloc space
-      ret += space->AsDlMallocSpace()->GetFootprint();
+      ret += space->AsMallocSpace()->GetFootprint();
     }
   }
   for (const auto& space : discontinuous_spaces_) {
@@ -57,14 +57,18 @@ namespace accounting {
 namespace collector {
   class GarbageCollector;
   class MarkSweep;
+  class SemiSpace;
 }  // namespace collector
 
 namespace space {
   class AllocSpace;
+  class BumpPointerSpace;
   class DiscontinuousSpace;
   class DlMallocSpace;
   class ImageSpace;
   class LargeObjectSpace;
+  class MallocSpace;
+  class RosAllocSpace;
   class Space;
   class SpaceTest;
 }  // namespace space
@@ -72,8 +76,9 @@ namespace space {
 class AgeCardVisitor {
  public:
   byte operator()(byte card) const {
-    if (card == accounting::CardTable::kCardDirty) {
-      return card - 1;
+    if (card == accounting::CardTable::kCardDirty ||
+        card == accounting::CardTable::kCardPreCleaned) {
+      return accounting::CardTable::kCardDirty - 1;
     } else {
       return 0;
     }
@@ -92,6 +97,18 @@ enum GcCause {
 };
 std::ostream& operator<<(std::ostream& os, const GcCause& policy);
 
+// Which kind of collector the heap currently runs.
+enum CollectorType {
+  // Non-moving mark sweep, concurrent or not depending on the concurrent GC option.
+  kCollectorTypeMS,
+  // Semi-space compaction of a bump pointer space, used while the process is in the background.
+  kCollectorTypeSS,
+  // Movable objects are allocated into a nursery which minor collections promote the survivors
+  // out of, mark sweep collects the old generation while the nursery is closed.
+  kCollectorTypeGSS,
+};
+std::ostream& operator<<(std::ostream& os, const CollectorType& collector_type);
+
 // How we want to sanity check the heap's correctness.
 enum HeapVerificationMode {
   kHeapVerificationNotPermitted,  // Too early in runtime start-up for heap to be verified.
@@ -109,6 +126,10 @@ class Heap {
   static constexpr size_t kDefaultMinFree = kDefaultMaxFree / 4;
   static constexpr size_t kDefaultLongPauseLogThreshold = MsToNs(5);
   static constexpr size_t kDefaultLongGCLogThreshold = MsToNs(100);
+  // Size of the thread-local allocation buffers handed out to threads when use_tlab is set.
+  static constexpr size_t kDefaultTLABSize = 16 * KB;
+  // Allocations larger than this bypass the thread-local allocation buffers.
+  static constexpr size_t kMaxTLABAllocationSize = kDefaultTLABSize / 8;
 
   // Default target utilization.
   static constexpr double kDefaultTargetUtilization = 0.5;
@@ -123,13 +144,25 @@ class Heap {
                 size_t max_free, double target_utilization, size_t capacity,
                 const std::string& original_image_file_name, bool concurrent_gc,
                 size_t parallel_gc_threads, size_t conc_gc_threads, bool low_memory_mode,
-                size_t long_pause_threshold, size_t long_gc_threshold, bool ignore_max_footprint);
+                size_t long_pause_threshold, size_t long_gc_threshold, bool ignore_max_footprint,
+                bool use_tlab, bool use_rosalloc, bool use_background_compaction,
+                size_t nursery_size);
 
   ~Heap();
 
   // Allocates and initializes storage for an object instance.
   mirror::Object* AllocObject(Thread* self, mirror::Class* klass, size_t num_bytes)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    return AllocObjectInternal(self, klass, num_bytes, true);
+  }
+
+  // Allocates a primitive array which no collector moves, its address may be handed to native
+  // code. Such arrays go to the large object space once the zygote space exists, before that to
+  // the alloc space which becomes the zygote space and neither is ever compacted.
+  mirror::Object* AllocNonMovableObject(Thread* self, mirror::Class* klass, size_t num_bytes)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    return AllocObjectInternal(self, klass, num_bytes, false);
+  }
 
   void RegisterNativeAllocation(int bytes)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -226,6 +259,8 @@ class Heap {
                            MemberOffset finalizer_reference_zombie_offset);
 
   mirror::Object* GetReferenceReferent(mirror::Object* reference);
+  void SetReferenceReferent(mirror::Object* reference, mirror::Object* referent)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void ClearReferenceReferent(mirror::Object* reference) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   // Returns true if the reference object has not yet been enqueued.
@@ -359,6 +394,11 @@ class Heap {
 
   void PreZygoteFork() LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
 
+  // Return the unused part of thread's allocation buffer to the alloc space.
+  void RevokeThreadLocalBuffers(Thread* thread);
+  // Revoke the allocation buffers of every thread, the other threads must be suspended.
+  void RevokeAllThreadLocalBuffers() LOCKS_EXCLUDED(Locks::thread_list_lock_);
+
   // Mark and empty stack.
   void FlushAllocStack()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
@@ -380,7 +420,7 @@ class Heap {
   // Assumes there is only one image space.
   space::ImageSpace* GetImageSpace() const;
 
-  space::DlMallocSpace* GetAllocSpace() const {
+  space::MallocSpace* GetAllocSpace() const {
     return alloc_space_;
   }
 
@@ -414,6 +454,29 @@ class Heap {
     return care_about_pause_times_;
   }
 
+  CollectorType GetCollectorType() const {
+    return collector_type_;
+  }
+
+  // Returns false for the objects the semi-space collector must leave in place: classes, methods,
+  // fields, dex caches and class loaders, which the runtime refers to with raw pointers. Classes
+  // are never unloaded or redefined either, so caches may keep raw pointers to classes and methods
+  // without visiting them or being cleared. Unloading or redefinition would have to clear the
+  // inline caches, the catch block caches and the contention profiler.
+  bool IsMovableObjectClass(const mirror::Class* klass) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  bool IsMovableObject(const mirror::Object* obj) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Returns true if no collector will ever move the object, unlike IsMovableObject this also
+  // takes the space of the object into account.
+  bool IsNonMovable(const mirror::Object* obj) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Returns true while native code holds pinned primitive arrays or strings, objects can't be
+  // moved until they are released.
+  bool IsMovingGcDisabled(Thread* self);
+
   // Thread pool.
   void CreateThreadPool();
   void DeleteThreadPool();
@@ -428,6 +491,12 @@ class Heap {
   }
 
  private:
+  // Allocates and initializes storage for an object instance, objects which mustn't move are kept
+  // out of the spaces that get compacted.
+  mirror::Object* AllocObjectInternal(Thread* self, mirror::Class* klass, size_t num_bytes,
+                                      bool movable)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Allocates uninitialized storage. Passing in a null space tries to place the object in the
   // large object space.
   template <class T> mirror::Object* Allocate(Thread* self, T* space, size_t num_bytes, size_t* bytes_allocated)
@@ -453,6 +522,21 @@ class Heap {
       LOCKS_EXCLUDED(Locks::thread_suspend_count_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Try to allocate a number of bytes, this function never does any GCs. RosAllocSpace-specialized version.
+  mirror::Object* TryToAllocate(Thread* self, space::RosAllocSpace* space, size_t alloc_size, bool grow,
+                                size_t* bytes_allocated)
+      LOCKS_EXCLUDED(Locks::thread_suspend_count_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Try to allocate a number of bytes, this function never does any GCs. BumpPointerSpace-specialized version.
+  mirror::Object* TryToAllocate(Thread* self, space::BumpPointerSpace* space, size_t alloc_size,
+                                bool grow, size_t* bytes_allocated)
+      LOCKS_EXCLUDED(Locks::thread_suspend_count_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Returns the space an allocation which was attempted in space should retry in after a GC.
+  space::AllocSpace* GetSpaceAfterGc(space::AllocSpace* space) const;
+
   bool IsOutOfMemoryOnAllocation(size_t alloc_size, bool grow);
 
   // Pushes a list of cleared references out to the managed heap.
@@ -462,7 +546,9 @@ class Heap {
   void RequestConcurrentGC(Thread* self) LOCKS_EXCLUDED(Locks::runtime_shutdown_lock_);
   bool IsGCRequestPending() const;
 
-  void RecordAllocation(size_t size, mirror::Object* object)
+  // Returns the object, which may have been moved by a GC while pushing it on the allocation
+  // stack.
+  mirror::Object* RecordAllocation(size_t size, mirror::Object* object)
       LOCKS_EXCLUDED(GlobalSynchronization::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
@@ -474,6 +560,25 @@ class Heap {
                      Locks::heap_bitmap_lock_,
                      Locks::thread_suspend_count_lock_);
 
+  // Called by the semi-space collector, with the world still stopped, once the survivors of
+  // from_space were evacuated into to_space. Swaps the bump pointer spaces, or switches between
+  // mark sweep and the semi-space collector when either space is the alloc space.
+  void SemiSpaceCollectionFinished(space::ContinuousSpace* from_space,
+                                   space::ContinuousSpace* to_space)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
+      LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
+
+  // Starts allocating movable objects into the nursery. Nothing may allocate concurrently, either
+  // the other threads are suspended or they don't exist yet.
+  void OpenNursery() LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
+
+  // True if the free part of the alloc space, up to its growth limit, can take every object of the
+  // nursery.
+  bool HasRoomForPromotion() const;
+
+  // Returns the mark sweep collector to use for a collection of the given type.
+  collector::MarkSweep* FindMarkSweepCollector(collector::GcType gc_type) const;
+
   void PreGcVerification(collector::GarbageCollector* gc);
   void PreSweepingGcVerification(collector::GarbageCollector* gc)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -491,6 +596,8 @@ class Heap {
   size_t GetPercentFree();
 
   void AddContinuousSpace(space::ContinuousSpace* space) LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
+  void RemoveContinuousSpace(space::ContinuousSpace* space)
+      LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
   void AddDiscontinuousSpace(space::DiscontinuousSpace* space)
       LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
 
@@ -514,7 +621,7 @@ class Heap {
   std::vector<space::DiscontinuousSpace*> discontinuous_spaces_;
 
   // The allocation space we are currently allocating into.
-  space::DlMallocSpace* alloc_space_;
+  space::MallocSpace* alloc_space_;
 
   // The large object space we are currently allocating into.
   space::LargeObjectSpace* large_object_space_;
@@ -553,6 +660,40 @@ class Heap {
   // useful for benchmarking since it reduces time spent in GC to a low %.
   const bool ignore_max_footprint_;
 
+  // If true, small objects are bump allocated out of thread-local allocation buffers carved from
+  // the alloc space instead of taking the alloc space's lock for every allocation.
+  const bool use_tlab_;
+
+  // If true, the alloc space is backed by rosalloc rather than dlmalloc. Ignored under valgrind
+  // since only the dlmalloc space has red zone support.
+  const bool use_rosalloc_;
+
+  // If true, the alloc space is compacted into a bump pointer space when the process goes to the
+  // background, and the semi-space collector runs until it comes back to the foreground. Turned
+  // off if the bump pointer spaces can't be reserved next to the alloc space.
+  bool use_background_compaction_;
+
+  // The collector the heap currently runs.
+  CollectorType collector_type_;
+
+  // The bump pointer space movable objects are allocated into while the semi-space collector is
+  // in use, and the space it evacuates the survivors into. They swap roles after every collection.
+  // Only part of continuous_spaces_ while the semi-space collector is in use.
+  space::BumpPointerSpace* bump_pointer_space_;
+  space::BumpPointerSpace* temp_space_;
+
+  // The young generation, null unless a nursery size was given. Reserved after the alloc space so
+  // that the card table covers it, only part of continuous_spaces_ while it is open.
+  space::BumpPointerSpace* nursery_space_;
+
+  // Set while collecting the old generation, the minor collection emptying the nursery beforehand
+  // closes it as well.
+  bool close_nursery_;
+
+  // Set when the last collection of the nursery couldn't promote every survivor since the alloc
+  // space was full. The nursery keeps them and stays open until a later collection empties it.
+  bool nursery_promotion_failed_;
+
   // If we have a zygote space.
   bool have_zygote_space_;
 
@@ -709,10 +850,13 @@ class Heap {
   HeapVerificationMode verify_object_mode_;
 
   std::vector<collector::MarkSweep*> mark_sweep_collectors_;
+  collector::SemiSpace* semi_space_collector_;
+  collector::SemiSpace* nursery_collector_;
 
   const bool running_on_valgrind_;
 
   friend class collector::MarkSweep;
+  friend class collector::SemiSpace;
   friend class VerifyReferenceCardVisitor;
   friend class VerifyReferenceVisitor;
   friend class VerifyObjectVisitor;
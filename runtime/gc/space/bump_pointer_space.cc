@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bump_pointer_space.h"
+#include "bump_pointer_space-inl.h"
+
+#include "base/stringprintf.h"
+#include "mirror/object-inl.h"
+#include "monitor.h"
+
+#include <sys/mman.h>
+
+namespace art {
+namespace gc {
+namespace space {
+
+size_t BumpPointerSpace::bitmap_index_ = 0;
+
+BumpPointerSpace* BumpPointerSpace::Create(const std::string& name, size_t capacity,
+                                           byte* requested_begin) {
+  capacity = RoundUp(capacity, kPageSize);
+  UniquePtr<MemMap> mem_map(MemMap::MapAnonymous(name.c_str(), requested_begin, capacity,
+                                                 PROT_READ | PROT_WRITE));
+  if (mem_map.get() == NULL) {
+    LOG(ERROR) << "Failed to allocate pages for bump pointer space (" << name << ") of size "
+        << PrettySize(capacity);
+    return NULL;
+  }
+  return new BumpPointerSpace(name, mem_map.release());
+}
+
+BumpPointerSpace::BumpPointerSpace(const std::string& name, MemMap* mem_map)
+    : MemMapSpace(name, mem_map, 0, kGcRetentionPolicyAlwaysCollect) {
+  size_t bitmap_index = bitmap_index_++;
+  live_bitmap_.reset(accounting::SpaceBitmap::Create(
+      StringPrintf("bump pointer space %s live-bitmap %d", name.c_str(),
+                   static_cast<int>(bitmap_index)),
+      Begin(), Capacity()));
+  CHECK(live_bitmap_.get() != NULL) << "could not create bump pointer space live bitmap #"
+      << bitmap_index;
+  mark_bitmap_.reset(accounting::SpaceBitmap::Create(
+      StringPrintf("bump pointer space %s mark-bitmap %d", name.c_str(),
+                   static_cast<int>(bitmap_index)),
+      Begin(), Capacity()));
+  CHECK(mark_bitmap_.get() != NULL) << "could not create bump pointer space mark bitmap #"
+      << bitmap_index;
+}
+
+mirror::Object* BumpPointerSpace::Alloc(Thread*, size_t num_bytes, size_t* bytes_allocated) {
+  mirror::Object* result = AllocNonvirtual(num_bytes);
+  if (LIKELY(result != NULL)) {
+    *bytes_allocated = RoundUp(num_bytes, kAlignment);
+  }
+  return result;
+}
+
+size_t BumpPointerSpace::AllocationSize(const mirror::Object* obj) {
+  size_t num_bytes = obj->SizeOf();
+  // Objects which were hashed before being moved carry their old address after the last field.
+  uint32_t lock_word = *const_cast<mirror::Object*>(obj)->GetRawLockWordAddress();
+  if (LW_HASH_STATE(lock_word) == LW_HASH_STATE_HASHED_AND_MOVED) {
+    num_bytes += sizeof(uint32_t);
+  }
+  return RoundUp(num_bytes, kAlignment);
+}
+
+size_t BumpPointerSpace::Free(Thread*, mirror::Object*) {
+  UNIMPLEMENTED(FATAL) << "Objects in a bump pointer space can't be freed individually";
+  return 0;
+}
+
+size_t BumpPointerSpace::FreeList(Thread*, size_t, mirror::Object**) {
+  UNIMPLEMENTED(FATAL) << "Objects in a bump pointer space can't be freed individually";
+  return 0;
+}
+
+void BumpPointerSpace::Clear() {
+  // Hand the pages back, they read as zero the next time they are touched.
+  if (Size() != 0) {
+    size_t used = RoundUp(Size(), kPageSize);
+    if (madvise(Begin(), used, MADV_DONTNEED) == -1) {
+      PLOG(FATAL) << "madvise failed for " << GetName();
+    }
+  }
+  end_ = Begin();
+  objects_allocated_ = 0;
+  live_bitmap_->Clear();
+  mark_bitmap_->Clear();
+}
+
+void BumpPointerSpace::Dump(std::ostream& os) const {
+  os << GetType()
+      << " begin=" << reinterpret_cast<void*>(Begin())
+      << ",end=" << reinterpret_cast<void*>(End())
+      << ",size=" << PrettySize(Size()) << ",capacity=" << PrettySize(Capacity())
+      << ",name=\"" << GetName() << "\"]";
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
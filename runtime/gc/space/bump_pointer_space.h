@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_SPACE_BUMP_POINTER_SPACE_H_
+#define ART_RUNTIME_GC_SPACE_BUMP_POINTER_SPACE_H_
+
+#include "atomic_integer.h"
+#include "space.h"
+
+namespace art {
+namespace gc {
+
+namespace collector {
+  class SemiSpace;
+}  // namespace collector
+
+namespace space {
+
+// A space which hands out memory by atomically bumping a pointer. Individual objects can't be
+// freed, the whole space is emptied at once after the semi-space collector evacuated the
+// survivors out of it.
+class BumpPointerSpace : public MemMapSpace, public AllocSpace {
+ public:
+  static constexpr size_t kAlignment = 8;
+
+  // Create a bump pointer space with the requested capacity. The requested base address is not
+  // guaranteed to be granted, if it is required, the caller should call Begin on the returned
+  // space to confirm the request was granted.
+  static BumpPointerSpace* Create(const std::string& name, size_t capacity, byte* requested_begin);
+
+  virtual ~BumpPointerSpace() {}
+
+  SpaceType GetType() const {
+    return kSpaceTypeBumpPointerSpace;
+  }
+
+  // Allocate num_bytes, returns NULL if the space is full.
+  virtual mirror::Object* Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated);
+  mirror::Object* AllocNonvirtual(size_t num_bytes);
+
+  // Return the storage space required by obj.
+  virtual size_t AllocationSize(const mirror::Object* obj)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Objects are never freed individually.
+  virtual size_t Free(Thread* self, mirror::Object* ptr);
+  virtual size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs);
+
+  virtual uint64_t GetBytesAllocated() const {
+    return Size();
+  }
+  virtual uint64_t GetObjectsAllocated() const {
+    return objects_allocated_;
+  }
+  virtual uint64_t GetTotalBytesAllocated() const {
+    return total_bytes_allocated_;
+  }
+  virtual uint64_t GetTotalObjectsAllocated() const {
+    return total_objects_allocated_;
+  }
+
+  accounting::SpaceBitmap* GetLiveBitmap() const {
+    return live_bitmap_.get();
+  }
+
+  accounting::SpaceBitmap* GetMarkBitmap() const {
+    return mark_bitmap_.get();
+  }
+
+  // Release all the pages back to the kernel and reset the space to empty.
+  void Clear();
+
+  virtual void Dump(std::ostream& os) const;
+
+ protected:
+  BumpPointerSpace(const std::string& name, MemMap* mem_map);
+
+ private:
+  // The number of objects currently allocated in the space, and since the space was created.
+  AtomicInteger objects_allocated_;
+  AtomicInteger total_objects_allocated_;
+  AtomicInteger total_bytes_allocated_;
+
+  UniquePtr<accounting::SpaceBitmap> live_bitmap_;
+  UniquePtr<accounting::SpaceBitmap> mark_bitmap_;
+
+  static size_t bitmap_index_;
+
+  friend class collector::SemiSpace;
+
+  DISALLOW_COPY_AND_ASSIGN(BumpPointerSpace);
+};
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_SPACE_BUMP_POINTER_SPACE_H_
@@ -19,6 +19,8 @@
 
 #include "dlmalloc_space.h"
 
+#include "thread.h"
+
 namespace art {
 namespace gc {
 namespace space {
@@ -55,6 +57,37 @@ inline mirror::Object* DlMallocSpace::AllocWithoutGrowthLocked(size_t num_bytes,
   return result;
 }
 
+inline mirror::Object* DlMallocSpace::AllocThreadLocal(Thread* self, size_t num_bytes,
+                                                      size_t* bytes_allocated) {
+  byte* pos = self->GetThreadLocalBufferPos();
+  size_t remaining = self->GetThreadLocalBufferEnd() - pos;
+  size_t chunk_size = DlmallocRequestToChunkSize(num_bytes);
+  // The remainder of the buffer must either be consumed exactly or stay large enough to remain a
+  // valid chunk.
+  if (UNLIKELY(chunk_size > remaining ||
+               (chunk_size != remaining && remaining - chunk_size < kDlmallocMinChunkSize))) {
+    return NULL;
+  }
+  // pos is the user pointer of the chunk holding the rest of the buffer, its head word directly
+  // precedes it. Shrink that chunk to chunk_size and start a new in-use chunk for the remainder.
+  size_t* head = reinterpret_cast<size_t*>(pos) - 1;
+  *head = chunk_size | (*head & kDlmallocPinuseBit) | kDlmallocCinuseBit;
+  if (chunk_size != remaining) {
+    size_t* next_head = reinterpret_cast<size_t*>(pos + chunk_size) - 1;
+    *next_head = (remaining - chunk_size) | kDlmallocPinuseBit | kDlmallocCinuseBit;
+  }
+  self->BumpThreadLocalBuffer(chunk_size);
+  mirror::Object* result = reinterpret_cast<mirror::Object*>(pos);
+  if (kDebugSpaces) {
+    CHECK(Contains(result)) << "Allocation (" << reinterpret_cast<void*>(result)
+          << ") not in bounds of allocation space " << *this;
+    CHECK_EQ(AllocationSizeNonvirtual(result), chunk_size);
+  }
+  // The buffer was zeroed when it was created.
+  *bytes_allocated = chunk_size;
+  return result;
+}
+
 }  // namespace space
 }  // namespace gc
 }  // namespace art
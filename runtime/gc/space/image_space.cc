@@ -21,6 +21,7 @@
 
 #include "base/stl_util.h"
 #include "base/unix_file/fd_file.h"
+#include "entrypoints/entrypoint_utils.h"
 #include "gc/accounting/space_bitmap-inl.h"
 #include "mirror/art_method.h"
 #include "mirror/class-inl.h"
@@ -213,6 +214,11 @@ ImageSpace* ImageSpace::Init(const std::string& image_file_name, bool validate_o
   Runtime* runtime = Runtime::Current();
   mirror::Object* resolution_method = image_header.GetImageRoot(ImageHeader::kResolutionMethod);
   runtime->SetResolutionMethod(down_cast<mirror::ArtMethod*>(resolution_method));
+  // The image doesn't know where libart's conflict stub is, see Runtime::CreateImtConflictMethod.
+  mirror::ArtMethod* imt_conflict_method =
+      down_cast<mirror::ArtMethod*>(image_header.GetImageRoot(ImageHeader::kImtConflictMethod));
+  imt_conflict_method->SetEntryPointFromCompiledCode(GetQuickImtConflictTrampoline());
+  runtime->SetImtConflictMethod(imt_conflict_method);
 
   mirror::Object* callee_save_method = image_header.GetImageRoot(ImageHeader::kCalleeSaveMethod);
   runtime->SetCalleeSaveMethod(down_cast<mirror::ArtMethod*>(callee_save_method), Runtime::kSaveAll);
@@ -76,15 +76,20 @@ mirror::Object* LargeObjectMapSpace::Alloc(Thread* self, size_t num_bytes, size_
 }
 
 size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
-  MutexLock mu(self, lock_);
-  MemMaps::iterator found = mem_maps_.find(ptr);
-  CHECK(found != mem_maps_.end()) << "Attempted to free large object which was not live";
-  DCHECK_GE(num_bytes_allocated_, found->second->Size());
-  size_t allocation_size = found->second->Size();
-  num_bytes_allocated_ -= allocation_size;
-  --num_objects_allocated_;
-  delete found->second;
-  mem_maps_.erase(found);
+  MemMap* mem_map;
+  {
+    MutexLock mu(self, lock_);
+    MemMaps::iterator found = mem_maps_.find(ptr);
+    CHECK(found != mem_maps_.end()) << "Attempted to free large object which was not live";
+    mem_map = found->second;
+    DCHECK_GE(num_bytes_allocated_, mem_map->Size());
+    num_bytes_allocated_ -= mem_map->Size();
+    --num_objects_allocated_;
+    mem_maps_.erase(found);
+  }
+  size_t allocation_size = mem_map->Size();
+  // Unmap outside of the lock so that parallel sweepers don't serialize on it.
+  delete mem_map;
   return allocation_size;
 }
 
@@ -106,7 +111,7 @@ size_t LargeObjectSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object*
   return total;
 }
 
-void LargeObjectMapSpace::Walk(DlMallocSpace::WalkCallback callback, void* arg) {
+void LargeObjectMapSpace::Walk(MallocSpace::WalkCallback callback, void* arg) {
   MutexLock mu(Thread::Current(), lock_);
   for (MemMaps::iterator it = mem_maps_.begin(); it != mem_maps_.end(); ++it) {
     MemMap* mem_map = it->second;
@@ -145,7 +150,7 @@ FreeListSpace::FreeListSpace(const std::string& name, MemMap* mem_map, byte* beg
 
 FreeListSpace::~FreeListSpace() {}
 
-void FreeListSpace::Walk(DlMallocSpace::WalkCallback callback, void* arg) {
+void FreeListSpace::Walk(MallocSpace::WalkCallback callback, void* arg) {
   MutexLock mu(Thread::Current(), lock_);
   uintptr_t free_end_start = reinterpret_cast<uintptr_t>(end_) - free_end_;
   AllocationHeader* cur_header = reinterpret_cast<AllocationHeader*>(Begin());
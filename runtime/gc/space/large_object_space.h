@@ -18,7 +18,7 @@
 #define ART_RUNTIME_GC_SPACE_LARGE_OBJECT_SPACE_H_
 
 #include "gc/accounting/gc_allocator.h"
-#include "dlmalloc_space.h"
+#include "malloc_space.h"
 #include "safe_map.h"
 #include "space.h"
 
@@ -38,7 +38,7 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
 
   virtual void SwapBitmaps();
   virtual void CopyLiveToMarked();
-  virtual void Walk(DlMallocSpace::WalkCallback, void* arg) = 0;
+  virtual void Walk(MallocSpace::WalkCallback, void* arg) = 0;
   virtual ~LargeObjectSpace() {}
 
   uint64_t GetBytesAllocated() const {
@@ -85,7 +85,7 @@ class LargeObjectMapSpace : public LargeObjectSpace {
   size_t AllocationSize(const mirror::Object* obj);
   mirror::Object* Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated);
   size_t Free(Thread* self, mirror::Object* ptr);
-  void Walk(DlMallocSpace::WalkCallback, void* arg) LOCKS_EXCLUDED(lock_);
+  void Walk(MallocSpace::WalkCallback, void* arg) LOCKS_EXCLUDED(lock_);
   // TODO: disabling thread safety analysis as this may be called when we already hold lock_.
   bool Contains(const mirror::Object* obj) const NO_THREAD_SAFETY_ANALYSIS;
 
@@ -112,7 +112,7 @@ class FreeListSpace : public LargeObjectSpace {
   mirror::Object* Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated);
   size_t Free(Thread* self, mirror::Object* obj);
   bool Contains(const mirror::Object* obj) const;
-  void Walk(DlMallocSpace::WalkCallback callback, void* arg) LOCKS_EXCLUDED(lock_);
+  void Walk(MallocSpace::WalkCallback callback, void* arg) LOCKS_EXCLUDED(lock_);
 
   // Address at which the space begins.
   byte* Begin() const {
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_SPACE_ROSALLOC_SPACE_H_
+#define ART_RUNTIME_GC_SPACE_ROSALLOC_SPACE_H_
+
+#include "gc/allocator/rosalloc.h"
+#include "malloc_space.h"
+
+namespace art {
+namespace gc {
+
+namespace collector {
+  class MarkSweep;
+}  // namespace collector
+
+namespace space {
+
+// An alloc space backed by a rosalloc allocator. Small objects are served from runs of equally
+// sized slots, the smallest ones from runs owned by the allocating thread.
+class RosAllocSpace : public MallocSpace {
+ public:
+  // Create a RosAllocSpace with the requested sizes. The requested base address is not guaranteed
+  // to be granted, if it is required, the caller should call Begin on the returned space to
+  // confirm the request was granted.
+  static RosAllocSpace* Create(const std::string& name, size_t initial_size, size_t growth_limit,
+                               size_t capacity, byte* requested_begin);
+
+  virtual ~RosAllocSpace() {
+    delete rosalloc_;
+  }
+
+  virtual bool IsRosAllocSpace() const {
+    return true;
+  }
+
+  // Allocate num_bytes allowing the underlying allocator to grow.
+  virtual mirror::Object* AllocWithGrowth(Thread* self, size_t num_bytes,
+                                          size_t* bytes_allocated) LOCKS_EXCLUDED(lock_);
+
+  // Allocate num_bytes without allowing the underlying allocator to grow.
+  virtual mirror::Object* Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated);
+
+  // Return the storage space required by obj.
+  virtual size_t AllocationSize(const mirror::Object* obj);
+  virtual size_t Free(Thread* self, mirror::Object* ptr);
+  virtual size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs);
+
+  mirror::Object* AllocNonvirtual(Thread* self, size_t num_bytes, size_t* bytes_allocated);
+
+  size_t AllocationSizeNonvirtual(const mirror::Object* obj) {
+    return rosalloc_->UsableSize(obj);
+  }
+
+  // Hand thread's thread-local runs back to the allocator. The thread must either be the caller
+  // or be suspended.
+  virtual void RevokeThreadLocalBuffer(Thread* thread);
+
+  allocator::RosAlloc* GetRosAlloc() const {
+    return rosalloc_;
+  }
+
+  // Hands unused pages back to the system.
+  virtual size_t Trim();
+
+  // Call back for each run slot, large object and free page run. The chunk may not be in use,
+  // indicated by num_bytes equaling zero.
+  virtual void Walk(WalkCallback callback, void* arg);
+
+  virtual size_t GetFootprint();
+  virtual size_t GetFootprintLimit();
+  virtual void SetFootprintLimit(size_t limit);
+
+  // The current counts are computed by walking the allocator, they are meant for diagnostics
+  // rather than for the allocation path.
+  uint64_t GetBytesAllocated() const;
+  uint64_t GetObjectsAllocated() const;
+
+  uint64_t GetTotalBytesAllocated() const {
+    return GetBytesAllocated() + total_bytes_freed_;
+  }
+
+  uint64_t GetTotalObjectsAllocated() const {
+    return GetObjectsAllocated() + total_objects_freed_;
+  }
+
+ protected:
+  RosAllocSpace(const std::string& name, MemMap* mem_map, allocator::RosAlloc* rosalloc,
+                byte* begin, byte* end, size_t growth_limit);
+
+  virtual void* CreateAllocator(void* begin, size_t morecore_start, size_t initial_size,
+                                size_t capacity) {
+    return CreateRosAlloc(begin, morecore_start, initial_size, capacity);
+  }
+
+  virtual MallocSpace* CreateInstance(const std::string& name, MemMap* mem_map, void* allocator,
+                                      byte* begin, byte* end, size_t growth_limit) {
+    return new RosAllocSpace(name, mem_map, reinterpret_cast<allocator::RosAlloc*>(allocator),
+                             begin, end, growth_limit);
+  }
+
+ private:
+  static allocator::RosAlloc* CreateRosAlloc(void* base, size_t morecore_start,
+                                             size_t initial_size, size_t capacity);
+
+  // Objects and bytes freed since the space was created.
+  uint64_t total_bytes_freed_ GUARDED_BY(lock_);
+  uint64_t total_objects_freed_ GUARDED_BY(lock_);
+
+  // Underlying rosalloc.
+  allocator::RosAlloc* const rosalloc_;
+
+  friend class collector::MarkSweep;
+
+  DISALLOW_COPY_AND_ASSIGN(RosAllocSpace);
+};
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_SPACE_ROSALLOC_SPACE_H_
@@ -19,8 +19,10 @@
 
 #include "space.h"
 
+#include "bump_pointer_space.h"
 #include "dlmalloc_space.h"
 #include "image_space.h"
+#include "rosalloc_space.h"
 
 namespace art {
 namespace gc {
@@ -31,16 +33,31 @@ inline ImageSpace* Space::AsImageSpace() {
   return down_cast<ImageSpace*>(down_cast<MemMapSpace*>(this));
 }
 
+inline MallocSpace* Space::AsMallocSpace() {
+  DCHECK(IsMallocSpace());
+  return down_cast<MallocSpace*>(down_cast<MemMapSpace*>(this));
+}
+
 inline DlMallocSpace* Space::AsDlMallocSpace() {
-  DCHECK(GetType() == kSpaceTypeAllocSpace || GetType() == kSpaceTypeZygoteSpace);
+  DCHECK(IsDlMallocSpace());
   return down_cast<DlMallocSpace*>(down_cast<MemMapSpace*>(this));
 }
 
+inline RosAllocSpace* Space::AsRosAllocSpace() {
+  DCHECK(IsRosAllocSpace());
+  return down_cast<RosAllocSpace*>(down_cast<MemMapSpace*>(this));
+}
+
 inline LargeObjectSpace* Space::AsLargeObjectSpace() {
   DCHECK_EQ(GetType(), kSpaceTypeLargeObjectSpace);
   return reinterpret_cast<LargeObjectSpace*>(this);
 }
 
+inline BumpPointerSpace* Space::AsBumpPointerSpace() {
+  DCHECK(IsBumpPointerSpace());
+  return down_cast<BumpPointerSpace*>(down_cast<MemMapSpace*>(this));
+}
+
 }  // namespace space
 }  // namespace gc
 }  // namespace art
@@ -42,9 +42,12 @@ class Heap;
 
 namespace space {
 
+class BumpPointerSpace;
 class DlMallocSpace;
 class ImageSpace;
 class LargeObjectSpace;
+class MallocSpace;
+class RosAllocSpace;
 
 static constexpr bool kDebugSpaces = kIsDebugBuild;
 
@@ -65,6 +68,7 @@ enum SpaceType {
   kSpaceTypeAllocSpace,
   kSpaceTypeZygoteSpace,
   kSpaceTypeLargeObjectSpace,
+  kSpaceTypeBumpPointerSpace,
 };
 std::ostream& operator<<(std::ostream& os, const SpaceType& space_type);
 
@@ -92,7 +96,7 @@ class Space {
   // Is the given object contained within this space?
   virtual bool Contains(const mirror::Object* obj) const = 0;
 
-  // The kind of space this: image, alloc, zygote, large object.
+  // The kind of space this: image, alloc, zygote, large object, bump pointer.
   virtual SpaceType GetType() const = 0;
 
   // Is this an image space, ie one backed by a memory mapped image file.
@@ -101,13 +105,25 @@ class Space {
   }
   ImageSpace* AsImageSpace();
 
-  // Is this a dlmalloc backed allocation space?
-  bool IsDlMallocSpace() const {
+  // Is this a malloc backed allocation space, ie one objects are allocated into or the zygote?
+  bool IsMallocSpace() const {
     SpaceType type = GetType();
     return type == kSpaceTypeAllocSpace || type == kSpaceTypeZygoteSpace;
   }
+  MallocSpace* AsMallocSpace();
+
+  // Is this a dlmalloc backed allocation space?
+  virtual bool IsDlMallocSpace() const {
+    return false;
+  }
   DlMallocSpace* AsDlMallocSpace();
 
+  // Is this a rosalloc backed allocation space?
+  virtual bool IsRosAllocSpace() const {
+    return false;
+  }
+  RosAllocSpace* AsRosAllocSpace();
+
   // Is this the space allocated into by the Zygote and no-longer in use?
   bool IsZygoteSpace() const {
     return GetType() == kSpaceTypeZygoteSpace;
@@ -119,6 +135,12 @@ class Space {
   }
   LargeObjectSpace* AsLargeObjectSpace();
 
+  // Is this a bump pointer space whose objects may be moved by the semi-space collector?
+  bool IsBumpPointerSpace() const {
+    return GetType() == kSpaceTypeBumpPointerSpace;
+  }
+  BumpPointerSpace* AsBumpPointerSpace();
+
   virtual ~Space() {}
 
  protected:
@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 
+#include "bump_pointer_space.h"
+#include "bump_pointer_space-inl.h"
 #include "dlmalloc_space.h"
+#include "dlmalloc_space-inl.h"
 #include "large_object_space.h"
+#include "rosalloc_space.h"
 
 #include "common_test.h"
 #include "globals.h"
@@ -29,9 +33,30 @@ namespace space {
 
 class SpaceTest : public CommonTest {
  public:
-  void SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr_t object_size,
+  typedef MallocSpace* (*CreateSpaceFn)(const std::string& name, size_t initial_size,
+                                        size_t growth_limit, size_t capacity,
+                                        byte* requested_begin);
+
+  static MallocSpace* CreateDlMallocSpace(const std::string& name, size_t initial_size,
+                                          size_t growth_limit, size_t capacity,
+                                          byte* requested_begin) {
+    return DlMallocSpace::Create(name, initial_size, growth_limit, capacity, requested_begin);
+  }
+
+  static MallocSpace* CreateRosAllocSpace(const std::string& name, size_t initial_size,
+                                          size_t growth_limit, size_t capacity,
+                                          byte* requested_begin) {
+    return RosAllocSpace::Create(name, initial_size, growth_limit, capacity, requested_begin);
+  }
+
+  void InitTestBody(CreateSpaceFn create_space);
+  void ZygoteSpaceTestBody(CreateSpaceFn create_space);
+  void AllocAndFreeTestBody(CreateSpaceFn create_space);
+  void AllocAndFreeListTestBody(CreateSpaceFn create_space);
+
+  void SizeFootPrintGrowthLimitAndTrimBody(MallocSpace* space, intptr_t object_size,
                                            int round, size_t growth_limit);
-  void SizeFootPrintGrowthLimitAndTrimDriver(size_t object_size);
+  void SizeFootPrintGrowthLimitAndTrimDriver(size_t object_size, CreateSpaceFn create_space);
 
   void AddContinuousSpace(ContinuousSpace* space) {
     Runtime::Current()->GetHeap()->AddContinuousSpace(space);
@@ -43,51 +68,58 @@ static size_t test_rand(size_t* seed) {
   return *seed;
 }
 
-TEST_F(SpaceTest, Init) {
+void SpaceTest::InitTestBody(CreateSpaceFn create_space) {
   {
     // Init < max == growth
-    UniquePtr<Space> space(DlMallocSpace::Create("test", 16 * MB, 32 * MB, 32 * MB, NULL));
+    UniquePtr<Space> space(create_space("test", 16 * MB, 32 * MB, 32 * MB, NULL));
     EXPECT_TRUE(space.get() != NULL);
   }
   {
     // Init == max == growth
-    UniquePtr<Space> space(DlMallocSpace::Create("test", 16 * MB, 16 * MB, 16 * MB, NULL));
+    UniquePtr<Space> space(create_space("test", 16 * MB, 16 * MB, 16 * MB, NULL));
     EXPECT_TRUE(space.get() != NULL);
   }
   {
     // Init > max == growth
-    UniquePtr<Space> space(DlMallocSpace::Create("test", 32 * MB, 16 * MB, 16 * MB, NULL));
+    UniquePtr<Space> space(create_space("test", 32 * MB, 16 * MB, 16 * MB, NULL));
     EXPECT_TRUE(space.get() == NULL);
   }
   {
     // Growth == init < max
-    UniquePtr<Space> space(DlMallocSpace::Create("test", 16 * MB, 16 * MB, 32 * MB, NULL));
+    UniquePtr<Space> space(create_space("test", 16 * MB, 16 * MB, 32 * MB, NULL));
     EXPECT_TRUE(space.get() != NULL);
   }
   {
     // Growth < init < max
-    UniquePtr<Space> space(DlMallocSpace::Create("test", 16 * MB, 8 * MB, 32 * MB, NULL));
+    UniquePtr<Space> space(create_space("test", 16 * MB, 8 * MB, 32 * MB, NULL));
     EXPECT_TRUE(space.get() == NULL);
   }
   {
     // Init < growth < max
-    UniquePtr<Space> space(DlMallocSpace::Create("test", 8 * MB, 16 * MB, 32 * MB, NULL));
+    UniquePtr<Space> space(create_space("test", 8 * MB, 16 * MB, 32 * MB, NULL));
     EXPECT_TRUE(space.get() != NULL);
   }
   {
     // Init < max < growth
-    UniquePtr<Space> space(DlMallocSpace::Create("test", 8 * MB, 32 * MB, 16 * MB, NULL));
+    UniquePtr<Space> space(create_space("test", 8 * MB, 32 * MB, 16 * MB, NULL));
     EXPECT_TRUE(space.get() == NULL);
   }
 }
 
+TEST_F(SpaceTest, Init_DlMallocSpace) {
+  InitTestBody(SpaceTest::CreateDlMallocSpace);
+}
+TEST_F(SpaceTest, Init_RosAllocSpace) {
+  InitTestBody(SpaceTest::CreateRosAllocSpace);
+}
+
 // TODO: This test is not very good, we should improve it.
 // The test should do more allocations before the creation of the ZygoteSpace, and then do
 // allocations after the ZygoteSpace is created. The test should also do some GCs to ensure that
 // the GC works with the ZygoteSpace.
-TEST_F(SpaceTest, ZygoteSpace) {
+void SpaceTest::ZygoteSpaceTestBody(CreateSpaceFn create_space) {
     size_t dummy = 0;
-    DlMallocSpace* space(DlMallocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, NULL));
+    MallocSpace* space(create_space("test", 4 * MB, 16 * MB, 16 * MB, NULL));
     ASSERT_TRUE(space != NULL);
 
     // Make space findable to the heap, will also delete space when runtime is cleaned up
@@ -157,9 +189,17 @@ TEST_F(SpaceTest, ZygoteSpace) {
     EXPECT_LE(1U * MB, free1);
 }
 
-TEST_F(SpaceTest, AllocAndFree) {
+TEST_F(SpaceTest, ZygoteSpace_DlMallocSpace) {
+  ZygoteSpaceTestBody(SpaceTest::CreateDlMallocSpace);
+}
+
+TEST_F(SpaceTest, ZygoteSpace_RosAllocSpace) {
+  ZygoteSpaceTestBody(SpaceTest::CreateRosAllocSpace);
+}
+
+void SpaceTest::AllocAndFreeTestBody(CreateSpaceFn create_space) {
   size_t dummy = 0;
-  DlMallocSpace* space(DlMallocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, NULL));
+  MallocSpace* space(create_space("test", 4 * MB, 16 * MB, 16 * MB, NULL));
   ASSERT_TRUE(space != NULL);
   Thread* self = Thread::Current();
 
@@ -204,6 +244,13 @@ TEST_F(SpaceTest, AllocAndFree) {
   EXPECT_LE(1U * MB, free1);
 }
 
+TEST_F(SpaceTest, AllocAndFree_DlMallocSpace) {
+  AllocAndFreeTestBody(SpaceTest::CreateDlMallocSpace);
+}
+TEST_F(SpaceTest, AllocAndFree_RosAllocSpace) {
+  AllocAndFreeTestBody(SpaceTest::CreateRosAllocSpace);
+}
+
 TEST_F(SpaceTest, LargeObjectTest) {
   size_t rand_seed = 0;
   for (size_t i = 0; i < 2; ++i) {
@@ -265,8 +312,41 @@ TEST_F(SpaceTest, LargeObjectTest) {
   }
 }
 
-TEST_F(SpaceTest, AllocAndFreeList) {
-  DlMallocSpace* space(DlMallocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, NULL));
+TEST_F(SpaceTest, BumpPointerSpace) {
+  UniquePtr<BumpPointerSpace> space(BumpPointerSpace::Create("test", 1 * MB, NULL));
+  ASSERT_TRUE(space.get() != NULL);
+  Thread* self = Thread::Current();
+
+  // Allocations are contiguous and rounded up to the object alignment.
+  size_t bytes_allocated = 0;
+  mirror::Object* obj1 = space->Alloc(self, 12, &bytes_allocated);
+  ASSERT_TRUE(obj1 != NULL);
+  EXPECT_EQ(RoundUp(12U, BumpPointerSpace::kAlignment), bytes_allocated);
+  mirror::Object* obj2 = space->Alloc(self, 100, &bytes_allocated);
+  ASSERT_TRUE(obj2 != NULL);
+  EXPECT_EQ(reinterpret_cast<byte*>(obj1) + RoundUp(12U, BumpPointerSpace::kAlignment),
+            reinterpret_cast<byte*>(obj2));
+  EXPECT_EQ(2U, space->GetObjectsAllocated());
+
+  // Fails once the space is exhausted.
+  EXPECT_TRUE(space->Alloc(self, 2 * MB, &bytes_allocated) == NULL);
+
+  // Clearing resets the space and hands back zeroed memory.
+  memset(obj2, 0xAB, 100);
+  space->Clear();
+  EXPECT_EQ(0U, space->Size());
+  EXPECT_EQ(0U, space->GetObjectsAllocated());
+  mirror::Object* obj3 = space->Alloc(self, 200, &bytes_allocated);
+  ASSERT_TRUE(obj3 != NULL);
+  EXPECT_EQ(space->Begin(), reinterpret_cast<byte*>(obj3));
+  for (size_t i = 0; i < 200; ++i) {
+    ASSERT_EQ(0, reinterpret_cast<const byte*>(obj3)[i]);
+  }
+  EXPECT_EQ(3U, space->GetTotalObjectsAllocated());
+}
+
+void SpaceTest::AllocAndFreeListTestBody(CreateSpaceFn create_space) {
+  MallocSpace* space(create_space("test", 4 * MB, 16 * MB, 16 * MB, NULL));
   ASSERT_TRUE(space != NULL);
 
   // Make space findable to the heap, will also delete space when runtime is cleaned up
@@ -303,20 +383,70 @@ TEST_F(SpaceTest, AllocAndFreeList) {
   }
 }
 
-void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr_t object_size,
+TEST_F(SpaceTest, AllocAndFreeList_DlMallocSpace) {
+  AllocAndFreeListTestBody(SpaceTest::CreateDlMallocSpace);
+}
+TEST_F(SpaceTest, AllocAndFreeList_RosAllocSpace) {
+  AllocAndFreeListTestBody(SpaceTest::CreateRosAllocSpace);
+}
+
+TEST_F(SpaceTest, ThreadLocalAllocAndFreeList) {
+  DlMallocSpace* space(DlMallocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, NULL));
+  ASSERT_TRUE(space != NULL);
+
+  // Make space findable to the heap, will also delete space when runtime is cleaned up
+  AddContinuousSpace(space);
+  Thread* self = Thread::Current();
+
+  // No buffer yet.
+  size_t allocation_size = 0;
+  EXPECT_TRUE(space->AllocThreadLocal(self, 16, &allocation_size) == NULL);
+
+  // Carve objects of varying sizes out of a series of buffers.
+  mirror::Object* lots_of_objects[1024];
+  size_t total_size = 0;
+  for (size_t i = 0; i < arraysize(lots_of_objects); i++) {
+    size_t size = 8 + (i % 64) * 4;
+    mirror::Object* obj = space->AllocThreadLocal(self, size, &allocation_size);
+    if (obj == NULL) {
+      ASSERT_TRUE(space->AllocNewThreadLocalBuffer(self, 4 * KB));
+      obj = space->AllocThreadLocal(self, size, &allocation_size);
+    }
+    ASSERT_TRUE(obj != NULL);
+    EXPECT_TRUE(space->Contains(obj));
+    EXPECT_EQ(allocation_size, space->AllocationSize(obj));
+    EXPECT_LE(size, allocation_size);
+    // Objects come out of the buffer zeroed.
+    for (size_t j = 0; j < size; ++j) {
+      EXPECT_EQ(0, reinterpret_cast<byte*>(obj)[j]);
+    }
+    lots_of_objects[i] = obj;
+    total_size += allocation_size;
+  }
+
+  // Objects are only accounted to the space once the buffer is revoked.
+  space->RevokeThreadLocalBuffer(self);
+  EXPECT_FALSE(self->HasThreadLocalBuffer());
+  EXPECT_EQ(arraysize(lots_of_objects), space->GetObjectsAllocated());
+  EXPECT_EQ(total_size, space->GetBytesAllocated());
+
+  // Carved out objects are regular chunks which can be freed individually.
+  space->FreeList(self, arraysize(lots_of_objects), lots_of_objects);
+  EXPECT_EQ(0U, space->GetObjectsAllocated());
+  EXPECT_EQ(0U, space->GetBytesAllocated());
+}
+
+void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(MallocSpace* space, intptr_t object_size,
                                                     int round, size_t growth_limit) {
   if (((object_size > 0 && object_size >= static_cast<intptr_t>(growth_limit))) ||
       ((object_size < 0 && -object_size >= static_cast<intptr_t>(growth_limit)))) {
     // No allocation can succeed
     return;
   }
-  // Mspace for raw dlmalloc operations
-  void* mspace = space->GetMspace();
-
-  // mspace's footprint equals amount of resources requested from system
-  size_t footprint = mspace_footprint(mspace);
+  // The allocator's footprint equals amount of resources requested from system
+  size_t footprint = space->GetFootprint();
 
-  // mspace must at least have its book keeping allocated
+  // The allocator must at least have its book keeping allocated
   EXPECT_GT(footprint, 0u);
 
   // mspace but it shouldn't exceed the initial size
@@ -356,7 +486,7 @@ void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr
       } else {
         object = space->AllocWithGrowth(self, alloc_size, &bytes_allocated);
       }
-      footprint = mspace_footprint(mspace);
+      footprint = space->GetFootprint();
       EXPECT_GE(space->Size(), footprint);  // invariant
       if (object != NULL) {  // allocation succeeded
         lots_of_objects.get()[i] = object;
@@ -395,7 +525,7 @@ void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr
     space->Trim();
 
     // Bounds sanity
-    footprint = mspace_footprint(mspace);
+    footprint = space->GetFootprint();
     EXPECT_LE(amount_allocated, growth_limit);
     EXPECT_GE(footprint, amount_allocated);
     EXPECT_LE(footprint, growth_limit);
@@ -421,13 +551,16 @@ void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr
       space->Free(self, object);
       lots_of_objects.get()[i] = NULL;
       amount_allocated -= allocation_size;
-      footprint = mspace_footprint(mspace);
+      footprint = space->GetFootprint();
       EXPECT_GE(space->Size(), footprint);  // invariant
     }
 
     free_increment >>= 1;
   }
 
+  // Hand back the thread-local runs so that they don't pin their pages.
+  space->RevokeThreadLocalBuffer(self);
+
   // All memory was released, try a large allocation to check freed memory is being coalesced
   mirror::Object* large_object;
   size_t three_quarters_space = (growth_limit / 2) + (growth_limit / 4);
@@ -440,7 +573,7 @@ void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr
   EXPECT_TRUE(large_object != NULL);
 
   // Sanity check footprint
-  footprint = mspace_footprint(mspace);
+  footprint = space->GetFootprint();
   EXPECT_LE(footprint, growth_limit);
   EXPECT_GE(space->Size(), footprint);
   EXPECT_LE(space->Size(), growth_limit);
@@ -449,17 +582,18 @@ void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr
   space->Free(self, large_object);
 
   // Sanity check footprint
-  footprint = mspace_footprint(mspace);
+  footprint = space->GetFootprint();
   EXPECT_LE(footprint, growth_limit);
   EXPECT_GE(space->Size(), footprint);
   EXPECT_LE(space->Size(), growth_limit);
 }
 
-void SpaceTest::SizeFootPrintGrowthLimitAndTrimDriver(size_t object_size) {
+void SpaceTest::SizeFootPrintGrowthLimitAndTrimDriver(size_t object_size,
+                                                      CreateSpaceFn create_space) {
   size_t initial_size = 4 * MB;
   size_t growth_limit = 8 * MB;
   size_t capacity = 16 * MB;
-  DlMallocSpace* space(DlMallocSpace::Create("test", initial_size, growth_limit, capacity, NULL));
+  MallocSpace* space(create_space("test", initial_size, growth_limit, capacity, NULL));
   ASSERT_TRUE(space != NULL);
 
   // Basic sanity
@@ -479,28 +613,32 @@ void SpaceTest::SizeFootPrintGrowthLimitAndTrimDriver(size_t object_size) {
   SizeFootPrintGrowthLimitAndTrimBody(space, object_size, 3, capacity);
 }
 
-#define TEST_SizeFootPrintGrowthLimitAndTrim(name, size) \
-  TEST_F(SpaceTest, SizeFootPrintGrowthLimitAndTrim_AllocationsOf_##name) { \
-    SizeFootPrintGrowthLimitAndTrimDriver(size); \
+#define TEST_SizeFootPrintGrowthLimitAndTrim(name, size, spaceName, spaceFn) \
+  TEST_F(SpaceTest, SizeFootPrintGrowthLimitAndTrim_AllocationsOf_##name##_##spaceName) { \
+    SizeFootPrintGrowthLimitAndTrimDriver(size, spaceFn); \
   } \
-  TEST_F(SpaceTest, SizeFootPrintGrowthLimitAndTrim_RandomAllocationsWithMax_##name) { \
-    SizeFootPrintGrowthLimitAndTrimDriver(-size); \
+  TEST_F(SpaceTest, SizeFootPrintGrowthLimitAndTrim_RandomAllocationsWithMax_##name##_##spaceName) { \
+    SizeFootPrintGrowthLimitAndTrimDriver(-size, spaceFn); \
   }
 
+#define TEST_SPACE_CREATE_FN(spaceName, spaceFn) \
+  TEST_F(SpaceTest, SizeFootPrintGrowthLimitAndTrim_AllocationsOf_8B_##spaceName) { \
+    SizeFootPrintGrowthLimitAndTrimDriver(8, spaceFn); \
+  } \
+  TEST_SizeFootPrintGrowthLimitAndTrim(16B, 16, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(24B, 24, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(32B, 32, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(64B, 64, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(128B, 128, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(1KB, 1 * KB, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(4KB, 4 * KB, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(1MB, 1 * MB, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(4MB, 4 * MB, spaceName, spaceFn) \
+  TEST_SizeFootPrintGrowthLimitAndTrim(8MB, 8 * MB, spaceName, spaceFn)
+
 // Each size test is its own test so that we get a fresh heap each time
-TEST_F(SpaceTest, SizeFootPrintGrowthLimitAndTrim_AllocationsOf_8B) {
-  SizeFootPrintGrowthLimitAndTrimDriver(8);
-}
-TEST_SizeFootPrintGrowthLimitAndTrim(16B, 16)
-TEST_SizeFootPrintGrowthLimitAndTrim(24B, 24)
-TEST_SizeFootPrintGrowthLimitAndTrim(32B, 32)
-TEST_SizeFootPrintGrowthLimitAndTrim(64B, 64)
-TEST_SizeFootPrintGrowthLimitAndTrim(128B, 128)
-TEST_SizeFootPrintGrowthLimitAndTrim(1KB, 1 * KB)
-TEST_SizeFootPrintGrowthLimitAndTrim(4KB, 4 * KB)
-TEST_SizeFootPrintGrowthLimitAndTrim(1MB, 1 * MB)
-TEST_SizeFootPrintGrowthLimitAndTrim(4MB, 4 * MB)
-TEST_SizeFootPrintGrowthLimitAndTrim(8MB, 8 * MB)
+TEST_SPACE_CREATE_FN(DlMallocSpace, SpaceTest::CreateDlMallocSpace)
+TEST_SPACE_CREATE_FN(RosAllocSpace, SpaceTest::CreateRosAllocSpace)
 
 }  // namespace space
 }  // namespace gc
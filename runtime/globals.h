@@ -73,6 +73,14 @@ const bool kIsTargetBuild = true;
 const bool kIsTargetBuild = false;
 #endif
 
+// Whether or not compiled ARM code leaves the null checks of the memory accesses at small offsets
+// to the SIGSEGV handler. Oat files record the mode they were compiled in.
+#if defined(ART_USE_IMPLICIT_NULL_CHECKS)
+const bool kUseImplicitNullChecks = true;
+#else
+const bool kUseImplicitNullChecks = false;
+#endif
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_GLOBALS_H_
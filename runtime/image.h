@@ -90,12 +90,14 @@ class PACKED(4) ImageHeader {
 
   enum ImageRoot {
     kResolutionMethod,
+    kImtConflictMethod,
     kCalleeSaveMethod,
     kRefsOnlySaveMethod,
     kRefsAndArgsSaveMethod,
     kOatLocation,
     kDexCaches,
     kClassRoots,
+    kInternedStrings,
     kImageRootsMax,
   };
 
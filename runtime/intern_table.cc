@@ -16,6 +16,7 @@
 
 #include "intern_table.h"
 
+#include "class_linker.h"
 #include "gc/space/image_space.h"
 #include "mirror/dex_cache.h"
 #include "mirror/object_array-inl.h"
@@ -24,9 +25,123 @@
 #include "thread.h"
 #include "UniquePtr.h"
 #include "utf.h"
+#include "utils.h"
 
 namespace art {
 
+mirror::String* const InternTable::Table::kRemoved = reinterpret_cast<mirror::String*>(1);
+
+InternTable::Table::Table() : num_strings_(0), num_used_slots_(0) {
+  Entry empty = { 0, NULL };
+  entries_.resize(kMinCapacity, empty);
+}
+
+mirror::String* InternTable::Table::Lookup(mirror::String* s, uint32_t hash_code) const {
+  size_t mask = entries_.size() - 1;
+  for (size_t i = hash_code & mask; entries_[i].string != NULL; i = (i + 1) & mask) {
+    mirror::String* existing_string = entries_[i].string;
+    if (existing_string != kRemoved && entries_[i].hash_code == hash_code &&
+        existing_string->Equals(s)) {
+      return existing_string;
+    }
+  }
+  return NULL;
+}
+
+void InternTable::Table::Insert(mirror::String* s, uint32_t hash_code) {
+  if ((num_used_slots_ + 1) * 2 > entries_.size()) {
+    // Grow unless enough tombstones can be dropped.
+    size_t capacity = entries_.size();
+    while ((num_strings_ + 1) * 4 > capacity) {
+      capacity *= 2;
+    }
+    Resize(capacity);
+  }
+  size_t mask = entries_.size() - 1;
+  size_t i = hash_code & mask;
+  while (entries_[i].string != NULL && entries_[i].string != kRemoved) {
+    i = (i + 1) & mask;
+  }
+  if (entries_[i].string == NULL) {
+    ++num_used_slots_;
+  }
+  entries_[i].hash_code = hash_code;
+  entries_[i].string = s;
+  ++num_strings_;
+}
+
+void InternTable::Table::Remove(const mirror::String* s, uint32_t hash_code) {
+  size_t mask = entries_.size() - 1;
+  for (size_t i = hash_code & mask; entries_[i].string != NULL; i = (i + 1) & mask) {
+    if (entries_[i].string == s) {
+      entries_[i].string = kRemoved;
+      --num_strings_;
+      return;
+    }
+  }
+}
+
+void InternTable::Table::VisitRoots(RootVisitor* visitor, void* arg) {
+  for (Entry& entry : entries_) {
+    if (entry.string != NULL && entry.string != kRemoved) {
+      entry.string = down_cast<mirror::String*>(visitor(entry.string, arg));
+    }
+  }
+}
+
+void InternTable::Table::SweepWeaks(IsMarkedCallback* is_marked, void* arg) {
+  for (Entry& entry : entries_) {
+    if (entry.string == NULL || entry.string == kRemoved) {
+      continue;
+    }
+    mirror::Object* object = is_marked(entry.string, arg);
+    if (object == NULL) {
+      entry.string = kRemoved;
+      --num_strings_;
+    } else {
+      // The string may have been moved, the hash code is based on its contents and stays valid.
+      entry.string = down_cast<mirror::String*>(object);
+    }
+  }
+  // Drop the tombstones once they take most of the used slots, probes stop at empty slots only.
+  if (num_used_slots_ > num_strings_ * 2 && num_used_slots_ > kMinCapacity / 4) {
+    size_t capacity = kMinCapacity;
+    while (num_strings_ * 4 > capacity) {
+      capacity *= 2;
+    }
+    Resize(capacity);
+  }
+}
+
+void InternTable::Table::GetStrings(std::vector<mirror::String*>* strings) const {
+  for (const Entry& entry : entries_) {
+    if (entry.string != NULL && entry.string != kRemoved) {
+      strings->push_back(entry.string);
+    }
+  }
+}
+
+void InternTable::Table::Resize(size_t capacity) {
+  DCHECK(IsPowerOfTwo(capacity));
+  DCHECK_LE(num_strings_ * 2, capacity);
+  std::vector<Entry> old_entries;
+  old_entries.swap(entries_);
+  Entry empty = { 0, NULL };
+  entries_.resize(capacity, empty);
+  size_t mask = capacity - 1;
+  for (const Entry& entry : old_entries) {
+    if (entry.string == NULL || entry.string == kRemoved) {
+      continue;
+    }
+    size_t i = entry.hash_code & mask;
+    while (entries_[i].string != NULL) {
+      i = (i + 1) & mask;
+    }
+    entries_[i] = entry;
+  }
+  num_used_slots_ = num_strings_;
+}
+
 InternTable::InternTable()
     : intern_table_lock_("InternTable lock"), is_dirty_(false), allow_new_interns_(true),
       new_intern_condition_("New intern condition", intern_table_lock_) {
@@ -34,22 +149,20 @@ InternTable::InternTable()
 
 size_t InternTable::Size() const {
   MutexLock mu(Thread::Current(), intern_table_lock_);
-  return strong_interns_.size() + weak_interns_.size();
+  return strong_interns_.Size() + weak_interns_.Size();
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
   MutexLock mu(Thread::Current(), intern_table_lock_);
-  os << "Intern table: " << strong_interns_.size() << " strong; "
-     << weak_interns_.size() << " weak\n";
+  os << "Intern table: " << strong_interns_.Size() << " strong; "
+     << weak_interns_.Size() << " weak\n";
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, void* arg,
                              bool only_dirty, bool clean_dirty) {
   MutexLock mu(Thread::Current(), intern_table_lock_);
   if (!only_dirty || is_dirty_) {
-    for (const auto& strong_intern : strong_interns_) {
-      visitor(strong_intern.second, arg);
-    }
+    strong_interns_.VisitRoots(visitor, arg);
     if (clean_dirty) {
       is_dirty_ = false;
     }
@@ -58,59 +171,57 @@ void InternTable::VisitRoots(RootVisitor* visitor, void* arg,
   // image roots.
 }
 
-mirror::String* InternTable::Lookup(Table& table, mirror::String* s,
-                                    uint32_t hash_code) {
-  intern_table_lock_.AssertHeld(Thread::Current());
-  for (auto it = table.find(hash_code), end = table.end(); it != end; ++it) {
-    mirror::String* existing_string = it->second;
-    if (existing_string->Equals(s)) {
-      return existing_string;
-    }
+static mirror::String* LookupStringFromImage(mirror::String* s, uint32_t hash_code)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  gc::space::ImageSpace* image = Runtime::Current()->GetHeap()->GetImageSpace();
+  if (image == NULL) {
+    return NULL;  // No image present.
   }
-  return NULL;
-}
-
-mirror::String* InternTable::Insert(Table& table, mirror::String* s,
-                                    uint32_t hash_code) {
-  intern_table_lock_.AssertHeld(Thread::Current());
-  table.insert(std::make_pair(hash_code, s));
-  return s;
-}
-
-void InternTable::Remove(Table& table, const mirror::String* s,
-                         uint32_t hash_code) {
-  intern_table_lock_.AssertHeld(Thread::Current());
-  for (auto it = table.find(hash_code), end = table.end(); it != end; ++it) {
-    if (it->second == s) {
-      table.erase(it);
-      return;
+  mirror::Object* root = image->GetImageHeader().GetImageRoot(ImageHeader::kInternedStrings);
+  mirror::ObjectArray<mirror::String>* table = root->AsObjectArray<mirror::String>();
+  // Laid out by CreateImageTable, the image strings already carry their hash codes.
+  size_t mask = table->GetLength() - 1;
+  for (size_t i = hash_code & mask; ; i = (i + 1) & mask) {
+    mirror::String* image_string = table->GetWithoutChecks(i);
+    if (image_string == NULL) {
+      return NULL;
+    }
+    if (static_cast<uint32_t>(image_string->GetHashCode()) == hash_code &&
+        image_string->Equals(s)) {
+      return image_string;
     }
   }
 }
 
-static mirror::String* LookupStringFromImage(mirror::String* s)
-    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
-  gc::space::ImageSpace* image = Runtime::Current()->GetHeap()->GetImageSpace();
-  if (image == NULL) {
-    return NULL;  // No image present.
+mirror::ObjectArray<mirror::String>* InternTable::CreateImageTable(Thread* self) {
+  size_t num_strings;
+  {
+    MutexLock mu(self, intern_table_lock_);
+    num_strings = strong_interns_.Size() + weak_interns_.Size();
   }
-  mirror::Object* root = image->GetImageHeader().GetImageRoot(ImageHeader::kDexCaches);
-  mirror::ObjectArray<mirror::DexCache>* dex_caches = root->AsObjectArray<mirror::DexCache>();
-  const std::string utf8 = s->ToModifiedUtf8();
-  for (int32_t i = 0; i < dex_caches->GetLength(); ++i) {
-    mirror::DexCache* dex_cache = dex_caches->Get(i);
-    const DexFile* dex_file = dex_cache->GetDexFile();
-    // Binary search the dex file for the string index.
-    const DexFile::StringId* string_id = dex_file->FindStringId(utf8.c_str());
-    if (string_id != NULL) {
-      uint32_t string_idx = dex_file->GetIndexForStringId(*string_id);
-      mirror::String* image = dex_cache->GetResolvedString(string_idx);
-      if (image != NULL) {
-        return image;
-      }
+  size_t length = RoundUpToPowerOfTwo(num_strings * 2 + 1);
+  mirror::Class* string_array_class =
+      Runtime::Current()->GetClassLinker()->FindSystemClass("[Ljava/lang/String;");
+  CHECK(string_array_class != NULL);
+  // Allocate before taking the lock, the allocation may run a collection which visits the roots.
+  mirror::ObjectArray<mirror::String>* table =
+      mirror::ObjectArray<mirror::String>::Alloc(self, string_array_class, length);
+  CHECK(table != NULL);
+  MutexLock mu(self, intern_table_lock_);
+  // Weak interns may have been swept meanwhile, nothing else may intern strings.
+  CHECK_LE(strong_interns_.Size() + weak_interns_.Size(), num_strings);
+  std::vector<mirror::String*> strings;
+  strong_interns_.GetStrings(&strings);
+  weak_interns_.GetStrings(&strings);
+  size_t mask = length - 1;
+  for (mirror::String* string : strings) {
+    size_t i = static_cast<uint32_t>(string->GetHashCode()) & mask;
+    while (table->GetWithoutChecks(i) != NULL) {
+      i = (i + 1) & mask;
     }
+    table->SetWithoutChecks(i, string);
   }
-  return NULL;
+  return table;
 }
 
 void InternTable::AllowNewInterns() {
@@ -137,9 +248,15 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong) {
     new_intern_condition_.WaitHoldingLocks(self);
   }
 
+  // Check the image for a match, image strings are never added to the other tables.
+  mirror::String* image = LookupStringFromImage(s, hash_code);
+  if (image != NULL) {
+    return image;
+  }
+
   if (is_strong) {
     // Check the strong table for a match.
-    mirror::String* strong = Lookup(strong_interns_, s, hash_code);
+    mirror::String* strong = strong_interns_.Lookup(s, hash_code);
     if (strong != NULL) {
       return strong;
     }
@@ -147,42 +264,34 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong) {
     // Mark as dirty so that we rescan the roots.
     is_dirty_ = true;
 
-    // Check the image for a match.
-    mirror::String* image = LookupStringFromImage(s);
-    if (image != NULL) {
-      return Insert(strong_interns_, image, hash_code);
-    }
-
     // There is no match in the strong table, check the weak table.
-    mirror::String* weak = Lookup(weak_interns_, s, hash_code);
+    mirror::String* weak = weak_interns_.Lookup(s, hash_code);
     if (weak != NULL) {
       // A match was found in the weak table. Promote to the strong table.
-      Remove(weak_interns_, weak, hash_code);
-      return Insert(strong_interns_, weak, hash_code);
+      weak_interns_.Remove(weak, hash_code);
+      strong_interns_.Insert(weak, hash_code);
+      return weak;
     }
 
     // No match in the strong table or the weak table. Insert into the strong
     // table.
-    return Insert(strong_interns_, s, hash_code);
+    strong_interns_.Insert(s, hash_code);
+    return s;
   }
 
   // Check the strong table for a match.
-  mirror::String* strong = Lookup(strong_interns_, s, hash_code);
+  mirror::String* strong = strong_interns_.Lookup(s, hash_code);
   if (strong != NULL) {
     return strong;
   }
-  // Check the image for a match.
-  mirror::String* image = LookupStringFromImage(s);
-  if (image != NULL) {
-    return Insert(weak_interns_, image, hash_code);
-  }
   // Check the weak table for a match.
-  mirror::String* weak = Lookup(weak_interns_, s, hash_code);
+  mirror::String* weak = weak_interns_.Lookup(s, hash_code);
   if (weak != NULL) {
     return weak;
   }
   // Insert into the weak table.
-  return Insert(weak_interns_, s, hash_code);
+  weak_interns_.Insert(s, hash_code);
+  return s;
 }
 
 mirror::String* InternTable::InternStrong(int32_t utf16_length,
@@ -212,21 +321,13 @@ mirror::String* InternTable::InternWeak(mirror::String* s) {
 
 bool InternTable::ContainsWeak(mirror::String* s) {
   MutexLock mu(Thread::Current(), intern_table_lock_);
-  const mirror::String* found = Lookup(weak_interns_, s, s->GetHashCode());
+  const mirror::String* found = weak_interns_.Lookup(s, s->GetHashCode());
   return found == s;
 }
 
-void InternTable::SweepInternTableWeaks(IsMarkedTester is_marked, void* arg) {
+void InternTable::SweepInternTableWeaks(IsMarkedCallback* is_marked, void* arg) {
   MutexLock mu(Thread::Current(), intern_table_lock_);
-  // TODO: std::remove_if + lambda.
-  for (auto it = weak_interns_.begin(), end = weak_interns_.end(); it != end;) {
-    mirror::Object* object = it->second;
-    if (!is_marked(object, arg)) {
-      weak_interns_.erase(it++);
-    } else {
-      ++it;
-    }
-  }
+  weak_interns_.SweepWeaks(is_marked, arg);
 }
 
 }  // namespace art
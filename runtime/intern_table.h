@@ -20,10 +20,11 @@
 #include "base/mutex.h"
 #include "root_visitor.h"
 
-#include <map>
+#include <vector>
 
 namespace art {
 namespace mirror {
+template<class T> class ObjectArray;
 class String;
 }  // namespace mirror
 
@@ -36,6 +37,10 @@ class String;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * The strings of the boot image are interned in a third, read-only table which the image writer
+ * lays out inside the image, see CreateImageTable. It is probed before any string is added to the
+ * other two, so they never hold a string equal to an image string.
  */
 class InternTable {
  public:
@@ -55,7 +60,7 @@ class InternTable {
   // Interns a potentially new string in the 'weak' table. (See above.)
   mirror::String* InternWeak(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  void SweepInternTableWeaks(IsMarkedTester is_marked, void* arg)
+  void SweepInternTableWeaks(IsMarkedCallback* is_marked, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
   bool ContainsWeak(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -69,17 +74,58 @@ class InternTable {
   void DisallowNewInterns() EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
   void AllowNewInterns() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Returns the interned strings laid out as an open addressed table: a power of two length
+  // String[] at most half full, where a string is found by linear probing from its hash code
+  // masked by the length. Used by the image writer once every string of the image is interned.
+  mirror::ObjectArray<mirror::String>* CreateImageTable(Thread* self)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
  private:
-  typedef std::multimap<int32_t, mirror::String*> Table;
+  // An open addressed set of strings keyed by their hash code, with linear probing. Removed
+  // strings leave tombstones which are reused by later inserts.
+  class Table {
+   public:
+    Table();
+
+    mirror::String* Lookup(mirror::String* s, uint32_t hash_code) const
+        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+    // The string must not be present yet.
+    void Insert(mirror::String* s, uint32_t hash_code);
+    void Remove(const mirror::String* s, uint32_t hash_code);
+
+    // Linear walks of the array.
+    void VisitRoots(RootVisitor* visitor, void* arg);
+    void SweepWeaks(IsMarkedCallback* is_marked, void* arg);
+    void GetStrings(std::vector<mirror::String*>* strings) const;
+
+    size_t Size() const {
+      return num_strings_;
+    }
+
+   private:
+    struct Entry {
+      uint32_t hash_code;
+      // NULL for a slot which was never used, kRemoved for a tombstone.
+      mirror::String* string;
+    };
+
+    static const size_t kMinCapacity = 256;
+
+    static mirror::String* const kRemoved;
+
+    // Rebuilds the array with the given power of two capacity, dropping the tombstones.
+    void Resize(size_t capacity);
+
+    std::vector<Entry> entries_;
+    // Live strings.
+    size_t num_strings_;
+    // Live strings and tombstones, kept at most half of the capacity.
+    size_t num_used_slots_;
+  };
 
   mirror::String* Insert(mirror::String* s, bool is_strong)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  mirror::String* Lookup(Table& table, mirror::String* s, uint32_t hash_code)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  mirror::String* Insert(Table& table, mirror::String* s, uint32_t hash_code);
-  void Remove(Table& table, const mirror::String* s, uint32_t hash_code);
-
   mutable Mutex intern_table_lock_;
   bool is_dirty_ GUARDED_BY(intern_table_lock_);
   bool allow_new_interns_ GUARDED_BY(intern_table_lock_);
@@ -16,8 +16,11 @@
 
 #include "intern_table.h"
 
+#include <set>
+
 #include "common_test.h"
 #include "mirror/object.h"
+#include "mirror/object_array-inl.h"
 #include "sirt_ref.h"
 
 namespace art {
@@ -117,6 +120,60 @@ TEST_F(InternTableTest, SweepInternTableWeaks) {
   EXPECT_EQ(3U, t.Size());
 }
 
+static mirror::Object* IsNotInSet(mirror::Object* object, void* arg) {
+  std::set<const mirror::Object*>* dead = reinterpret_cast<std::set<const mirror::Object*>*>(arg);
+  return dead->find(object) == dead->end() ? object : NULL;
+}
+
+// Enough strings to grow the tables several times and to leave tombstones behind a sweep.
+TEST_F(InternTableTest, ManyStrings) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable t;
+  const int32_t kNumStrings = 2000;
+  mirror::Class* string_array_class = class_linker_->FindSystemClass("[Ljava/lang/String;");
+  // The table isn't a root, keep its strings reachable.
+  SirtRef<mirror::ObjectArray<mirror::String> > weaks(soa.Self(),
+      mirror::ObjectArray<mirror::String>::Alloc(soa.Self(), string_array_class, kNumStrings));
+  SirtRef<mirror::ObjectArray<mirror::String> > strongs(soa.Self(),
+      mirror::ObjectArray<mirror::String>::Alloc(soa.Self(), string_array_class, kNumStrings));
+  for (int32_t i = 0; i < kNumStrings; ++i) {
+    std::string weak(StringPrintf("weak %d", i));
+    mirror::String* s = mirror::String::AllocFromModifiedUtf8(soa.Self(), weak.c_str());
+    weaks->Set(i, t.InternWeak(s));
+    strongs->Set(i, t.InternStrong(StringPrintf("strong %d", i).c_str()));
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumStrings * 2), t.Size());
+  for (int32_t i = 0; i < kNumStrings; ++i) {
+    EXPECT_EQ(weaks->Get(i), t.InternWeak(mirror::String::AllocFromModifiedUtf8(
+        soa.Self(), StringPrintf("weak %d", i).c_str())));
+    EXPECT_EQ(strongs->Get(i), t.InternStrong(StringPrintf("strong %d", i).c_str()));
+    EXPECT_TRUE(t.ContainsWeak(weaks->Get(i)));
+  }
+
+  // Sweep the odd weak strings.
+  std::set<const mirror::Object*> dead;
+  for (int32_t i = 1; i < kNumStrings; i += 2) {
+    dead.insert(weaks->Get(i));
+  }
+  {
+    ReaderMutexLock mu(soa.Self(), *Locks::heap_bitmap_lock_);
+    t.SweepInternTableWeaks(IsNotInSet, &dead);
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumStrings + kNumStrings / 2), t.Size());
+  for (int32_t i = 0; i < kNumStrings; ++i) {
+    SirtRef<mirror::String> copy(soa.Self(), mirror::String::AllocFromModifiedUtf8(
+        soa.Self(), StringPrintf("weak %d", i).c_str()));
+    if (i % 2 == 0) {
+      EXPECT_TRUE(t.ContainsWeak(weaks->Get(i)));
+      EXPECT_EQ(weaks->Get(i), t.InternWeak(copy.get()));
+    } else {
+      // Interning again takes a tombstone or a free slot.
+      EXPECT_EQ(copy.get(), t.InternWeak(copy.get()));
+    }
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumStrings * 2), t.Size());
+}
+
 TEST_F(InternTableTest, ContainsWeak) {
   ScopedObjectAccess soa(Thread::Current());
   {
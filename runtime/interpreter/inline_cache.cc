@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "inline_cache.h"
+
+#include <ostream>
+
+#include "atomic.h"
+#include "base/stl_util.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace interpreter {
+
+InlineCache::InlineCache(const mirror::ArtMethod* caller, uint32_t dex_pc)
+    : caller_(caller), dex_pc_(dex_pc), megamorphic_count_(0) {
+  for (size_t i = 0; i < kMaxEntries; ++i) {
+    entries_[i].klass = NULL;
+    entries_[i].target = NULL;
+    entries_[i].count = 0;
+  }
+}
+
+InlineCacheTable::Array::Array(size_t capacity)
+    : mask(capacity - 1), slots(new InlineCache* volatile[capacity]) {
+  DCHECK(IsPowerOfTwo(capacity));
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i] = NULL;
+  }
+}
+
+InlineCacheTable::Array::~Array() {
+  delete[] slots;
+}
+
+InlineCacheTable::InlineCacheTable()
+    : lock_("interpreter inline cache lock"), array_(new Array(kMinCapacity)) {
+}
+
+InlineCacheTable::~InlineCacheTable() {
+  delete array_;
+  STLDeleteElements(&retired_arrays_);
+  STLDeleteElements(&caches_);
+}
+
+size_t InlineCacheTable::Hash(const mirror::ArtMethod* caller, uint32_t dex_pc) {
+  size_t hash = reinterpret_cast<uintptr_t>(caller) / kObjectAlignment;
+  return (hash * 31 + dex_pc) * 0x9e3779b1;
+}
+
+InlineCache* InlineCacheTable::Find(const Array* array, const mirror::ArtMethod* caller,
+                                    uint32_t dex_pc) const {
+  for (size_t i = Hash(caller, dex_pc) & array->mask; ; i = (i + 1) & array->mask) {
+    InlineCache* cache = array->slots[i];
+    if (cache == NULL || (cache->caller_ == caller && cache->dex_pc_ == dex_pc)) {
+      return cache;
+    }
+  }
+}
+
+void InlineCacheTable::Insert(Array* array, InlineCache* cache) {
+  size_t i = Hash(cache->caller_, cache->dex_pc_) & array->mask;
+  while (array->slots[i] != NULL) {
+    i = (i + 1) & array->mask;
+  }
+  array->slots[i] = cache;
+}
+
+InlineCache* InlineCacheTable::GetInlineCache(const mirror::ArtMethod* caller, uint32_t dex_pc) {
+  InlineCache* cache = Find(array_, caller, dex_pc);
+  if (LIKELY(cache != NULL)) {
+    return cache;
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  // Another thread may have created the cache since.
+  cache = Find(array_, caller, dex_pc);
+  if (cache != NULL) {
+    return cache;
+  }
+  cache = new InlineCache(caller, dex_pc);
+  caches_.push_back(cache);
+  Array* array = array_;
+  if (caches_.size() * 2 > array->mask + 1) {
+    Array* new_array = new Array((array->mask + 1) * 2);
+    for (size_t i = 0; i <= array->mask; ++i) {
+      if (array->slots[i] != NULL) {
+        Insert(new_array, array->slots[i]);
+      }
+    }
+    Insert(new_array, cache);
+    // Lookups must see the filled array.
+    ANDROID_MEMBAR_STORE();
+    array_ = new_array;
+    retired_arrays_.push_back(array);
+  } else {
+    // Lookups must see the initialized cache.
+    ANDROID_MEMBAR_STORE();
+    Insert(array, cache);
+  }
+  return cache;
+}
+
+void InlineCacheTable::Update(InlineCache* cache, mirror::Class* klass,
+                              mirror::ArtMethod* target) {
+  DCHECK(klass != NULL);
+  DCHECK(target != NULL);
+  MutexLock mu(Thread::Current(), lock_);
+  for (size_t i = 0; i < InlineCache::kMaxEntries; ++i) {
+    InlineCache::Entry& entry = cache->entries_[i];
+    if (entry.klass == klass) {
+      // Added by another thread since its lookup missed.
+      DCHECK_EQ(entry.target, target);
+      return;
+    }
+    if (entry.klass == NULL) {
+      entry.target = target;
+      entry.count = 1;
+      // Lookups must see the target of a published class.
+      ANDROID_MEMBAR_STORE();
+      entry.klass = klass;
+      return;
+    }
+  }
+}
+
+void InlineCacheTable::GetReceiverTypeProfiles(const mirror::ArtMethod* caller,
+                                               std::vector<ReceiverTypeProfile>* profiles) const {
+  MutexLock mu(Thread::Current(), lock_);
+  for (size_t i = 0; i < caches_.size(); ++i) {
+    const InlineCache* cache = caches_[i];
+    if (caller != NULL && cache->caller_ != caller) {
+      continue;
+    }
+    ReceiverTypeProfile profile;
+    profile.caller = cache->caller_;
+    profile.dex_pc = cache->dex_pc_;
+    profile.megamorphic_count = cache->megamorphic_count_;
+    for (size_t j = 0; j < InlineCache::kMaxEntries && cache->entries_[j].klass != NULL; ++j) {
+      ReceiverTypeProfile::Receiver receiver;
+      receiver.klass = cache->entries_[j].klass;
+      receiver.target = cache->entries_[j].target;
+      receiver.count = cache->entries_[j].count;
+      profile.receivers.push_back(receiver);
+    }
+    profiles->push_back(profile);
+  }
+}
+
+void InlineCacheTable::Dump(std::ostream& os) const {
+  std::vector<ReceiverTypeProfile> profiles;
+  GetReceiverTypeProfiles(NULL, &profiles);
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    const ReceiverTypeProfile& profile = profiles[i];
+    os << PrettyMethod(profile.caller) << StringPrintf(" @0x%x:", profile.dex_pc);
+    for (size_t j = 0; j < profile.receivers.size(); ++j) {
+      const ReceiverTypeProfile::Receiver& receiver = profile.receivers[j];
+      os << " " << PrettyDescriptor(receiver.klass) << "=" << receiver.count;
+    }
+    if (profile.megamorphic_count != 0) {
+      os << " megamorphic=" << profile.megamorphic_count;
+    }
+    os << "\n";
+  }
+}
+
+void InlineCacheTable::DumpForSigQuit(std::ostream& os) const {
+  MutexLock mu(Thread::Current(), lock_);
+  size_t num_megamorphic = 0;
+  for (size_t i = 0; i < caches_.size(); ++i) {
+    if (caches_[i]->IsMegamorphic()) {
+      ++num_megamorphic;
+    }
+  }
+  os << "Interpreter inline caches: " << caches_.size() << " call sites; "
+     << num_megamorphic << " megamorphic\n";
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_INTERPRETER_INLINE_CACHE_H_
+#define ART_RUNTIME_INTERPRETER_INLINE_CACHE_H_
+
+#include <iosfwd>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+namespace mirror {
+  class ArtMethod;
+  class Class;
+}  // namespace mirror
+
+namespace interpreter {
+
+// The receiver classes seen by an invoke-virtual or invoke-interface of interpreted code and the
+// method each of them dispatched to. The call site is monomorphic while it saw a single class,
+// polymorphic up to kMaxEntries classes and megamorphic beyond, the classes which don't fit are
+// only counted and resolved through FindMethodFromCode on every call.
+//
+// Lookups don't take a lock: the target of an entry is written before its class publishes it and
+// an entry never changes afterwards but for its hit count, which is approximate. The caches hold
+// plain pointers to classes and methods, see Heap::IsMovableObjectClass.
+class InlineCache {
+ public:
+  static const size_t kMaxEntries = 4;
+
+  InlineCache(const mirror::ArtMethod* caller, uint32_t dex_pc);
+
+  // Returns the method that receivers of the class dispatch to or NULL if the class wasn't cached.
+  mirror::ArtMethod* Lookup(const mirror::Class* klass) {
+    for (size_t i = 0; i < kMaxEntries; ++i) {
+      const mirror::Class* cached = entries_[i].klass;
+      if (cached == klass) {
+        ++entries_[i].count;
+        return entries_[i].target;
+      }
+      if (cached == NULL) {
+        return NULL;
+      }
+    }
+    ++megamorphic_count_;
+    return NULL;
+  }
+
+  const mirror::ArtMethod* GetCaller() const {
+    return caller_;
+  }
+
+  uint32_t GetDexPc() const {
+    return dex_pc_;
+  }
+
+  // Whether every entry holds a class, which Update then leaves alone. Entries are never removed.
+  bool IsFull() const {
+    return entries_[kMaxEntries - 1].klass != NULL;
+  }
+
+  bool IsMegamorphic() const {
+    return megamorphic_count_ != 0;
+  }
+
+ private:
+  struct Entry {
+    // NULL while the entry is unused.
+    mirror::Class* volatile klass;
+    mirror::ArtMethod* target;
+    uint32_t count;
+  };
+
+  const mirror::ArtMethod* const caller_;
+  const uint32_t dex_pc_;
+  // The calls since the cache filled up whose receiver class isn't cached.
+  uint32_t megamorphic_count_;
+  Entry entries_[kMaxEntries];
+
+  friend class InlineCacheTable;
+  DISALLOW_COPY_AND_ASSIGN(InlineCache);
+};
+
+// The receiver types of a call site, for a recompilation of the caller to devirtualize or inline
+// the hot targets. Receivers are in the order their classes were first seen.
+struct ReceiverTypeProfile {
+  struct Receiver {
+    mirror::Class* klass;
+    mirror::ArtMethod* target;
+    uint32_t count;
+  };
+
+  const mirror::ArtMethod* caller;
+  uint32_t dex_pc;
+  std::vector<Receiver> receivers;
+  // Calls with receiver classes beyond the kMaxEntries ones in receivers.
+  uint32_t megamorphic_count;
+};
+
+// The inline caches of all call sites, created on the first execution of a site. Keyed by caller
+// and dex pc in an open addressed table that lookups probe without taking the lock, like the
+// ClassTable. Created caches are never deleted until the runtime shuts down.
+class InlineCacheTable {
+ public:
+  InlineCacheTable();
+  ~InlineCacheTable();
+
+  // Returns the cache of the call site, creating it on the first call.
+  InlineCache* GetInlineCache(const mirror::ArtMethod* caller, uint32_t dex_pc)
+      LOCKS_EXCLUDED(lock_);
+
+  // Remembers the target resolved for a receiver class that missed in the cache, unless the cache
+  // is full. Callers check IsFull() first to not take the lock for megamorphic call sites.
+  void Update(InlineCache* cache, mirror::Class* klass, mirror::ArtMethod* target)
+      LOCKS_EXCLUDED(lock_);
+
+  // Appends the profiles of the call sites of the caller, or of every call site if it is NULL.
+  void GetReceiverTypeProfiles(const mirror::ArtMethod* caller,
+                               std::vector<ReceiverTypeProfile>* profiles) const
+      LOCKS_EXCLUDED(lock_);
+
+  // One line per call site with the receiver classes and their counts.
+  void Dump(std::ostream& os) const
+      LOCKS_EXCLUDED(lock_) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  void DumpForSigQuit(std::ostream& os) const LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Array {
+    explicit Array(size_t capacity);
+    ~Array();
+
+    const size_t mask;
+    InlineCache* volatile* const slots;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Array);
+  };
+
+  static const size_t kMinCapacity = 256;
+
+  static size_t Hash(const mirror::ArtMethod* caller, uint32_t dex_pc);
+
+  InlineCache* Find(const Array* array, const mirror::ArtMethod* caller, uint32_t dex_pc) const;
+
+  void Insert(Array* array, InlineCache* cache) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Guards the creation of caches and the addition of entries.
+  mutable Mutex lock_;
+  Array* volatile array_;
+  // Outgrown arrays, which lookups may still probe.
+  std::vector<Array*> retired_arrays_ GUARDED_BY(lock_);
+  std::vector<InlineCache*> caches_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(InlineCacheTable);
+};
+
+}  // namespace interpreter
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_INLINE_CACHE_H_
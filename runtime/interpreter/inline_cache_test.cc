@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "inline_cache.h"
+
+#include <vector>
+
+#include "common_test.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+
+namespace art {
+namespace interpreter {
+
+class InlineCacheTest : public CommonTest {
+ protected:
+  mirror::ArtMethod* HashCode(mirror::Class* klass) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    mirror::ArtMethod* method = klass->FindVirtualMethod("hashCode", "()I");
+    CHECK(method != NULL);
+    return method;
+  }
+};
+
+TEST_F(InlineCacheTest, GetInlineCache) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object = class_linker_->FindSystemClass("Ljava/lang/Object;");
+  mirror::ArtMethod* caller = HashCode(object);
+  InlineCacheTable table;
+  InlineCache* cache = table.GetInlineCache(caller, 3);
+  ASSERT_TRUE(cache != NULL);
+  EXPECT_EQ(caller, cache->GetCaller());
+  EXPECT_EQ(3U, cache->GetDexPc());
+  EXPECT_EQ(cache, table.GetInlineCache(caller, 3));
+  EXPECT_NE(cache, table.GetInlineCache(caller, 4));
+
+  // Enough call sites to grow the table several times.
+  std::vector<InlineCache*> caches;
+  for (uint32_t dex_pc = 0; dex_pc < 2000; ++dex_pc) {
+    caches.push_back(table.GetInlineCache(caller, dex_pc));
+  }
+  for (uint32_t dex_pc = 0; dex_pc < 2000; ++dex_pc) {
+    EXPECT_EQ(caches[dex_pc], table.GetInlineCache(caller, dex_pc));
+  }
+  EXPECT_EQ(cache, table.GetInlineCache(caller, 3));
+}
+
+TEST_F(InlineCacheTest, LookupAndUpdate) {
+  ScopedObjectAccess soa(Thread::Current());
+  const char* descriptors[] = {
+    "Ljava/lang/Object;", "Ljava/lang/String;", "Ljava/lang/Integer;", "Ljava/lang/Long;",
+    "Ljava/lang/Short;",
+  };
+  std::vector<mirror::Class*> classes;
+  for (size_t i = 0; i < arraysize(descriptors); ++i) {
+    classes.push_back(class_linker_->FindSystemClass(descriptors[i]));
+  }
+  ASSERT_GT(classes.size(), InlineCache::kMaxEntries);
+  InlineCacheTable table;
+  InlineCache* cache = table.GetInlineCache(HashCode(classes[0]), 0);
+
+  // Monomorphic.
+  EXPECT_TRUE(cache->Lookup(classes[1]) == NULL);
+  table.Update(cache, classes[1], HashCode(classes[1]));
+  EXPECT_EQ(HashCode(classes[1]), cache->Lookup(classes[1]));
+  EXPECT_TRUE(cache->Lookup(classes[2]) == NULL);
+  EXPECT_FALSE(cache->IsFull());
+  EXPECT_FALSE(cache->IsMegamorphic());
+
+  // Polymorphic up to kMaxEntries classes.
+  for (size_t i = 2; i <= InlineCache::kMaxEntries; ++i) {
+    table.Update(cache, classes[i], HashCode(classes[i]));
+  }
+  for (size_t i = 1; i <= InlineCache::kMaxEntries; ++i) {
+    EXPECT_EQ(HashCode(classes[i]), cache->Lookup(classes[i]));
+  }
+  EXPECT_TRUE(cache->IsFull());
+  EXPECT_FALSE(cache->IsMegamorphic());
+
+  // Megamorphic beyond, the other classes keep hitting.
+  EXPECT_TRUE(cache->Lookup(classes[0]) == NULL);
+  table.Update(cache, classes[0], HashCode(classes[0]));
+  EXPECT_TRUE(cache->Lookup(classes[0]) == NULL);
+  EXPECT_TRUE(cache->IsMegamorphic());
+  EXPECT_EQ(HashCode(classes[1]), cache->Lookup(classes[1]));
+}
+
+TEST_F(InlineCacheTest, GetReceiverTypeProfiles) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object = class_linker_->FindSystemClass("Ljava/lang/Object;");
+  mirror::Class* string = class_linker_->FindSystemClass("Ljava/lang/String;");
+  mirror::ArtMethod* caller1 = HashCode(object);
+  mirror::ArtMethod* caller2 = HashCode(string);
+  InlineCacheTable table;
+  InlineCache* cache1 = table.GetInlineCache(caller1, 7);
+  table.Update(cache1, string, HashCode(string));
+  table.Update(cache1, object, HashCode(object));
+  cache1->Lookup(string);
+  cache1->Lookup(string);
+  cache1->Lookup(object);
+  table.GetInlineCache(caller2, 1);
+
+  std::vector<ReceiverTypeProfile> profiles;
+  table.GetReceiverTypeProfiles(caller1, &profiles);
+  ASSERT_EQ(1U, profiles.size());
+  EXPECT_EQ(caller1, profiles[0].caller);
+  EXPECT_EQ(7U, profiles[0].dex_pc);
+  EXPECT_EQ(0U, profiles[0].megamorphic_count);
+  ASSERT_EQ(2U, profiles[0].receivers.size());
+  EXPECT_EQ(string, profiles[0].receivers[0].klass);
+  EXPECT_EQ(HashCode(string), profiles[0].receivers[0].target);
+  EXPECT_EQ(3U, profiles[0].receivers[0].count);
+  EXPECT_EQ(object, profiles[0].receivers[1].klass);
+  EXPECT_EQ(HashCode(object), profiles[0].receivers[1].target);
+  EXPECT_EQ(2U, profiles[0].receivers[1].count);
+
+  profiles.clear();
+  table.GetReceiverTypeProfiles(NULL, &profiles);
+  EXPECT_EQ(2U, profiles.size());
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -3084,12 +3084,11 @@ void JavaVMExt::AllowNewWeakGlobals() {
   weak_globals_add_condition_.Broadcast(self);
 }
 
-void JavaVMExt::SweepWeakGlobals(IsMarkedTester is_marked, void* arg) {
+void JavaVMExt::SweepWeakGlobals(IsMarkedCallback* is_marked, void* arg) {
   MutexLock mu(Thread::Current(), weak_globals_lock_);
   for (const Object** entry : weak_globals_) {
-    if (!is_marked(*entry, arg)) {
-      *entry = kClearedJniWeakGlobal;
-    }
+    Object* object = is_marked(const_cast<Object*>(*entry), arg);
+    *entry = object != NULL ? object : kClearedJniWeakGlobal;
   }
 }
 
@@ -22,9 +22,20 @@
 
 namespace art {
 
-// A utility for processing the raw uleb128 encoded mapping table created by the quick compiler.
+// A utility for processing the mapping table created by the quick compiler. The table starts with
+// the uleb128 encoded total number of entries, the number of pc to dex entries and the size in
+// bytes of the pc to dex section, followed by the pc to dex and the dex to pc sections.
+//
+// The entries of a section are sorted by their key, the native pc offset for the pc to dex
+// mappings and the dex pc for the dex to pc mappings, and encoded as the uleb128 delta of the key
+// and the zigzag uleb128 delta of the value to the previous entry. Every kIndexInterval-th entry
+// is encoded against zero instead and the section starts with the little endian 32-bit byte
+// offsets of these entries after the first, so a lookup binary searches the indexed entries and
+// decodes at most an interval of the others.
 class MappingTable {
  public:
+  static const uint32_t kIndexInterval = 16;
+
   explicit MappingTable(const uint8_t* encoded_map) : encoded_table_(encoded_map) {
   }
 
@@ -48,72 +59,6 @@ class MappingTable {
     }
   }
 
-  const uint8_t* FirstDexToPcPtr() const {
-    const uint8_t* table = encoded_table_;
-    if (table != NULL) {
-      DecodeUnsignedLeb128(&table);  // Total_size, unused.
-      uint32_t pc_to_dex_size = DecodeUnsignedLeb128(&table);
-      for (uint32_t i = 0; i < pc_to_dex_size; ++i) {
-        DecodeUnsignedLeb128(&table);  // Move ptr past native PC.
-        DecodeUnsignedLeb128(&table);  // Move ptr past dex PC.
-      }
-    }
-    return table;
-  }
-
-  class DexToPcIterator {
-   public:
-    DexToPcIterator(const MappingTable* table, uint32_t element) :
-        table_(table), element_(element), end_(table_->DexToPcSize()), encoded_table_ptr_(NULL),
-        native_pc_offset_(0), dex_pc_(0) {
-      if (element == 0) {
-        encoded_table_ptr_ = table_->FirstDexToPcPtr();
-        native_pc_offset_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
-        dex_pc_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
-      } else {
-        DCHECK_EQ(table_->DexToPcSize(), element);
-      }
-    }
-    uint32_t NativePcOffset() const {
-      return native_pc_offset_;
-    }
-    uint32_t DexPc() const {
-      return dex_pc_;
-    }
-    void operator++() {
-      ++element_;
-      if (element_ != end_) {  // Avoid reading beyond the end of the table.
-        native_pc_offset_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
-        dex_pc_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
-      }
-    }
-    bool operator==(const DexToPcIterator& rhs) const {
-      CHECK(table_ == rhs.table_);
-      return element_ == rhs.element_;
-    }
-    bool operator!=(const DexToPcIterator& rhs) const {
-      CHECK(table_ == rhs.table_);
-      return element_ != rhs.element_;
-    }
-
-   private:
-    const MappingTable* const table_;  // The original table.
-    uint32_t element_;  // A value in the range 0 to end_.
-    const uint32_t end_;  // Equal to table_->DexToPcSize().
-    const uint8_t* encoded_table_ptr_;  // Either NULL or points to encoded data after this entry.
-    uint32_t native_pc_offset_;  // The current value of native pc offset.
-    uint32_t dex_pc_;  // The current value of dex pc.
-  };
-
-  DexToPcIterator DexToPcBegin() const {
-    return DexToPcIterator(this, 0);
-  }
-
-  DexToPcIterator DexToPcEnd() const {
-    uint32_t size = DexToPcSize();
-    return DexToPcIterator(this, size);
-  }
-
   uint32_t PcToDexSize() const PURE {
     const uint8_t* table = encoded_table_;
     if (table == NULL) {
@@ -125,69 +70,153 @@ class MappingTable {
     }
   }
 
-  const uint8_t* FirstPcToDexPtr() const {
+  const uint8_t* PcToDexSectionPtr() const {
+    const uint8_t* table = encoded_table_;
+    if (table != NULL) {
+      DecodeUnsignedLeb128(&table);  // Total_size, unused.
+      DecodeUnsignedLeb128(&table);  // PC to Dex size, unused.
+      DecodeUnsignedLeb128(&table);  // PC to Dex section size, unused.
+    }
+    return table;
+  }
+
+  const uint8_t* DexToPcSectionPtr() const {
     const uint8_t* table = encoded_table_;
     if (table != NULL) {
       DecodeUnsignedLeb128(&table);  // Total_size, unused.
       DecodeUnsignedLeb128(&table);  // PC to Dex size, unused.
+      uint32_t pc_to_dex_section_size = DecodeUnsignedLeb128(&table);
+      table += pc_to_dex_section_size;
     }
     return table;
   }
 
-  class PcToDexIterator {
+  // The number of index entries of a section with the given number of entries.
+  static uint32_t IndexSize(uint32_t size) {
+    return (size == 0) ? 0 : (size - 1) / kIndexInterval;
+  }
+
+  // Reads a 32-bit index entry, which need not be aligned.
+  static uint32_t ReadIndexEntry(const uint8_t* ptr) {
+    return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | (ptr[3] << 24);
+  }
+
+  template <bool kKeyIsNativePcOffset>
+  class Iterator {
    public:
-    PcToDexIterator(const MappingTable* table, uint32_t element) :
-        table_(table), element_(element), end_(table_->PcToDexSize()), encoded_table_ptr_(NULL),
-        native_pc_offset_(0), dex_pc_(0) {
-      if (element == 0) {
-        encoded_table_ptr_ = table_->FirstPcToDexPtr();
-        native_pc_offset_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
-        dex_pc_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
-      } else {
-        DCHECK_EQ(table_->PcToDexSize(), element);
+    // The element must be indexed or the end of the section.
+    Iterator(const uint8_t* section, uint32_t size, uint32_t element) :
+        section_(section), element_(element), end_(size), encoded_table_ptr_(NULL), key_(0),
+        value_(0) {
+      if (element_ != end_) {
+        DCHECK_EQ(element_ % kIndexInterval, 0U);
+        encoded_table_ptr_ = section_ + IndexSize(end_) * sizeof(uint32_t);
+        if (element_ != 0) {
+          encoded_table_ptr_ +=
+              ReadIndexEntry(section_ + (element_ / kIndexInterval - 1) * sizeof(uint32_t));
+        }
+        Decode();
       }
     }
     uint32_t NativePcOffset() const {
-      return native_pc_offset_;
+      return kKeyIsNativePcOffset ? key_ : value_;
     }
     uint32_t DexPc() const {
-      return dex_pc_;
+      return kKeyIsNativePcOffset ? value_ : key_;
     }
     void operator++() {
       ++element_;
       if (element_ != end_) {  // Avoid reading beyond the end of the table.
-        native_pc_offset_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
-        dex_pc_ = DecodeUnsignedLeb128(&encoded_table_ptr_);
+        Decode();
       }
     }
-    bool operator==(const PcToDexIterator& rhs) const {
-      CHECK(table_ == rhs.table_);
+    bool operator==(const Iterator& rhs) const {
+      CHECK(section_ == rhs.section_);
       return element_ == rhs.element_;
     }
-    bool operator!=(const PcToDexIterator& rhs) const {
-      CHECK(table_ == rhs.table_);
+    bool operator!=(const Iterator& rhs) const {
+      CHECK(section_ == rhs.section_);
       return element_ != rhs.element_;
     }
 
    private:
-    const MappingTable* const table_;  // The original table.
-    uint32_t element_;  // A value in the range 0 to PcToDexSize.
-    const uint32_t end_;  // Equal to table_->PcToDexSize().
+    void Decode() {
+      if (element_ % kIndexInterval == 0) {
+        key_ = 0;
+        value_ = 0;
+      }
+      key_ += DecodeUnsignedLeb128(&encoded_table_ptr_);
+      uint32_t zigzag_delta = DecodeUnsignedLeb128(&encoded_table_ptr_);
+      value_ += (zigzag_delta >> 1) ^ -(zigzag_delta & 1);
+    }
+
+    const uint8_t* const section_;  // The start of the section, with its index.
+    uint32_t element_;  // A value in the range 0 to end_.
+    const uint32_t end_;  // The number of entries of the section.
     const uint8_t* encoded_table_ptr_;  // Either NULL or points to encoded data after this entry.
-    uint32_t native_pc_offset_;  // The current value of native pc offset.
-    uint32_t dex_pc_;  // The current value of dex pc.
+    uint32_t key_;  // The current value of the key.
+    uint32_t value_;  // The current value of the value.
+
+    friend class MappingTable;
   };
 
+  typedef Iterator<false> DexToPcIterator;
+  typedef Iterator<true> PcToDexIterator;
+
+  DexToPcIterator DexToPcBegin() const {
+    return DexToPcIterator(DexToPcSectionPtr(), DexToPcSize(), 0);
+  }
+
+  DexToPcIterator DexToPcEnd() const {
+    uint32_t size = DexToPcSize();
+    return DexToPcIterator(DexToPcSectionPtr(), size, size);
+  }
+
+  // Returns the first dex to pc entry of the dex pc or DexToPcEnd().
+  DexToPcIterator FindDexToPc(uint32_t dex_pc) const {
+    return Find<false>(DexToPcSectionPtr(), DexToPcSize(), dex_pc);
+  }
+
   PcToDexIterator PcToDexBegin() const {
-    return PcToDexIterator(this, 0);
+    return PcToDexIterator(PcToDexSectionPtr(), PcToDexSize(), 0);
   }
 
   PcToDexIterator PcToDexEnd() const {
     uint32_t size = PcToDexSize();
-    return PcToDexIterator(this, size);
+    return PcToDexIterator(PcToDexSectionPtr(), size, size);
+  }
+
+  // Returns the first pc to dex entry of the native pc offset or PcToDexEnd().
+  PcToDexIterator FindPcToDex(uint32_t native_pc_offset) const {
+    return Find<true>(PcToDexSectionPtr(), PcToDexSize(), native_pc_offset);
   }
 
  private:
+  template <bool kKeyIsNativePcOffset>
+  static Iterator<kKeyIsNativePcOffset> Find(const uint8_t* section, uint32_t size,
+                                             uint32_t key) {
+    // Find the last indexed entry with a smaller key, the first entry with the key can only be
+    // in its interval or be the next indexed entry.
+    uint32_t lo = 0;
+    uint32_t hi = IndexSize(size) + 1;
+    while (hi - lo > 1) {
+      uint32_t mid = (lo + hi) / 2;
+      if (Iterator<kKeyIsNativePcOffset>(section, size, mid * kIndexInterval).key_ < key) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    Iterator<kKeyIsNativePcOffset> it(section, size, (size == 0) ? 0 : lo * kIndexInterval);
+    while (it.element_ != size && it.key_ < key) {
+      ++it;
+    }
+    if (it.element_ != size && it.key_ == key) {
+      return it;
+    }
+    return Iterator<kKeyIsNativePcOffset>(section, size, size);
+  }
+
   const uint8_t* const encoded_table_;
 };
 
@@ -32,8 +32,8 @@
 namespace art {
 namespace mirror {
 
-Array* Array::Alloc(Thread* self, Class* array_class, int32_t component_count,
-                    size_t component_size) {
+Array* Array::AllocInternal(Thread* self, Class* array_class, int32_t component_count,
+                            size_t component_size, bool movable) {
   DCHECK(array_class != NULL);
   DCHECK_GE(component_count, 0);
   DCHECK(array_class->IsArrayClass());
@@ -52,7 +52,12 @@ Array* Array::Alloc(Thread* self, Class* array_class, int32_t component_count,
   }
 
   gc::Heap* heap = Runtime::Current()->GetHeap();
-  Array* array = down_cast<Array*>(heap->AllocObject(self, array_class, size));
+  Array* array;
+  if (movable) {
+    array = down_cast<Array*>(heap->AllocObject(self, array_class, size));
+  } else {
+    array = down_cast<Array*>(heap->AllocNonMovableObject(self, array_class, size));
+  }
   if (array != NULL) {
     DCHECK(array->IsArrayInstance());
     array->SetLength(component_count);
@@ -60,6 +65,16 @@ Array* Array::Alloc(Thread* self, Class* array_class, int32_t component_count,
   return array;
 }
 
+Array* Array::Alloc(Thread* self, Class* array_class, int32_t component_count,
+                    size_t component_size) {
+  return AllocInternal(self, array_class, component_count, component_size, true);
+}
+
+Array* Array::AllocNonMovable(Thread* self, Class* array_class, int32_t component_count) {
+  DCHECK(array_class->IsArrayClass());
+  return AllocInternal(self, array_class, component_count, array_class->GetComponentSize(), false);
+}
+
 Array* Array::Alloc(Thread* self, Class* array_class, int32_t component_count) {
   DCHECK(array_class->IsArrayClass());
   return Alloc(self, array_class, component_count, array_class->GetComponentSize());
@@ -74,7 +89,7 @@ Array* Array::Alloc(Thread* self, Class* array_class, int32_t component_count) {
 // Recursively create an array with multiple dimensions.  Elements may be
 // Objects or primitive types.
 static Array* RecursiveCreateMultiArray(Thread* self, Class* array_class, int current_dimension,
-                                        IntArray* dimensions)
+                                        SirtRef<IntArray>& dimensions)
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
   int32_t array_length = dimensions->Get(current_dimension);
   SirtRef<Array> new_array(self, Array::Alloc(self, array_class, array_length));
@@ -114,6 +129,9 @@ Array* Array::CreateMultiArray(Thread* self, Class* element_class, IntArray* dim
     }
   }
 
+  // The allocations below may move the dimensions.
+  SirtRef<IntArray> dimensions_ref(self, dimensions);
+
   // Generate the full name of the array class.
   std::string descriptor(num_dimensions, '[');
   descriptor += ClassHelper(element_class).GetDescriptor();
@@ -126,7 +144,7 @@ Array* Array::CreateMultiArray(Thread* self, Class* element_class, IntArray* dim
     return NULL;
   }
   // create the array
-  Array* new_array = RecursiveCreateMultiArray(self, array_class, 0, dimensions);
+  Array* new_array = RecursiveCreateMultiArray(self, array_class, 0, dimensions_ref);
   if (UNLIKELY(new_array == NULL)) {
     CHECK(self->IsExceptionPending());
     return NULL;
@@ -30,6 +30,7 @@
 #include "object_array-inl.h"
 #include "string.h"
 #include "object_utils.h"
+#include "thread.h"
 
 namespace art {
 namespace mirror {
@@ -160,15 +161,13 @@ uint32_t ArtMethod::ToDexPc(const uintptr_t pc) const {
   const void* code = Runtime::Current()->GetInstrumentation()->GetQuickCodeFor(this);
   uint32_t sought_offset = pc - reinterpret_cast<uintptr_t>(code);
   // Assume the caller wants a pc-to-dex mapping so check here first.
-  typedef MappingTable::PcToDexIterator It;
-  for (It cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
-    if (cur.NativePcOffset() == sought_offset) {
-      return cur.DexPc();
-    }
+  MappingTable::PcToDexIterator found = table.FindPcToDex(sought_offset);
+  if (found != table.PcToDexEnd()) {
+    return found.DexPc();
   }
-  // Now check dex-to-pc mappings.
-  typedef MappingTable::DexToPcIterator It2;
-  for (It2 cur = table.DexToPcBegin(), end = table.DexToPcEnd(); cur != end; ++cur) {
+  // Now check dex-to-pc mappings, which are sorted by dex pc.
+  typedef MappingTable::DexToPcIterator It;
+  for (It cur = table.DexToPcBegin(), end = table.DexToPcEnd(); cur != end; ++cur) {
     if (cur.NativePcOffset() == sought_offset) {
       return cur.DexPc();
     }
@@ -190,16 +189,14 @@ uintptr_t ArtMethod::ToNativePc(const uint32_t dex_pc) const {
     return 0;   // Special no mapping/pc == 0 case
   }
   // Assume the caller wants a dex-to-pc mapping so check here first.
-  typedef MappingTable::DexToPcIterator It;
-  for (It cur = table.DexToPcBegin(), end = table.DexToPcEnd(); cur != end; ++cur) {
-    if (cur.DexPc() == dex_pc) {
-      const void* code = Runtime::Current()->GetInstrumentation()->GetQuickCodeFor(this);
-      return reinterpret_cast<uintptr_t>(code) + cur.NativePcOffset();
-    }
+  MappingTable::DexToPcIterator found = table.FindDexToPc(dex_pc);
+  if (found != table.DexToPcEnd()) {
+    const void* code = Runtime::Current()->GetInstrumentation()->GetQuickCodeFor(this);
+    return reinterpret_cast<uintptr_t>(code) + found.NativePcOffset();
   }
-  // Now check pc-to-dex mappings.
-  typedef MappingTable::PcToDexIterator It2;
-  for (It2 cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
+  // Now check pc-to-dex mappings, which are sorted by native pc offset.
+  typedef MappingTable::PcToDexIterator It;
+  for (It cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
     if (cur.DexPc() == dex_pc) {
       const void* code = Runtime::Current()->GetInstrumentation()->GetQuickCodeFor(this);
       return reinterpret_cast<uintptr_t>(code) + cur.NativePcOffset();
@@ -212,10 +209,21 @@ uintptr_t ArtMethod::ToNativePc(const uint32_t dex_pc) const {
 
 uint32_t ArtMethod::FindCatchBlock(Class* exception_type, uint32_t dex_pc,
                                    bool* has_no_move_exception) const {
+  CatchBlockCache* cache = Thread::Current()->GetCatchBlockCache();
+  uint32_t found_dex_pc;
+  bool no_move_exception;
+  if (cache->Lookup(this, dex_pc, exception_type, &found_dex_pc, &no_move_exception)) {
+    if (found_dex_pc != DexFile::kDexNoIndex) {
+      *has_no_move_exception = no_move_exception;
+    }
+    return found_dex_pc;
+  }
   MethodHelper mh(this);
   const DexFile::CodeItem* code_item = mh.GetCodeItem();
   // Default to handler not found.
-  uint32_t found_dex_pc = DexFile::kDexNoIndex;
+  found_dex_pc = DexFile::kDexNoIndex;
+  // Whether the result can't change, which it may once an unresolved catch type gets resolved.
+  bool cacheable = true;
   // Iterate over the catch handlers associated with dex_pc.
   for (CatchHandlerIterator it(*code_item, dex_pc); it.HasNext(); it.Next()) {
     uint16_t iter_type_idx = it.GetHandlerTypeIndex();
@@ -230,15 +238,21 @@ uint32_t ArtMethod::FindCatchBlock(Class* exception_type, uint32_t dex_pc,
       // The verifier should take care of resolving all exception classes early
       LOG(WARNING) << "Unresolved exception class when finding catch block: "
         << mh.GetTypeDescriptorFromTypeIdx(iter_type_idx);
+      cacheable = false;
     } else if (iter_exception_type->IsAssignableFrom(exception_type)) {
       found_dex_pc = it.GetHandlerAddress();
       break;
     }
   }
+  no_move_exception = false;
   if (found_dex_pc != DexFile::kDexNoIndex) {
     const Instruction* first_catch_instr =
         Instruction::At(&mh.GetCodeItem()->insns_[found_dex_pc]);
-    *has_no_move_exception = (first_catch_instr->Opcode() != Instruction::MOVE_EXCEPTION);
+    no_move_exception = (first_catch_instr->Opcode() != Instruction::MOVE_EXCEPTION);
+    *has_no_move_exception = no_move_exception;
+  }
+  if (cacheable) {
+    cache->Insert(this, dex_pc, exception_type, found_dex_pc, no_move_exception);
   }
   return found_dex_pc;
 }
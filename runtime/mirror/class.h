@@ -544,6 +544,25 @@ class MANAGED Class : public StaticStorageBase {
     return OFFSET_OF_OBJECT_MEMBER(Class, vtable_);
   }
 
+  // Number of slots of an interface method table, see imtable_.
+  static const size_t kImtSize = 64;
+  // Index in the table of the interface method that the implementation in a slot is for.
+  static size_t ImtInterfaceMethodIndex(size_t slot) {
+    return kImtSize + slot;
+  }
+  // Index in the table of the runtime's imt conflict method, and length of the table.
+  static const size_t kImtConflictMethodIndex = 2 * kImtSize;
+  static const size_t kImtLength = 2 * kImtSize + 1;
+
+  ObjectArray<ArtMethod>* GetImTable() const;
+
+  void SetImTable(ObjectArray<ArtMethod>* new_imtable)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  static MemberOffset ImTableOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(Class, imtable_);
+  }
+
   // Given a method implemented by this class but potentially from a super class, return the
   // specific implementation method for this class.
   ArtMethod* FindVirtualMethodForVirtual(ArtMethod* method) const
@@ -803,6 +822,18 @@ class MANAGED Class : public StaticStorageBase {
   // methods for the methods in the interface.
   IfTable* iftable_;
 
+  // Interface method table (imt), for use by "invoke-interface" from compiled code. An interface
+  // method with dex method index i is implemented by the method in slot i % kImtSize, and is
+  // recorded at ImtInterfaceMethodIndex(i % kImtSize). Compiled code only calls the implementation
+  // if the recorded method is the one called, as the verifier doesn't check that the receiver
+  // implements the interface, and otherwise calls the runtime's imt conflict method kept at
+  // kImtConflictMethodIndex, which resolves the call through the iftable and throws
+  // IncompatibleClassChangeError if need be. Slots shared by several interface methods, and empty
+  // ones, hold the conflict method and record no interface method. Classes without interface
+  // methods, array classes among them, share a table holding only the conflict method. Only
+  // primitive classes, which have no instances, have no table.
+  ObjectArray<ArtMethod>* imtable_;
+
   // descriptor for the class such as "java.lang.Class" or "[C". Lazily initialized by ComputeName
   String* name_;
 
@@ -45,6 +45,8 @@ Object* Object::Clone(Thread* self) {
   // Using c->AllocObject() here would be wrong.
   size_t num_bytes = SizeOf();
   gc::Heap* heap = Runtime::Current()->GetHeap();
+  // The allocation may run a moving collection.
+  SirtRef<Object> this_object(self, this);
   SirtRef<Object> copy(self, heap->AllocObject(self, c, num_bytes));
   if (copy.get() == NULL) {
     return NULL;
@@ -52,7 +54,7 @@ Object* Object::Clone(Thread* self) {
 
   // Copy instance data.  We assume memcpy copies by words.
   // TODO: expose and use move32.
-  byte* src_bytes = reinterpret_cast<byte*>(this);
+  byte* src_bytes = reinterpret_cast<byte*>(this_object.get());
   byte* dst_bytes = reinterpret_cast<byte*>(copy.get());
   size_t offset = sizeof(Object);
   memcpy(dst_bytes + offset, src_bytes + offset, num_bytes - offset);
@@ -82,6 +84,49 @@ Object* Object::Clone(Thread* self) {
   return copy.get();
 }
 
+int32_t Object::IdentityHashCode() {
+  volatile int32_t* thinp = GetRawLockWordAddress();
+  uint32_t thin = *thinp;
+  switch (LW_HASH_STATE(thin)) {
+    case LW_HASH_STATE_HASHED:
+      return reinterpret_cast<int32_t>(this);
+    case LW_HASH_STATE_HASHED_AND_MOVED:
+      // The copying collector appended the old address to the object.
+      return *reinterpret_cast<int32_t*>(reinterpret_cast<byte*>(this) + SizeOf());
+    default:
+      break;
+  }
+  const uint32_t hashed = LW_HASH_STATE_HASHED << LW_HASH_STATE_SHIFT;
+  Thread* self = Thread::Current();
+  for (;;) {
+    thin = *thinp;
+    if (LW_IS_BIASED(thin)) {
+      // The hash state bits hold the bias, turn the lock into an ordinary thin lock first. The
+      // object may move while the bias owner is suspended.
+      return Monitor::RevokeBias(self, this)->IdentityHashCode();
+    }
+    if (LW_SHAPE(thin) == LW_SHAPE_THIN &&
+        LW_LOCK_OWNER(thin) == static_cast<int32_t>(self->GetThinLockId())) {
+      // Only the owner writes the lock word of a thin lock it holds.
+      *thinp = thin | hashed;
+      break;
+    } else if (LW_SHAPE(thin) == LW_SHAPE_FAT || LW_LOCK_OWNER(thin) == 0) {
+      // Fat lock words only change under the GC, unowned thin ones may be acquired meanwhile.
+      if (android_atomic_release_cas(thin, thin | hashed, thinp) == 0) {
+        break;
+      }
+    } else {
+      // Another thread holds the thin lock and may update the count in place. Wait for the lock,
+      // which leaves it inflated, and try again. The object may move while we are blocked.
+      SirtRef<Object> this_object(self, this);
+      this_object->MonitorEnter(self);
+      this_object->MonitorExit(self);
+      return this_object->IdentityHashCode();
+    }
+  }
+  return reinterpret_cast<int32_t>(this);
+}
+
 void Object::CheckFieldAssignmentImpl(MemberOffset field_offset, const Object* new_value) {
   const Class* c = GetClass();
   if (Runtime::Current()->GetClassLinker() == NULL ||
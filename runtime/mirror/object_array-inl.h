@@ -23,6 +23,7 @@
 #include "mirror/art_field.h"
 #include "mirror/class.h"
 #include "runtime.h"
+#include "sirt_ref.h"
 #include "thread.h"
 
 namespace art {
@@ -134,9 +135,11 @@ inline void ObjectArray<T>::Copy(const ObjectArray<T>* src, int src_pos,
 
 template<class T>
 inline ObjectArray<T>* ObjectArray<T>::CopyOf(Thread* self, int32_t new_length) {
+  // The allocation may run a moving collection.
+  SirtRef<ObjectArray<T> > this_array(self, this);
   ObjectArray<T>* new_array = Alloc(self, GetClass(), new_length);
   if (LIKELY(new_array != NULL)) {
-    Copy(this, 0, new_array, 0, std::min(GetLength(), new_length));
+    Copy(this_array.get(), 0, new_array, 0, std::min(this_array->GetLength(), new_length));
   }
   return new_array;
 }
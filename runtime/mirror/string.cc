@@ -173,8 +173,8 @@ String* String::Alloc(Thread* self, Class* java_lang_String, CharArray* array) {
   if (string == NULL) {
     return NULL;
   }
-  string->SetArray(array);
-  string->SetCount(array->GetLength());
+  string->SetArray(array_ref.get());
+  string->SetCount(array_ref->GetLength());
   return string;
 }
 
@@ -16,6 +16,7 @@
 
 #include "monitor.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "base/mutex.h"
@@ -29,6 +30,7 @@
 #include "mirror/object_array-inl.h"
 #include "object_utils.h"
 #include "scoped_thread_state_change.h"
+#include "sirt_ref.h"
 #include "thread.h"
 #include "thread_list.h"
 #include "verifier/method_verifier.h"
@@ -81,10 +83,6 @@ namespace art {
  * TODO: the various members of monitor are not SMP-safe.
  */
 
-// The shape is the bottom bit; either LW_SHAPE_THIN or LW_SHAPE_FAT.
-#define LW_SHAPE_MASK 0x1
-#define LW_SHAPE(x) static_cast<int>((x) & LW_SHAPE_MASK)
-
 /*
  * Monitor accessor.  Extracts a monitor structure pointer from a fat
  * lock.  Performs no error checking.
@@ -100,9 +98,90 @@ namespace art {
 #define LW_LOCK_COUNT_SHIFT 19
 #define LW_LOCK_COUNT(x) (((x) >> LW_LOCK_COUNT_SHIFT) & LW_LOCK_COUNT_MASK)
 
+/*
+ * Biased locking. Most objects are only ever locked by one thread, so the
+ * first thread to acquire an unhashed thin lock through the runtime also
+ * claims it: the hash state becomes LW_HASH_STATE_BIASED and the owner
+ * field keeps its thread id after it unlocks. The bias owner then locks
+ * and unlocks with plain stores, no other thread writes a biased lock word
+ * without first suspending all threads.
+ *
+ * The lock count of a biased lock holds the number of holds plus one, so
+ * that a biased lock word looks neither unheld nor held once to the thin
+ * lock fast paths of compiled code, which leave it to the runtime.
+ *
+ * Another thread acquiring, inflating or hashing the object revokes the
+ * bias, which turns the word into an ordinary thin lock with the same
+ * holds. Revoking the bias of another thread is a global suspension, so
+ * biasing stops once more than one in kBiasRevocationRatio biased locks
+ * had to be revoked that way.
+ */
+static const int32_t kBiasRevocationRatio = 16;
+// Revocations always tolerated, so that startup doesn't disable biasing.
+static const int32_t kMinBiasRevocations = 64;
+
+static volatile int32_t num_biased_locks = 0;
+static volatile int32_t num_bias_revocations = 0;
+
+static bool ShouldBias() {
+  int32_t revocations = num_bias_revocations;
+  return revocations < kMinBiasRevocations ||
+      revocations * kBiasRevocationRatio < num_biased_locks;
+}
+
+// The ordinary thin lock word with the holds of a biased one.
+static uint32_t UnbiasedLockWord(uint32_t thin) {
+  DCHECK(LW_IS_BIASED(thin));
+  uint32_t holds = LW_LOCK_COUNT(thin) - 1;
+  if (holds == 0) {
+    return 0;
+  }
+  return (LW_LOCK_OWNER(thin) << LW_LOCK_OWNER_SHIFT) | ((holds - 1) << LW_LOCK_COUNT_SHIFT);
+}
+
 bool (*Monitor::is_sensitive_thread_hook_)() = NULL;
 uint32_t Monitor::lock_profiling_threshold_ = 0;
 
+/*
+ * Adaptive spinning. Locks are usually held briefly, so a thread that finds
+ * one owned by a running thread busy-waits a while before yielding, sleeping
+ * or blocking on the monitor. The spin limit doubles each time spinning
+ * acquired the lock and halves each time the thread had to block anyway.
+ * Fat locks adapt a limit of their own, thin locks share one as their lock
+ * word has no room for it.
+ */
+static const uint32_t kMinSpinLimit = 16;
+static const uint32_t kInitialSpinLimit = 256;
+static const uint32_t kMaxSpinLimit = 4096;
+
+static volatile uint32_t thin_lock_spin_limit = kInitialSpinLimit;
+
+static uint32_t AdaptSpinLimit(uint32_t spin_limit, bool spinning_acquired) {
+  if (spinning_acquired) {
+    return std::min(spin_limit * 2, kMaxSpinLimit);
+  } else {
+    return std::max(spin_limit / 2, kMinSpinLimit);
+  }
+}
+
+static inline void SpinPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__("pause" ::: "memory");
+#else
+  __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+// Whether the thin lock word is held by the thread, biased or not.
+static bool HoldsThinLock(Thread* self, uint32_t thin) {
+  DCHECK_EQ(LW_SHAPE(thin), LW_SHAPE_THIN);
+  if (LW_LOCK_OWNER(thin) != self->GetThinLockId()) {
+    return false;
+  }
+  // A biased lock keeps its owner while released.
+  return LW_HASH_STATE(thin) != LW_HASH_STATE_BIASED || LW_LOCK_COUNT(thin) > 1;
+}
+
 bool Monitor::IsSensitiveThread() {
   if (is_sensitive_thread_hook_ != NULL) {
     return (*is_sensitive_thread_hook_)();
@@ -121,11 +200,13 @@ Monitor::Monitor(Thread* owner, mirror::Object* obj)
       lock_count_(0),
       obj_(obj),
       wait_set_(NULL),
+      spin_limit_(kInitialSpinLimit),
       locking_method_(NULL),
       locking_dex_pc_(0) {
   monitor_lock_.Lock(owner);
   // Propagate the lock state.
   uint32_t thin = *obj->GetRawLockWordAddress();
+  DCHECK(!LW_IS_BIASED(thin));
   lock_count_ = LW_LOCK_COUNT(thin);
   thin &= LW_HASH_STATE_MASK << LW_HASH_STATE_SHIFT;
   thin |= reinterpret_cast<uint32_t>(this) | LW_SHAPE_FAT;
@@ -200,7 +281,8 @@ void Monitor::Lock(Thread* self) {
     return;
   }
 
-  if (!monitor_lock_.TryLock(self)) {
+  if (!monitor_lock_.TryLock(self) && !SpinLock(self)) {
+    uint64_t contention_start = NanoTime();
     uint64_t waitStart = 0;
     uint64_t waitEnd = 0;
     uint32_t wait_threshold = lock_profiling_threshold_;
@@ -236,6 +318,9 @@ void Monitor::Lock(Thread* self) {
         LogContentionEvent(self, wait_ms, sample_percent, current_locking_filename, current_locking_line_number);
       }
     }
+    spin_limit_ = AdaptSpinLimit(spin_limit_, false);
+    Runtime::Current()->GetContentionProfiler()->RecordContention(self,
+                                                                  NanoTime() - contention_start);
   }
   owner_ = self;
   DCHECK_EQ(lock_count_, 0);
@@ -247,6 +332,22 @@ void Monitor::Lock(Thread* self) {
   }
 }
 
+bool Monitor::SpinLock(Thread* self) {
+  uint32_t spin_limit = spin_limit_;
+  for (uint32_t i = 0; i < spin_limit; ++i) {
+    // Don't hold up a suspension or checkpoint, the thread is still runnable.
+    if (UNLIKELY(self->TestAllFlags())) {
+      return false;
+    }
+    if (owner_ == NULL && monitor_lock_.TryLock(self)) {
+      spin_limit_ = AdaptSpinLimit(spin_limit, true);
+      return true;
+    }
+    SpinPause();
+  }
+  return false;
+}
+
 static void ThrowIllegalMonitorStateExceptionF(const char* fmt, ...)
                                               __attribute__((format(printf, 1, 2)));
 
@@ -576,13 +677,18 @@ void Monitor::NotifyAllWithLock() {
 
 /*
  * Changes the shape of a monitor from thin to fat, preserving the
- * internal lock state. The calling thread must own the lock.
+ * internal lock state. The calling thread must own the lock, a bias
+ * towards it is revoked first.
  */
 void Monitor::Inflate(Thread* self, mirror::Object* obj) {
   DCHECK(self != NULL);
   DCHECK(obj != NULL);
   DCHECK_EQ(LW_SHAPE(*obj->GetRawLockWordAddress()), LW_SHAPE_THIN);
   DCHECK_EQ(LW_LOCK_OWNER(*obj->GetRawLockWordAddress()), static_cast<int32_t>(self->GetThinLockId()));
+  if (LW_IS_BIASED(*obj->GetRawLockWordAddress())) {
+    // Revoking our own bias doesn't suspend, the object stays put.
+    RevokeBias(self, obj);
+  }
 
   // Allocate and acquire a new monitor.
   Monitor* m = new Monitor(self, obj);
@@ -591,6 +697,37 @@ void Monitor::Inflate(Thread* self, mirror::Object* obj) {
   Runtime::Current()->GetMonitorList()->Add(m);
 }
 
+mirror::Object* Monitor::RevokeBias(Thread* self, mirror::Object* obj) {
+  volatile int32_t* thinp = obj->GetRawLockWordAddress();
+  uint32_t thin = *thinp;
+  if (!LW_IS_BIASED(thin)) {
+    return obj;
+  }
+  if (LW_LOCK_OWNER(thin) == self->GetThinLockId()) {
+    // Only the bias owner writes the lock word.
+    *thinp = UnbiasedLockWord(thin);
+    return obj;
+  }
+  android_atomic_inc(&num_bias_revocations);
+  // The bias owner updates the lock word without atomics, so it is only rewritten once the owner
+  // is suspended. The object may move meanwhile.
+  VLOG(monitor) << StringPrintf("monitor: thread %d revoking bias of lock %p towards thread %d",
+                                self->GetThinLockId(), thinp, LW_LOCK_OWNER(thin));
+  SirtRef<mirror::Object> sirt_obj(self, obj);
+  ThreadList* thread_list = Runtime::Current()->GetThreadList();
+  self->TransitionFromRunnableToSuspended(kSuspended);
+  thread_list->SuspendAll();
+  thinp = sirt_obj->GetRawLockWordAddress();
+  // Other threads may have revoked the bias or inflated the lock since.
+  thin = *thinp;
+  if (LW_IS_BIASED(thin)) {
+    *thinp = UnbiasedLockWord(thin);
+  }
+  thread_list->ResumeAll();
+  self->TransitionFromSuspendedToRunnable();
+  return sirt_obj.get();
+}
+
 void Monitor::MonitorEnter(Thread* self, mirror::Object* obj) {
   volatile int32_t* thinp = obj->GetRawLockWordAddress();
   uint32_t sleepDelayNs;
@@ -609,6 +746,17 @@ void Monitor::MonitorEnter(Thread* self, mirror::Object* obj) {
      * determine the acquire method, ordered by cost.
      */
     if (LW_LOCK_OWNER(thin) == threadId) {
+      if (LW_HASH_STATE(thin) == LW_HASH_STATE_BIASED) {
+        // The lock is biased towards the calling thread, which alone writes the lock word.
+        if (LIKELY(LW_LOCK_COUNT(thin) + 1 < LW_LOCK_COUNT_MASK)) {
+          *thinp = thin + (1 << LW_LOCK_COUNT_SHIFT);
+          return;
+        }
+        // Too many holds for a biased lock. Continue as an ordinary thin lock, which inflates.
+        obj = RevokeBias(self, obj);
+        thinp = obj->GetRawLockWordAddress();
+        goto retry;
+      }
       /*
        * The calling thread owns the lock.  Increment the
        * value of the recursion count field.
@@ -627,19 +775,40 @@ void Monitor::MonitorEnter(Thread* self, mirror::Object* obj) {
       // This is the common case: compiled code will have tried this before calling back into
       // the runtime.
       newThin = thin | (threadId << LW_LOCK_OWNER_SHIFT);
+      bool bias = (thin == 0) && ShouldBias();
+      if (bias) {
+        // Claim the unhashed lock for the calling thread, held once.
+        newThin |= (LW_HASH_STATE_BIASED << LW_HASH_STATE_SHIFT) | (2 << LW_LOCK_COUNT_SHIFT);
+      }
       if (android_atomic_acquire_cas(thin, newThin, thinp) != 0) {
         // The acquire failed. Try again.
         goto retry;
       }
+      if (bias) {
+        android_atomic_inc(&num_biased_locks);
+      }
+    } else if (LW_HASH_STATE(thin) == LW_HASH_STATE_BIASED) {
+      // The lock is biased towards another thread, which may or may not hold it.
+      obj = RevokeBias(self, obj);
+      thinp = obj->GetRawLockWordAddress();
+      goto retry;
     } else {
       VLOG(monitor) << StringPrintf("monitor: thread %d spin on lock %p (a %s) owned by %d",
                                     threadId, thinp, PrettyTypeOf(obj).c_str(), LW_LOCK_OWNER(thin));
-      // The lock is owned by another thread. Notify the runtime that we are about to wait.
+      // The lock is owned by another thread. Remember the object so that a moving collection
+      // running while we are suspended updates it.
       self->monitor_enter_object_ = obj;
-      self->TransitionFromRunnableToSuspended(kBlocked);
-      // Spin until the thin lock is released or inflated.
+      // Spin until the thin lock is released or inflated. We stay runnable while looking at the
+      // lock word and are only suspended while yielding, the object may have moved in between.
+      // Busy-wait up to the spin limit before yielding the first time.
       sleepDelayNs = 0;
+      uint32_t spin_limit = thin_lock_spin_limit;
+      uint32_t spins = 0;
+      bool yielded = false;
+      uint64_t contention_start = 0;
       for (;;) {
+        obj = self->monitor_enter_object_;
+        thinp = obj->GetRawLockWordAddress();
         thin = *thinp;
         // Check the shape of the lock word. Another thread
         // may have inflated the lock while we were waiting.
@@ -652,8 +821,20 @@ void Monitor::MonitorEnter(Thread* self, mirror::Object* obj) {
               // The acquire succeed. Break out of the loop and proceed to inflate the lock.
               break;
             }
+          } else if (LW_HASH_STATE(thin) == LW_HASH_STATE_BIASED) {
+            // Another thread biased the lock after it was released. Try again.
+            self->monitor_enter_object_ = NULL;
+            goto retry;
+          } else if (spins < spin_limit && !yielded && LIKELY(!self->TestAllFlags())) {
+            ++spins;
+            SpinPause();
           } else {
             // The lock has not been released. Yield so the owning thread can run.
+            if (!yielded) {
+              yielded = true;
+              contention_start = NanoTime();
+            }
+            self->TransitionFromRunnableToSuspended(kBlocked);
             if (sleepDelayNs == 0) {
               sched_yield();
               sleepDelayNs = minSleepDelayNs;
@@ -666,20 +847,23 @@ void Monitor::MonitorEnter(Thread* self, mirror::Object* obj) {
                 sleepDelayNs = minSleepDelayNs;
               }
             }
+            self->TransitionFromSuspendedToRunnable();
           }
         } else {
-          // The thin lock was inflated by another thread. Let the runtime know we are no longer
-          // waiting and try again.
+          // The thin lock was inflated by another thread. Try again.
           VLOG(monitor) << StringPrintf("monitor: thread %d found lock %p surprise-fattened by another thread", threadId, thinp);
           self->monitor_enter_object_ = NULL;
-          self->TransitionFromSuspendedToRunnable();
           goto retry;
         }
       }
       VLOG(monitor) << StringPrintf("monitor: thread %d spin on lock %p done", threadId, thinp);
-      // We have acquired the thin lock. Let the runtime know that we are no longer waiting.
+      // We have acquired the thin lock.
       self->monitor_enter_object_ = NULL;
-      self->TransitionFromSuspendedToRunnable();
+      thin_lock_spin_limit = AdaptSpinLimit(spin_limit, !yielded);
+      if (yielded) {
+        uint64_t wait_ns = NanoTime() - contention_start;
+        Runtime::Current()->GetContentionProfiler()->RecordContention(self, wait_ns);
+      }
       // Fatten the lock.
       Inflate(self, obj);
       VLOG(monitor) << StringPrintf("monitor: thread %d fattened lock %p", threadId, thinp);
@@ -716,7 +900,15 @@ bool Monitor::MonitorExit(Thread* self, mirror::Object* obj) {
        * We are the lock owner.  It is safe to update the lock
        * without CAS as lock ownership guards the lock itself.
        */
-      if (LW_LOCK_COUNT(thin) == 0) {
+      if (LW_HASH_STATE(thin) == LW_HASH_STATE_BIASED) {
+        // The lock is biased towards us and stays so once released. No barrier is needed as
+        // other threads only look at its holds once all threads are suspended.
+        if (LW_LOCK_COUNT(thin) == 1) {
+          FailedUnlock(obj, self, NULL, NULL);
+          return false;
+        }
+        *thinp = thin - (1 << LW_LOCK_COUNT_SHIFT);
+      } else if (LW_LOCK_COUNT(thin) == 0) {
         /*
          * The lock was not recursively acquired, the common
          * case.  Unlock by clearing all bits except for the
@@ -764,7 +956,7 @@ void Monitor::Wait(Thread* self, mirror::Object *obj, int64_t ms, int32_t ns,
   uint32_t thin = *thinp;
   if (LW_SHAPE(thin) == LW_SHAPE_THIN) {
     // Make sure that 'self' holds the lock.
-    if (LW_LOCK_OWNER(thin) != self->GetThinLockId()) {
+    if (!HoldsThinLock(self, thin)) {
       ThrowIllegalMonitorStateExceptionF("object not locked by thread before wait()");
       return;
     }
@@ -787,7 +979,7 @@ void Monitor::Notify(Thread* self, mirror::Object *obj) {
   // waiting on an object forces lock fattening.
   if (LW_SHAPE(thin) == LW_SHAPE_THIN) {
     // Make sure that 'self' holds the lock.
-    if (LW_LOCK_OWNER(thin) != self->GetThinLockId()) {
+    if (!HoldsThinLock(self, thin)) {
       ThrowIllegalMonitorStateExceptionF("object not locked by thread before notify()");
       return;
     }
@@ -808,7 +1000,7 @@ void Monitor::NotifyAll(Thread* self, mirror::Object *obj) {
   // waiting on an object forces lock fattening.
   if (LW_SHAPE(thin) == LW_SHAPE_THIN) {
     // Make sure that 'self' holds the lock.
-    if (LW_LOCK_OWNER(thin) != self->GetThinLockId()) {
+    if (!HoldsThinLock(self, thin)) {
       ThrowIllegalMonitorStateExceptionF("object not locked by thread before notifyAll()");
       return;
     }
@@ -824,6 +1016,11 @@ void Monitor::NotifyAll(Thread* self, mirror::Object *obj) {
 
 uint32_t Monitor::GetThinLockId(uint32_t raw_lock_word) {
   if (LW_SHAPE(raw_lock_word) == LW_SHAPE_THIN) {
+    if (LW_HASH_STATE(raw_lock_word) == LW_HASH_STATE_BIASED &&
+        LW_LOCK_COUNT(raw_lock_word) == 1) {
+      // Biased but not held.
+      return 0;
+    }
     return LW_LOCK_OWNER(raw_lock_word);
   } else {
     Thread* owner = LW_MONITOR(raw_lock_word)->owner_;
@@ -967,6 +1164,9 @@ bool Monitor::IsValidLockWord(int32_t lock_word) {
       }
     }
     return found;
+  } else if (LW_IS_BIASED(lock_word)) {
+    // A biased lock has an owner and at least the one count of an unheld lock.
+    return LW_LOCK_OWNER(lock_word) != 0 && LW_LOCK_COUNT(lock_word) != 0;
   } else {
     // TODO: thin lock validity checking.
     return LW_SHAPE(lock_word) == LW_SHAPE_THIN;
@@ -1020,34 +1220,95 @@ void MonitorList::Add(Monitor* m) {
   list_.push_front(m);
 }
 
-void MonitorList::SweepMonitorList(IsMarkedTester is_marked, void* arg) {
+void MonitorList::SweepMonitorList(IsMarkedCallback* is_marked, void* arg) {
   MutexLock mu(Thread::Current(), monitor_list_lock_);
   for (auto it = list_.begin(); it != list_.end(); ) {
     Monitor* m = *it;
-    if (!is_marked(m->GetObject(), arg)) {
+    mirror::Object* obj = is_marked(m->GetObject(), arg);
+    if (obj == NULL) {
       VLOG(monitor) << "freeing monitor " << m << " belonging to unmarked object " << m->GetObject();
       delete m;
       it = list_.erase(it);
     } else {
+      m->obj_ = obj;
       ++it;
     }
   }
 }
 
+ContentionProfiler::ContentionProfiler()
+    : lock_("contention profiler lock"), num_samples_(0) {
+}
+
+void ContentionProfiler::RecordContention(Thread* self, uint64_t wait_ns) {
+  if (num_events_.fetch_add(1) % kSamplingInterval != 0) {
+    return;
+  }
+  uint32_t dex_pc = 0;
+  const mirror::ArtMethod* method = self->GetCurrentMethod(&dex_pc);
+  MutexLock mu(self, lock_);
+  ++num_samples_;
+  CallSite call_site(method, dex_pc);
+  auto it = call_sites_.find(call_site);
+  if (it == call_sites_.end()) {
+    CallSiteStats stats;
+    stats.count = 0;
+    stats.total_wait_ns = 0;
+    stats.max_wait_ns = 0;
+    call_sites_.Put(call_site, stats);
+    it = call_sites_.find(call_site);
+  }
+  ++it->second.count;
+  it->second.total_wait_ns += wait_ns;
+  it->second.max_wait_ns = std::max(it->second.max_wait_ns, wait_ns);
+}
+
+// Orders call sites by decreasing total blocking time.
+struct ContendedCallSiteComparator {
+  template <typename T>
+  bool operator()(const T& lhs, const T& rhs) const {
+    return lhs.second.total_wait_ns > rhs.second.total_wait_ns;
+  }
+};
+
+void ContentionProfiler::DumpForSigQuit(std::ostream& os) {
+  static const size_t kMaxDumpedCallSites = 20;
+  MutexLock mu(Thread::Current(), lock_);
+  os << "Monitor contention: " << num_samples_ << " sampled blocking events at "
+     << call_sites_.size() << " call sites (1 in " << kSamplingInterval << " events sampled)\n";
+  std::vector<std::pair<CallSite, CallSiteStats> > call_sites(call_sites_.begin(),
+                                                              call_sites_.end());
+  std::sort(call_sites.begin(), call_sites.end(), ContendedCallSiteComparator());
+  for (size_t i = 0; i < call_sites.size() && i < kMaxDumpedCallSites; ++i) {
+    const CallSiteStats& stats = call_sites[i].second;
+    os << "  " << PrettyMethod(call_sites[i].first.first)
+       << StringPrintf(" @0x%x: ", call_sites[i].first.second) << stats.count << " blocked for "
+       << PrettyDuration(stats.total_wait_ns) << " total, "
+       << PrettyDuration(stats.max_wait_ns) << " max\n";
+  }
+}
+
 MonitorInfo::MonitorInfo(mirror::Object* o) : owner(NULL), entry_count(0) {
   uint32_t lock_word = *o->GetRawLockWordAddress();
   if (LW_SHAPE(lock_word) == LW_SHAPE_THIN) {
-    uint32_t owner_thin_lock_id = LW_LOCK_OWNER(lock_word);
+    uint32_t owner_thin_lock_id = Monitor::GetThinLockId(lock_word);
     if (owner_thin_lock_id != 0) {
       owner = Runtime::Current()->GetThreadList()->FindThreadByThinLockId(owner_thin_lock_id);
-      entry_count = 1 + LW_LOCK_COUNT(lock_word);
+      if (LW_IS_BIASED(lock_word)) {
+        // The count of a biased lock is one more than its holds.
+        entry_count = LW_LOCK_COUNT(lock_word) - 1;
+      } else {
+        entry_count = LW_LOCK_COUNT(lock_word) + 1;
+      }
     }
     // Thin locks have no waiters.
   } else {
     CHECK_EQ(LW_SHAPE(lock_word), LW_SHAPE_FAT);
     Monitor* monitor = LW_MONITOR(lock_word);
     owner = monitor->owner_;
-    entry_count = 1 + monitor->lock_count_;
+    if (owner != NULL) {
+      entry_count = 1 + monitor->lock_count_;
+    }
     for (Thread* waiter = monitor->wait_set_; waiter != NULL; waiter = waiter->wait_next_) {
       waiters.push_back(waiter);
     }
@@ -24,8 +24,10 @@
 #include <list>
 #include <vector>
 
+#include "atomic_integer.h"
 #include "base/mutex.h"
 #include "root_visitor.h"
+#include "safe_map.h"
 #include "thread_state.h"
 
 namespace art {
@@ -35,17 +37,25 @@ namespace art {
  */
 #define LW_SHAPE_THIN 0
 #define LW_SHAPE_FAT 1
+// The shape is the bottom bit; either LW_SHAPE_THIN or LW_SHAPE_FAT.
+#define LW_SHAPE_MASK 0x1
+#define LW_SHAPE(x) static_cast<int>((x) & LW_SHAPE_MASK)
 
 /*
  * Hash state field.  Used to signify that an object has had its
- * identity hash code exposed or relocated.
+ * identity hash code exposed or relocated.  The otherwise unused
+ * value LW_HASH_STATE_BIASED marks a thin lock biased towards the
+ * thread in its owner field; biased objects are unhashed.
  */
 #define LW_HASH_STATE_UNHASHED 0
 #define LW_HASH_STATE_HASHED 1
+#define LW_HASH_STATE_BIASED 2
 #define LW_HASH_STATE_HASHED_AND_MOVED 3
 #define LW_HASH_STATE_MASK 0x3
 #define LW_HASH_STATE_SHIFT 1
 #define LW_HASH_STATE(x) (((x) >> LW_HASH_STATE_SHIFT) & LW_HASH_STATE_MASK)
+// Whether the identity hash code was exposed, i.e. the state is HASHED or HASHED_AND_MOVED.
+#define LW_IS_HASHED(x) ((LW_HASH_STATE(x) & LW_HASH_STATE_HASHED) != 0)
 
 /*
  * Lock owner field.  Contains the thread id of the thread currently
@@ -55,6 +65,12 @@ namespace art {
 #define LW_LOCK_OWNER_SHIFT 3
 #define LW_LOCK_OWNER(x) (((x) >> LW_LOCK_OWNER_SHIFT) & LW_LOCK_OWNER_MASK)
 
+/*
+ * Whether the lock word is a thin lock biased towards its owner.
+ */
+#define LW_IS_BIASED(x) \
+  (LW_SHAPE(x) == LW_SHAPE_THIN && LW_HASH_STATE(x) == LW_HASH_STATE_BIASED)
+
 namespace mirror {
   class ArtMethod;
   class Object;
@@ -102,6 +118,12 @@ class Monitor {
 
   static bool IsValidLockWord(int32_t lock_word);
 
+  // Turns a lock biased towards a thread into an ordinary thin lock with the same holds, so that
+  // other threads may acquire, inflate or hash it. Suspends all threads unless the bias is
+  // towards self. Returns the object, which may have moved meanwhile.
+  static mirror::Object* RevokeBias(Thread* self, mirror::Object* obj)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   mirror::Object* GetObject();
 
  private:
@@ -123,6 +145,8 @@ class Monitor {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   void Lock(Thread* self) EXCLUSIVE_LOCK_FUNCTION(monitor_lock_);
+  // Spins trying to acquire the monitor while its owner runs, returns whether it succeeded.
+  bool SpinLock(Thread* self) EXCLUSIVE_TRYLOCK_FUNCTION(true, monitor_lock_);
   bool Unlock(Thread* thread, bool for_wait) UNLOCK_FUNCTION(monitor_lock_);
 
   void Notify(Thread* self) NO_THREAD_SAFETY_ANALYSIS;
@@ -158,12 +182,16 @@ class Monitor {
   // Owner's recursive lock depth.
   int lock_count_ GUARDED_BY(monitor_lock_);
 
-  // What object are we part of (for debugging).
-  mirror::Object* const obj_;
+  // What object are we part of. Updated by MonitorList::SweepMonitorList if the object moves.
+  mirror::Object* obj_;
 
   // Threads currently waiting on this monitor.
   Thread* wait_set_ GUARDED_BY(monitor_lock_);
 
+  // How long a contending thread spins before blocking, adapted to whether spinning acquired the
+  // monitor. Only updated with monitor_lock_ held but read before acquiring it.
+  uint32_t spin_limit_;
+
   // Method and dex pc where the lock owner acquired the lock, used when lock
   // sampling is enabled. locking_method_ may be null if the lock is currently
   // unlocked, or if the lock is acquired by the system when the stack is empty.
@@ -182,7 +210,7 @@ class MonitorList {
   ~MonitorList();
 
   void Add(Monitor* m);
-  void SweepMonitorList(IsMarkedTester is_marked, void* arg)
+  void SweepMonitorList(IsMarkedCallback* is_marked, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
   void DisallowNewMonitors();
   void AllowNewMonitors();
@@ -196,6 +224,42 @@ class MonitorList {
   DISALLOW_COPY_AND_ASSIGN(MonitorList);
 };
 
+// Samples the times threads block on contended monitors, thin or fat, and accumulates them by the
+// call site of the monitor-enter for the SIGQUIT dump. Call sites hold plain method pointers, see
+// Heap::IsMovableObjectClass.
+class ContentionProfiler {
+ public:
+  // One in kSamplingInterval blocking events is recorded.
+  static const int32_t kSamplingInterval = 4;
+
+  ContentionProfiler();
+
+  // Called once the thread acquired the monitor it blocked on for wait_ns.
+  void RecordContention(Thread* self, uint64_t wait_ns)
+      LOCKS_EXCLUDED(lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // The call sites with the longest total blocking times.
+  void DumpForSigQuit(std::ostream& os)
+      LOCKS_EXCLUDED(lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+ private:
+  typedef std::pair<const mirror::ArtMethod*, uint32_t> CallSite;
+  struct CallSiteStats {
+    uint64_t count;
+    uint64_t total_wait_ns;
+    uint64_t max_wait_ns;
+  };
+
+  AtomicInteger num_events_;
+  Mutex lock_;
+  uint64_t num_samples_ GUARDED_BY(lock_);
+  SafeMap<CallSite, CallSiteStats> call_sites_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(ContentionProfiler);
+};
+
 // Collects information about the current state of an object's monitor.
 // This is very unsafe, and must only be called when all threads are suspended.
 // For use only by the JDWP implementation.
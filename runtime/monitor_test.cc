@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "monitor.h"
+
+#include "common_test.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "sirt_ref.h"
+#include "thread_pool.h"
+
+namespace art {
+
+// Locks and unlocks an object, or hashes it, on a worker of a thread pool while the test thread
+// holds the lock or the bias.
+class ContendingTask : public Task {
+ public:
+  ContendingTask(SirtRef<mirror::Object>* obj, bool hash)
+      : obj_(obj), hash_(hash), thread(NULL), held(false), owner_thin_lock_id(0), hash_code(0) {
+  }
+
+  void Run(Thread* self) {
+    thread = self;
+    ScopedObjectAccess soa(self);
+    // The object may move whenever the thread is suspended, so it is always read from the
+    // SirtRef.
+    if (hash_) {
+      hash_code = obj_->get()->IdentityHashCode();
+    } else {
+      obj_->get()->MonitorEnter(self);
+      held = self->HoldsLock(obj_->get());
+      owner_thin_lock_id = obj_->get()->GetThinLockId();
+      obj_->get()->MonitorExit(self);
+    }
+  }
+
+ private:
+  SirtRef<mirror::Object>* const obj_;
+  const bool hash_;
+
+ public:
+  Thread* volatile thread;
+  bool held;
+  uint32_t owner_thin_lock_id;
+  int32_t hash_code;
+};
+
+class MonitorTest : public CommonTest {
+ protected:
+  mirror::Object* AllocObject(Thread* self) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    mirror::Class* klass = class_linker_->FindSystemClass("Ljava/lang/Object;");
+    mirror::Object* obj = klass->AllocObject(self);
+    CHECK(obj != NULL);
+    return obj;
+  }
+
+  // Returns the owner that MonitorInfo finds for the object and its entry count, with the mutator
+  // lock held exclusively as by the debugger.
+  Thread* GetMonitorInfo(Thread* self, mirror::Object* obj, size_t* entry_count)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    Locks::mutator_lock_->SharedUnlock(self);
+    Locks::mutator_lock_->ExclusiveLock(self);
+    MonitorInfo monitor_info(obj);
+    Locks::mutator_lock_->ExclusiveUnlock(self);
+    Locks::mutator_lock_->SharedLock(self);
+    *entry_count = monitor_info.entry_count;
+    return monitor_info.owner;
+  }
+
+  // Lets other threads suspend the test thread until the bias of the object is revoked.
+  void WaitForBiasRevocation(Thread* self, SirtRef<mirror::Object>& obj)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    while (LW_IS_BIASED(*obj->GetRawLockWordAddress())) {
+      ScopedThreadStateChange tsc(self, kSleeping);
+      usleep(1000);
+    }
+  }
+
+  // Lets the task start and block on the lock the test thread holds.
+  void WaitForBlockedTask(Thread* self, ContendingTask* task)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    while (task->thread == NULL || task->thread->GetState() != kBlocked) {
+      ScopedThreadStateChange tsc(self, kSleeping);
+      usleep(1000);
+    }
+  }
+
+  void WaitForTasks(Thread* self, ThreadPool* thread_pool)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    ScopedThreadStateChange tsc(self, kNative);
+    thread_pool->Wait(self, false, false);
+  }
+};
+
+TEST_F(MonitorTest, BiasedLock) {
+  ScopedObjectAccess soa(Thread::Current());
+  Thread* self = soa.Self();
+  SirtRef<mirror::Object> obj(self, AllocObject(self));
+  ASSERT_EQ(0, *obj->GetRawLockWordAddress());
+
+  // The first lock biases the object towards the thread.
+  obj->MonitorEnter(self);
+  EXPECT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+  EXPECT_TRUE(Monitor::IsValidLockWord(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  obj->MonitorEnter(self);
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_TRUE(self->HoldsLock(obj.get()));
+  EXPECT_TRUE(obj->MonitorExit(self));
+
+  // Released, the bias remains.
+  EXPECT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(0U, obj->GetThinLockId());
+  EXPECT_FALSE(self->HoldsLock(obj.get()));
+  EXPECT_FALSE(obj->MonitorExit(self));
+  EXPECT_TRUE(self->IsExceptionPending());
+  self->ClearException();
+
+  obj->MonitorEnter(self);
+  EXPECT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  EXPECT_TRUE(obj->MonitorExit(self));
+}
+
+TEST_F(MonitorTest, IdentityHashCodeRevokesBias) {
+  ScopedObjectAccess soa(Thread::Current());
+  Thread* self = soa.Self();
+  SirtRef<mirror::Object> obj(self, AllocObject(self));
+  obj->MonitorEnter(self);
+  obj->MonitorEnter(self);
+  ASSERT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+
+  // Hashing keeps the holds of the lock.
+  int32_t hash = obj->IdentityHashCode();
+  EXPECT_FALSE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+  EXPECT_TRUE(LW_IS_HASHED(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_EQ(0U, obj->GetThinLockId());
+  EXPECT_EQ(hash, obj->IdentityHashCode());
+
+  // Hashed objects aren't biased again.
+  obj->MonitorEnter(self);
+  EXPECT_FALSE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+  EXPECT_TRUE(obj->MonitorExit(self));
+}
+
+TEST_F(MonitorTest, InflateRevokesBias) {
+  ScopedObjectAccess soa(Thread::Current());
+  Thread* self = soa.Self();
+  SirtRef<mirror::Object> obj(self, AllocObject(self));
+  obj->MonitorEnter(self);
+  obj->MonitorEnter(self);
+  ASSERT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+
+  // Notify inflates the lock, which keeps its holds.
+  obj->Notify(self);
+  EXPECT_FALSE(self->IsExceptionPending());
+  EXPECT_EQ(LW_SHAPE_FAT, LW_SHAPE(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_EQ(0U, obj->GetThinLockId());
+
+  // Notify of a released biased lock throws.
+  SirtRef<mirror::Object> other(self, AllocObject(self));
+  other->MonitorEnter(self);
+  EXPECT_TRUE(other->MonitorExit(self));
+  ASSERT_TRUE(LW_IS_BIASED(*other->GetRawLockWordAddress()));
+  other->Notify(self);
+  EXPECT_TRUE(self->IsExceptionPending());
+  self->ClearException();
+}
+
+TEST_F(MonitorTest, MonitorInfo) {
+  ScopedObjectAccess soa(Thread::Current());
+  Thread* self = soa.Self();
+  SirtRef<mirror::Object> obj(self, AllocObject(self));
+  size_t entry_count;
+  EXPECT_TRUE(GetMonitorInfo(self, obj.get(), &entry_count) == NULL);
+  EXPECT_EQ(0U, entry_count);
+
+  // Biased, the count of the lock word is one more than the holds.
+  obj->MonitorEnter(self);
+  ASSERT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self, GetMonitorInfo(self, obj.get(), &entry_count));
+  EXPECT_EQ(1U, entry_count);
+  obj->MonitorEnter(self);
+  EXPECT_EQ(self, GetMonitorInfo(self, obj.get(), &entry_count));
+  EXPECT_EQ(2U, entry_count);
+
+  // The same holds as an ordinary thin lock and as a fat lock.
+  Monitor::RevokeBias(self, obj.get());
+  ASSERT_FALSE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self, GetMonitorInfo(self, obj.get(), &entry_count));
+  EXPECT_EQ(2U, entry_count);
+  obj->Notify(self);
+  ASSERT_EQ(LW_SHAPE_FAT, LW_SHAPE(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self, GetMonitorInfo(self, obj.get(), &entry_count));
+  EXPECT_EQ(2U, entry_count);
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_TRUE(GetMonitorInfo(self, obj.get(), &entry_count) == NULL);
+  EXPECT_EQ(0U, entry_count);
+
+  // A released biased lock keeps its owner in the lock word but isn't held.
+  SirtRef<mirror::Object> other(self, AllocObject(self));
+  other->MonitorEnter(self);
+  EXPECT_TRUE(other->MonitorExit(self));
+  ASSERT_TRUE(LW_IS_BIASED(*other->GetRawLockWordAddress()));
+  EXPECT_TRUE(GetMonitorInfo(self, other.get(), &entry_count) == NULL);
+  EXPECT_EQ(0U, entry_count);
+}
+
+// Another thread revokes the bias of a lock the test thread holds, while the test thread is
+// suspended, then waits for the lock.
+TEST_F(MonitorTest, OtherThreadRevokesBias) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool(1);
+  ScopedObjectAccess soa(self);
+  SirtRef<mirror::Object> obj(self, AllocObject(self));
+  obj->MonitorEnter(self);
+  obj->MonitorEnter(self);
+  ASSERT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+
+  ContendingTask task(&obj, false);
+  thread_pool.AddTask(self, &task);
+  thread_pool.StartWorkers(self);
+  WaitForBiasRevocation(self, obj);
+
+  // An ordinary thin lock with the same holds, which only its owner inflates.
+  uint32_t thin = *obj->GetRawLockWordAddress();
+  EXPECT_EQ(LW_SHAPE_THIN, LW_SHAPE(thin));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  size_t entry_count;
+  EXPECT_EQ(self, GetMonitorInfo(self, obj.get(), &entry_count));
+  EXPECT_EQ(2U, entry_count);
+  EXPECT_TRUE(obj->MonitorExit(self));
+  EXPECT_TRUE(self->HoldsLock(obj.get()));
+  EXPECT_TRUE(obj->MonitorExit(self));
+
+  // The worker got the lock once released and inflated it, having found it contended.
+  WaitForTasks(self, &thread_pool);
+  EXPECT_TRUE(task.held);
+  EXPECT_EQ(task.thread->GetThinLockId(), task.owner_thin_lock_id);
+  EXPECT_EQ(LW_SHAPE_FAT, LW_SHAPE(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(0U, obj->GetThinLockId());
+  EXPECT_FALSE(self->HoldsLock(obj.get()));
+}
+
+// Another thread hashes an object whose lock is biased towards the test thread and held by it.
+TEST_F(MonitorTest, OtherThreadHashRevokesBias) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool(1);
+  ScopedObjectAccess soa(self);
+  SirtRef<mirror::Object> obj(self, AllocObject(self));
+  obj->MonitorEnter(self);
+  ASSERT_TRUE(LW_IS_BIASED(*obj->GetRawLockWordAddress()));
+
+  ContendingTask task(&obj, true);
+  thread_pool.AddTask(self, &task);
+  thread_pool.StartWorkers(self);
+  WaitForBiasRevocation(self, obj);
+
+  EXPECT_EQ(LW_SHAPE_THIN, LW_SHAPE(*obj->GetRawLockWordAddress()));
+  EXPECT_EQ(self->GetThinLockId(), obj->GetThinLockId());
+  EXPECT_TRUE(self->HoldsLock(obj.get()));
+  EXPECT_TRUE(obj->MonitorExit(self));
+
+  // The worker waited for the lock to hash it, which left it inflated.
+  WaitForTasks(self, &thread_pool);
+  uint32_t lock_word = *obj->GetRawLockWordAddress();
+  EXPECT_EQ(LW_SHAPE_FAT, LW_SHAPE(lock_word));
+  EXPECT_TRUE(LW_IS_HASHED(lock_word));
+  EXPECT_EQ(0U, obj->GetThinLockId());
+  EXPECT_EQ(task.hash_code, obj->IdentityHashCode());
+
+  // Hashing a released biased lock needs no lock.
+  SirtRef<mirror::Object> other(self, AllocObject(self));
+  other->MonitorEnter(self);
+  EXPECT_TRUE(other->MonitorExit(self));
+  ASSERT_TRUE(LW_IS_BIASED(*other->GetRawLockWordAddress()));
+  ContendingTask other_task(&other, true);
+  thread_pool.AddTask(self, &other_task);
+  WaitForTasks(self, &thread_pool);
+  lock_word = *other->GetRawLockWordAddress();
+  EXPECT_EQ(LW_SHAPE_THIN, LW_SHAPE(lock_word));
+  EXPECT_TRUE(LW_IS_HASHED(lock_word));
+  EXPECT_EQ(0U, other->GetThinLockId());
+  EXPECT_EQ(other_task.hash_code, other->IdentityHashCode());
+}
+
+// Pool workers have no managed frames, their call sites are dumped as null methods.
+static std::string DumpContention() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  std::ostringstream os;
+  Runtime::Current()->GetContentionProfiler()->DumpForSigQuit(os);
+  return os.str();
+}
+
+TEST_F(MonitorTest, ContentionProfiler) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool(1);
+  ScopedObjectAccess soa(self);
+  thread_pool.StartWorkers(self);
+  EXPECT_EQ("Monitor contention: 0 sampled blocking events at 0 call sites (1 in 4 events sampled)\n",
+            DumpContention());
+
+  // The first of kSamplingInterval threads blocking on fat locks is sampled.
+  SirtRef<mirror::Object> obj(self, AllocObject(self));
+  for (int32_t i = 0; i < ContentionProfiler::kSamplingInterval; ++i) {
+    obj->MonitorEnter(self);
+    obj->Notify(self);
+    ASSERT_EQ(LW_SHAPE_FAT, LW_SHAPE(*obj->GetRawLockWordAddress()));
+    ContendingTask task(&obj, false);
+    thread_pool.AddTask(self, &task);
+    WaitForBlockedTask(self, &task);
+    EXPECT_TRUE(obj->MonitorExit(self));
+    WaitForTasks(self, &thread_pool);
+    EXPECT_TRUE(task.held);
+  }
+  std::string dump(DumpContention());
+  EXPECT_NE(std::string::npos,
+            dump.find("Monitor contention: 1 sampled blocking events at 1 call sites")) << dump;
+  EXPECT_NE(std::string::npos, dump.find("\n  null @0x0: 1 blocked for ")) << dump;
+
+  // So is the first of kSamplingInterval threads blocking on thin locks. Hashed locks aren't
+  // biased, the worker spins on the thin lock and inflates it once acquired.
+  for (int32_t i = 0; i < ContentionProfiler::kSamplingInterval; ++i) {
+    SirtRef<mirror::Object> thin_obj(self, AllocObject(self));
+    thin_obj->IdentityHashCode();
+    thin_obj->MonitorEnter(self);
+    ASSERT_EQ(LW_SHAPE_THIN, LW_SHAPE(*thin_obj->GetRawLockWordAddress()));
+    ASSERT_FALSE(LW_IS_BIASED(*thin_obj->GetRawLockWordAddress()));
+    ContendingTask task(&thin_obj, false);
+    thread_pool.AddTask(self, &task);
+    WaitForBlockedTask(self, &task);
+    EXPECT_TRUE(thin_obj->MonitorExit(self));
+    WaitForTasks(self, &thread_pool);
+    EXPECT_TRUE(task.held);
+    EXPECT_EQ(LW_SHAPE_FAT, LW_SHAPE(*thin_obj->GetRawLockWordAddress()));
+  }
+  dump = DumpContention();
+  EXPECT_NE(std::string::npos,
+            dump.find("Monitor contention: 2 sampled blocking events at 1 call sites")) << dump;
+  EXPECT_NE(std::string::npos, dump.find("\n  null @0x0: 2 blocked for ")) << dump;
+}
+
+}  // namespace art
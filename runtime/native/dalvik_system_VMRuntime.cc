@@ -22,7 +22,7 @@
 #include "dex_file-inl.h"
 #include "gc/allocator/dlmalloc.h"
 #include "gc/heap.h"
-#include "gc/space/dlmalloc_space.h"
+#include "gc/space/malloc_space.h"
 #include "jni_internal.h"
 #include "mirror/class-inl.h"
 #include "mirror/object.h"
@@ -51,18 +51,16 @@ static void VMRuntime_disableJitCompilation(JNIEnv*, jobject) {
 
 static jobject VMRuntime_newNonMovableArray(JNIEnv* env, jobject, jclass javaElementClass, jint length) {
   ScopedObjectAccess soa(env);
-#ifdef MOVING_GARBAGE_COLLECTOR
-  // TODO: right now, we don't have a copying collector, so there's no need
-  // to do anything special here, but we ought to pass the non-movability
-  // through to the allocator.
-  UNIMPLEMENTED(FATAL);
-#endif
-
   mirror::Class* element_class = soa.Decode<mirror::Class*>(javaElementClass);
   if (element_class == NULL) {
     ThrowNullPointerException(NULL, "element class == null");
     return NULL;
   }
+  if (!element_class->IsPrimitive()) {
+    // Only primitive arrays can be kept out of the spaces that get compacted.
+    ThrowIllegalArgumentException(NULL, "not a primitive type");
+    return NULL;
+  }
   if (length < 0) {
     ThrowNegativeArraySizeException(length);
     return NULL;
@@ -73,7 +71,7 @@ static jobject VMRuntime_newNonMovableArray(JNIEnv* env, jobject, jclass javaEle
   descriptor += "[";
   descriptor += ClassHelper(element_class).GetDescriptor();
   mirror::Class* array_class = class_linker->FindClass(descriptor.c_str(), NULL);
-  mirror::Array* result = mirror::Array::Alloc(soa.Self(), array_class, length);
+  mirror::Array* result = mirror::Array::AllocNonMovable(soa.Self(), array_class, length);
   return soa.AddLocalReference<jobject>(result);
 }
 
@@ -87,7 +85,10 @@ static jlong VMRuntime_addressOf(JNIEnv* env, jobject, jobject javaArray) {
     ThrowIllegalArgumentException(NULL, "not an array");
     return 0;
   }
-  // TODO: we should also check that this is a non-movable array.
+  if (!Runtime::Current()->GetHeap()->IsNonMovable(array)) {
+    ThrowRuntimeException("Trying to get address of movable array object");
+    return 0;
+  }
   return reinterpret_cast<uintptr_t>(array->GetRawData(array->GetClass()->GetComponentSize()));
 }
 
@@ -169,7 +170,7 @@ static void VMRuntime_trimHeap(JNIEnv*, jobject) {
 
   // Trim the managed heap.
   gc::Heap* heap = Runtime::Current()->GetHeap();
-  gc::space::DlMallocSpace* alloc_space = heap->GetAllocSpace();
+  gc::space::MallocSpace* alloc_space = heap->GetAllocSpace();
   size_t alloc_space_size = alloc_space->Size();
   float managed_utilization =
       static_cast<float>(alloc_space->GetBytesAllocated()) / alloc_space_size;
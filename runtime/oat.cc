@@ -22,7 +22,7 @@
 namespace art {
 
 const uint8_t OatHeader::kOatMagic[] = { 'o', 'a', 't', '\n' };
-const uint8_t OatHeader::kOatVersion[] = { '0', '0', '7', '\0' };
+const uint8_t OatHeader::kOatVersion[] = { '0', '1', '2', '\0' };
 
 OatHeader::OatHeader() {
   memset(this, 0, sizeof(*this));
@@ -42,6 +42,9 @@ OatHeader::OatHeader(InstructionSet instruction_set,
   instruction_set_ = instruction_set;
   UpdateChecksum(&instruction_set_, sizeof(instruction_set_));
 
+  implicit_null_checks_ = kUseImplicitNullChecks ? 1 : 0;
+  UpdateChecksum(&implicit_null_checks_, sizeof(implicit_null_checks_));
+
   dex_file_count_ = dex_files->size();
   UpdateChecksum(&dex_file_count_, sizeof(dex_file_count_));
 
@@ -97,6 +100,11 @@ InstructionSet OatHeader::GetInstructionSet() const {
   return instruction_set_;
 }
 
+bool OatHeader::HasImplicitNullChecks() const {
+  CHECK(IsValid());
+  return implicit_null_checks_ != 0;
+}
+
 uint32_t OatHeader::GetExecutableOffset() const {
   DCHECK(IsValid());
   DCHECK_ALIGNED(executable_offset_, kPageSize);
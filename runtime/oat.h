@@ -74,6 +74,8 @@ class PACKED(4) OatHeader {
   void SetQuickToInterpreterBridgeOffset(uint32_t offset);
 
   InstructionSet GetInstructionSet() const;
+  // Whether the code relies on the SIGSEGV handler for null checks, see kUseImplicitNullChecks.
+  bool HasImplicitNullChecks() const;
   uint32_t GetImageFileLocationOatChecksum() const;
   uint32_t GetImageFileLocationOatDataBegin() const;
   uint32_t GetImageFileLocationSize() const;
@@ -86,6 +88,7 @@ class PACKED(4) OatHeader {
   uint32_t adler32_checksum_;
 
   InstructionSet instruction_set_;
+  uint32_t implicit_null_checks_;
   uint32_t dex_file_count_;
   uint32_t executable_offset_;
   uint32_t interpreter_to_interpreter_bridge_offset_;
@@ -205,6 +205,12 @@ bool OatFile::Setup() {
     LOG(WARNING) << "Invalid oat magic for " << GetLocation();
     return false;
   }
+  if (GetOatHeader().HasImplicitNullChecks() != kUseImplicitNullChecks) {
+    // Code without explicit null checks would crash on null without the SIGSEGV handler.
+    LOG(WARNING) << "Oat file " << GetLocation() << " was compiled "
+                 << (kUseImplicitNullChecks ? "without" : "with") << " implicit null checks";
+    return false;
+  }
   const byte* oat = Begin();
   oat += sizeof(OatHeader);
   if (oat > End()) {
@@ -85,7 +85,8 @@ struct ObjectComparator {
 
     // Sort by class...
     if (obj1->GetClass() != obj2->GetClass()) {
-      return obj1->GetClass()->IdentityHashCode() < obj2->IdentityHashCode();
+      return reinterpret_cast<uintptr_t>(obj1->GetClass()) <
+          reinterpret_cast<uintptr_t>(obj2->GetClass());
     } else {
       // ...then by size...
       size_t count1 = obj1->SizeOf();
@@ -93,8 +94,8 @@ struct ObjectComparator {
       if (count1 != count2) {
         return count1 < count2;
       } else {
-        // ...and finally by identity hash code.
-        return obj1->IdentityHashCode() < obj2->IdentityHashCode();
+        // ...and finally by address.
+        return reinterpret_cast<uintptr_t>(obj1) < reinterpret_cast<uintptr_t>(obj2);
       }
     }
   }
@@ -232,8 +233,8 @@ void ReferenceTable::Dump(std::ostream& os, const Table& entries) {
 }
 
 void ReferenceTable::VisitRoots(RootVisitor* visitor, void* arg) {
-  for (const auto& ref : entries_) {
-    visitor(ref, arg);
+  for (auto& ref : entries_) {
+    ref = visitor(const_cast<mirror::Object*>(ref), arg);
   }
 }
 
@@ -23,10 +23,16 @@ class Object;
 }  // namespace mirror
 class StackVisitor;
 
-typedef void (RootVisitor)(const mirror::Object* root, void* arg);
+// Visits a root, returning the address the root should be updated to. Collectors which do not
+// move objects return root unchanged.
+typedef mirror::Object* (RootVisitor)(mirror::Object* root, void* arg)
+    __attribute__((warn_unused_result));
 typedef void (VerifyRootVisitor)(const mirror::Object* root, void* arg, size_t vreg,
                                  const StackVisitor* visitor);
-typedef bool (IsMarkedTester)(const mirror::Object* object, void* arg);
+// Returns NULL if the object is not marked, otherwise returns the (possibly new) address of the
+// object.
+typedef mirror::Object* (IsMarkedCallback)(mirror::Object* object, void* arg)
+    __attribute__((warn_unused_result));
 
 }  // namespace art
 
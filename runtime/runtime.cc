@@ -34,12 +34,14 @@
 #include "atomic.h"
 #include "class_linker.h"
 #include "debugger.h"
+#include "fault_handler.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/heap.h"
 #include "gc/space/space.h"
 #include "image.h"
 #include "instrumentation.h"
 #include "intern_table.h"
+#include "interpreter/inline_cache.h"
 #include "invoke_arg_array_builder.h"
 #include "jni_internal.h"
 #include "mirror/art_field-inl.h"
@@ -76,13 +78,16 @@ Runtime::Runtime()
       default_stack_size_(0),
       heap_(NULL),
       monitor_list_(NULL),
+      contention_profiler_(NULL),
       thread_list_(NULL),
       intern_table_(NULL),
+      inline_cache_table_(NULL),
       class_linker_(NULL),
       signal_catcher_(NULL),
       java_vm_(NULL),
       pre_allocated_OutOfMemoryError_(NULL),
       resolution_method_(NULL),
+      imt_conflict_method_(NULL),
       threads_being_born_(0),
       shutdown_cond_(new ConditionVariable("Runtime shutdown", *Locks::runtime_shutdown_lock_)),
       shutting_down_(false),
@@ -128,9 +133,11 @@ Runtime::~Runtime() {
   // Make sure all other non-daemon threads have terminated, and all daemon threads are suspended.
   delete thread_list_;
   delete monitor_list_;
+  delete contention_profiler_;
   delete class_linker_;
   delete heap_;
   delete intern_table_;
+  delete inline_cache_table_;
   delete java_vm_;
   Thread::Shutdown();
   QuasiAtomic::Shutdown();
@@ -338,12 +345,16 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
   parsed->heap_max_free_ = gc::Heap::kDefaultMaxFree;
   parsed->heap_target_utilization_ = gc::Heap::kDefaultTargetUtilization;
   parsed->heap_growth_limit_ = 0;  // 0 means no growth limit.
+  parsed->heap_nursery_size_ = 0;  // 0 means no nursery.
   // Default to number of processors minus one since the main GC thread also does work.
   parsed->parallel_gc_threads_ = sysconf(_SC_NPROCESSORS_CONF) - 1;
   // Only the main GC thread, no workers.
   parsed->conc_gc_threads_ = 0;
   parsed->stack_size_ = 0;  // 0 means default.
   parsed->low_memory_mode_ = false;
+  parsed->use_tlab_ = false;
+  parsed->use_rosalloc_ = false;
+  parsed->use_background_compaction_ = false;
 
   parsed->is_compiler_ = false;
   parsed->is_zygote_ = false;
@@ -368,6 +379,7 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
   parsed->small_method_threshold_ = Runtime::kDefaultSmallMethodThreshold;
   parsed->tiny_method_threshold_ = Runtime::kDefaultTinyMethodThreshold;
   parsed->num_dex_methods_threshold_ = Runtime::kDefaultNumDexMethodsThreshold;
+  parsed->inline_max_code_units_ = Runtime::kDefaultInlineMaxCodeUnits;
 
   parsed->sea_ir_mode_ = false;
 //  gLogVerbosity.class_linker = true;  // TODO: don't check this in!
@@ -439,6 +451,17 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
         return NULL;
       }
       parsed->heap_maximum_size_ = size;
+    } else if (StartsWith(option, "-Xmn")) {
+      size_t size = ParseMemoryOption(option.substr(strlen("-Xmn")).c_str(), 1024);
+      if (size == 0) {
+        if (ignore_unrecognized) {
+          continue;
+        }
+        // TODO: usage
+        LOG(FATAL) << "Failed to parse " << option;
+        return NULL;
+      }
+      parsed->heap_nursery_size_ = size;
     } else if (StartsWith(option, "-XX:HeapGrowthLimit=")) {
       size_t size = ParseMemoryOption(option.substr(strlen("-XX:HeapGrowthLimit=")).c_str(), 1024);
       if (size == 0) {
@@ -513,6 +536,12 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
       parsed->ignore_max_footprint_ = true;
     } else if (option == "-XX:LowMemoryMode") {
       parsed->low_memory_mode_ = true;
+    } else if (option == "-XX:UseTLAB") {
+      parsed->use_tlab_ = true;
+    } else if (option == "-XX:UseRosAlloc") {
+      parsed->use_rosalloc_ = true;
+    } else if (option == "-XX:BackgroundCompaction") {
+      parsed->use_background_compaction_ = true;
     } else if (StartsWith(option, "-D")) {
       parsed->properties_.push_back(option.substr(strlen("-D")));
     } else if (StartsWith(option, "-Xjnitrace:")) {
@@ -620,6 +649,8 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
       parsed->tiny_method_threshold_ = ParseIntegerOrDie(option);
     } else if (StartsWith(option, "-num-dex-methods-max:")) {
       parsed->num_dex_methods_threshold_ = ParseIntegerOrDie(option);
+    } else if (StartsWith(option, "-inline-max-code-units:")) {
+      parsed->inline_max_code_units_ = ParseIntegerOrDie(option);
     } else {
       if (!ignore_unrecognized) {
         // TODO: print usage via vfprintf
@@ -856,6 +887,7 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
   small_method_threshold_ = options->small_method_threshold_;
   tiny_method_threshold_ = options->tiny_method_threshold_;
   num_dex_methods_threshold_ = options->num_dex_methods_threshold_;
+  inline_max_code_units_ = options->inline_max_code_units_;
 
   sea_ir_mode_ = options->sea_ir_mode_;
   vfprintf_ = options->hook_vfprintf_;
@@ -866,8 +898,10 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
   stack_trace_file_ = options->stack_trace_file_;
 
   monitor_list_ = new MonitorList;
+  contention_profiler_ = new ContentionProfiler;
   thread_list_ = new ThreadList;
   intern_table_ = new InternTable;
+  inline_cache_table_ = new interpreter::InlineCacheTable;
 
 
   if (options->interpreter_only_) {
@@ -887,10 +921,15 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
                        options->low_memory_mode_,
                        options->long_pause_log_threshold_,
                        options->long_gc_log_threshold_,
-                       options->ignore_max_footprint_);
+                       options->ignore_max_footprint_,
+                       options->use_tlab_,
+                       options->use_rosalloc_,
+                       options->use_background_compaction_,
+                       options->heap_nursery_size_);
 
   BlockSignals();
   InitPlatformSignalHandlers();
+  InitImplicitNullCheckHandler();
 
   java_vm_ = new JavaVMExt(this, options.get());
 
@@ -1034,6 +1073,8 @@ void Runtime::RegisterRuntimeNativeMethods(JNIEnv* env) {
 void Runtime::DumpForSigQuit(std::ostream& os) {
   GetClassLinker()->DumpForSigQuit(os);
   GetInternTable()->DumpForSigQuit(os);
+  GetInlineCacheTable()->DumpForSigQuit(os);
+  GetContentionProfiler()->DumpForSigQuit(os);
   GetJavaVM()->DumpForSigQuit(os);
   GetHeap()->DumpForSigQuit(os);
   os << "\n";
@@ -1151,11 +1192,15 @@ void Runtime::VisitConcurrentRoots(RootVisitor* visitor, void* arg, bool only_di
 void Runtime::VisitNonThreadRoots(RootVisitor* visitor, void* arg) {
   java_vm_->VisitRoots(visitor, arg);
   if (pre_allocated_OutOfMemoryError_ != NULL) {
-    visitor(pre_allocated_OutOfMemoryError_, arg);
+    pre_allocated_OutOfMemoryError_ = down_cast<mirror::Throwable*>(
+        visitor(pre_allocated_OutOfMemoryError_, arg));
+  }
+  resolution_method_ = down_cast<mirror::ArtMethod*>(visitor(resolution_method_, arg));
+  if (imt_conflict_method_ != NULL) {
+    imt_conflict_method_ = down_cast<mirror::ArtMethod*>(visitor(imt_conflict_method_, arg));
   }
-  visitor(resolution_method_, arg);
   for (int i = 0; i < Runtime::kLastCalleeSaveType; i++) {
-    visitor(callee_save_methods_[i], arg);
+    callee_save_methods_[i] = down_cast<mirror::ArtMethod*>(visitor(callee_save_methods_[i], arg));
   }
 }
 
@@ -1184,6 +1229,19 @@ mirror::ArtMethod* Runtime::CreateResolutionMethod() {
   return method.get();
 }
 
+mirror::ArtMethod* Runtime::CreateImtConflictMethod() {
+  mirror::Class* method_class = mirror::ArtMethod::GetJavaLangReflectArtMethod();
+  Thread* self = Thread::Current();
+  SirtRef<mirror::ArtMethod>
+      method(self, down_cast<mirror::ArtMethod*>(method_class->AllocObject(self)));
+  method->SetDeclaringClass(method_class);
+  method->SetDexMethodIndex(DexFile::kDexNoIndex);
+  // The stub is part of libart, an image only records NULL and the entry point is set again
+  // when the image is loaded.
+  method->SetEntryPointFromCompiledCode(GetQuickImtConflictTrampoline());
+  return method.get();
+}
+
 mirror::ArtMethod* Runtime::CreateCalleeSaveMethod(InstructionSet instruction_set,
                                                         CalleeSaveType type) {
   mirror::Class* method_class = mirror::ArtMethod::GetJavaLangReflectArtMethod();
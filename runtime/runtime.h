@@ -51,8 +51,12 @@ namespace mirror {
   class Throwable;
 }  // namespace mirror
 class ClassLinker;
+class ContentionProfiler;
 class DexFile;
 class InternTable;
+namespace interpreter {
+  class InlineCacheTable;
+}  // namespace interpreter
 struct JavaVMExt;
 class MonitorList;
 class SignalCatcher;
@@ -82,6 +86,8 @@ class Runtime {
   static const size_t kDefaultSmallMethodThreshold = 60;
   static const size_t kDefaultTinyMethodThreshold = 20;
   static const size_t kDefaultNumDexMethodsThreshold = 900;
+  // Largest callee in code units that the compiler inlines, 0 disables inlining.
+  static const size_t kDefaultInlineMaxCodeUnits = 4;
 
   class ParsedOptions {
    public:
@@ -106,6 +112,7 @@ class Runtime {
     size_t heap_initial_size_;
     size_t heap_maximum_size_;
     size_t heap_growth_limit_;
+    size_t heap_nursery_size_;
     size_t heap_min_free_;
     size_t heap_max_free_;
     double heap_target_utilization_;
@@ -113,6 +120,9 @@ class Runtime {
     size_t conc_gc_threads_;
     size_t stack_size_;
     bool low_memory_mode_;
+    bool use_tlab_;
+    bool use_rosalloc_;
+    bool use_background_compaction_;
     size_t lock_profiling_threshold_;
     std::string stack_trace_file_;
     bool method_trace_;
@@ -129,6 +139,7 @@ class Runtime {
     size_t small_method_threshold_;
     size_t tiny_method_threshold_;
     size_t num_dex_methods_threshold_;
+    size_t inline_max_code_units_;
     bool sea_ir_mode_;
 
    private:
@@ -193,6 +204,10 @@ class Runtime {
       return num_dex_methods_threshold_;
   }
 
+  size_t GetInlineMaxCodeUnits() const {
+    return inline_max_code_units_;
+  }
+
   const std::string& GetHostPrefix() const {
     DCHECK(!IsStarted());
     return host_prefix_;
@@ -282,6 +297,11 @@ class Runtime {
     return intern_table_;
   }
 
+  // The inline caches of the call sites of interpreted code, with their receiver type profiles.
+  interpreter::InlineCacheTable* GetInlineCacheTable() const {
+    return inline_cache_table_;
+  }
+
   JavaVMExt* GetJavaVM() const {
     return java_vm_;
   }
@@ -290,6 +310,10 @@ class Runtime {
     return monitor_list_;
   }
 
+  ContentionProfiler* GetContentionProfiler() const {
+    return contention_profiler_;
+  }
+
   mirror::Throwable* GetPreAllocatedOutOfMemoryError() const
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
@@ -339,6 +363,23 @@ class Runtime {
 
   mirror::ArtMethod* CreateResolutionMethod() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Returns a special method that fills the interface method table slots shared by several
+  // implementations, calling it dispatches through the iftable.
+  mirror::ArtMethod* GetImtConflictMethod() const {
+    CHECK(HasImtConflictMethod());
+    return imt_conflict_method_;
+  }
+
+  bool HasImtConflictMethod() const {
+    return imt_conflict_method_ != NULL;
+  }
+
+  void SetImtConflictMethod(mirror::ArtMethod* method) {
+    imt_conflict_method_ = method;
+  }
+
+  mirror::ArtMethod* CreateImtConflictMethod() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Returns a special method that describes all callee saves being spilled to the stack.
   enum CalleeSaveType {
     kSaveAll,
@@ -427,6 +468,7 @@ class Runtime {
   size_t small_method_threshold_;
   size_t tiny_method_threshold_;
   size_t num_dex_methods_threshold_;
+  size_t inline_max_code_units_;
 
   bool sea_ir_mode_;
 
@@ -453,10 +495,15 @@ class Runtime {
 
   MonitorList* monitor_list_;
 
+  // Blocking on contended monitors by call site.
+  ContentionProfiler* contention_profiler_;
+
   ThreadList* thread_list_;
 
   InternTable* intern_table_;
 
+  interpreter::InlineCacheTable* inline_cache_table_;
+
   ClassLinker* class_linker_;
 
   SignalCatcher* signal_catcher_;
@@ -470,6 +517,8 @@ class Runtime {
 
   mirror::ArtMethod* resolution_method_;
 
+  mirror::ArtMethod* imt_conflict_method_;
+
   // A non-zero value indicates that a thread has been created but not yet initialized. Guarded by
   // the shutdown lock so that threads aren't born while we're shutting down.
   size_t threads_being_born_ GUARDED_BY(Locks::runtime_shutdown_lock_);
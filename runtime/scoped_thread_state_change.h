@@ -202,14 +202,12 @@ class ScopedObjectAccessUnchecked : public ScopedThreadStateChange {
     return down_cast<T>(Self()->DecodeJObject(obj));
   }
 
+  // Fields and methods are never moved by the garbage collector (see Heap::IsMovableObjectClass),
+  // so their ids are plain pointers.
   mirror::ArtField* DecodeField(jfieldID fid) const
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     Locks::mutator_lock_->AssertSharedHeld(Self());
     DCHECK_EQ(thread_state_, kRunnable);  // Don't work with raw objects in non-runnable states.
-#ifdef MOVING_GARBAGE_COLLECTOR
-    // TODO: we should make these unique weak globals if Field instances can ever move.
-    UNIMPLEMENTED(WARNING);
-#endif
     return reinterpret_cast<mirror::ArtField*>(fid);
   }
 
@@ -217,9 +215,6 @@ class ScopedObjectAccessUnchecked : public ScopedThreadStateChange {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     Locks::mutator_lock_->AssertSharedHeld(Self());
     DCHECK_EQ(thread_state_, kRunnable);  // Don't work with raw objects in non-runnable states.
-#ifdef MOVING_GARBAGE_COLLECTOR
-    UNIMPLEMENTED(WARNING);
-#endif
     return reinterpret_cast<jfieldID>(field);
   }
 
@@ -227,10 +222,6 @@ class ScopedObjectAccessUnchecked : public ScopedThreadStateChange {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     Locks::mutator_lock_->AssertSharedHeld(Self());
     DCHECK_EQ(thread_state_, kRunnable);  // Don't work with raw objects in non-runnable states.
-#ifdef MOVING_GARBAGE_COLLECTOR
-    // TODO: we should make these unique weak globals if Method instances can ever move.
-    UNIMPLEMENTED(WARNING);
-#endif
     return reinterpret_cast<mirror::ArtMethod*>(mid);
   }
 
@@ -238,9 +229,6 @@ class ScopedObjectAccessUnchecked : public ScopedThreadStateChange {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     Locks::mutator_lock_->AssertSharedHeld(Self());
     DCHECK_EQ(thread_state_, kRunnable);  // Don't work with raw objects in non-runnable states.
-#ifdef MOVING_GARBAGE_COLLECTOR
-    UNIMPLEMENTED(WARNING);
-#endif
     return reinterpret_cast<jmethodID>(method);
   }
 
@@ -476,6 +476,15 @@ class StackVisitor {
     return *reinterpret_cast<uint32_t*>(vreg_addr);
   }
 
+  void SetVReg(mirror::ArtMethod** cur_quick_frame, const DexFile::CodeItem* code_item,
+               uint32_t core_spills, uint32_t fp_spills, size_t frame_size,
+               uint16_t vreg, uint32_t new_value) {
+    int offset = GetVRegOffset(code_item, core_spills, fp_spills, frame_size, vreg);
+    DCHECK_EQ(cur_quick_frame, GetCurrentQuickFrame());
+    byte* vreg_addr = reinterpret_cast<byte*>(cur_quick_frame) + offset;
+    *reinterpret_cast<uint32_t*>(vreg_addr) = new_value;
+  }
+
   uintptr_t GetReturnPc() const;
 
   void SetReturnPc(uintptr_t new_ret_pc);
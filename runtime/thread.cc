@@ -987,11 +987,16 @@ Thread::Thread(bool daemon)
       no_thread_suspension_(0),
       last_no_thread_suspension_cause_(NULL),
       checkpoint_function_(0),
+      thread_local_start_(NULL),
+      thread_local_pos_(NULL),
+      thread_local_end_(NULL),
+      thread_local_objects_(0),
       thread_exit_check_count_(0) {
   CHECK_EQ((sizeof(Thread) % 4), 0U) << sizeof(Thread);
   state_and_flags_.as_struct.flags = 0;
   state_and_flags_.as_struct.state = kNative;
   memset(&held_mutexes_[0], 0, sizeof(held_mutexes_));
+  memset(&rosalloc_runs_[0], 0, sizeof(rosalloc_runs_));
 }
 
 bool Thread::IsStillStarting() const {
@@ -1012,9 +1017,10 @@ void Thread::AssertNoPendingException() const {
   }
 }
 
-static void MonitorExitVisitor(const mirror::Object* object, void* arg) NO_THREAD_SAFETY_ANALYSIS {
+static mirror::Object* MonitorExitVisitor(mirror::Object* object, void* arg)
+    NO_THREAD_SAFETY_ANALYSIS {
   Thread* self = reinterpret_cast<Thread*>(arg);
-  mirror::Object* entered_monitor = const_cast<mirror::Object*>(object);
+  mirror::Object* entered_monitor = object;
   if (self->HoldsLock(entered_monitor)) {
     LOG(WARNING) << "Calling MonitorExit on object "
                  << object << " (" << PrettyTypeOf(object) << ")"
@@ -1022,6 +1028,7 @@ static void MonitorExitVisitor(const mirror::Object* object, void* arg) NO_THREA
                  << *Thread::Current() << " which is detaching";
     entered_monitor->MonitorExit(self);
   }
+  return object;
 }
 
 void Thread::Destroy() {
@@ -1152,7 +1159,10 @@ void Thread::SirtVisitRoots(RootVisitor* visitor, void* arg) {
     for (size_t j = 0; j < num_refs; j++) {
       mirror::Object* object = cur->GetReference(j);
       if (object != NULL) {
-        visitor(object, arg);
+        mirror::Object* new_obj = visitor(object, arg);
+        if (new_obj != object) {
+          cur->SetReference(j, new_obj);
+        }
       }
     }
   }
@@ -1446,12 +1456,10 @@ jobjectArray Thread::InternalStackTraceToStackTraceElementArray(JNIEnv* env, job
     if (obj == NULL) {
       return NULL;
     }
-#ifdef MOVING_GARBAGE_COLLECTOR
-    // Re-read after potential GC
-    java_traces = Decode<ObjectArray<Object>*>(soa.Env(), result);
-    method_trace = down_cast<ObjectArray<Object>*>(Decode<Object*>(soa.Env(), internal));
-    pc_trace = down_cast<IntArray*>(method_trace->Get(depth));
-#endif
+    // Re-read after potential GC, the arrays may have moved.
+    java_traces = soa.Decode<mirror::ObjectArray<mirror::StackTraceElement>*>(result);
+    method_trace = soa.Decode<mirror::ObjectArray<mirror::Object>*>(internal);
+    pc_trace = down_cast<mirror::IntArray*>(method_trace->Get(method_trace->GetLength() - 1));
     java_traces->Set(i, obj);
   }
   return result;
@@ -1995,7 +2003,8 @@ bool Thread::HoldsLock(mirror::Object* object) {
   return object->GetThinLockId() == thin_lock_id_;
 }
 
-// RootVisitor parameters are: (const Object* obj, size_t vreg, const StackVisitor* visitor).
+// RootVisitor parameters are: (Object* obj, size_t vreg, const StackVisitor* visitor). The
+// visitor returns the new address of obj, which is written back into the frame if it moved.
 template <typename RootVisitor>
 class ReferenceMapVisitor : public StackVisitor {
  public:
@@ -2017,7 +2026,10 @@ class ReferenceMapVisitor : public StackVisitor {
         for (size_t reg = 0; reg < num_regs; ++reg) {
           mirror::Object* ref = shadow_frame->GetVRegReference(reg);
           if (ref != NULL) {
-            visitor_(ref, reg, this);
+            mirror::Object* new_ref = visitor_(ref, reg, this);
+            if (new_ref != ref) {
+              shadow_frame->SetVRegReference(reg, new_ref);
+            }
           }
         }
       } else {
@@ -2038,7 +2050,10 @@ class ReferenceMapVisitor : public StackVisitor {
           if (TestBitmap(reg, reg_bitmap)) {
             mirror::Object* ref = shadow_frame->GetVRegReference(reg);
             if (ref != NULL) {
-              visitor_(ref, reg, this);
+              mirror::Object* new_ref = visitor_(ref, reg, this);
+              if (new_ref != ref) {
+                shadow_frame->SetVRegReference(reg, new_ref);
+              }
             }
           }
         }
@@ -2069,19 +2084,28 @@ class ReferenceMapVisitor : public StackVisitor {
             // Does this register hold a reference?
             if (TestBitmap(reg, reg_bitmap)) {
               uint32_t vmap_offset;
-              mirror::Object* ref;
               if (vmap_table.IsInContext(reg, kReferenceVReg, &vmap_offset)) {
-                uintptr_t val = GetGPR(vmap_table.ComputeRegister(core_spills, vmap_offset,
-                                                                  kReferenceVReg));
-                ref = reinterpret_cast<mirror::Object*>(val);
+                uint32_t gpr = vmap_table.ComputeRegister(core_spills, vmap_offset,
+                                                          kReferenceVReg);
+                mirror::Object* ref = reinterpret_cast<mirror::Object*>(GetGPR(gpr));
+                if (ref != NULL) {
+                  mirror::Object* new_ref = visitor_(ref, reg, this);
+                  if (new_ref != ref) {
+                    SetGPR(gpr, reinterpret_cast<uintptr_t>(new_ref));
+                  }
+                }
               } else {
-                ref = reinterpret_cast<mirror::Object*>(GetVReg(cur_quick_frame, code_item,
-                                                                core_spills, fp_spills, frame_size,
-                                                                reg));
-              }
-
-              if (ref != NULL) {
-                visitor_(ref, reg, this);
+                mirror::Object* ref =
+                    reinterpret_cast<mirror::Object*>(GetVReg(cur_quick_frame, code_item,
+                                                              core_spills, fp_spills, frame_size,
+                                                              reg));
+                if (ref != NULL) {
+                  mirror::Object* new_ref = visitor_(ref, reg, this);
+                  if (new_ref != ref) {
+                    SetVReg(cur_quick_frame, code_item, core_spills, fp_spills, frame_size, reg,
+                            reinterpret_cast<uint32_t>(new_ref));
+                  }
+                }
               }
             }
           }
@@ -2107,8 +2131,8 @@ class RootCallbackVisitor {
  public:
   RootCallbackVisitor(RootVisitor* visitor, void* arg) : visitor_(visitor), arg_(arg) {}
 
-  void operator()(const mirror::Object* obj, size_t, const StackVisitor*) const {
-    visitor_(obj, arg_);
+  mirror::Object* operator()(mirror::Object* obj, size_t, const StackVisitor*) const {
+    return visitor_(obj, arg_);
   }
 
  private:
@@ -2123,8 +2147,9 @@ class VerifyCallbackVisitor {
         arg_(arg) {
   }
 
-  void operator()(const mirror::Object* obj, size_t vreg, const StackVisitor* visitor) const {
+  mirror::Object* operator()(mirror::Object* obj, size_t vreg, const StackVisitor* visitor) const {
     visitor_(obj, arg_, vreg, visitor);
+    return obj;
   }
 
  private:
@@ -2137,9 +2162,10 @@ struct VerifyRootWrapperArg {
   void* arg;
 };
 
-static void VerifyRootWrapperCallback(const mirror::Object* root, void* arg) {
+static mirror::Object* VerifyRootWrapperCallback(mirror::Object* root, void* arg) {
   VerifyRootWrapperArg* wrapperArg = reinterpret_cast<VerifyRootWrapperArg*>(arg);
   wrapperArg->visitor(root, wrapperArg->arg, 0, NULL);
+  return root;
 }
 
 void Thread::VerifyRoots(VerifyRootVisitor* visitor, void* arg) {
@@ -2185,14 +2211,17 @@ void Thread::VerifyRoots(VerifyRootVisitor* visitor, void* arg) {
 
 void Thread::VisitRoots(RootVisitor* visitor, void* arg) {
   if (opeer_ != NULL) {
-    visitor(opeer_, arg);
+    opeer_ = visitor(opeer_, arg);
   }
   if (exception_ != NULL) {
-    visitor(exception_, arg);
+    exception_ = down_cast<mirror::Throwable*>(visitor(exception_, arg));
   }
   throw_location_.VisitRoots(visitor, arg);
   if (class_loader_override_ != NULL) {
-    visitor(class_loader_override_, arg);
+    class_loader_override_ = down_cast<mirror::ClassLoader*>(visitor(class_loader_override_, arg));
+  }
+  if (monitor_enter_object_ != NULL) {
+    monitor_enter_object_ = visitor(monitor_enter_object_, arg);
   }
   jni_env_->locals.VisitRoots(visitor, arg);
   jni_env_->monitors.VisitRoots(visitor, arg);
@@ -2206,19 +2235,19 @@ void Thread::VisitRoots(RootVisitor* visitor, void* arg) {
   mapper.WalkStack();
   ReleaseLongJumpContext(context);
 
-  for (const instrumentation::InstrumentationStackFrame& frame : *GetInstrumentationStack()) {
-    mirror::Object* this_object = frame.this_object_;
-    if (this_object != NULL) {
-      visitor(this_object, arg);
+  for (instrumentation::InstrumentationStackFrame& frame : *GetInstrumentationStack()) {
+    if (frame.this_object_ != NULL) {
+      frame.this_object_ = visitor(frame.this_object_, arg);
     }
-    mirror::ArtMethod* method = frame.method_;
-    visitor(method, arg);
+    DCHECK(frame.method_ != NULL);
+    frame.method_ = down_cast<mirror::ArtMethod*>(visitor(frame.method_, arg));
   }
 }
 
-static void VerifyObject(const mirror::Object* root, void* arg) {
+static mirror::Object* VerifyObject(mirror::Object* root, void* arg) {
   gc::Heap* heap = reinterpret_cast<gc::Heap*>(arg);
   heap->VerifyObject(root);
+  return root;
 }
 
 void Thread::VerifyStackImpl() {
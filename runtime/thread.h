@@ -26,6 +26,7 @@
 #include <string>
 
 #include "base/macros.h"
+#include "catch_block_cache.h"
 #include "entrypoints/interpreter/interpreter_entrypoints.h"
 #include "entrypoints/jni/jni_entrypoints.h"
 #include "entrypoints/portable/portable_entrypoints.h"
@@ -73,6 +74,9 @@ class ShadowFrame;
 class Thread;
 class ThreadList;
 
+// Thread-local runs of the rosalloc allocator. Sync this with RosAlloc::kNumThreadLocalSizeBrackets.
+static constexpr size_t kRosAllocNumThreadLocalSizeBrackets = 8;
+
 // Thread priorities. These must match the Thread.MIN_PRIORITY,
 // Thread.NORM_PRIORITY, and Thread.MAX_PRIORITY constants.
 enum ThreadPriority {
@@ -283,6 +287,59 @@ class PACKED(4) Thread {
     return &stats_;
   }
 
+  CatchBlockCache* GetCatchBlockCache() {
+    return &catch_block_cache_;
+  }
+
+  // Thread-local allocation buffer (TLAB) support. The buffer is a region of the alloc space that
+  // only this thread bump allocates into, see DlMallocSpace::AllocThreadLocal.
+  bool HasThreadLocalBuffer() const {
+    return thread_local_start_ != NULL;
+  }
+
+  byte* GetThreadLocalBufferPos() const {
+    return thread_local_pos_;
+  }
+
+  byte* GetThreadLocalBufferEnd() const {
+    return thread_local_end_;
+  }
+
+  size_t GetThreadLocalObjectsAllocated() const {
+    return thread_local_objects_;
+  }
+
+  size_t GetThreadLocalBytesAllocated() const {
+    return thread_local_pos_ - thread_local_start_;
+  }
+
+  void SetThreadLocalBuffer(byte* start, byte* end) {
+    DCHECK_LE(start, end);
+    thread_local_start_ = start;
+    thread_local_pos_ = start;
+    thread_local_end_ = end;
+    thread_local_objects_ = 0;
+  }
+
+  // Advance the bump pointer by num_bytes, only called by the owning thread or while it is
+  // suspended.
+  void BumpThreadLocalBuffer(size_t num_bytes) {
+    DCHECK_LE(thread_local_pos_ + num_bytes, thread_local_end_);
+    thread_local_pos_ += num_bytes;
+    ++thread_local_objects_;
+  }
+
+  // The run of rosalloc size bracket idx that only this thread allocates from, see RosAlloc::Alloc.
+  void* GetRosAllocRun(size_t idx) const {
+    DCHECK_LT(idx, kRosAllocNumThreadLocalSizeBrackets);
+    return rosalloc_runs_[idx];
+  }
+
+  void SetRosAllocRun(size_t idx, void* run) {
+    DCHECK_LT(idx, kRosAllocNumThreadLocalSizeBrackets);
+    rosalloc_runs_[idx] = run;
+  }
+
   bool IsStillStarting() const;
 
   bool IsExceptionPending() const {
@@ -800,6 +857,16 @@ class PACKED(4) Thread {
   // Pending checkpoint functions.
   Closure* checkpoint_function_;
 
+  // Thread-local allocation buffer. [thread_local_start_, thread_local_pos_) holds objects that
+  // have been carved out, [thread_local_pos_, thread_local_end_) is still free.
+  byte* thread_local_start_;
+  byte* thread_local_pos_;
+  byte* thread_local_end_;
+  size_t thread_local_objects_;
+
+  // Thread-local rosalloc runs, one per small size bracket.
+  void* rosalloc_runs_[kRosAllocNumThreadLocalSizeBrackets];
+
  public:
   // Entrypoint function pointers
   // TODO: move this near the top, since changing its offset requires all oats to be recompiled!
@@ -812,6 +879,9 @@ class PACKED(4) Thread {
   // How many times has our pthread key's destructor been called?
   uint32_t thread_exit_check_count_;
 
+  // The handlers found for the exceptions this thread threw.
+  CatchBlockCache catch_block_cache_;
+
   friend class ScopedThreadStateChange;
 
   DISALLOW_COPY_AND_ASSIGN(Thread);
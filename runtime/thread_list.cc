@@ -23,6 +23,8 @@
 #include "base/mutex.h"
 #include "base/timing_logger.h"
 #include "debugger.h"
+#include "gc/heap.h"
+#include "runtime.h"
 #include "thread.h"
 #include "utils.h"
 
@@ -539,6 +541,9 @@ void ThreadList::Unregister(Thread* self) {
     // Note: we don't take the thread_suspend_count_lock_ here as to be suspending a thread other
     // than yourself you need to hold the thread_list_lock_ (see Thread::ModifySuspendCount).
     if (!self->IsSuspended()) {
+      // Hand back our allocation buffer while holding the thread_list_lock_ so that we don't race
+      // with the GC revoking it.
+      Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
       list_.remove(self);
       delete self;
       self = NULL;
@@ -76,6 +76,11 @@ int32_t ComputeUtf16Hash(const mirror::CharArray* chars, int32_t offset, size_t
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count);
 
+/*
+ * The java.lang.String hashCode() of a Modified UTF-8 string, computed without converting it.
+ */
+int32_t ComputeModifiedUtf8Hash(const char* utf8);
+
 /*
  * Retrieve the next UTF-16 character from a UTF-8 string.
  *
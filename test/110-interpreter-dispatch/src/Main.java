@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Loops of cheap bytecodes, the interpreter spends its time dispatching from one instruction
+ * to the next.
+ */
+public class Main {
+    static final int ITERATIONS = 200000;
+
+    private int field;
+    private static long staticField;
+
+    static public void main(String[] args) {
+        boolean timing = (args.length >= 1) && args[0].equals("--timing");
+
+        long time0 = System.nanoTime();
+        int arith = arithmetic(ITERATIONS);
+        long time1 = System.nanoTime();
+        long wide = wideArithmetic(ITERATIONS);
+        long time2 = System.nanoTime();
+        int arrays = arrays(ITERATIONS);
+        long time3 = System.nanoTime();
+        int fields = new Main().fields(ITERATIONS);
+        long time4 = System.nanoTime();
+        int invokes = invokes(ITERATIONS);
+        long time5 = System.nanoTime();
+        int branches = branches(ITERATIONS);
+        long time6 = System.nanoTime();
+
+        System.out.println("arithmetic: " + arith);
+        System.out.println("wide arithmetic: " + wide);
+        System.out.println("arrays: " + arrays);
+        System.out.println("fields: " + fields);
+        System.out.println("invokes: " + invokes);
+        System.out.println("branches: " + branches);
+
+        if (timing) {
+            printTime("arithmetic", time1 - time0);
+            printTime("wide arithmetic", time2 - time1);
+            printTime("arrays", time3 - time2);
+            printTime("fields", time4 - time3);
+            printTime("invokes", time5 - time4);
+            printTime("branches", time6 - time5);
+            printTime("total", time6 - time0);
+        }
+    }
+
+    static void printTime(String name, long nanos) {
+        System.out.printf("%s: %.3g msec, %.3g nsec per iteration\n", name,
+                          nanos / 1000000.0, nanos / (double) ITERATIONS);
+    }
+
+    static int arithmetic(int n) {
+        int a = 1;
+        int b = 3;
+        for (int i = 0; i < n; i++) {
+            a += i;
+            b ^= a;
+            a = (a << 3) - b;
+            b = b * 5 + 7;
+            a >>>= 1;
+            b = b & 0xffff | i;
+        }
+        return a + b;
+    }
+
+    static long wideArithmetic(int n) {
+        long a = 1;
+        long b = 3;
+        for (int i = 0; i < n; i++) {
+            a += i;
+            b ^= a;
+            a = (a << 5) - b;
+            b = b * 3 + 11;
+            a >>>= 2;
+        }
+        return a + b;
+    }
+
+    static int arrays(int n) {
+        int[] ints = new int[16];
+        char[] chars = new char[16];
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            int j = i & 15;
+            ints[j] += i;
+            chars[j] = (char) (ints[j] + j);
+            sum += chars[(j + 1) & 15] + ints.length;
+        }
+        return sum;
+    }
+
+    int fields(int n) {
+        for (int i = 0; i < n; i++) {
+            field += i;
+            staticField += field;
+            field ^= (int) staticField;
+        }
+        return field + (int) staticField;
+    }
+
+    static int leaf(int x) {
+        return x + 1;
+    }
+
+    int virtualLeaf(int x) {
+        return x + field;
+    }
+
+    static int invokes(int n) {
+        Main m = new Main();
+        m.field = 3;
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum = leaf(sum);
+            sum = m.virtualLeaf(sum);
+        }
+        return sum;
+    }
+
+    static int branches(int n) {
+        int count = 0;
+        for (int i = 0; i < n; i++) {
+            switch (i & 7) {
+                case 0: count += 1; break;
+                case 1: count -= 2; break;
+                case 2: count ^= 3; break;
+                case 3: count += i; break;
+                default:
+                    if (i % 3 == 0) {
+                        count++;
+                    } else if (count > i) {
+                        count--;
+                    }
+                    break;
+            }
+        }
+        return count;
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Interface calls from compiled code, see mirror::Class::imtable_.
+ */
+public class Main {
+    public static void main(String[] args) {
+        testSingleImplementation();
+        testSharedSlot();
+        testIncompatible("NoInterfaces", new NoInterfaces());
+        testIncompatible("MarkerOnly", new MarkerOnly());
+        testIncompatible("OtherOnly", new OtherOnly());
+        testIncompatible("ManyOnly", new ManyOnly());
+    }
+
+    static void testSingleImplementation() {
+        Both both = new Both();
+        Iface iface = both;
+        IfaceOther other = both;
+        int sum = 0;
+        for (int i = 0; i < 1000; ++i) {
+            sum += iface.get() + other.other();
+        }
+        System.out.println("single implementation: " + sum);
+    }
+
+    static void testSharedSlot() {
+        Many many = new ManyImpl();
+        boolean ok = many.m00() == 0 && many.m64() == 64;
+        int sum = 0;
+        for (int i = 0; i < 10; ++i) {
+            sum += many.m00() + many.m01() + many.m02() + many.m03() + many.m04() + many.m05() +
+                many.m06() + many.m07() + many.m08() + many.m09() + many.m10() + many.m11() +
+                many.m12() + many.m13() + many.m14() + many.m15() + many.m16() + many.m17() +
+                many.m18() + many.m19() + many.m20() + many.m21() + many.m22() + many.m23() +
+                many.m24() + many.m25() + many.m26() + many.m27() + many.m28() + many.m29() +
+                many.m30() + many.m31() + many.m32() + many.m33() + many.m34() + many.m35() +
+                many.m36() + many.m37() + many.m38() + many.m39() + many.m40() + many.m41() +
+                many.m42() + many.m43() + many.m44() + many.m45() + many.m46() + many.m47() +
+                many.m48() + many.m49() + many.m50() + many.m51() + many.m52() + many.m53() +
+                many.m54() + many.m55() + many.m56() + many.m57() + many.m58() + many.m59() +
+                many.m60() + many.m61() + many.m62() + many.m63() + many.m64();
+        }
+        System.out.println("shared slot: " + ok + " " + sum);
+    }
+
+    // The receiver's class implemented Iface when this was compiled, it doesn't any more.
+    static void testIncompatible(String name, Iface iface) {
+        for (int i = 0; i < 2; ++i) {
+            try {
+                iface.get();
+                System.out.println(name + ": call succeeded unexpectedly");
+            } catch (IncompatibleClassChangeError expected) {
+                System.out.println(name + ": got expected ICCE");
+            }
+        }
+    }
+}
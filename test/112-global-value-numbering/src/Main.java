@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Loads and computations that global value numbering may or may not reuse, see
+ * compiler/dex/global_value_numbering.cc. Each test compares its result with the one of the
+ * unoptimized code.
+ */
+public class Main {
+    int field;
+    long wideField;
+    static int staticField;
+
+    public static void main(String[] args) {
+        constantsTest();
+        arithmeticTest(7, 5);
+        fieldLoadsTest();
+        arrayLoadsTest();
+        mergeTest();
+        catchTest();
+        nullCheckTest();
+        rangeCheckTest();
+    }
+
+    static void check(String name, long result, long expected) {
+        if (result == expected) {
+            System.out.println(name + " passes");
+        } else {
+            System.out.println(name + " fails: " + result + " (expecting " + expected + ")");
+        }
+    }
+
+    // Constants whose halves are alike must keep distinct values: const/high16 and
+    // const-wide/high16 of negative values, and wide constants with equal low words.
+    static void constantsTest() {
+        int high16 = 0xffff0000;
+        int high16Again = 0xffff0000;
+        int other = 0x7fff0000;
+        long wideHigh16 = 0xffff000000000000L;
+        long wideHigh16Again = 0xffff000000000000L;
+        long lowOnes = 0x00000000ffffffffL;
+        long allOnes = -1L;
+        long wideSmall = -8L;
+        int intSmall = -8;
+        int failures = 0;
+        if (high16 != high16Again || high16 == other || high16 != -65536) {
+            failures++;
+        }
+        if (wideHigh16 != wideHigh16Again || wideHigh16 != (-65536L << 32)) {
+            failures++;
+        }
+        if (lowOnes == allOnes || lowOnes != 4294967295L) {
+            failures++;
+        }
+        if (wideSmall != intSmall || wideSmall + 8 != 0) {
+            failures++;
+        }
+        check("constantsTest", failures, 0);
+    }
+
+    // Repeated pure operations, and operations whose operands only differ in order.
+    static void arithmeticTest(int a, int b) {
+        int x = a + b;
+        int y = a + b;
+        int z = a - b;
+        int w = b - a;
+        int v = (a * b) + (a * b);
+        a = a + 1;
+        int u = a + b;
+        check("arithmeticTest", x + y * 10 + z * 100 + w * 1000 + v * 10000 + u * 100000,
+              12 + 120 + 200 - 2000 + 700000 + 1300000);
+    }
+
+    int getAndIncrement() {
+        return field++;
+    }
+
+    // Loads of a field must not be reused across a store to it, through this or another
+    // reference to the same object, a call or an allocation.
+    static void fieldLoadsTest() {
+        Main m = new Main();
+        Main alias = m;
+        m.field = 1;
+        m.wideField = 1L << 40;
+        int sum = m.field + m.field;        // 2
+        alias.field = 10;
+        sum += m.field;                     // 12
+        m.getAndIncrement();
+        sum += m.field;                     // 23
+        long wide = m.wideField;
+        alias.wideField = 3;
+        wide += m.wideField;
+        staticField = 5;
+        sum += staticField;                 // 28
+        staticField = 6;
+        sum += staticField;                 // 34
+        check("fieldLoadsTest", sum + wide, 34 + (1L << 40) + 3);
+    }
+
+    // Loads of an element must not be reused across a store to the array through an alias, nor
+    // across a store to another index that may be the same.
+    static void arrayLoadsTest() {
+        int[] a = new int[4];
+        int[] alias = a;
+        int i = 1;
+        int j = 1;
+        a[i] = 3;
+        int sum = a[i] + a[i];              // 6
+        alias[i] = 4;
+        sum += a[i];                        // 10
+        a[j] = 5;
+        sum += a[i];                        // 15
+        check("arrayLoadsTest", sum, 15);
+    }
+
+    static void mergeHelper(Main m, boolean store) {
+        int before = m.field;
+        if (store) {
+            m.field = before + 100;
+        }
+        // Not dominated by a store on every path, the load must see it when there was one.
+        int after = m.field;
+        check("mergeTest " + store, after - before, store ? 100 : 0);
+    }
+
+    static void mergeTest() {
+        Main m = new Main();
+        m.field = 1;
+        mergeHelper(m, false);
+        mergeHelper(m, true);
+    }
+
+    static void store(Main m, int value, boolean doThrow) {
+        m.field = value;
+        if (doThrow) {
+            throw new RuntimeException();
+        }
+    }
+
+    // The catch handler must reload what the try block stored before throwing.
+    static void catchTest() {
+        Main m = new Main();
+        m.field = 1;
+        int before = m.field;
+        int caught = 0;
+        try {
+            store(m, 2, true);
+        } catch (RuntimeException e) {
+            caught = m.field;
+        }
+        check("catchTest", before * 10 + caught, 12);
+    }
+
+    // The first of two dominating checks must still throw.
+    static void nullCheckTest() {
+        Main m = null;
+        int result = 0;
+        try {
+            result = m.field;
+            result += m.field;
+            result = -1;
+        } catch (NullPointerException expected) {
+            result = 1;
+        }
+        check("nullCheckTest", result, 1);
+    }
+
+    static int twice(int[] a, int i) {
+        return a[i] + a[i];
+    }
+
+    static void rangeCheckTest() {
+        int[] a = new int[] { 1, 2, 3 };
+        int result = twice(a, 2);
+        try {
+            result += twice(a, 3);
+            result = -1;
+        } catch (ArrayIndexOutOfBoundsException expected) {
+            result += 100;
+        }
+        check("rangeCheckTest", result, 106);
+    }
+}
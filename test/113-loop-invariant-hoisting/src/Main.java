@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Loops with computations which may or may not be hoisted to the preheader, see
+ * MIRGraph::HoistLoopInvariants. Each test compares its result with the one of the unoptimized
+ * code.
+ */
+public class Main {
+    int field;
+    long wideField;
+
+    public static void main(String[] args) {
+        arithmeticTest(3, 4, 10);
+        wideArithmeticTest(3L, 10);
+        divisionTest(0, 10);
+        nestedTest(2, 5);
+        fieldTest();
+        fieldStoredInLoopTest();
+        fieldStoredByCallTest();
+        nullReceiverTest();
+        arrayLengthTest();
+        redefinedTest(3, 5);
+    }
+
+    static void check(String name, long result, long expected) {
+        if (result == expected) {
+            System.out.println(name + " passes");
+        } else {
+            System.out.println(name + " fails: " + result + " (expecting " + expected + ")");
+        }
+    }
+
+    static void arithmeticTest(int a, int b, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += a * b + (a << 2) - i;
+        }
+        check("arithmeticTest", sum, 10 * (12 + 12) - 45);
+    }
+
+    static void wideArithmeticTest(long a, int n) {
+        long sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += (a << 40) + i;
+        }
+        check("wideArithmeticTest", sum, 10 * (3L << 40) + 45);
+    }
+
+    // A division by an invariant zero that the loop never executes mustn't throw.
+    static void divisionTest(int d, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            if (d != 0) {
+                sum += 100 / d;
+            }
+            sum += i;
+        }
+        check("divisionTest", sum, 45);
+    }
+
+    // Invariants of the outer loop computed in the inner one.
+    static void nestedTest(int a, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            int outer = i * 3;
+            for (int j = 0; j < n; j++) {
+                sum += a * 7 + outer + j;
+            }
+        }
+        check("nestedTest", sum, 25 * 14 + 5 * 3 * 10 + 5 * 10);
+    }
+
+    static void fieldTest() {
+        Main m = new Main();
+        m.field = 5;
+        m.wideField = 1L << 33;
+        long sum = 0;
+        for (int i = 0; i < 10; i++) {
+            sum += m.field + m.wideField;
+        }
+        check("fieldTest", sum, 50 + (10L << 33));
+    }
+
+    static void fieldStoredInLoopTest() {
+        Main m = new Main();
+        int sum = 0;
+        for (int i = 0; i < 10; i++) {
+            sum += m.field;
+            m.field = i;
+        }
+        check("fieldStoredInLoopTest", sum, 36);
+    }
+
+    void increment() {
+        field++;
+    }
+
+    static void fieldStoredByCallTest() {
+        Main m = new Main();
+        int sum = 0;
+        for (int i = 0; i < 10; i++) {
+            sum += m.field;
+            m.increment();
+        }
+        check("fieldStoredByCallTest", sum, 45);
+    }
+
+    static int sumField(Main m, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += m.field;
+        }
+        return sum;
+    }
+
+    // A get of a null receiver throws in the first iteration, not when the loop isn't entered.
+    static void nullReceiverTest() {
+        int result = sumField(null, 0);
+        try {
+            result += sumField(null, 3);
+            result = -1;
+        } catch (NullPointerException expected) {
+            result += 100;
+        }
+        check("nullReceiverTest", result, 100);
+    }
+
+    static void arrayLengthTest() {
+        int[] a = new int[1];
+        int sum = 0;
+        for (int i = 0; i < 5; i++) {
+            sum += a.length;
+            a = new int[a.length + 1];
+        }
+        check("arrayLengthTest", sum, 1 + 2 + 3 + 4 + 5);
+    }
+
+    // The register of an invariant computation is written again in the loop.
+    static void redefinedTest(int a, int b) {
+        int sum = 0;
+        for (int i = 0; i < 4; i++) {
+            int t = a + b;
+            if (i > 1) {
+                t = t * 2;
+            }
+            sum += t;
+        }
+        check("redefinedTest", sum, 8 + 8 + 16 + 16);
+    }
+}
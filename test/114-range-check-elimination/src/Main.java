@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Loops over arrays indexed by their induction variable, see MIRGraph::RangeCheckElimination. The
+ * in range accesses must work, and every out of range index must still throw.
+ */
+public class Main {
+    public static void main(String[] args) {
+        int[] a = new int[] { 1, 2, 3, 4, 5 };
+        int[] shorter = new int[] { 1, 2, 3 };
+        check("upToLength", upToLength(a), 15);
+        check("downFromLength", downFromLength(a), 15);
+        check("newArray", newArray(), 45);
+        expectThrow("upToConstant", a, shorter, 0);
+        expectThrow("upToOtherLength", a, shorter, 1);
+        expectThrow("upToLengthInclusive", a, shorter, 2);
+        expectThrow("downFromLengthExclusive", a, shorter, 3);
+        expectThrow("negativeStart", a, shorter, 4);
+        expectThrow("parameterStart", a, shorter, 5);
+        expectThrow("arrayReplaced", a, shorter, 6);
+        expectThrow("stepByTwo", a, shorter, 7);
+        expectThrow("newArrayTooShort", a, shorter, 8);
+    }
+
+    static void check(String name, int result, int expected) {
+        if (result == expected) {
+            System.out.println(name + " passes");
+        } else {
+            System.out.println(name + " fails: " + result + " (expecting " + expected + ")");
+        }
+    }
+
+    static int upToLength(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int downFromLength(int[] a) {
+        int sum = 0;
+        for (int i = a.length - 1; i >= 0; i--) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int newArray() {
+        int[] b = new int[10];
+        for (int i = 0; i < 10; i++) {
+            b[i] = i;
+        }
+        return upToLength(b);
+    }
+
+    static int upToConstant(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < 10; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int upToOtherLength(int[] a, int[] b) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += b[i];
+        }
+        return sum;
+    }
+
+    static int upToLengthInclusive(int[] a) {
+        int sum = 0;
+        for (int i = 0; i <= a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int downFromLengthExclusive(int[] a) {
+        int sum = 0;
+        for (int i = a.length; i >= 0; i--) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int negativeStart(int[] a) {
+        int sum = 0;
+        for (int i = -1; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int parameterStart(int[] a, int start) {
+        int sum = 0;
+        for (int i = start; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int arrayReplaced(int[] a, int[] b) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            a = b;
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int stepByTwo(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i += 2) {
+            sum += a[i + 1];
+        }
+        return sum;
+    }
+
+    static int newArrayTooShort() {
+        int[] b = new int[5];
+        int sum = 0;
+        for (int i = 0; i < 10; i++) {
+            b[i] = i;
+            sum += i;
+        }
+        return sum;
+    }
+
+    static void expectThrow(String name, int[] a, int[] shorter, int which) {
+        try {
+            switch (which) {
+                case 0: upToConstant(a); break;
+                case 1: upToOtherLength(a, shorter); break;
+                case 2: upToLengthInclusive(a); break;
+                case 3: downFromLengthExclusive(a); break;
+                case 4: negativeStart(a); break;
+                case 5: parameterStart(a, -2); break;
+                case 6: arrayReplaced(a, shorter); break;
+                case 7: stepByTwo(a); break;
+                default: newArrayTooShort(); break;
+            }
+            System.out.println(name + " fails: no exception");
+        } catch (ArrayIndexOutOfBoundsException expected) {
+            System.out.println(name + " passes");
+        }
+    }
+}
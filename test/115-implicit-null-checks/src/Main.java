@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Accesses through null references, see Mir2Lir::NeedsImplicitNullCheck. Each must throw a
+ * NullPointerException whose top frame is the method of the access, and leave the locals of a
+ * method catching it intact.
+ */
+public class Main {
+    int intField;
+    long longField;
+    Object objectField;
+
+    public static void main(String[] args) {
+        Main m = new Main();
+        m.intField = 1;
+        m.longField = 2;
+        m.objectField = "3";
+        int[] ints = new int[] { 4 };
+        long[] longs = new long[] { 5 };
+        Object[] objects = new Object[] { "6" };
+        for (int i = 0; i < 2; i++) {
+            // The first pass checks the accesses work, the second that they throw.
+            Main receiver = (i == 0) ? m : null;
+            int[] intArray = (i == 0) ? ints : null;
+            long[] longArray = (i == 0) ? longs : null;
+            Object[] objectArray = (i == 0) ? objects : null;
+            try {
+                check("igetInt", igetInt(receiver), 1);
+            } catch (NullPointerException e) {
+                expect("igetInt", e);
+            }
+            try {
+                check("igetLong", (int) igetLong(receiver), 2);
+            } catch (NullPointerException e) {
+                expect("igetLong", e);
+            }
+            try {
+                check("igetObject", igetObject(receiver).hashCode(), "3".hashCode());
+            } catch (NullPointerException e) {
+                expect("igetObject", e);
+            }
+            try {
+                iputInt(receiver, 1);
+                check("iputInt", m.intField, 1);
+            } catch (NullPointerException e) {
+                expect("iputInt", e);
+            }
+            try {
+                iputObject(receiver, "3");
+                check("iputObject", m.objectField.hashCode(), "3".hashCode());
+            } catch (NullPointerException e) {
+                expect("iputObject", e);
+            }
+            try {
+                check("arrayLength", arrayLength(intArray), 1);
+            } catch (NullPointerException e) {
+                expect("arrayLength", e);
+            }
+            try {
+                check("agetInt", agetInt(intArray), 4);
+            } catch (NullPointerException e) {
+                expect("agetInt", e);
+            }
+            try {
+                check("agetLong", (int) agetLong(longArray), 5);
+            } catch (NullPointerException e) {
+                expect("agetLong", e);
+            }
+            try {
+                check("agetObject", agetObject(objectArray).hashCode(), "6".hashCode());
+            } catch (NullPointerException e) {
+                expect("agetObject", e);
+            }
+            try {
+                aputInt(intArray, 4);
+                check("aputInt", ints[0], 4);
+            } catch (NullPointerException e) {
+                expect("aputInt", e);
+            }
+        }
+        check("catchInSameMethod", catchInSameMethod(m, 7), 1 + 7);
+        check("catchInSameMethod", catchInSameMethod(null, 7), -7);
+    }
+
+    static void check(String name, int result, int expected) {
+        if (result != expected) {
+            System.out.println(name + " fails: " + result + " (expecting " + expected + ")");
+        }
+    }
+
+    static void expect(String name, NullPointerException e) {
+        String method = e.getStackTrace()[0].getMethodName();
+        if (method.equals(name)) {
+            System.out.println(name + " throws");
+        } else {
+            System.out.println(name + " throws from " + method);
+        }
+    }
+
+    static int igetInt(Main m) {
+        return m.intField;
+    }
+
+    static long igetLong(Main m) {
+        return m.longField;
+    }
+
+    static Object igetObject(Main m) {
+        return m.objectField;
+    }
+
+    static void iputInt(Main m, int value) {
+        m.intField = value;
+    }
+
+    static void iputObject(Main m, Object value) {
+        m.objectField = value;
+    }
+
+    static int arrayLength(int[] a) {
+        return a.length;
+    }
+
+    static int agetInt(int[] a) {
+        return a[0];
+    }
+
+    static long agetLong(long[] a) {
+        return a[0];
+    }
+
+    static Object agetObject(Object[] a) {
+        return a[0];
+    }
+
+    static void aputInt(int[] a, int value) {
+        a[0] = value;
+    }
+
+    // The value is live across the faulting access and must be intact in the handler.
+    static int catchInSameMethod(Main m, int value) {
+        int result = value;
+        try {
+            result += m.intField;
+        } catch (NullPointerException e) {
+            result = -value;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Fills the heap with young objects until it runs out of memory, so that the survivors of the
+ * nursery stop fitting into the old generation.
+ */
+public class Main {
+    static class Node {
+        Node next;
+        int value;
+        int hashCode;
+    }
+
+    public static void main(String[] args) {
+        // The second round starts with whatever the first one left in the nursery.
+        for (int round = 0; round < 2; ++round) {
+            Node head = null;
+            int count = 0;
+            try {
+                while (true) {
+                    Node node = new Node();
+                    node.next = head;
+                    node.value = count;
+                    // Hashed objects grow by a word when they are moved.
+                    if ((count & 3) == 0) {
+                        node.hashCode = System.identityHashCode(node);
+                    }
+                    head = node;
+                    ++count;
+                }
+            } catch (OutOfMemoryError e) {
+            }
+            int expected = count;
+            for (Node node = head; node != null; node = node.next) {
+                --expected;
+                if (node.value != expected) {
+                    System.out.println("round " + round + ": bad value " + node.value);
+                    return;
+                }
+                if ((expected & 3) == 0 && System.identityHashCode(node) != node.hashCode) {
+                    System.out.println("round " + round + ": hash code changed for " + expected);
+                    return;
+                }
+            }
+            if (expected != 0) {
+                System.out.println("round " + round + ": lost " + expected + " nodes");
+                return;
+            }
+            head = null;
+            System.out.println("round " + round + ": ok");
+        }
+        System.out.println("Test complete");
+    }
+}
@@ -25,6 +25,7 @@ TEST_DEX_DIRECTORIES := \
 	AllFields \
 	CreateMethodSignature \
 	ExceptionHandle \
+	Inline \
 	Interfaces \
 	Main \
 	MyClass \
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Trivial methods whose calls the compiler inlines.
+final class Inline {
+  private int i;
+  private long j;
+  private Object o;
+
+  Inline(int i, long j, Object o) {
+    this.i = i;
+    this.j = j;
+    this.o = o;
+  }
+
+  private int getI() {
+    return i;
+  }
+
+  private void setI(int i) {
+    this.i = i;
+  }
+
+  long getJ() {
+    return j;
+  }
+
+  void setJ(long j) {
+    this.j = j;
+  }
+
+  Object getO() {
+    return o;
+  }
+
+  void nothing() {
+  }
+
+  int constant() {
+    return 42;
+  }
+
+  static int identity(int x) {
+    return x;
+  }
+
+  static long identityWide(long x) {
+    return x;
+  }
+
+  static long sum(Inline a) {
+    a.setI(a.getI() + identity(1));
+    a.setJ(a.getJ() + identityWide(2L));
+    a.nothing();
+    return a.getI() + a.getJ() + a.constant() + (a.getO() == null ? 0 : 100);
+  }
+
+  static boolean nullReceiver(Inline a) {
+    try {
+      a.nothing();
+    } catch (NullPointerException e) {
+      return true;
+    }
+    return false;
+  }
+}